@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -63,6 +66,57 @@ struct VideoFrame {
     int format;            ///< 像素格式标识符
 };
 
+/**
+ * @brief 像素格式
+ * @details VideoFrame::format的取值
+ */
+enum VideoFormat : int {
+    kVideoFormatRGBA = 0,   ///< 打包RGBA，8位
+    kVideoFormatI420 = 1,   ///< 平面YUV 4:2:0，8位
+    kVideoFormatNV12 = 2,   ///< 半平面YUV 4:2:0，8位
+    kVideoFormatP010 = 3,   ///< 半平面YUV 4:2:0，每个采样16位小端，10位有效值在高位（低6位为0）
+    kVideoFormatI010 = 4,   ///< 平面YUV 4:2:0，每个采样16位小端，10位有效值在低位
+};
+
+/**
+ * @brief 像素格式的有效位深
+ * @param[in] format 像素格式
+ * @return 8或10，格式无效时返回0
+ *
+ * @note 高位深格式在整条链路中保持原格式，不会被隐式转换为8位
+ */
+int videoFormatBitDepth(int format);
+
+/**
+ * @brief 计算视频帧的内存布局
+ * @param[in] format 像素格式
+ * @param[in] width 宽度
+ * @param[in] height 高度
+ * @param[out] linesize 各平面行字节数（按64字节对齐），未使用的平面为0
+ * @param[out] offsets 各平面相对帧起始的偏移
+ * @return 整帧字节数，格式或尺寸无效时返回0
+ */
+size_t videoFrameLayout(int format, int width, int height, int linesize[4], size_t offsets[4]);
+
+/**
+ * @brief 把源帧复制到目标帧左上角，超出目标的部分裁掉
+ * @param[in,out] dst 目标帧，data须已指向足够大的缓冲区
+ * @param[in] src 源帧
+ * @return false表示格式不一致或源帧没有数据
+ */
+bool copyVideoFrame(VideoFrame& dst, const VideoFrame& src);
+
+/**
+ * @brief 把源帧转换为目标帧的像素格式
+ * @param[in,out] dst 目标帧，格式、尺寸与data须已设置好
+ * @param[in] src 源帧，尺寸与目标帧相同
+ * @return false表示格式不支持、尺寸不一致或源帧没有数据
+ *
+ * @note RGBA与YUV之间按BT.709有限范围换算，RGBA的alpha被丢弃，转为RGBA时alpha为255；
+ *       YUV格式之间只换算位深和平面布局，RGBA转YUV的色度取2x2像素的平均值
+ */
+bool convertVideoFrame(VideoFrame& dst, const VideoFrame& src);
+
 /**
  * @brief 音频帧数据结构
  * @details 存储音频帧的采样数据和元信息，支持多声道
@@ -75,6 +129,164 @@ struct AudioFrame {
     FrameTime timestamp;   ///< 时间戳，用于同步
 };
 
+/**
+ * @brief 编码数据包类型
+ */
+enum class PacketType {
+    Video,   ///< 视频数据包
+    Audio    ///< 音频数据包
+};
+
+/**
+ * @brief 编码数据包
+ * @details 编码器的输出单元，输出模块据此进行封装和发送
+ */
+struct EncodedPacket {
+    std::vector<uint8_t> data;          ///< 压缩数据
+    FrameTime pts{0};                   ///< 显示时间戳
+    FrameTime dts{0};                   ///< 解码时间戳
+    FrameTime duration{0};              ///< 数据包时长
+    PacketType type = PacketType::Audio;  ///< 数据包类型
+    int track = 0;                      ///< 轨道索引，多轨录制时区分音轨
+    bool keyframe = false;              ///< 是否为关键帧（音频包总是可独立解码）
+};
+
+/**
+ * @brief 音频块大小范围（采样点）
+ * @details 混音器、重采样器和滤镜均按该块大小处理音频。
+ *          小块适合低延迟监听，大块适合批量编码的吞吐量。
+ */
+constexpr int kMinAudioBlockSize = 64;
+constexpr int kMaxAudioBlockSize = 1024;
+constexpr int kDefaultAudioBlockSize = 480;
+
+/**
+ * @brief 引擎音频配置
+ * @details 描述混音总线的统一格式，所有源的音频在混音前都会被转换为此格式
+ */
+struct AudioSettings {
+    int sample_rate = 48000;                   ///< 采样率（Hz）
+    int channels = 2;                          ///< 声道数（1-8）
+    int block_size = kDefaultAudioBlockSize;   ///< 每个音频块的采样点数（64-1024）
+};
+
+/**
+ * @brief 引擎视频配置
+ * @details 描述输出画布，场景渲染到从画布帧池取得的帧上
+ */
+struct VideoSettings {
+    int width = 1920;                  ///< 画布宽度
+    int height = 1080;                 ///< 画布高度
+    int fps = 60;                      ///< 输出帧率
+    int format = kVideoFormatRGBA;     ///< 画布像素格式
+    int frame_pool_size = 8;           ///< 画布帧池的帧数
+    bool huge_pages = true;            ///< 帧池是否尝试使用2MB大页
+    int numa_node = -1;                ///< 渲染线程和画布帧池绑定的NUMA节点，-1表示不绑定
+};
+
+/**
+ * @brief 音频链路延迟统计
+ * @details 从源采集时间戳到混音块交付给下游（编码器/监听）之间的端到端延迟
+ */
+struct AudioLatencyStats {
+    FrameTime block_duration{0};   ///< 单个音频块的时长
+    FrameTime last{0};             ///< 最近一个块的延迟
+    FrameTime min{0};              ///< 最小延迟
+    FrameTime max{0};              ///< 最大延迟
+    FrameTime average{0};          ///< 平均延迟
+    uint64_t blocks = 0;           ///< 已统计的音频块数量
+};
+
+/**
+ * @brief 音频监听配置
+ * @details 监听链路把混音结果送到本地设备，设备运行在自己的时钟域中
+ */
+struct AudioMonitorSettings {
+    std::string sink = "auto";      ///< 输出类型："auto"、"pulse"、"alsa"、"wav"、"pipe"
+    std::string device;             ///< 设备名（pulse/alsa）或文件路径（wav/pipe）
+    int sample_rate = 48000;        ///< 设备采样率（Hz）
+    int period_frames = 256;        ///< 每次写入设备的采样点数
+    int target_latency_ms = 40;     ///< 目标缓冲延迟（毫秒）
+    double clock_scale = 1.0;       ///< wav/pipe虚拟设备时钟相对标称速率的比例，用于模拟时钟漂移
+};
+
+/**
+ * @brief 音频监听统计
+ */
+struct AudioMonitorStats {
+    bool running = false;           ///< 是否正在监听
+    std::string sink;               ///< 实际使用的输出类型
+    uint64_t frames_written = 0;    ///< 已写入设备的采样点数
+    uint64_t underruns = 0;         ///< 设备取数时缓冲不足的次数
+    uint64_t dropped_blocks = 0;    ///< 因缓冲区满被丢弃的混音块数
+    double resample_ratio = 1.0;    ///< 当前漂移补偿系数
+    FrameTime buffered{0};          ///< 当前缓冲的音频时长
+};
+
+/**
+ * @brief 单个子系统的内存占用
+ */
+struct MemorySubsystemStats {
+    std::string name;                   ///< 子系统名称，如"frame_pool"
+    int priority = 0;                   ///< 淘汰优先级（MemoryPriority），越小越先被淘汰
+    uint64_t used = 0;                  ///< 当前占用字节数
+    uint64_t peak = 0;                  ///< 峰值占用字节数
+    uint64_t evicted = 0;               ///< 累计被淘汰的字节数
+    uint64_t failed_reservations = 0;   ///< 因超出预算被拒绝的申请次数
+};
+
+/**
+ * @brief 引擎内存统计
+ * @details 由引擎内存预算汇总，各子系统申请内存时登记
+ */
+struct MemoryStats {
+    uint64_t limit = 0;                 ///< 内存上限（字节），0表示不限制
+    uint64_t used = 0;                  ///< 当前登记的总占用
+    uint64_t peak = 0;                  ///< 峰值总占用
+    uint64_t evicted = 0;               ///< 累计淘汰的字节数
+    uint64_t failed_reservations = 0;   ///< 被拒绝的申请次数
+    std::vector<MemorySubsystemStats> subsystems;   ///< 各子系统占用
+};
+
+/**
+ * @brief 截图编码格式
+ */
+enum class ImageFormat {
+    Png,    ///< 无损PNG
+    Jpeg    ///< 基线JPEG
+};
+
+/**
+ * @brief 截图请求
+ * @details scene和source都为空时截取当前场景；只给出source时先在当前场景中查找
+ */
+struct ScreenshotRequest {
+    std::string scene;                      ///< 场景名称，为空表示当前场景
+    std::string source;                     ///< 源名称，非空时截取该源的画面
+    ImageFormat format = ImageFormat::Png;  ///< 编码格式
+    int quality = 85;                       ///< JPEG质量（1~100）
+    int max_width = 0;                      ///< 缩略图最大宽度，0表示原尺寸
+    int max_height = 0;                     ///< 缩略图最大高度，0表示原尺寸
+};
+
+/**
+ * @brief 截图结果
+ */
+struct Screenshot {
+    bool ok = false;                        ///< 是否成功
+    std::string error;                      ///< 失败原因
+    ImageFormat format = ImageFormat::Png;  ///< 编码格式
+    int width = 0;                          ///< 编码后的宽度
+    int height = 0;                         ///< 编码后的高度
+    FrameTime timestamp{0};                 ///< 所截帧的时间戳
+    std::vector<uint8_t> data;              ///< 编码后的图像文件内容
+};
+
+/**
+ * @brief 截图完成回调，在截图工作线程中调用
+ */
+using ScreenshotCallback = std::function<void(const Screenshot&)>;
+
 /**
  * @brief 基础接口类
  * @details 所有SimpleOBS组件的基类，提供统一的命名和生命周期管理接口
@@ -106,6 +318,20 @@ public:
      * @details 释放资源，停止所有活动
      */
     virtual void shutdown() = 0;
+
+    /**
+     * @brief 设置组件属性
+     * @param[in] key 属性名
+     * @param[in] value 属性值（文本形式）
+     * @return true表示已应用，false表示不支持该属性或值无效
+     *
+     * @note 运行中由渲染线程在两次渲染之间调用，默认不支持任何属性
+     */
+    virtual bool setProperty(const std::string& key, const std::string& value) {
+        (void)key;
+        (void)value;
+        return false;
+    }
 };
 
 /**
@@ -125,7 +351,8 @@ public:
 
     /**
      * @brief 获取音频帧
-     * @param[out] frame 输出音频帧数据
+     * @param[in,out] frame 调用前samples/sample_rate为场景期望的块大小和采样率（0表示未指定），
+     *                      返回时为输出音频帧数据
      * @return true表示成功获取帧，false表示无帧或错误
      */
     virtual bool getAudioFrame(AudioFrame& frame) = 0;
@@ -170,6 +397,20 @@ public:
      * @return true表示编码成功，false表示编码失败
      */
     virtual bool encodeFrame(const AudioFrame& frame) = 0;
+
+    /**
+     * @brief 取出一个已编码的数据包
+     * @param[out] packet 输出数据包
+     * @return true表示取到数据包，false表示暂无输出
+     */
+    virtual bool receivePacket(EncodedPacket& packet) = 0;
+
+    /**
+     * @brief 获取编解码器配置数据
+     * @param[out] data 配置数据，如FLAC的STREAMINFO、AAC的AudioSpecificConfig
+     * @return true表示有配置数据
+     */
+    virtual bool getExtraData(std::vector<uint8_t>& data) const = 0;
 };
 
 /**
@@ -197,6 +438,13 @@ public:
      * @return true表示正在输出，false表示已停止
      */
     virtual bool isActive() const = 0;
+
+    /**
+     * @brief 发送编码数据包
+     * @param[in] packet 编码器输出的数据包
+     * @return true表示已接收（排队或发送），false表示输出未启动或数据包被丢弃
+     */
+    virtual bool sendPacket(const EncodedPacket& packet) = 0;
 };
 
 /**
@@ -264,6 +512,58 @@ public:
  * @note 使用单例模式，确保全局只有一个引擎实例
  * @note 使用PIMPL模式隐藏实现细节，提高编译速度和接口稳定性
  */
+/**
+ * @brief 引擎控制命令
+ * @details 由控制线程通过Engine::postCommand提交，渲染线程在两次渲染之间执行并写入status。
+ *
+ * @note 提交方持有命令对象，status离开Pending之前不能释放或修改；
+ *       之后调用Engine::finishCommand，在提交线程中完成渲染线程不做的收尾（如停止被换下场景的源）
+ */
+struct EngineCommand {
+    /**
+     * @brief 命令类型
+     */
+    enum class Type {
+        SwitchScene,    ///< 切换当前场景（scene）
+        AddSource,      ///< 向场景添加源（scene、source_ptr）
+        RemoveSource,   ///< 从场景移除源（scene、source）
+        SetProperty,    ///< 设置场景、源或滤镜的属性（scene、source可为空、filter可为空、key、value）
+        AddFilter,      ///< 添加滤镜（scene、source为空时为场景级、filter_ptr）
+        RemoveFilter    ///< 移除滤镜（scene、source可为空、filter）
+    };
+
+    /**
+     * @brief 执行结果
+     */
+    enum class Status {
+        Pending,        ///< 尚未执行
+        Ok,             ///< 执行成功
+        NotFound,       ///< 场景或源不存在
+        Rejected        ///< 参数无效、源已存在或属性不支持
+    };
+
+    Type type = Type::SwitchScene;
+    std::string scene;                          ///< 目标场景名称
+    std::string source;                         ///< 目标源名称
+    std::string filter;                         ///< 目标滤镜名称
+    std::string key;                            ///< 属性名
+    std::string value;                          ///< 属性值
+    SourcePtr source_ptr;                       ///< 待添加的源；移除成功后保存被移除的源，由提交方释放
+    FilterPtr filter_ptr;                       ///< 待添加的滤镜；移除成功后保存被移除的滤镜，由提交方释放
+    std::vector<FilterPtr> removed_filters;     ///< 移除源时随之移除的源级滤镜，由提交方释放
+    ScenePtr scene_ptr;                         ///< 切换场景：提交时已显示的新场景，执行成功后为被换下的场景
+    std::atomic<Status> status{Status::Pending};
+};
+
+class EventBus;
+class FlightRecorder;
+class MemoryBudget;
+class NumaFramePool;
+class Watchdog;
+class ModuleRegistry;
+class ScreenshotService;
+class SourceActivation;
+
 class Engine {
 public:
     /**
@@ -293,7 +593,7 @@ public:
 
     /**
      * @brief 创建源
-     * @param[in] id 源类型ID，如"color_source"、"image_source"等
+     * @param[in] id 源类型ID，如"base_source"，可用类型见ModuleRegistry
      * @param[in] name 源名称
      * @return 源的智能指针，失败时返回nullptr
      */
@@ -301,7 +601,7 @@ public:
 
     /**
      * @brief 创建编码器
-     * @param[in] id 编码器类型ID，如"x264"、"aac"等
+     * @param[in] id 编码器类型ID，如"flac"、"aac"等
      * @param[in] name 编码器名称
      * @return 编码器的智能指针，失败时返回nullptr
      */
@@ -309,7 +609,7 @@ public:
 
     /**
      * @brief 创建输出
-     * @param[in] id 输出类型ID，如"rtmp"、"file"等
+     * @param[in] id 输出类型ID，如"udp"、"rudp"、"mp4"等
      * @param[in] name 输出名称
      * @return 输出的智能指针，失败时返回nullptr
      */
@@ -340,6 +640,166 @@ public:
      */
     bool isStreaming() const;
 
+    /**
+     * @brief 设置引擎音频配置
+     * @param[in] settings 新的音频配置
+     * @return true表示设置成功，false表示参数无效或正在流媒体
+     *
+     * @note 块大小必须在kMinAudioBlockSize到kMaxAudioBlockSize之间
+     * @note 流媒体运行期间不允许修改
+     */
+    bool setAudioSettings(const AudioSettings& settings);
+
+    /**
+     * @brief 获取引擎音频配置
+     * @return 当前音频配置
+     */
+    AudioSettings getAudioSettings() const;
+
+    /**
+     * @brief 获取音频链路延迟统计
+     * @return 从源采集到混音输出的端到端延迟统计
+     */
+    AudioLatencyStats getAudioLatencyStats() const;
+
+    /**
+     * @brief 设置引擎视频配置
+     * @param[in] settings 新的视频配置
+     * @return true表示设置成功，false表示参数无效或正在流媒体
+     *
+     * @note 画布帧池在下次开始流媒体时按新配置重新分配
+     */
+    bool setVideoSettings(const VideoSettings& settings);
+
+    /**
+     * @brief 获取引擎视频配置
+     * @return 当前视频配置
+     */
+    VideoSettings getVideoSettings() const;
+
+    /**
+     * @brief 获取画布帧池
+     * @return 帧池，getStats()可查询各NUMA节点子池实际使用的内存类型（大页/普通页）
+     */
+    NumaFramePool& getFramePool();
+
+    /**
+     * @brief 获取引擎内存预算
+     * @return 内存预算，子系统在此登记占用并提供淘汰回调，setLimit()设置硬上限
+     */
+    MemoryBudget& getMemoryBudget();
+
+    /**
+     * @brief 获取源激活计数
+     * @return 激活计数，显示中的场景（节目输出、截图）里的源保持运行，其余源被停止
+     */
+    SourceActivation& getSourceActivation();
+
+    /**
+     * @brief 获取内存统计
+     * @return 总占用、上限及各子系统占用
+     */
+    MemoryStats getMemoryStats() const;
+
+    /**
+     * @brief 设置当前输出场景
+     * @param[in] name 场景名称
+     * @return true表示切换成功，false表示场景不存在
+     */
+    bool setCurrentScene(const std::string& name);
+
+    /**
+     * @brief 获取当前输出场景
+     * @return 当前场景，未设置时返回nullptr
+     */
+    ScenePtr getCurrentScene() const;
+
+    /**
+     * @brief 获取所有场景名称
+     * @return 场景名称列表
+     */
+    std::vector<std::string> getSceneNames() const;
+
+    /**
+     * @brief 提交控制命令
+     * @param[in] command 命令，执行完成前必须保持有效
+     * @return true表示已入队，false表示命令队列已满
+     *
+     * @details 推流时由渲染线程在下一次渲染前执行；未推流时由调用线程直接执行。
+     * 提交过程无锁，不会与渲染线程竞争任何互斥量
+     */
+    bool postCommand(EngineCommand* command);
+
+    /**
+     * @brief 命令执行完成后的收尾，在提交线程中调用
+     * @param[in,out] command status已离开Pending的命令
+     *
+     * @details 切换场景时新场景的源在postCommand中启动，被换下场景的源在这里停止，
+     * 渲染线程只交换当前场景，不启停源
+     */
+    void finishCommand(EngineCommand* command);
+
+    /**
+     * @brief 获取组件类型注册表
+     * @return 注册表，create*按类型ID从中查找工厂，所属模块在第一次使用时加载
+     */
+    ModuleRegistry& getModuleRegistry();
+
+    /**
+     * @brief 获取引擎事件总线
+     * @return 事件总线，发布为wait-free，可在任意线程调用
+     */
+    EventBus& getEventBus();
+
+    /**
+     * @brief 获取飞行记录器
+     * @return 记录器，写入为wait-free，可在任意线程调用
+     */
+    FlightRecorder& getFlightRecorder();
+
+    /**
+     * @brief 获取管线看门狗
+     * @return 看门狗，组件可登记自己的阶段并定期心跳
+     */
+    Watchdog& getWatchdog();
+
+    /**
+     * @brief 异步截取场景或源的画面
+     * @param[in] request 截图请求
+     * @param[in] callback 完成回调，在截图工作线程中调用，成功或失败都恰好调用一次
+     * @return true表示已受理；未推流、场景/源不存在或待处理请求过多时返回false且不调用回调
+     *
+     * @details 截取当前场景时渲染线程只把刚合成的画布帧交给工作线程，不复制像素；
+     * 其他场景或源由渲染线程每个节拍最多额外渲染一个。格式转换、缩放和编码都在工作线程完成
+     */
+    bool requestScreenshot(const ScreenshotRequest& request, ScreenshotCallback callback);
+
+    /**
+     * @brief 获取截图服务
+     * @return 截图服务，可查询统计信息
+     */
+    ScreenshotService& getScreenshots();
+
+    /**
+     * @brief 启动音频监听
+     * @param[in] settings 监听配置
+     * @return true表示启动成功，false表示配置无效或设备打开失败
+     *
+     * @note 监听只从混音器读取数据，设备卡顿不会阻塞混音器
+     */
+    bool startAudioMonitor(const AudioMonitorSettings& settings);
+
+    /**
+     * @brief 停止音频监听
+     */
+    void stopAudioMonitor();
+
+    /**
+     * @brief 获取音频监听统计
+     * @return 监听链路的统计信息
+     */
+    AudioMonitorStats getAudioMonitorStats() const;
+
 private:
     Engine();
     ~Engine();
@@ -1,8 +1,210 @@
-#include "SimpleOBS.h"
+/**
+ * @file AudioFrame.cpp
+ * @brief 音频帧工具实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件实现了混音链路使用的音频工具：线性重采样器和分块队列。
+ *
+ * @note
+ * - 处理过程中不分配内存，适合在渲染线程中调用
+ */
+
+#include "AudioProcessing.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace SimpleOBS {
 
-// 音频帧工具函数可以在这里实现
-// 目前为空，后续可以添加音频格式转换、重采样等功能
+FrameTime currentFrameTime() {
+    return std::chrono::duration_cast<FrameTime>(
+        std::chrono::high_resolution_clock::now().time_since_epoch()
+    );
+}
+
+FrameTime audioBlockDuration(const AudioSettings& settings) {
+    if (settings.sample_rate <= 0) {
+        return FrameTime(0);
+    }
+    return FrameTime(static_cast<int64_t>(settings.block_size) * 1000000 / settings.sample_rate);
+}
+
+bool validateAudioSettings(const AudioSettings& settings) {
+    return settings.block_size >= kMinAudioBlockSize &&
+           settings.block_size <= kMaxAudioBlockSize &&
+           settings.sample_rate >= 8000 && settings.sample_rate <= 192000 &&
+           settings.channels >= 1 && settings.channels <= kMaxAudioChannels;
+}
+
+// ---------------------------------------------------------------------------
+// AudioResampler
+// ---------------------------------------------------------------------------
+
+void AudioResampler::configure(int inRate, int outRate, int channels) {
+    inRate_ = inRate;
+    outRate_ = outRate;
+    channels_ = std::min(channels, kMaxAudioChannels);
+    adjust_ = 1.0;
+    reset();
+}
+
+void AudioResampler::reset() {
+    position_ = 0.0;
+    std::fill(std::begin(last_), std::end(last_), 0.0f);
+}
+
+int AudioResampler::maxOutputSamples(int inSamples) const {
+    if (inRate_ <= 0 || outRate_ <= 0) {
+        return inSamples;
+    }
+    // 步长最多被微调±10%，额外预留插值边界
+    double ratio = static_cast<double>(outRate_) / inRate_ / 0.9;
+    return static_cast<int>(std::ceil((inSamples + 1) * ratio)) + 2;
+}
+
+/**
+ * @brief 处理一段输入
+ *
+ * @details
+ * position_位于[-1, inSamples)区间，-1表示上一块的最后一个采样，
+ * 因此块与块之间的插值是连续的。
+ */
+int AudioResampler::process(const float* const* in, int inSamples, float* const* out, int maxOut) {
+    if (inSamples <= 0) {
+        return 0;
+    }
+
+    if (isPassthrough()) {
+        int n = std::min(inSamples, maxOut);
+        for (int c = 0; c < channels_; ++c) {
+            std::memcpy(out[c], in[c], sizeof(float) * n);
+        }
+        return n;
+    }
+
+    const double step = static_cast<double>(inRate_) / outRate_ * adjust_;
+    int produced = 0;
+    double pos = position_;
+
+    while (produced < maxOut) {
+        int index = static_cast<int>(std::floor(pos));
+        if (index + 1 >= inSamples) {
+            break;
+        }
+        float frac = static_cast<float>(pos - index);
+        for (int c = 0; c < channels_; ++c) {
+            float a = index < 0 ? last_[c] : in[c][index];
+            float b = in[c][index + 1];
+            out[c][produced] = a + (b - a) * frac;
+        }
+        ++produced;
+        pos += step;
+    }
+
+    position_ = pos - inSamples;
+    for (int c = 0; c < channels_; ++c) {
+        last_[c] = in[c][inSamples - 1];
+    }
+
+    return produced;
+}
+
+// ---------------------------------------------------------------------------
+// AudioBlockQueue
+// ---------------------------------------------------------------------------
+
+void AudioBlockQueue::configure(int channels, int sampleRate, int capacity) {
+    channels_ = std::min(channels, kMaxAudioChannels);
+    sampleRate_ = sampleRate > 0 ? sampleRate : 48000;
+    capacity_ = capacity;
+    buffer_.assign(static_cast<size_t>(channels_) * capacity_, 0.0f);
+    clear();
+}
+
+void AudioBlockQueue::clear() {
+    head_ = 0;
+    size_ = 0;
+    frontTimestamp_ = FrameTime(0);
+}
+
+void AudioBlockQueue::consume(int samples) {
+    head_ = (head_ + samples) % capacity_;
+    size_ -= samples;
+    frontTimestamp_ += FrameTime(static_cast<int64_t>(samples) * 1000000 / sampleRate_);
+}
+
+void AudioBlockQueue::push(const float* const* data, int samples, FrameTime timestamp) {
+    if (capacity_ <= 0 || samples <= 0) {
+        return;
+    }
+
+    // 输入比整个队列还长时只保留最新的部分
+    if (samples > capacity_) {
+        int skip = samples - capacity_;
+        dropped_ += skip;
+        timestamp += FrameTime(static_cast<int64_t>(skip) * 1000000 / sampleRate_);
+        const float* shifted[kMaxAudioChannels];
+        for (int c = 0; c < channels_; ++c) {
+            shifted[c] = data[c] + skip;
+        }
+        push(shifted, capacity_, timestamp);
+        return;
+    }
+
+    int overflow = size_ + samples - capacity_;
+    if (overflow > 0) {
+        dropped_ += overflow;
+        consume(overflow);
+    }
+
+    if (size_ == 0) {
+        frontTimestamp_ = timestamp;
+    }
+
+    int tail = (head_ + size_) % capacity_;
+    int first = std::min(samples, capacity_ - tail);
+    for (int c = 0; c < channels_; ++c) {
+        float* channel = buffer_.data() + static_cast<size_t>(c) * capacity_;
+        std::memcpy(channel + tail, data[c], sizeof(float) * first);
+        if (first < samples) {
+            std::memcpy(channel, data[c] + first, sizeof(float) * (samples - first));
+        }
+    }
+    size_ += samples;
+}
+
+int AudioBlockQueue::pop(float* const* out, int samples) {
+    int n = std::min(samples, size_);
+    int first = std::min(n, capacity_ - head_);
+    for (int c = 0; c < channels_; ++c) {
+        const float* channel = buffer_.data() + static_cast<size_t>(c) * capacity_;
+        std::memcpy(out[c], channel + head_, sizeof(float) * first);
+        if (first < n) {
+            std::memcpy(out[c] + first, channel, sizeof(float) * (n - first));
+        }
+    }
+    consume(n);
+    return n;
+}
+
+int AudioBlockQueue::popMix(float* const* out, int samples) {
+    int n = std::min(samples, size_);
+    int first = std::min(n, capacity_ - head_);
+    for (int c = 0; c < channels_; ++c) {
+        const float* channel = buffer_.data() + static_cast<size_t>(c) * capacity_;
+        float* dst = out[c];
+        for (int i = 0; i < first; ++i) {
+            dst[i] += channel[head_ + i];
+        }
+        for (int i = first; i < n; ++i) {
+            dst[i] += channel[i - first];
+        }
+    }
+    consume(n);
+    return n;
+}
 
 } // namespace SimpleOBS
@@ -0,0 +1,530 @@
+/**
+ * @file AudioMonitor.cpp
+ * @brief 本地音频监听链路实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件实现了音频监听器和各类监听输出设备。
+ *
+ * @note
+ * - 渲染线程只做交错和一次无锁写入
+ * - 设备线程用PI控制器根据缓冲水位调整重采样比例
+ */
+
+#include "AudioMonitor.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef SIMPLEOBS_HAVE_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+#ifdef SIMPLEOBS_HAVE_PULSEAUDIO
+#include <pulse/error.h>
+#include <pulse/simple.h>
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+// 漂移控制器参数：比例项、积分项以及最大调整幅度（±0.5%）
+constexpr double kDriftProportional = 0.002;
+constexpr double kDriftIntegral = 0.00005;
+constexpr double kDriftMaxAdjust = 0.005;
+
+// 监听配置上限：设备周期和目标延迟
+constexpr int kMaxMonitorPeriodFrames = 8192;
+constexpr int kMaxMonitorLatencyMs = 2000;
+
+/**
+ * @brief 按小端序写入整数
+ */
+void writeLE(std::FILE* file, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        std::fputc(static_cast<int>((value >> (8 * i)) & 0xFF), file);
+    }
+}
+
+/**
+ * @brief 浮点采样转换为16位整数
+ */
+int16_t toInt16(float sample) {
+    float clamped = std::max(-1.0f, std::min(1.0f, sample));
+    return static_cast<int16_t>(std::lrint(clamped * 32767.0f));
+}
+
+/**
+ * @brief 基于文件的虚拟设备
+ * @details 以16位PCM写入文件或管道，并用稳定时钟模拟设备的播放速率
+ */
+class PacedFileSink : public MonitorSink {
+public:
+    PacedFileSink(std::string path, double clockScale, bool wavHeader)
+        : path_(std::move(path)), clockScale_(clockScale > 0.0 ? clockScale : 1.0),
+          wavHeader_(wavHeader) {}
+
+    ~PacedFileSink() override { close(); }
+
+    bool open(int sampleRate, int channels, int periodFrames) override {
+        if (path_.empty()) {
+            LOG_ERROR("Monitor sink requires a file path");
+            return false;
+        }
+
+        file_ = (path_ == "-") ? stdout : std::fopen(path_.c_str(), "wb");
+        if (!file_) {
+            LOG_ERROR("Failed to open monitor sink: {}", path_);
+            return false;
+        }
+
+        sampleRate_ = sampleRate;
+        channels_ = channels;
+        dataBytes_ = 0;
+        samples_.resize(static_cast<size_t>(periodFrames) * channels);
+        if (wavHeader_) {
+            writeWavHeader();
+        }
+        deadline_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool write(const float* data, int frames) override {
+        if (!file_) {
+            return false;
+        }
+
+        size_t count = static_cast<size_t>(frames) * channels_;
+        if (samples_.size() < count) {
+            samples_.resize(count);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            samples_[i] = toInt16(data[i]);
+        }
+        if (std::fwrite(samples_.data(), sizeof(int16_t), count, file_) != count) {
+            return false;
+        }
+        dataBytes_ += static_cast<uint32_t>(count * sizeof(int16_t));
+        if (!wavHeader_) {
+            std::fflush(file_);
+        }
+
+        // 按设备时钟节奏阻塞，clock_scale != 1 时模拟设备与引擎之间的漂移
+        deadline_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(frames / (sampleRate_ * clockScale_)));
+        std::this_thread::sleep_until(deadline_);
+        return true;
+    }
+
+    void close() override {
+        if (!file_) {
+            return;
+        }
+        if (wavHeader_ && std::fseek(file_, 0, SEEK_SET) == 0) {
+            writeWavHeader();
+        }
+        if (file_ != stdout) {
+            std::fclose(file_);
+        } else {
+            std::fflush(file_);
+        }
+        file_ = nullptr;
+    }
+
+    std::string name() const override { return wavHeader_ ? "wav" : "pipe"; }
+
+private:
+    void writeWavHeader() {
+        std::fwrite("RIFF", 1, 4, file_);
+        writeLE(file_, 36 + dataBytes_, 4);
+        std::fwrite("WAVEfmt ", 1, 8, file_);
+        writeLE(file_, 16, 4);
+        writeLE(file_, 1, 2);                                   // PCM
+        writeLE(file_, static_cast<uint32_t>(channels_), 2);
+        writeLE(file_, static_cast<uint32_t>(sampleRate_), 4);
+        writeLE(file_, static_cast<uint32_t>(sampleRate_ * channels_ * 2), 4);
+        writeLE(file_, static_cast<uint32_t>(channels_ * 2), 2);
+        writeLE(file_, 16, 2);
+        std::fwrite("data", 1, 4, file_);
+        writeLE(file_, dataBytes_, 4);
+    }
+
+    std::string path_;
+    double clockScale_;
+    bool wavHeader_;
+    std::FILE* file_ = nullptr;
+    int sampleRate_ = 48000;
+    int channels_ = 2;
+    uint32_t dataBytes_ = 0;
+    std::vector<int16_t> samples_;
+    std::chrono::steady_clock::time_point deadline_;
+};
+
+#ifdef SIMPLEOBS_HAVE_ALSA
+/**
+ * @brief ALSA播放设备
+ */
+class AlsaSink : public MonitorSink {
+public:
+    explicit AlsaSink(std::string device)
+        : device_(device.empty() ? "default" : std::move(device)) {}
+
+    ~AlsaSink() override { close(); }
+
+    bool open(int sampleRate, int channels, int periodFrames) override {
+        int err = snd_pcm_open(&pcm_, device_.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+        if (err < 0) {
+            LOG_ERROR("ALSA open failed ({}): {}", device_, snd_strerror(err));
+            pcm_ = nullptr;
+            return false;
+        }
+        unsigned int latencyUs = static_cast<unsigned int>(
+            4LL * periodFrames * 1000000 / sampleRate);
+        err = snd_pcm_set_params(pcm_, SND_PCM_FORMAT_FLOAT_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                                 static_cast<unsigned int>(channels),
+                                 static_cast<unsigned int>(sampleRate), 1, latencyUs);
+        if (err < 0) {
+            LOG_ERROR("ALSA configure failed ({}): {}", device_, snd_strerror(err));
+            close();
+            return false;
+        }
+        channels_ = channels;
+        return true;
+    }
+
+    bool write(const float* data, int frames) override {
+        while (frames > 0) {
+            snd_pcm_sframes_t written = snd_pcm_writei(pcm_, data, static_cast<snd_pcm_uframes_t>(frames));
+            if (written < 0) {
+                if (snd_pcm_recover(pcm_, static_cast<int>(written), 1) < 0) {
+                    return false;
+                }
+                continue;
+            }
+            frames -= static_cast<int>(written);
+            data += written * channels_;
+        }
+        return true;
+    }
+
+    void close() override {
+        if (pcm_) {
+            snd_pcm_drop(pcm_);
+            snd_pcm_close(pcm_);
+            pcm_ = nullptr;
+        }
+    }
+
+    std::string name() const override { return "alsa"; }
+
+private:
+    std::string device_;
+    snd_pcm_t* pcm_ = nullptr;
+    int channels_ = 2;
+};
+#endif
+
+#ifdef SIMPLEOBS_HAVE_PULSEAUDIO
+/**
+ * @brief PulseAudio播放设备
+ */
+class PulseSink : public MonitorSink {
+public:
+    explicit PulseSink(std::string device) : device_(std::move(device)) {}
+
+    ~PulseSink() override { close(); }
+
+    bool open(int sampleRate, int channels, int periodFrames) override {
+        pa_sample_spec spec;
+        spec.format = PA_SAMPLE_FLOAT32LE;
+        spec.rate = static_cast<uint32_t>(sampleRate);
+        spec.channels = static_cast<uint8_t>(channels);
+
+        pa_buffer_attr attr;
+        attr.maxlength = static_cast<uint32_t>(-1);
+        attr.tlength = static_cast<uint32_t>(4 * periodFrames * channels * sizeof(float));
+        attr.prebuf = static_cast<uint32_t>(-1);
+        attr.minreq = static_cast<uint32_t>(-1);
+        attr.fragsize = static_cast<uint32_t>(-1);
+
+        int error = 0;
+        stream_ = pa_simple_new(nullptr, "SimpleOBS", PA_STREAM_PLAYBACK,
+                                device_.empty() ? nullptr : device_.c_str(),
+                                "Monitor", &spec, nullptr, &attr, &error);
+        if (!stream_) {
+            LOG_ERROR("PulseAudio open failed: {}", pa_strerror(error));
+            return false;
+        }
+        channels_ = channels;
+        return true;
+    }
+
+    bool write(const float* data, int frames) override {
+        int error = 0;
+        size_t bytes = static_cast<size_t>(frames) * channels_ * sizeof(float);
+        if (pa_simple_write(stream_, data, bytes, &error) < 0) {
+            LOG_ERROR("PulseAudio write failed: {}", pa_strerror(error));
+            return false;
+        }
+        return true;
+    }
+
+    void close() override {
+        if (stream_) {
+            pa_simple_free(stream_);
+            stream_ = nullptr;
+        }
+    }
+
+    std::string name() const override { return "pulse"; }
+
+private:
+    std::string device_;
+    pa_simple* stream_ = nullptr;
+    int channels_ = 2;
+};
+#endif
+
+} // namespace
+
+bool validateMonitorSettings(const AudioMonitorSettings& settings) {
+    return settings.sample_rate >= 8000 && settings.sample_rate <= 192000 &&
+           settings.period_frames >= 16 && settings.period_frames <= kMaxMonitorPeriodFrames &&
+           settings.target_latency_ms >= 0 && settings.target_latency_ms <= kMaxMonitorLatencyMs &&
+           std::isfinite(settings.clock_scale) && settings.clock_scale > 0.0;
+}
+
+std::unique_ptr<MonitorSink> createMonitorSink(const AudioMonitorSettings& settings) {
+    const std::string& type = settings.sink;
+
+    if (type == "wav") {
+        return std::make_unique<PacedFileSink>(settings.device, settings.clock_scale, true);
+    }
+    if (type == "pipe") {
+        return std::make_unique<PacedFileSink>(settings.device, settings.clock_scale, false);
+    }
+#ifdef SIMPLEOBS_HAVE_PULSEAUDIO
+    if (type == "pulse" || type == "auto") {
+        return std::make_unique<PulseSink>(settings.device);
+    }
+#endif
+#ifdef SIMPLEOBS_HAVE_ALSA
+    if (type == "alsa" || type == "auto") {
+        return std::make_unique<AlsaSink>(settings.device);
+    }
+#endif
+
+    LOG_ERROR("Monitor sink not available: {}", type);
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// AudioMonitor
+// ---------------------------------------------------------------------------
+
+AudioMonitor::AudioMonitor(const AudioSettings& audio, const AudioMonitorSettings& settings,
+                           std::unique_ptr<MonitorSink> sink)
+    : audio_(audio), settings_(settings), sink_(std::move(sink)) {
+    settings_.period_frames = std::max(16, settings_.period_frames);
+    settings_.target_latency_ms = std::max(1, settings_.target_latency_ms);
+
+    targetFill_ = static_cast<int>(static_cast<int64_t>(audio_.sample_rate) *
+                                   settings_.target_latency_ms / 1000);
+    targetFill_ = std::max(targetFill_, audio_.block_size);
+
+    // 至少容纳0.5秒或4倍目标水位
+    size_t frames = std::max<size_t>(audio_.sample_rate / 2, static_cast<size_t>(targetFill_) * 4);
+    ring_.reset(frames * audio_.channels);
+    pushScratch_.assign(static_cast<size_t>(kMaxAudioBlockSize) * audio_.channels, 0.0f);
+
+    resampler_.configure(audio_.sample_rate, settings_.sample_rate, audio_.channels);
+    inCapacity_ = settings_.period_frames * 4 + 16;
+    outCapacity_ = settings_.period_frames + resampler_.maxOutputSamples(inCapacity_);
+    popScratch_.assign(static_cast<size_t>(inCapacity_) * audio_.channels, 0.0f);
+    inPlanar_.assign(static_cast<size_t>(inCapacity_) * audio_.channels, 0.0f);
+    outPlanar_.assign(static_cast<size_t>(outCapacity_) * audio_.channels, 0.0f);
+    outInterleaved_.assign(static_cast<size_t>(settings_.period_frames) * audio_.channels, 0.0f);
+}
+
+AudioMonitor::~AudioMonitor() {
+    stop();
+}
+
+bool AudioMonitor::start() {
+    if (running_) {
+        return true;
+    }
+    if (!sink_ || !sink_->open(settings_.sample_rate, audio_.channels, settings_.period_frames)) {
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread([this]() { deviceLoop(); });
+    LOG_INFO("Audio monitor started: sink={}, rate={}, period={}, target={}ms",
+             sink_->name(), settings_.sample_rate, settings_.period_frames,
+             settings_.target_latency_ms);
+    return true;
+}
+
+void AudioMonitor::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    sink_->close();
+    LOG_INFO("Audio monitor stopped: frames={}, underruns={}, dropped={}",
+             framesWritten_.load(), underruns_.load(), droppedBlocks_.load());
+}
+
+void AudioMonitor::push(const AudioFrame& frame) {
+    if (!running_.load(std::memory_order_relaxed) || frame.samples <= 0 || !frame.data[0]) {
+        return;
+    }
+
+    const int channels = audio_.channels;
+    const int samples = std::min(frame.samples, kMaxAudioBlockSize);
+    for (int c = 0; c < channels; ++c) {
+        const float* src = frame.data[std::min(c, std::max(frame.channels, 1) - 1)];
+        if (!src) {
+            src = frame.data[0];
+        }
+        for (int i = 0; i < samples; ++i) {
+            pushScratch_[static_cast<size_t>(i) * channels + c] = src[i];
+        }
+    }
+
+    if (!ring_.tryPush(pushScratch_.data(), static_cast<size_t>(samples) * channels)) {
+        droppedBlocks_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+AudioMonitorStats AudioMonitor::getStats() const {
+    AudioMonitorStats stats;
+    stats.running = running_;
+    stats.sink = sink_ ? sink_->name() : std::string();
+    stats.frames_written = framesWritten_.load(std::memory_order_relaxed);
+    stats.underruns = underruns_.load(std::memory_order_relaxed);
+    stats.dropped_blocks = droppedBlocks_.load(std::memory_order_relaxed);
+    stats.resample_ratio = ratio_.load(std::memory_order_relaxed);
+    size_t frames = ring_.size() / audio_.channels;
+    stats.buffered = FrameTime(static_cast<int64_t>(frames) * 1000000 / audio_.sample_rate);
+    return stats;
+}
+
+/**
+ * @brief 设备线程主循环
+ *
+ * @details
+ * 1. 缓冲未达到目标水位时写入静音，保持设备时钟运转
+ * 2. 根据水位误差调整重采样比例：缓冲偏多则加快消耗，偏少则放慢
+ * 3. 取数不足时记为欠载，重新等待缓冲达到目标水位
+ */
+void AudioMonitor::deviceLoop() {
+    const int period = settings_.period_frames;
+    const int channels = audio_.channels;
+    bool primed = false;
+
+    while (running_) {
+        int fill = static_cast<int>(ring_.size() / channels);
+
+        if (!primed) {
+            if (fill >= targetFill_) {
+                primed = true;
+                integral_ = 0.0;
+            } else {
+                std::fill(outInterleaved_.begin(), outInterleaved_.end(), 0.0f);
+                if (!sink_->write(outInterleaved_.data(), period)) {
+                    break;
+                }
+                continue;
+            }
+        }
+
+        double error = static_cast<double>(fill - targetFill_) / targetFill_;
+        integral_ = std::max(-kDriftMaxAdjust, std::min(kDriftMaxAdjust, integral_ + kDriftIntegral * error));
+        double adjust = 1.0 + std::max(-kDriftMaxAdjust,
+                                       std::min(kDriftMaxAdjust, kDriftProportional * error + integral_));
+        resampler_.setRatioAdjust(adjust);
+        ratio_.store(adjust, std::memory_order_relaxed);
+
+        if (fillOutput(period) < period) {
+            underruns_.fetch_add(1, std::memory_order_relaxed);
+            primed = false;
+        }
+
+        for (int i = 0; i < period; ++i) {
+            for (int c = 0; c < channels; ++c) {
+                outInterleaved_[static_cast<size_t>(i) * channels + c] =
+                    outPlanar_[static_cast<size_t>(c) * outCapacity_ + i];
+            }
+        }
+
+        // 保留多余的重采样输出到下一个周期
+        int leftover = outCount_ - period;
+        for (int c = 0; c < channels; ++c) {
+            float* channel = outPlanar_.data() + static_cast<size_t>(c) * outCapacity_;
+            std::memmove(channel, channel + period, sizeof(float) * leftover);
+        }
+        outCount_ = leftover;
+
+        if (!sink_->write(outInterleaved_.data(), period)) {
+            LOG_ERROR("Audio monitor sink write failed: {}", sink_->name());
+            break;
+        }
+        framesWritten_.fetch_add(static_cast<uint64_t>(period), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 重采样直到凑够一个设备周期
+ * @param[in] periodFrames 设备周期
+ * @return 实际来自混音器的采样点数（不足部分已补静音）
+ */
+int AudioMonitor::fillOutput(int periodFrames) {
+    const int channels = audio_.channels;
+    const double step = static_cast<double>(audio_.sample_rate) / settings_.sample_rate;
+
+    float* out[kMaxAudioChannels] = {};
+    const float* in[kMaxAudioChannels] = {};
+
+    while (outCount_ < periodFrames) {
+        int available = static_cast<int>(ring_.size() / channels);
+        if (available == 0) {
+            int real = outCount_;
+            for (int c = 0; c < channels; ++c) {
+                float* channel = outPlanar_.data() + static_cast<size_t>(c) * outCapacity_;
+                std::fill(channel + outCount_, channel + periodFrames, 0.0f);
+            }
+            outCount_ = periodFrames;
+            return real;
+        }
+
+        int want = static_cast<int>(std::ceil((periodFrames - outCount_) * step)) + 1;
+        want = std::max(1, std::min({want, available, inCapacity_}));
+
+        size_t got = ring_.pop(popScratch_.data(), static_cast<size_t>(want) * channels) / channels;
+        for (int c = 0; c < channels; ++c) {
+            float* channel = inPlanar_.data() + static_cast<size_t>(c) * inCapacity_;
+            for (size_t i = 0; i < got; ++i) {
+                channel[i] = popScratch_[i * channels + c];
+            }
+            in[c] = channel;
+            out[c] = outPlanar_.data() + static_cast<size_t>(c) * outCapacity_ + outCount_;
+        }
+
+        outCount_ += resampler_.process(in, static_cast<int>(got), out, outCapacity_ - outCount_);
+    }
+
+    return periodFrames;
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,163 @@
+/**
+ * @file AudioMonitor.h
+ * @brief 本地音频监听链路
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了音频监听链路：混音器把每个音频块写入无锁环形缓冲区，
+ * 设备线程按设备时钟从缓冲区取数，经自适应重采样后写入本地输出。
+ *
+ * @note
+ * - 混音器侧的push()永不阻塞，缓冲区满时丢弃整块并计数
+ * - 设备线程根据缓冲水位微调重采样比例，吸收引擎与设备之间的时钟漂移
+ * - 输出支持PulseAudio、ALSA（编译时检测），以及用于测试的WAV文件和管道
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include "AudioProcessing.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 监听输出设备接口
+ * @details write()按设备时钟阻塞，设备线程借此获得自己的时钟域
+ */
+class MonitorSink {
+public:
+    virtual ~MonitorSink() = default;
+
+    /**
+     * @brief 打开设备
+     * @param[in] sampleRate 采样率
+     * @param[in] channels 声道数
+     * @param[in] periodFrames 每次写入的采样点数
+     * @return true表示打开成功
+     */
+    virtual bool open(int sampleRate, int channels, int periodFrames) = 0;
+
+    /**
+     * @brief 写入交错格式的采样
+     * @param[in] data 交错float采样
+     * @param[in] frames 采样点数
+     * @return true表示写入成功
+     */
+    virtual bool write(const float* data, int frames) = 0;
+
+    /**
+     * @brief 关闭设备
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief 获取输出类型名称
+     * @return 如"wav"、"alsa"
+     */
+    virtual std::string name() const = 0;
+};
+
+/**
+ * @brief 根据配置创建监听输出
+ * @param[in] settings 监听配置
+ * @return 输出设备，类型不可用时返回nullptr
+ */
+std::unique_ptr<MonitorSink> createMonitorSink(const AudioMonitorSettings& settings);
+
+/**
+ * @brief 校验监听配置
+ * @param[in] settings 监听配置
+ * @return true表示采样率、周期和时钟比例都在有效范围内
+ */
+bool validateMonitorSettings(const AudioMonitorSettings& settings);
+
+/**
+ * @brief 音频监听器
+ * @details 连接混音器与监听输出设备，两端运行在不同线程和时钟域
+ */
+class AudioMonitor {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] audio 引擎音频配置
+     * @param[in] settings 监听配置
+     * @param[in] sink 输出设备
+     */
+    AudioMonitor(const AudioSettings& audio, const AudioMonitorSettings& settings,
+                 std::unique_ptr<MonitorSink> sink);
+
+    /**
+     * @brief 析构函数
+     * @details 停止设备线程并关闭设备
+     */
+    ~AudioMonitor();
+
+    AudioMonitor(const AudioMonitor&) = delete;
+    AudioMonitor& operator=(const AudioMonitor&) = delete;
+
+    /**
+     * @brief 打开设备并启动设备线程
+     * @return true表示启动成功
+     */
+    bool start();
+
+    /**
+     * @brief 停止设备线程并关闭设备
+     */
+    void stop();
+
+    /**
+     * @brief 写入一个混音块（渲染线程调用）
+     * @param[in] frame 混音输出
+     *
+     * @note wait-free，缓冲区空间不足时丢弃整块
+     */
+    void push(const AudioFrame& frame);
+
+    /**
+     * @brief 获取监听统计
+     * @return 统计信息
+     */
+    AudioMonitorStats getStats() const;
+
+private:
+    void deviceLoop();
+    int fillOutput(int periodFrames);
+
+    AudioSettings audio_;                    ///< 引擎音频配置
+    AudioMonitorSettings settings_;          ///< 监听配置
+    std::unique_ptr<MonitorSink> sink_;      ///< 输出设备
+
+    SpscRing<float> ring_;                   ///< 交错格式的混音数据
+    std::vector<float> pushScratch_;         ///< 渲染线程交错临时缓冲区
+    int targetFill_ = 0;                     ///< 目标缓冲水位（引擎采样点）
+
+    // 以下仅设备线程访问
+    AudioResampler resampler_;               ///< 引擎采样率 -> 设备采样率
+    std::vector<float> popScratch_;          ///< 从环形缓冲区取出的交错数据
+    std::vector<float> inPlanar_;            ///< 去交错后的输入
+    std::vector<float> outPlanar_;           ///< 重采样后的平面输出
+    std::vector<float> outInterleaved_;      ///< 写入设备的交错输出
+    int inCapacity_ = 0;                     ///< 每声道输入容量
+    int outCapacity_ = 0;                    ///< 每声道输出容量
+    int outCount_ = 0;                       ///< 已重采样但尚未写入设备的采样点数
+    double integral_ = 0.0;                  ///< 漂移控制器积分项
+
+    std::atomic<bool> running_{false};       ///< 设备线程运行标志
+    std::thread thread_;                     ///< 设备线程
+
+    std::atomic<uint64_t> framesWritten_{0};   ///< 已写入设备的采样点数
+    std::atomic<uint64_t> underruns_{0};       ///< 缓冲不足次数
+    std::atomic<uint64_t> droppedBlocks_{0};   ///< 丢弃的混音块数
+    std::atomic<double> ratio_{1.0};           ///< 当前漂移补偿系数
+};
+
+} // namespace SimpleOBS
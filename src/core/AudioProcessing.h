@@ -0,0 +1,176 @@
+/**
+ * @file AudioProcessing.h
+ * @brief 音频处理工具：重采样器与分块队列
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了混音链路使用的音频工具类。
+ * AudioResampler负责把源的采样率转换为引擎采样率，
+ * AudioBlockQueue负责把任意长度的输入重新切分为引擎块大小。
+ *
+ * @note
+ * - 所有数据均为平面（planar）float格式，与AudioFrame一致
+ * - 内存只在configure()时分配，处理过程中不分配内存
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 最大声道数，与AudioFrame::data数组大小一致
+ */
+constexpr int kMaxAudioChannels = 8;
+
+/**
+ * @brief 线性插值重采样器
+ * @details 保存跨块的插值状态，支持通过setRatioAdjust()微调转换比例以吸收时钟漂移
+ */
+class AudioResampler {
+public:
+    /**
+     * @brief 配置重采样器
+     * @param[in] inRate 输入采样率
+     * @param[in] outRate 输出采样率
+     * @param[in] channels 声道数
+     */
+    void configure(int inRate, int outRate, int channels);
+
+    /**
+     * @brief 重置插值状态
+     */
+    void reset();
+
+    /**
+     * @brief 设置比例微调系数
+     * @param[in] adjust 输入步长的乘数，1.0表示不调整
+     */
+    void setRatioAdjust(double adjust) { adjust_ = adjust; }
+
+    /**
+     * @brief 检查是否无需重采样
+     * @return true表示输入输出采样率一致且没有微调
+     */
+    bool isPassthrough() const { return inRate_ == outRate_ && adjust_ == 1.0; }
+
+    /**
+     * @brief 计算给定输入长度可能产生的最大输出长度
+     * @param[in] inSamples 输入采样点数
+     * @return 输出采样点数上限
+     */
+    int maxOutputSamples(int inSamples) const;
+
+    /**
+     * @brief 处理一段输入
+     * @param[in] in 每声道输入指针
+     * @param[in] inSamples 输入采样点数
+     * @param[out] out 每声道输出指针
+     * @param[in] maxOut 输出缓冲区容量（采样点）
+     * @return 实际输出的采样点数
+     */
+    int process(const float* const* in, int inSamples, float* const* out, int maxOut);
+
+    int inputRate() const { return inRate_; }
+    int outputRate() const { return outRate_; }
+    int channels() const { return channels_; }
+
+private:
+    int inRate_ = 0;                 ///< 输入采样率
+    int outRate_ = 0;                ///< 输出采样率
+    int channels_ = 0;               ///< 声道数
+    double adjust_ = 1.0;            ///< 步长微调系数
+    double position_ = 0.0;          ///< 下一个输出点相对当前输入起点的位置
+    float last_[kMaxAudioChannels] = {};  ///< 上一块输入的最后一个采样
+};
+
+/**
+ * @brief 平面音频分块队列
+ * @details 固定容量的环形缓冲区，把任意长度的输入切分为固定长度的块，
+ *          并跟踪队首采样的采集时间戳用于延迟统计
+ */
+class AudioBlockQueue {
+public:
+    /**
+     * @brief 配置队列
+     * @param[in] channels 声道数
+     * @param[in] sampleRate 采样率，用于推算时间戳
+     * @param[in] capacity 每声道容量（采样点）
+     */
+    void configure(int channels, int sampleRate, int capacity);
+
+    /**
+     * @brief 清空队列
+     */
+    void clear();
+
+    /**
+     * @brief 写入采样
+     * @param[in] data 每声道数据指针
+     * @param[in] samples 采样点数
+     * @param[in] timestamp 第一个采样的采集时间戳
+     *
+     * @note 队列满时丢弃最旧的数据
+     */
+    void push(const float* const* data, int samples, FrameTime timestamp);
+
+    /**
+     * @brief 读取采样
+     * @param[out] out 每声道输出指针
+     * @param[in] samples 需要读取的采样点数
+     * @return 实际读取的采样点数
+     */
+    int pop(float* const* out, int samples);
+
+    /**
+     * @brief 把队首采样累加到输出（混音）
+     * @param[in,out] out 每声道累加目标
+     * @param[in] samples 需要混入的采样点数
+     * @return 实际混入的采样点数
+     */
+    int popMix(float* const* out, int samples);
+
+    int available() const { return size_; }
+    int capacity() const { return capacity_; }
+    int channels() const { return channels_; }
+    FrameTime frontTimestamp() const { return frontTimestamp_; }
+    uint64_t droppedSamples() const { return dropped_; }
+
+private:
+    void consume(int samples);
+
+    std::vector<float> buffer_;      ///< 平面存储，channels_ * capacity_
+    int channels_ = 0;               ///< 声道数
+    int sampleRate_ = 48000;         ///< 采样率
+    int capacity_ = 0;               ///< 每声道容量
+    int head_ = 0;                   ///< 读位置
+    int size_ = 0;                   ///< 当前采样点数
+    FrameTime frontTimestamp_{0};    ///< 队首采样的采集时间戳
+    uint64_t dropped_ = 0;           ///< 因溢出丢弃的采样点数
+};
+
+/**
+ * @brief 获取当前帧时间
+ * @return 与源时间戳同一时钟的当前时间
+ */
+FrameTime currentFrameTime();
+
+/**
+ * @brief 计算音频块时长
+ * @param[in] settings 音频配置
+ * @return 一个块对应的时长
+ */
+FrameTime audioBlockDuration(const AudioSettings& settings);
+
+/**
+ * @brief 校验音频配置
+ * @param[in] settings 音频配置
+ * @return true表示配置有效
+ */
+bool validateAudioSettings(const AudioSettings& settings);
+
+} // namespace SimpleOBS
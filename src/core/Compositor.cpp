@@ -0,0 +1,652 @@
+/**
+ * @file Compositor.cpp
+ * @brief 场景合成内核实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "Compositor.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace SimpleOBS {
+
+namespace {
+
+constexpr uint32_t kAlphaMask = 0xFF000000u;
+
+/**
+ * @brief sRGB传递函数查找表
+ * @details toLinear把8位sRGB值映射为16位线性值；fromLinear以线性值的高12位为下标映射回sRGB，
+ *          每项取线性值与区间中心最接近的sRGB值，保证8位值往返不变。
+ *          两张表末尾留出填充，AVX2按32位gather读取最后一项时不会越界
+ */
+struct TransferTables {
+    uint16_t toLinear[256 + 2];
+    uint8_t fromLinear[4096 + 4];
+
+    TransferTables() {
+        for (int v = 0; v < 256; ++v) {
+            const double c = v / 255.0;
+            const double linear = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+            toLinear[v] = static_cast<uint16_t>(std::lround(linear * 65535.0));
+        }
+        toLinear[256] = toLinear[257] = 0;
+
+        for (int i = 0; i < 4096; ++i) {
+            const double center = i * 16 + 8;
+            const double linear = center / 65535.0;
+            const double c = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+            const int guess = std::clamp(static_cast<int>(std::lround(c * 255.0)), 0, 255);
+            int best = guess;
+            for (int v = std::max(0, guess - 1); v <= std::min(255, guess + 1); ++v) {
+                if (std::abs(toLinear[v] - center) < std::abs(toLinear[best] - center)) {
+                    best = v;
+                }
+            }
+            fromLinear[i] = static_cast<uint8_t>(best);
+        }
+        std::memset(fromLinear + 4096, 0, 4);
+    }
+};
+
+const TransferTables& transferTables() {
+    static const TransferTables tables;
+    return tables;
+}
+
+// ---------------------------------------------------------------------------
+// 混合模式：s为层的值，d为画布的值，返回该模式下层在该点的颜色
+// ---------------------------------------------------------------------------
+
+// a * b / 255，四舍五入
+inline uint32_t mul255(uint32_t a, uint32_t b) {
+    const uint32_t t = a * b + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+// a * b / 65535，四舍五入
+inline uint32_t mul65535(uint32_t a, uint32_t b) {
+    const uint32_t t = a * b + 32768;
+    return (t + (t >> 16)) >> 16;
+}
+
+template <BlendMode M>
+inline uint32_t blend8(uint32_t s, uint32_t d) {
+    switch (M) {
+    case BlendMode::Add:
+        return std::min<uint32_t>(s + d, 255);
+    case BlendMode::Multiply:
+        return mul255(s, d);
+    case BlendMode::Screen:
+        return s + d - mul255(s, d);
+    case BlendMode::Overlay:
+        return d < 128 ? 2 * mul255(s, d) : 255 - 2 * mul255(255 - s, 255 - d);
+    default:
+        return s;
+    }
+}
+
+template <BlendMode M>
+inline uint32_t blend16(uint32_t s, uint32_t d) {
+    switch (M) {
+    case BlendMode::Add:
+        return std::min<uint32_t>(s + d, 65535);
+    case BlendMode::Multiply:
+        return mul65535(s, d);
+    case BlendMode::Screen:
+        return s + d - mul65535(s, d);
+    case BlendMode::Overlay:
+        return d < 32768 ? 2 * mul65535(s, d) : 65535 - 2 * mul65535(65535 - s, 65535 - d);
+    default:
+        return s;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 叠加内核：一次处理一行中的pixels个RGBA像素，opacity为0~256的层不透明度
+// ---------------------------------------------------------------------------
+
+template <BlendMode M>
+void overRowGammaScalar(uint8_t* dst, const uint8_t* src, int pixels, int opacity, const TransferTables&) {
+    for (int i = 0; i < pixels; ++i, src += 4, dst += 4) {
+        const int a = src[3];
+        const int w = ((a + (a >> 7)) * opacity) >> 8;
+        const int iw = 256 - w;
+        for (int c = 0; c < 3; ++c) {
+            dst[c] = static_cast<uint8_t>((blend8<M>(src[c], dst[c]) * w + dst[c] * iw) >> 8);
+        }
+        dst[3] = static_cast<uint8_t>((255 * w + dst[3] * iw) >> 8);
+    }
+}
+
+template <BlendMode M>
+void overRowLinearScalar(uint8_t* dst, const uint8_t* src, int pixels, int opacity, const TransferTables& t) {
+    for (int i = 0; i < pixels; ++i, src += 4, dst += 4) {
+        const int a = src[3];
+        const int w = ((a + (a >> 7)) * opacity) >> 8;
+        const int iw = 256 - w;
+        for (int c = 0; c < 3; ++c) {
+            const uint32_t dl = t.toLinear[dst[c]];
+            dst[c] = t.fromLinear[(blend16<M>(t.toLinear[src[c]], dl) * w + dl * iw) >> 12];
+        }
+        dst[3] = static_cast<uint8_t>((255 * w + dst[3] * iw) >> 8);
+    }
+}
+
+#ifdef SIMPLEOBS_X86
+/**
+ * @brief 8个像素全部透明时返回1，全部不透明时返回2，否则返回0
+ */
+SIMPLEOBS_TARGET_AVX2
+inline int alphaClass(__m256i s) {
+    const __m256i alpha = _mm256_and_si256(s, _mm256_set1_epi32(static_cast<int>(kAlphaMask)));
+    const int opaque = _mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, _mm256_set1_epi32(static_cast<int>(kAlphaMask))));
+    if (opaque == -1) {
+        return 2;
+    }
+    const int clear = _mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, _mm256_setzero_si256()));
+    return clear == -1 ? 1 : 0;
+}
+
+// 16位通道中的mul255
+SIMPLEOBS_TARGET_AVX2
+inline __m256i mul255x16(__m256i a, __m256i b) {
+    const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(a, b), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+// 32位通道中的mul65535
+SIMPLEOBS_TARGET_AVX2
+inline __m256i mul65535x32(__m256i a, __m256i b) {
+    const __m256i t = _mm256_add_epi32(_mm256_mullo_epi32(a, b), _mm256_set1_epi32(32768));
+    return _mm256_srli_epi32(_mm256_add_epi32(t, _mm256_srli_epi32(t, 16)), 16);
+}
+
+// blend8的16位通道版本，s、d为0~255
+template <BlendMode M>
+SIMPLEOBS_TARGET_AVX2
+inline __m256i blend8x16(__m256i s, __m256i d) {
+    const __m256i max = _mm256_set1_epi16(255);
+    switch (M) {
+    case BlendMode::Add:
+        return _mm256_min_epu16(_mm256_add_epi16(s, d), max);
+    case BlendMode::Multiply:
+        return mul255x16(s, d);
+    case BlendMode::Screen:
+        return _mm256_sub_epi16(_mm256_add_epi16(s, d), mul255x16(s, d));
+    case BlendMode::Overlay: {
+        const __m256i low = _mm256_slli_epi16(mul255x16(s, d), 1);
+        const __m256i high = _mm256_sub_epi16(
+            max, _mm256_slli_epi16(mul255x16(_mm256_sub_epi16(max, s), _mm256_sub_epi16(max, d)), 1));
+        return _mm256_blendv_epi8(low, high, _mm256_cmpgt_epi16(d, _mm256_set1_epi16(127)));
+    }
+    default:
+        return s;
+    }
+}
+
+// blend16的32位通道版本，s、d为0~65535
+template <BlendMode M>
+SIMPLEOBS_TARGET_AVX2
+inline __m256i blend16x32(__m256i s, __m256i d) {
+    const __m256i max = _mm256_set1_epi32(65535);
+    switch (M) {
+    case BlendMode::Add:
+        return _mm256_min_epu32(_mm256_add_epi32(s, d), max);
+    case BlendMode::Multiply:
+        return mul65535x32(s, d);
+    case BlendMode::Screen:
+        return _mm256_sub_epi32(_mm256_add_epi32(s, d), mul65535x32(s, d));
+    case BlendMode::Overlay: {
+        const __m256i low = _mm256_slli_epi32(mul65535x32(s, d), 1);
+        const __m256i high = _mm256_sub_epi32(
+            max, _mm256_slli_epi32(mul65535x32(_mm256_sub_epi32(max, s), _mm256_sub_epi32(max, d)), 1));
+        return _mm256_blendv_epi8(low, high, _mm256_cmpgt_epi32(d, _mm256_set1_epi32(32767)));
+    }
+    default:
+        return s;
+    }
+}
+
+/**
+ * @brief 计算8个像素的混合权重：a' = a + (a >> 7)，层不完全不透明时再乘以层不透明度
+ */
+SIMPLEOBS_TARGET_AVX2
+inline __m256i pixelWeights(__m256i s, __m256i opacity, bool fullOpacity) {
+    const __m256i a = _mm256_srli_epi32(s, 24);
+    const __m256i w = _mm256_add_epi32(a, _mm256_srli_epi32(a, 7));
+    return fullOpacity ? w : _mm256_srli_epi32(_mm256_mullo_epi32(w, opacity), 8);
+}
+
+template <BlendMode M>
+SIMPLEOBS_TARGET_AVX2
+void overRowGammaAvx2(uint8_t* dst, const uint8_t* src, int pixels, int opacity, const TransferTables& t) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i full = _mm256_set1_epi16(256);
+    const __m256i opaque = _mm256_set1_epi16(255);
+    const __m256i layerOpacity = _mm256_set1_epi32(opacity);
+    const bool fullOpacity = opacity == 256;
+    const bool copyOpaque = M == BlendMode::Normal && fullOpacity;
+    int i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        const int kind = alphaClass(s);
+        if (kind == 1) {
+            continue;
+        }
+        if (kind == 2 && copyOpaque) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), s);
+            continue;
+        }
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i * 4));
+
+        // 每像素权重复制到该像素的4个16位通道
+        const __m256i w = pixelWeights(s, layerOpacity, fullOpacity);
+        const __m256i w2 = _mm256_or_si256(w, _mm256_slli_epi32(w, 16));
+        const __m256i wLo = _mm256_unpacklo_epi32(w2, w2);
+        const __m256i wHi = _mm256_unpackhi_epi32(w2, w2);
+
+        // 混合结果的alpha通道按255计算
+        const __m256i dLo = _mm256_unpacklo_epi8(d, zero);
+        const __m256i dHi = _mm256_unpackhi_epi8(d, zero);
+        const __m256i bLo = _mm256_blend_epi16(blend8x16<M>(_mm256_unpacklo_epi8(s, zero), dLo), opaque, 0x88);
+        const __m256i bHi = _mm256_blend_epi16(blend8x16<M>(_mm256_unpackhi_epi8(s, zero), dHi), opaque, 0x88);
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(bLo, wLo), _mm256_mullo_epi16(dLo, _mm256_sub_epi16(full, wLo)));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(bHi, wHi), _mm256_mullo_epi16(dHi, _mm256_sub_epi16(full, wHi)));
+        lo = _mm256_srli_epi16(lo, 8);
+        hi = _mm256_srli_epi16(hi, 8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_packus_epi16(lo, hi));
+    }
+    overRowGammaScalar<M>(dst + i * 4, src + i * 4, pixels - i, opacity, t);
+}
+
+template <BlendMode M>
+SIMPLEOBS_TARGET_AVX2
+void overRowLinearAvx2(uint8_t* dst, const uint8_t* src, int pixels, int opacity, const TransferTables& t) {
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i wordMask = _mm256_set1_epi32(0xFFFF);
+    const __m256i bias = _mm256_set1_epi16(static_cast<int16_t>(0x8000));
+    const __m256i unbias = _mm256_set1_epi32(32768 * 256);
+    const __m256i full = _mm256_set1_epi32(256);
+    const __m256i opaque = _mm256_set1_epi32(255);
+    const __m256i layerOpacity = _mm256_set1_epi32(opacity);
+    const bool fullOpacity = opacity == 256;
+    const bool copyOpaque = M == BlendMode::Normal && fullOpacity;
+    const int* toLinear = reinterpret_cast<const int*>(t.toLinear);
+    const int* fromLinear = reinterpret_cast<const int*>(t.fromLinear);
+    int i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        const int kind = alphaClass(s);
+        if (kind == 1) {
+            continue;
+        }
+        if (kind == 2 && copyOpaque) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), s);
+            continue;
+        }
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i * 4));
+
+        const __m256i w = pixelWeights(s, layerOpacity, fullOpacity);
+        const __m256i iw = _mm256_sub_epi32(full, w);
+        // 每个32位通道为(w, 256 - w)两个16位权重，与(混合值, dst)线性值对用madd相乘累加
+        const __m256i weights = _mm256_or_si256(w, _mm256_slli_epi32(iw, 16));
+
+        __m256i out = _mm256_setzero_si256();
+        for (int c = 0; c < 3; ++c) {
+            const __m128i shift = _mm_cvtsi32_si128(c * 8);
+            const __m256i sc = _mm256_and_si256(_mm256_srl_epi32(s, shift), byteMask);
+            const __m256i dc = _mm256_and_si256(_mm256_srl_epi32(d, shift), byteMask);
+            const __m256i sl = _mm256_i32gather_epi32(toLinear, sc, 2);
+            const __m256i dl = _mm256_i32gather_epi32(toLinear, dc, 2);
+            // 表项为16位，gather读出的高16位是下一项，只取低16位
+            __m256i blended = sl;
+            if (M != BlendMode::Normal) {
+                blended = blend16x32<M>(_mm256_and_si256(sl, wordMask), _mm256_and_si256(dl, wordMask));
+            }
+            // madd按有符号16位相乘，线性值先减去32768，结果再加回32768 * 256
+            const __m256i pair = _mm256_xor_si256(_mm256_blend_epi16(blended, _mm256_slli_epi32(dl, 16), 0xAA), bias);
+            const __m256i mixed = _mm256_srli_epi32(
+                _mm256_add_epi32(_mm256_madd_epi16(pair, weights), unbias), 12);
+            const __m256i encoded = _mm256_and_si256(_mm256_i32gather_epi32(fromLinear, mixed, 1), byteMask);
+            out = _mm256_or_si256(out, _mm256_sll_epi32(encoded, shift));
+        }
+        const __m256i da = _mm256_srli_epi32(d, 24);
+        const __m256i oa = _mm256_srli_epi32(
+            _mm256_add_epi32(_mm256_mullo_epi32(opaque, w), _mm256_mullo_epi32(da, iw)), 8);
+        out = _mm256_or_si256(out, _mm256_slli_epi32(oa, 24));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), out);
+    }
+    overRowLinearScalar<M>(dst + i * 4, src + i * 4, pixels - i, opacity, t);
+}
+#endif
+
+bool opaqueRowScalar(const uint8_t* src, int pixels) {
+    for (int i = 0; i < pixels; ++i) {
+        if (src[i * 4 + 3] != 255) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef SIMPLEOBS_X86
+SIMPLEOBS_TARGET_AVX2
+bool opaqueRowAvx2(const uint8_t* src, int pixels) {
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(kAlphaMask));
+    int i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        // 四组alpha按位与，任一像素不是255结果就不等于掩码
+        const __m256i* p = reinterpret_cast<const __m256i*>(src + i * 4);
+        const __m256i all = _mm256_and_si256(_mm256_and_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1)),
+                                             _mm256_and_si256(_mm256_loadu_si256(p + 2), _mm256_loadu_si256(p + 3)));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(all, alphaMask), alphaMask)) != -1) {
+            return false;
+        }
+    }
+    return opaqueRowScalar(src + i * 4, pixels - i);
+}
+#endif
+
+using OpaqueRowFn = bool (*)(const uint8_t*, int);
+
+OpaqueRowFn selectOpaqueRow() {
+#ifdef SIMPLEOBS_X86
+    if (cpuHasAvx2()) {
+        return opaqueRowAvx2;
+    }
+#endif
+    return opaqueRowScalar;
+}
+
+const OpaqueRowFn opaqueRow = selectOpaqueRow();
+
+using OverRowFn = void (*)(uint8_t*, const uint8_t*, int, int, const TransferTables&);
+
+/**
+ * @brief 各混合空间、混合模式的叠加内核，按BlendMode的顺序排列
+ */
+struct OverRowKernels {
+    OverRowFn gamma[kBlendModeCount];
+    OverRowFn linear[kBlendModeCount];
+};
+
+const OverRowKernels scalarOverRowKernels = {
+    {overRowGammaScalar<BlendMode::Normal>, overRowGammaScalar<BlendMode::Add>,
+     overRowGammaScalar<BlendMode::Multiply>, overRowGammaScalar<BlendMode::Screen>,
+     overRowGammaScalar<BlendMode::Overlay>},
+    {overRowLinearScalar<BlendMode::Normal>, overRowLinearScalar<BlendMode::Add>,
+     overRowLinearScalar<BlendMode::Multiply>, overRowLinearScalar<BlendMode::Screen>,
+     overRowLinearScalar<BlendMode::Overlay>}};
+
+OverRowKernels selectOverRowKernels() {
+#ifdef SIMPLEOBS_X86
+    if (cpuHasAvx2()) {
+        return {{overRowGammaAvx2<BlendMode::Normal>, overRowGammaAvx2<BlendMode::Add>,
+                 overRowGammaAvx2<BlendMode::Multiply>, overRowGammaAvx2<BlendMode::Screen>,
+                 overRowGammaAvx2<BlendMode::Overlay>},
+                {overRowLinearAvx2<BlendMode::Normal>, overRowLinearAvx2<BlendMode::Add>,
+                 overRowLinearAvx2<BlendMode::Multiply>, overRowLinearAvx2<BlendMode::Screen>,
+                 overRowLinearAvx2<BlendMode::Overlay>}};
+    }
+#endif
+    return scalarOverRowKernels;
+}
+
+const OverRowKernels overRowKernels = selectOverRowKernels();
+
+template <typename T>
+void fillPlane(uint8_t* data, int linesize, int count, int rows, T value) {
+    for (int y = 0; y < rows; ++y) {
+        T* row = reinterpret_cast<T*>(data + static_cast<size_t>(y) * linesize);
+        std::fill(row, row + count, value);
+    }
+}
+
+/**
+ * @brief 平面的每像素字节数和相对亮度平面的下采样位移
+ * @return false表示该格式没有这个平面
+ */
+bool planeGeometry(int format, int plane, int& bytes, int& shift) {
+    switch (format) {
+    case kVideoFormatRGBA:
+        bytes = 4;
+        shift = 0;
+        return plane == 0;
+    case kVideoFormatI420:
+    case kVideoFormatI010:
+        bytes = format == kVideoFormatI010 ? 2 : 1;
+        shift = plane == 0 ? 0 : 1;
+        return plane < 3;
+    case kVideoFormatNV12:
+    case kVideoFormatP010:
+        // 交错的UV平面每个色度像素含两个采样
+        bytes = (format == kVideoFormatP010 ? 2 : 1) * (plane == 0 ? 1 : 2);
+        shift = plane == 0 ? 0 : 1;
+        return plane < 2;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief 按不透明度把一行采样混合到画布行上：out = (src * w + dst * (256 - w)) >> 8
+ * @param[in] shift 16位采样中有效值的左移位数（P010为6），8位采样传-1
+ */
+void fadeRow(uint8_t* dst, const uint8_t* src, size_t samples, int weight, int shift) {
+    if (shift < 0) {
+        for (size_t i = 0; i < samples; ++i) {
+            dst[i] = static_cast<uint8_t>((src[i] * weight + dst[i] * (256 - weight)) >> 8);
+        }
+        return;
+    }
+    for (size_t i = 0; i < samples; ++i) {
+        uint16_t a;
+        uint16_t b;
+        std::memcpy(&a, src + i * 2, 2);
+        std::memcpy(&b, dst + i * 2, 2);
+        const int value = (((a >> shift) * weight + (b >> shift) * (256 - weight)) >> 8) << shift;
+        const uint16_t out = static_cast<uint16_t>(value);
+        std::memcpy(dst + i * 2, &out, 2);
+    }
+}
+
+/**
+ * @brief 按平面把层画面复制或按不透明度混合到画布上
+ * @param[in] opacity 255时逐行复制，否则逐采样线性插值
+ */
+bool drawPlanes(VideoFrame& canvas, const VideoFrame& layer, int x, int y, int opacity) {
+    int bytes;
+    int shift;
+    if (canvas.format != layer.format || !planeGeometry(canvas.format, 0, bytes, shift) || !canvas.data[0] ||
+        !layer.data[0]) {
+        return false;
+    }
+    if (canvas.format != kVideoFormatRGBA) {
+        // 向负无穷取整到偶数，色度平面与亮度平面保持对齐
+        x &= ~1;
+        y &= ~1;
+    }
+    const int x0 = std::max(0, x);
+    const int y0 = std::max(0, y);
+    const int x1 = std::min(canvas.width, x + layer.width);
+    const int y1 = std::min(canvas.height, y + layer.height);
+    if (x0 >= x1 || y0 >= y1 || opacity == 0) {
+        return true;
+    }
+
+    const int weight = opacity + (opacity >> 7);
+    const int depth = videoFormatBitDepth(canvas.format);
+    const int sampleShift = depth == 8 ? -1 : (canvas.format == kVideoFormatP010 ? 6 : 0);
+    for (int plane = 0; plane < 4 && planeGeometry(canvas.format, plane, bytes, shift); ++plane) {
+        if (!canvas.data[plane] || !layer.data[plane]) {
+            return false;
+        }
+        const int round = (1 << shift) - 1;
+        const int px0 = x0 >> shift;
+        const int py0 = y0 >> shift;
+        const int px1 = (x1 + round) >> shift;
+        const int py1 = (y1 + round) >> shift;
+        const size_t rowBytes = static_cast<size_t>(px1 - px0) * bytes;
+        for (int row = py0; row < py1; ++row) {
+            uint8_t* dst = canvas.data[plane] + static_cast<size_t>(row) * canvas.linesize[plane] +
+                           static_cast<size_t>(px0) * bytes;
+            const uint8_t* src = layer.data[plane] + static_cast<size_t>(row - (y >> shift)) * layer.linesize[plane] +
+                                 static_cast<size_t>(px0 - (x >> shift)) * bytes;
+            if (opacity == 255) {
+                std::memcpy(dst, src, rowBytes);
+            } else {
+                fadeRow(dst, src, sampleShift < 0 ? rowBytes : rowBytes / 2, weight, sampleShift);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 按给定的内核表把层叠加到画布上，负责裁剪和逐行调用
+ */
+bool overLayer(const OverRowKernels& kernels, VideoFrame& canvas, const VideoFrame& layer, int x, int y,
+               BlendSpace space, BlendMode mode, int opacity) {
+    if (canvas.format != kVideoFormatRGBA || layer.format != kVideoFormatRGBA || !canvas.data[0] ||
+        !layer.data[0]) {
+        return false;
+    }
+    opacity = std::clamp(opacity, 0, 255);
+    if (opacity == 0) {
+        return true;
+    }
+    const int x0 = std::max(0, x);
+    const int y0 = std::max(0, y);
+    const int x1 = std::min(canvas.width, x + layer.width);
+    const int y1 = std::min(canvas.height, y + layer.height);
+    if (x0 >= x1 || y0 >= y1) {
+        return true;
+    }
+
+    const TransferTables& tables = transferTables();
+    const int index = static_cast<int>(mode);
+    const OverRowFn over = space == BlendSpace::Linear ? kernels.linear[index] : kernels.gamma[index];
+    const int weight = opacity + (opacity >> 7);
+    for (int row = y0; row < y1; ++row) {
+        uint8_t* dst = canvas.data[0] + static_cast<size_t>(row) * canvas.linesize[0] + static_cast<size_t>(x0) * 4;
+        const uint8_t* src = layer.data[0] + static_cast<size_t>(row - y) * layer.linesize[0] +
+                             static_cast<size_t>(x0 - x) * 4;
+        over(dst, src, x1 - x0, weight, tables);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+const char* blendSpaceName(BlendSpace space) {
+    return space == BlendSpace::Linear ? "linear" : "gamma";
+}
+
+bool parseBlendSpace(const std::string& name, BlendSpace& space) {
+    if (name == "gamma") {
+        space = BlendSpace::Gamma;
+    } else if (name == "linear") {
+        space = BlendSpace::Linear;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool clearVideoFrame(VideoFrame& canvas) {
+    if (!canvas.data[0] || canvas.width <= 0 || canvas.height <= 0) {
+        return false;
+    }
+    const int chromaWidth = (canvas.width + 1) / 2;
+    const int chromaHeight = (canvas.height + 1) / 2;
+    switch (canvas.format) {
+    case kVideoFormatRGBA:
+        fillPlane<uint32_t>(canvas.data[0], canvas.linesize[0], canvas.width, canvas.height, kAlphaMask);
+        return true;
+    case kVideoFormatI420:
+        fillPlane<uint8_t>(canvas.data[0], canvas.linesize[0], canvas.width, canvas.height, 16);
+        fillPlane<uint8_t>(canvas.data[1], canvas.linesize[1], chromaWidth, chromaHeight, 128);
+        fillPlane<uint8_t>(canvas.data[2], canvas.linesize[2], chromaWidth, chromaHeight, 128);
+        return true;
+    case kVideoFormatNV12:
+        fillPlane<uint8_t>(canvas.data[0], canvas.linesize[0], canvas.width, canvas.height, 16);
+        fillPlane<uint8_t>(canvas.data[1], canvas.linesize[1], chromaWidth * 2, chromaHeight, 128);
+        return true;
+    case kVideoFormatP010:
+        fillPlane<uint16_t>(canvas.data[0], canvas.linesize[0], canvas.width, canvas.height, 64 << 6);
+        fillPlane<uint16_t>(canvas.data[1], canvas.linesize[1], chromaWidth * 2, chromaHeight, 512 << 6);
+        return true;
+    case kVideoFormatI010:
+        fillPlane<uint16_t>(canvas.data[0], canvas.linesize[0], canvas.width, canvas.height, 64);
+        fillPlane<uint16_t>(canvas.data[1], canvas.linesize[1], chromaWidth, chromaHeight, 512);
+        fillPlane<uint16_t>(canvas.data[2], canvas.linesize[2], chromaWidth, chromaHeight, 512);
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char* blendModeName(BlendMode mode) {
+    switch (mode) {
+    case BlendMode::Add:
+        return "add";
+    case BlendMode::Multiply:
+        return "multiply";
+    case BlendMode::Screen:
+        return "screen";
+    case BlendMode::Overlay:
+        return "overlay";
+    default:
+        return "normal";
+    }
+}
+
+bool parseBlendMode(const std::string& name, BlendMode& mode) {
+    for (int i = 0; i < kBlendModeCount; ++i) {
+        if (name == blendModeName(static_cast<BlendMode>(i))) {
+            mode = static_cast<BlendMode>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool compositeLayer(VideoFrame& canvas, const VideoFrame& layer, int x, int y, BlendSpace space,
+                    BlendMode mode, int opacity) {
+    return overLayer(overRowKernels, canvas, layer, x, y, space, mode, opacity);
+}
+
+bool compositeLayerScalar(VideoFrame& canvas, const VideoFrame& layer, int x, int y, BlendSpace space,
+                          BlendMode mode, int opacity) {
+    return overLayer(scalarOverRowKernels, canvas, layer, x, y, space, mode, opacity);
+}
+
+bool isOpaqueLayer(const VideoFrame& layer) {
+    if (layer.format != kVideoFormatRGBA) {
+        return true;
+    }
+    if (!layer.data[0]) {
+        return false;
+    }
+    for (int row = 0; row < layer.height; ++row) {
+        if (!opaqueRow(layer.data[0] + static_cast<size_t>(row) * layer.linesize[0], layer.width)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool blitLayer(VideoFrame& canvas, const VideoFrame& layer, int x, int y) {
+    return drawPlanes(canvas, layer, x, y, 255);
+}
+
+bool fadeLayer(VideoFrame& canvas, const VideoFrame& layer, int x, int y, int opacity) {
+    return drawPlanes(canvas, layer, x, y, std::clamp(opacity, 0, 255));
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,146 @@
+/**
+ * @file Compositor.h
+ * @brief 场景合成内核
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了把源画面按alpha叠加到画布上的合成函数。支持两种混合空间：
+ * - Gamma：直接在sRGB编码值上混合，速度最快
+ * - Linear：通过查找表把sRGB转换为16位线性光值，在线性空间混合后再编码回sRGB，
+ *   抗锯齿边缘不会出现暗边
+ * 每层可设置混合模式（normal、add、multiply、screen、overlay）和整体不透明度，
+ * 不透明度并入每像素的混合权重，不增加额外的遍历。
+ * 所有组合都有AVX2实现，与标量实现结果逐位一致。
+ * YUV画布上的源没有alpha，按平面直接复制（blitLayer），或按不透明度逐平面插值（fadeLayer），
+ * 不经过RGB转换；YUV画布上只有normal混合模式。
+ *
+ * @note
+ * - 叠加公式：a' = a + (a >> 7)，o' = o + (o >> 7)，w = (a' * o') >> 8，
+ *   out = (B(src, dst) * w + dst * (256 - w)) >> 8，B为混合模式函数，
+ *   alpha通道按B = 255计算，即标准的over运算
+ * - 混合模式在所选混合空间中计算：gamma空间为8位值，linear空间为16位线性值
+ * - 层按左上角坐标放置，超出画布的部分裁掉
+ * - 色度下采样格式的层坐标向下取整到偶数，保证亮度与色度平面对齐
+ * - linear空间的耗时：典型的叠加层（大片全透明或全不透明，只有边缘半透明）约为gamma空间的2倍，
+ *   全透明块跳过、normal模式的不透明块直接复制；整层半透明时normal约5倍，overlay最多约10倍。
+ *   每8个像素要做9次256项查表（src、dst各3个通道转线性，结果3个通道转回sRGB），
+ *   AVX2只能用gather完成，没有更快的查表方式，因此半透明内容达不到2倍以内
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <string>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 混合空间
+ */
+enum class BlendSpace {
+    Gamma,      ///< 在sRGB编码值上混合
+    Linear      ///< 在线性光空间混合
+};
+
+/**
+ * @brief 层的混合模式
+ */
+enum class BlendMode {
+    Normal,     ///< B = src
+    Add,        ///< B = min(src + dst, 1)
+    Multiply,   ///< B = src * dst
+    Screen,     ///< B = src + dst - src * dst
+    Overlay     ///< dst < 0.5时B = 2 * src * dst，否则B = 1 - 2 * (1 - src) * (1 - dst)
+};
+
+/// 混合模式数量
+constexpr int kBlendModeCount = 5;
+
+/**
+ * @brief 混合模式名称（"normal"、"add"、"multiply"、"screen"、"overlay"）
+ */
+const char* blendModeName(BlendMode mode);
+
+/**
+ * @brief 按名称解析混合模式
+ * @return false表示名称无效
+ */
+bool parseBlendMode(const std::string& name, BlendMode& mode);
+
+/**
+ * @brief 混合空间名称（"gamma"、"linear"）
+ */
+const char* blendSpaceName(BlendSpace space);
+
+/**
+ * @brief 按名称解析混合空间
+ * @return false表示名称无效
+ */
+bool parseBlendSpace(const std::string& name, BlendSpace& space);
+
+/**
+ * @brief 把画布填充为不透明黑色
+ * @param[in,out] canvas 画布帧（RGBA、8位或10位YUV）
+ * @return false表示格式不支持
+ */
+bool clearVideoFrame(VideoFrame& canvas);
+
+/**
+ * @brief 把一层RGBA画面按alpha叠加到RGBA画布上
+ * @param[in,out] canvas 画布帧
+ * @param[in] layer 层画面（非预乘alpha）
+ * @param[in] x 层左上角在画布中的横坐标
+ * @param[in] y 层左上角在画布中的纵坐标
+ * @param[in] space 混合空间
+ * @param[in] mode 混合模式
+ * @param[in] opacity 层整体不透明度（0~255）
+ * @return false表示格式不是RGBA
+ */
+bool compositeLayer(VideoFrame& canvas, const VideoFrame& layer, int x, int y, BlendSpace space,
+                    BlendMode mode, int opacity);
+
+/**
+ * @brief compositeLayer的标量实现，参数和结果相同
+ *
+ * @note 不随CPU特性切换，用于校验SIMD内核和对比耗时
+ */
+bool compositeLayerScalar(VideoFrame& canvas, const VideoFrame& layer, int x, int y, BlendSpace space,
+                          BlendMode mode, int opacity);
+
+/**
+ * @brief 判断层画面是否完全不透明
+ * @param[in] layer 层画面
+ * @return true表示YUV格式，或RGBA格式且所有像素的alpha为255
+ *
+ * @note 遇到第一个不透明度不足的像素即返回
+ */
+bool isOpaqueLayer(const VideoFrame& layer);
+
+/**
+ * @brief 把一层不透明画面按平面复制到画布上
+ * @param[in,out] canvas 画布帧
+ * @param[in] layer 层画面，格式与画布相同
+ * @param[in] x 层左上角在画布中的横坐标
+ * @param[in] y 层左上角在画布中的纵坐标
+ * @return false表示格式不一致或不支持
+ *
+ * @note 支持RGBA、I420、NV12、P010、I010；RGBA层的alpha被忽略
+ */
+bool blitLayer(VideoFrame& canvas, const VideoFrame& layer, int x, int y);
+
+/**
+ * @brief 把一层画面按整体不透明度逐平面线性混合到画布上
+ * @param[in,out] canvas 画布帧
+ * @param[in] layer 层画面，格式与画布相同
+ * @param[in] x 层左上角在画布中的横坐标
+ * @param[in] y 层左上角在画布中的纵坐标
+ * @param[in] opacity 层整体不透明度（0~255），255时与blitLayer相同
+ * @return false表示格式不一致或不支持
+ *
+ * @note 用于没有alpha的YUV画布：亮度和色度按相同权重插值，混合模式不适用
+ */
+bool fadeLayer(VideoFrame& canvas, const VideoFrame& layer, int x, int y, int opacity);
+
+} // namespace SimpleOBS
@@ -0,0 +1,550 @@
+/**
+ * @file ContentAnalysis.cpp
+ * @brief 源内容检测实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "ContentAnalysis.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace SimpleOBS {
+
+namespace {
+
+constexpr uint32_t kHashMultiplier = 0x9E3779B1u;
+constexpr int kHashLanes = 8;
+constexpr int kHashChunk = kHashLanes * 4;
+constexpr float kSilenceFloorDb = -120.0f;
+
+/**
+ * @brief 计算平面的有效字节数和行数
+ * @return false表示该平面不存在
+ */
+bool planeExtent(const VideoFrame& frame, int plane, int& bytes, int& rows) {
+    if (plane < 0 || plane >= 4 || !frame.data[plane] || frame.width <= 0 || frame.height <= 0) {
+        return false;
+    }
+    const int chromaWidth = (frame.width + 1) / 2;
+    const int chromaHeight = (frame.height + 1) / 2;
+    switch (frame.format) {
+    case kVideoFormatRGBA:
+        if (plane != 0) {
+            return false;
+        }
+        bytes = frame.width * 4;
+        rows = frame.height;
+        break;
+    case kVideoFormatI420:
+        if (plane > 2) {
+            return false;
+        }
+        bytes = plane == 0 ? frame.width : chromaWidth;
+        rows = plane == 0 ? frame.height : chromaHeight;
+        break;
+    case kVideoFormatNV12:
+        if (plane > 1) {
+            return false;
+        }
+        bytes = plane == 0 ? frame.width : chromaWidth * 2;
+        rows = plane == 0 ? frame.height : chromaHeight;
+        break;
+    case kVideoFormatP010:
+        if (plane > 1) {
+            return false;
+        }
+        bytes = plane == 0 ? frame.width * 2 : chromaWidth * 4;
+        rows = plane == 0 ? frame.height : chromaHeight;
+        break;
+    case kVideoFormatI010:
+        if (plane > 2) {
+            return false;
+        }
+        bytes = plane == 0 ? frame.width * 2 : chromaWidth * 2;
+        rows = plane == 0 ? frame.height : chromaHeight;
+        break;
+    default:
+        // 未知格式只哈希第一个平面的完整行
+        if (plane != 0) {
+            return false;
+        }
+        bytes = frame.linesize[0];
+        rows = frame.height;
+        break;
+    }
+    bytes = std::min(bytes, frame.linesize[plane]);
+    return bytes > 0;
+}
+
+// ---------------------------------------------------------------------------
+// 哈希内核：每32字节为8个32位字，第i个字并入第i个通道 lane = (lane ^ word) * K
+// ---------------------------------------------------------------------------
+
+void mixChunkScalar(uint32_t lanes[kHashLanes], const uint8_t* chunk) {
+    for (int i = 0; i < kHashLanes; ++i) {
+        uint32_t word;
+        std::memcpy(&word, chunk + i * 4, 4);
+        lanes[i] = (lanes[i] ^ word) * kHashMultiplier;
+    }
+}
+
+/**
+ * @brief 行尾不足32字节的部分补零后按整块处理，各实现结果一致
+ */
+void mixTail(uint32_t lanes[kHashLanes], const uint8_t* data, int bytes) {
+    uint8_t chunk[kHashChunk] = {};
+    std::memcpy(chunk, data, bytes);
+    mixChunkScalar(lanes, chunk);
+}
+
+void hashRowsScalar(const uint8_t* data, int linesize, int bytes, int rows, int rowStep,
+                    uint32_t lanes[kHashLanes]) {
+    for (int y = 0; y < rows; y += rowStep) {
+        const uint8_t* row = data + static_cast<size_t>(y) * linesize;
+        int x = 0;
+        for (; x + kHashChunk <= bytes; x += kHashChunk) {
+            mixChunkScalar(lanes, row + x);
+        }
+        if (x < bytes) {
+            mixTail(lanes, row + x, bytes - x);
+        }
+    }
+}
+
+#ifdef SIMPLEOBS_X86
+SIMPLEOBS_TARGET_SSE41
+void hashRowsSse41(const uint8_t* data, int linesize, int bytes, int rows, int rowStep,
+                   uint32_t lanes[kHashLanes]) {
+    const __m128i k = _mm_set1_epi32(static_cast<int>(kHashMultiplier));
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes + 4));
+    for (int y = 0; y < rows; y += rowStep) {
+        const uint8_t* row = data + static_cast<size_t>(y) * linesize;
+        int x = 0;
+        for (; x + kHashChunk <= bytes; x += kHashChunk) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 16));
+            lo = _mm_mullo_epi32(_mm_xor_si128(lo, a), k);
+            hi = _mm_mullo_epi32(_mm_xor_si128(hi, b), k);
+        }
+        if (x < bytes) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 4), hi);
+            mixTail(lanes, row + x, bytes - x);
+            lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+            hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes + 4));
+        }
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 4), hi);
+}
+
+SIMPLEOBS_TARGET_AVX2
+void hashRowsAvx2(const uint8_t* data, int linesize, int bytes, int rows, int rowStep,
+                  uint32_t lanes[kHashLanes]) {
+    const __m256i k = _mm256_set1_epi32(static_cast<int>(kHashMultiplier));
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+    for (int y = 0; y < rows; y += rowStep) {
+        const uint8_t* row = data + static_cast<size_t>(y) * linesize;
+        int x = 0;
+        for (; x + kHashChunk <= bytes; x += kHashChunk) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+            acc = _mm256_mullo_epi32(_mm256_xor_si256(acc, v), k);
+        }
+        if (x < bytes) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+            mixTail(lanes, row + x, bytes - x);
+            acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+        }
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+}
+#endif
+
+using HashRowsFn = void (*)(const uint8_t*, int, int, int, int, uint32_t*);
+
+HashRowsFn selectHashRows() {
+#ifdef SIMPLEOBS_X86
+    if (cpuHasAvx2()) {
+        return hashRowsAvx2;
+    }
+    if (cpuHasSse41()) {
+        return hashRowsSse41;
+    }
+#endif
+    return hashRowsScalar;
+}
+
+const HashRowsFn hashRows = selectHashRows();
+
+// ---------------------------------------------------------------------------
+// 字节求和内核：mask按32位应用，用于在RGBA中屏蔽alpha
+// ---------------------------------------------------------------------------
+
+uint64_t sumBytesScalar(const uint8_t* data, int bytes, uint32_t mask) {
+    uint64_t sum = 0;
+    for (int i = 0; i < bytes; ++i) {
+        if ((mask >> ((i & 3) * 8)) & 0xFF) {
+            sum += data[i];
+        }
+    }
+    return sum;
+}
+
+#ifdef SIMPLEOBS_X86
+uint64_t sumBytesSse2(const uint8_t* data, int bytes, uint32_t mask) {
+    const __m128i m = _mm_set1_epi32(static_cast<int>(mask));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i v = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), m);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + sumBytesScalar(data + i, bytes - i, mask);
+}
+
+SIMPLEOBS_TARGET_AVX2
+uint64_t sumBytesAvx2(const uint8_t* data, int bytes, uint32_t mask) {
+    const __m256i m = _mm256_set1_epi32(static_cast<int>(mask));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), m);
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumBytesScalar(data + i, bytes - i, mask);
+}
+#endif
+
+using SumBytesFn = uint64_t (*)(const uint8_t*, int, uint32_t);
+
+SumBytesFn selectSumBytes() {
+#ifdef SIMPLEOBS_X86
+    if (cpuHasAvx2()) {
+        return sumBytesAvx2;
+    }
+    if (cpuHasSse2()) {
+        return sumBytesSse2;
+    }
+#endif
+    return sumBytesScalar;
+}
+
+const SumBytesFn sumBytes = selectSumBytes();
+
+// ---------------------------------------------------------------------------
+// 16位采样求和内核：每个采样先右移shift位取出10位有效值
+// 10位值与1做madd不会溢出，单行的32位部分和也不会溢出
+// ---------------------------------------------------------------------------
+
+uint64_t sumSamples16Scalar(const uint8_t* data, int samples, int shift) {
+    uint64_t sum = 0;
+    for (int i = 0; i < samples; ++i) {
+        uint16_t value;
+        std::memcpy(&value, data + i * 2, 2);
+        sum += value >> shift;
+    }
+    return sum;
+}
+
+#ifdef SIMPLEOBS_X86
+uint64_t sumSamples16Sse2(const uint8_t* data, int samples, int shift) {
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m128i v = _mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2)), count);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(v, ones));
+    }
+    uint32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3] +
+           sumSamples16Scalar(data + i * 2, samples - i, shift);
+}
+
+SIMPLEOBS_TARGET_AVX2
+uint64_t sumSamples16Avx2(const uint8_t* data, int samples, int shift) {
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m256i v = _mm256_srl_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 2)), count);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(v, ones));
+    }
+    uint32_t lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    uint64_t sum = 0;
+    for (uint32_t lane : lanes) {
+        sum += lane;
+    }
+    return sum + sumSamples16Scalar(data + i * 2, samples - i, shift);
+}
+#endif
+
+using SumSamples16Fn = uint64_t (*)(const uint8_t*, int, int);
+
+SumSamples16Fn selectSumSamples16() {
+#ifdef SIMPLEOBS_X86
+    if (cpuHasAvx2()) {
+        return sumSamples16Avx2;
+    }
+    if (cpuHasSse2()) {
+        return sumSamples16Sse2;
+    }
+#endif
+    return sumSamples16Scalar;
+}
+
+const SumSamples16Fn sumSamples16 = selectSumSamples16();
+
+// ---------------------------------------------------------------------------
+// 平方和内核
+// ---------------------------------------------------------------------------
+
+double sumSquaresScalar(const float* data, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) {
+        sum += static_cast<double>(data[i]) * data[i];
+    }
+    return sum;
+}
+
+#ifdef SIMPLEOBS_X86
+double sumSquaresSse2(const float* data, int n) {
+    __m128 acc = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(data + i);
+        acc = _mm_add_ps(acc, _mm_mul_ps(v, v));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    return static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3] + sumSquaresScalar(data + i, n - i);
+}
+
+SIMPLEOBS_TARGET_AVX2
+double sumSquaresAvx2(const float* data, int n) {
+    __m256 acc = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(data + i);
+        acc = _mm256_fmadd_ps(v, v, acc);
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, acc);
+    double sum = 0.0;
+    for (float lane : lanes) {
+        sum += lane;
+    }
+    return sum + sumSquaresScalar(data + i, n - i);
+}
+#endif
+
+using SumSquaresFn = double (*)(const float*, int);
+
+SumSquaresFn selectSumSquares() {
+#ifdef SIMPLEOBS_X86
+    if (cpuHasAvx2()) {
+        return sumSquaresAvx2;
+    }
+    if (cpuHasSse2()) {
+        return sumSquaresSse2;
+    }
+#endif
+    return sumSquaresScalar;
+}
+
+const SumSquaresFn sumSquares = selectSumSquares();
+
+uint64_t finalizeHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+} // anonymous namespace
+
+uint64_t hashVideoFrame(const VideoFrame& frame, int rowStep) {
+    rowStep = std::max(1, rowStep);
+    uint32_t lanes[kHashLanes];
+    for (int i = 0; i < kHashLanes; ++i) {
+        lanes[i] = kHashMultiplier * static_cast<uint32_t>(i + 1);
+    }
+    for (int plane = 0; plane < 4; ++plane) {
+        int bytes = 0;
+        int rows = 0;
+        if (planeExtent(frame, plane, bytes, rows)) {
+            hashRows(frame.data[plane], frame.linesize[plane], bytes, rows, rowStep, lanes);
+        }
+    }
+
+    uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(frame.width)) << 32) ^
+                 (static_cast<uint64_t>(static_cast<uint32_t>(frame.height)) << 8) ^
+                 static_cast<uint64_t>(static_cast<uint32_t>(frame.format));
+    for (uint32_t lane : lanes) {
+        h = (h ^ lane) * 0x100000001B3ull;
+    }
+    return finalizeHash(h);
+}
+
+int averageLuma(const VideoFrame& frame, int rowStep) {
+    int bytes = 0;
+    int rows = 0;
+    if (!planeExtent(frame, 0, bytes, rows)) {
+        return -1;
+    }
+    rowStep = std::max(1, rowStep);
+    if (videoFormatBitDepth(frame.format) == 10) {
+        // 10位亮度换算到8位刻度，与黑场阈值一致
+        const int shift = frame.format == kVideoFormatP010 ? 6 : 0;
+        const int samples = bytes / 2;
+        uint64_t sum = 0;
+        uint64_t count = 0;
+        for (int y = 0; y < rows; y += rowStep) {
+            sum += sumSamples16(frame.data[0] + static_cast<size_t>(y) * frame.linesize[0], samples, shift);
+            count += samples;
+        }
+        return count ? static_cast<int>(sum / count) >> 2 : -1;
+    }
+
+    uint32_t mask;
+    int samplesPerRow;
+    switch (frame.format) {
+    case kVideoFormatRGBA:
+        mask = 0x00FFFFFFu;     // 小端下alpha为每像素的最高字节
+        samplesPerRow = frame.width * 3;
+        break;
+    case kVideoFormatI420:
+    case kVideoFormatNV12:
+        mask = 0xFFFFFFFFu;
+        samplesPerRow = bytes;
+        break;
+    default:
+        return -1;
+    }
+
+    uint64_t sum = 0;
+    uint64_t count = 0;
+    for (int y = 0; y < rows; y += rowStep) {
+        sum += sumBytes(frame.data[0] + static_cast<size_t>(y) * frame.linesize[0], bytes, mask);
+        count += samplesPerRow;
+    }
+    return count ? static_cast<int>(sum / count) : -1;
+}
+
+float audioRmsDb(const AudioFrame& frame) {
+    const int channels = std::min(frame.channels, 8);
+    if (frame.samples <= 0 || channels <= 0) {
+        return kSilenceFloorDb;
+    }
+    double sum = 0.0;
+    int used = 0;
+    for (int c = 0; c < channels; ++c) {
+        if (frame.data[c]) {
+            sum += sumSquares(frame.data[c], frame.samples);
+            ++used;
+        }
+    }
+    if (used == 0 || sum <= 0.0) {
+        return kSilenceFloorDb;
+    }
+    double rms = std::sqrt(sum / (static_cast<double>(used) * frame.samples));
+    return std::max(kSilenceFloorDb, static_cast<float>(20.0 * std::log10(rms)));
+}
+
+void ContentDetector::bind(const std::string& subject, EventBus* events) {
+    subject_ = subject;
+    events_ = events;
+}
+
+bool ContentDetector::analyzeVideo(const VideoFrame& frame, FrameTime now) {
+    const uint64_t hash = hashVideoFrame(frame, settings_.hash_row_step);
+    const bool unchanged = hasHash_ && hash == hash_.load(std::memory_order_relaxed);
+    const int luma = averageLuma(frame);
+    hasHash_ = true;
+
+    hash_.store(hash, std::memory_order_relaxed);
+    luma_.store(luma, std::memory_order_relaxed);
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    if (unchanged) {
+        unchanged_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    update(frozen_, unchanged, now, settings_.frozen_timeout_ms, EventType::SourceFrozen, frozenFlag_);
+    update(black_, luma >= 0 && luma <= settings_.black_threshold, now, settings_.black_timeout_ms,
+           EventType::SourceBlack, blackFlag_);
+    return unchanged;
+}
+
+void ContentDetector::analyzeAudio(const AudioFrame& frame, FrameTime now) {
+    const float db = audioRmsDb(frame);
+    rmsDb_.store(db, std::memory_order_relaxed);
+    update(silent_, db <= settings_.silence_threshold_db, now, settings_.silence_timeout_ms,
+           EventType::SourceSilent, silentFlag_);
+}
+
+/**
+ * @brief 推进持续性检测状态
+ * @details 条件持续成立超过timeoutMs后进入生效状态并发布事件（value为已持续的微秒数），
+ *          条件不再成立时退出生效状态并发布value为0的事件
+ */
+void ContentDetector::update(Condition& condition, bool holds, FrameTime now, int timeoutMs,
+                             EventType type, std::atomic<bool>& flag) {
+    if (!holds) {
+        condition.since = FrameTime(0);
+        if (condition.active) {
+            condition.active = false;
+            flag.store(false, std::memory_order_relaxed);
+            if (events_) {
+                events_->publish(type, subject_.c_str(), 0);
+            }
+        }
+        return;
+    }
+
+    if (condition.since.count() == 0) {
+        condition.since = now;
+    }
+    const FrameTime elapsed = now - condition.since;
+    if (!condition.active && elapsed >= FrameTime(static_cast<int64_t>(timeoutMs) * 1000)) {
+        condition.active = true;
+        flag.store(true, std::memory_order_relaxed);
+        if (events_) {
+            events_->publish(type, subject_.c_str(), std::max<int64_t>(elapsed.count(), 1));
+        }
+    }
+}
+
+ContentStats ContentDetector::getStats() const {
+    ContentStats stats;
+    stats.source = subject_;
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.unchanged_frames = unchanged_.load(std::memory_order_relaxed);
+    stats.skipped_composites = skipped_.load(std::memory_order_relaxed);
+    stats.passthrough_frames = passthrough_.load(std::memory_order_relaxed);
+    stats.culled_frames = culled_.load(std::memory_order_relaxed);
+    stats.hash = hash_.load(std::memory_order_relaxed);
+    stats.luma = luma_.load(std::memory_order_relaxed);
+    stats.rms_db = rmsDb_.load(std::memory_order_relaxed);
+    stats.frozen = frozenFlag_.load(std::memory_order_relaxed);
+    stats.black = blackFlag_.load(std::memory_order_relaxed);
+    stats.silent = silentFlag_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace SimpleOBS
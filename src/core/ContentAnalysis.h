@@ -0,0 +1,175 @@
+/**
+ * @file ContentAnalysis.h
+ * @brief 源内容检测：画面冻结、黑场与静音
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了逐源的内容检测器。每帧视频计算一次SIMD内容哈希和平均亮度，
+ * 每块音频计算RMS电平：哈希连续不变超过阈值时长视为画面冻结，亮度持续低于阈值视为黑场，
+ * 电平持续低于阈值视为静音，状态变化时发布事件并更新统计。
+ * 同一哈希也供合成器判断源画面与上一帧逐字节相同，从而跳过复制。
+ *
+ * @note
+ * - 哈希按8个32位通道并行累积，AVX2/SSE4.1/标量实现结果完全一致
+ * - 亮度按行抽样统计，RGBA取RGB三通道均值，YUV格式取Y平面均值
+ * - 检测器只在渲染线程中调用，统计可在任意线程读取
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include "EventBus.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 计算视频帧内容哈希
+ * @param[in] frame 视频帧
+ * @param[in] rowStep 行抽样间隔，1表示逐行
+ * @return 64位哈希，尺寸与格式也参与计算
+ */
+uint64_t hashVideoFrame(const VideoFrame& frame, int rowStep = 1);
+
+/**
+ * @brief 计算视频帧平均亮度
+ * @param[in] frame 视频帧
+ * @param[in] rowStep 行抽样间隔
+ * @return 0~255的平均亮度（10位格式换算到8位刻度），格式不支持或无数据时返回-1
+ */
+int averageLuma(const VideoFrame& frame, int rowStep = 8);
+
+/**
+ * @brief 计算音频帧RMS电平
+ * @param[in] frame 音频帧
+ * @return dBFS电平，无数据或全零时为-120
+ */
+float audioRmsDb(const AudioFrame& frame);
+
+/**
+ * @brief 内容检测配置
+ */
+struct ContentSettings {
+    int frozen_timeout_ms = 2000;           ///< 画面连续不变多久视为冻结
+    int black_threshold = 24;               ///< 平均亮度不超过该值视为黑帧（0~255）
+    int black_timeout_ms = 1000;            ///< 黑帧持续多久视为黑场
+    float silence_threshold_db = -60.0f;    ///< 电平不超过该值视为静音
+    int silence_timeout_ms = 2000;          ///< 静音持续多久发布事件
+    int hash_row_step = 1;                  ///< 哈希行抽样间隔，大于1时不再跳过合成
+};
+
+/**
+ * @brief 单个源的内容统计
+ */
+struct ContentStats {
+    std::string source;
+    uint64_t frames = 0;                ///< 已分析的视频帧数
+    uint64_t unchanged_frames = 0;      ///< 与上一帧哈希相同的帧数
+    uint64_t skipped_composites = 0;    ///< 因画面相同跳过的合成次数
+    uint64_t passthrough_frames = 0;    ///< 源画面直接作为输出、未复制进画布的帧数
+    uint64_t culled_frames = 0;         ///< 被上层不透明源完全遮挡、未拉取的帧数
+    uint64_t hash = 0;                  ///< 最近一帧的内容哈希
+    int luma = -1;                      ///< 最近一帧的平均亮度
+    float rms_db = -120.0f;             ///< 最近一块音频的电平
+    bool frozen = false;
+    bool black = false;
+    bool silent = false;
+};
+
+/**
+ * @brief 逐源内容检测器
+ */
+class ContentDetector {
+public:
+    /**
+     * @brief 绑定事件主体和事件总线
+     * @param[in] subject 源名称
+     * @param[in] events 事件总线，可为空
+     */
+    void bind(const std::string& subject, EventBus* events);
+
+    /**
+     * @brief 设置检测配置（渲染线程或推流前调用）
+     * @param[in] settings 配置
+     */
+    void setSettings(const ContentSettings& settings) { settings_ = settings; }
+
+    /**
+     * @brief 分析一帧视频
+     * @param[in] frame 源视频帧
+     * @param[in] now 当前时刻
+     * @return true表示与上一帧内容相同
+     */
+    bool analyzeVideo(const VideoFrame& frame, FrameTime now);
+
+    /**
+     * @brief 分析一帧音频
+     * @param[in] frame 源音频帧
+     * @param[in] now 当前时刻
+     */
+    void analyzeAudio(const AudioFrame& frame, FrameTime now);
+
+    /**
+     * @brief 哈希是否逐行计算，只有逐行哈希相同才能跳过合成
+     */
+    bool exactHash() const { return settings_.hash_row_step <= 1; }
+
+    /**
+     * @brief 记录一次跳过的合成
+     */
+    void countSkippedComposite() { skipped_.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief 记录一次直通输出
+     */
+    void countPassthrough() { passthrough_.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief 记录一次被遮挡而跳过的拉取
+     */
+    void countCulled() { culled_.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief 获取统计信息（任意线程）
+     */
+    ContentStats getStats() const;
+
+private:
+    /**
+     * @brief 持续一段时间才生效的检测状态
+     */
+    struct Condition {
+        bool active = false;
+        FrameTime since{0};     ///< 条件开始成立的时刻，0表示不成立
+    };
+
+    void update(Condition& condition, bool holds, FrameTime now, int timeoutMs,
+                EventType type, std::atomic<bool>& flag);
+
+    ContentSettings settings_;
+    std::string subject_;
+    EventBus* events_ = nullptr;
+
+    bool hasHash_ = false;
+    Condition frozen_;
+    Condition black_;
+    Condition silent_;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> unchanged_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> passthrough_{0};
+    std::atomic<uint64_t> culled_{0};
+    std::atomic<uint64_t> hash_{0};
+    std::atomic<int> luma_{-1};
+    std::atomic<float> rmsDb_{-120.0f};
+    std::atomic<bool> frozenFlag_{false};
+    std::atomic<bool> blackFlag_{false};
+    std::atomic<bool> silentFlag_{false};
+};
+
+} // namespace SimpleOBS
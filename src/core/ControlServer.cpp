@@ -0,0 +1,844 @@
+/**
+ * @file ControlServer.cpp
+ * @brief JSON-RPC控制服务器实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "ControlServer.h"
+#include "FlightRecorder.h"
+#include "FramePool.h"
+#include "MemoryBudget.h"
+#include "SceneImpl.h"
+#include "Screenshot.h"
+#include "SourceActivation.h"
+#include "Watchdog.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+/// 等待渲染线程执行命令时的轮询间隔
+constexpr auto kCommandPollInterval = std::chrono::microseconds(500);
+
+/// 等待截图完成的最长时间
+constexpr auto kScreenshotTimeout = std::chrono::seconds(3);
+
+std::string base64Encode(const std::vector<uint8_t>& data) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 3 <= data.size(); i += 3) {
+        uint32_t v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out.push_back(kAlphabet[v >> 18]);
+        out.push_back(kAlphabet[(v >> 12) & 63]);
+        out.push_back(kAlphabet[(v >> 6) & 63]);
+        out.push_back(kAlphabet[v & 63]);
+    }
+    if (i < data.size()) {
+        uint32_t v = data[i] << 16;
+        if (i + 1 < data.size()) {
+            v |= data[i + 1] << 8;
+        }
+        out.push_back(kAlphabet[v >> 18]);
+        out.push_back(kAlphabet[(v >> 12) & 63]);
+        out.push_back(i + 1 < data.size() ? kAlphabet[(v >> 6) & 63] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+JsonValue makeError(const JsonValue& id, int code, const std::string& message) {
+    JsonValue error = JsonValue::object();
+    error.set("code", code);
+    error.set("message", message);
+
+    JsonValue response = JsonValue::object();
+    response.set("jsonrpc", "2.0");
+    response.set("error", std::move(error));
+    response.set("id", id);
+    return response;
+}
+
+int64_t toMicroseconds(FrameTime time) {
+    return static_cast<int64_t>(time.count());
+}
+
+bool sendAll(int fd, const std::string& data) {
+#ifndef _WIN32
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t w = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) {
+            continue;
+        }
+        if (w <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(w);
+    }
+    return true;
+#else
+    (void)fd;
+    (void)data;
+    return false;
+#endif
+}
+
+bool eventTypeFromName(const std::string& name, EventType& type) {
+    for (int i = 0; i < static_cast<int>(EventType::Count); ++i) {
+        if (name == eventTypeName(static_cast<EventType>(i))) {
+            type = static_cast<EventType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+/**
+ * @brief 单个客户端连接
+ */
+struct ControlServer::Client {
+    int fd = -1;
+    std::string input;      ///< 尚未形成完整行的输入
+    uint32_t eventMask = 0; ///< 订阅的事件类型，0表示未订阅
+};
+
+ControlServer::ControlServer(Engine& engine) : engine_(engine) {}
+
+ControlServer::~ControlServer() {
+    stop();
+}
+
+bool ControlServer::start(const ControlServerSettings& settings) {
+    if (running_.load(std::memory_order_acquire)) {
+        return true;
+    }
+#ifdef _WIN32
+    (void)settings;
+    LOG_ERROR("Control server requires Unix domain sockets");
+    return false;
+#else
+    settings_ = settings;
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (settings_.path.empty() || settings_.path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Control server socket path invalid: '{}'", settings_.path);
+        return false;
+    }
+    std::memcpy(addr.sun_path, settings_.path.c_str(), settings_.path.size() + 1);
+
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        LOG_ERROR("Control server socket() failed: {}", std::strerror(errno));
+        return false;
+    }
+
+    // 上次异常退出可能留下套接字文件
+    unlink(settings_.path.c_str());
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd_, settings_.max_clients) != 0) {
+        LOG_ERROR("Control server cannot listen on {}: {}", settings_.path, std::strerror(errno));
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    if (pipe2(wakeFds_, O_CLOEXEC | O_NONBLOCK) != 0) {
+        LOG_ERROR("Control server pipe2() failed: {}", std::strerror(errno));
+        close(listenFd_);
+        listenFd_ = -1;
+        unlink(settings_.path.c_str());
+        return false;
+    }
+
+    // 分发线程只把事件放进本地队列并唤醒服务线程，由服务线程推送给客户端
+    subscription_ = engine_.getEventBus().subscribe([this](const Event& event) {
+        {
+            std::lock_guard<std::mutex> lock(eventsMutex_);
+            if (pendingEvents_.size() >= settings_.max_pending_events) {
+                pendingEvents_.pop_front();
+            }
+            pendingEvents_.push_back(event);
+        }
+        char byte = 1;
+        (void)!write(wakeFds_[1], &byte, 1);
+    });
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&ControlServer::serverLoop, this);
+    LOG_INFO("Control server listening on {}", settings_.path);
+    return true;
+#endif
+}
+
+void ControlServer::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+#ifndef _WIN32
+    engine_.getEventBus().unsubscribe(subscription_);
+    subscription_ = 0;
+
+    char byte = 0;
+    (void)!write(wakeFds_[1], &byte, 1);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    close(wakeFds_[0]);
+    close(wakeFds_[1]);
+    wakeFds_[0] = wakeFds_[1] = -1;
+    close(listenFd_);
+    listenFd_ = -1;
+    unlink(settings_.path.c_str());
+
+    ControlServerStats stats = getStats();
+    LOG_INFO("Control server stopped: {} connections, {} requests, {} errors",
+             stats.connections, stats.requests, stats.errors);
+#endif
+}
+
+ControlServerStats ControlServer::getStats() const {
+    ControlServerStats stats;
+    stats.connections = connections_.load(std::memory_order_relaxed);
+    stats.requests = requests_.load(std::memory_order_relaxed);
+    stats.errors = errors_.load(std::memory_order_relaxed);
+    stats.events_sent = eventsSent_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ControlServer::serverLoop() {
+#ifndef _WIN32
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    char buffer[4096];
+
+    while (running_.load(std::memory_order_acquire)) {
+        fds.clear();
+        fds.push_back({wakeFds_[0], POLLIN, 0});
+        fds.push_back({listenFd_, POLLIN, 0});
+        for (const auto& client : clients) {
+            fds.push_back({client.fd, POLLIN, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Control server poll() failed: {}", std::strerror(errno));
+            break;
+        }
+        if (fds[0].revents) {
+            char drain[64];
+            while (read(wakeFds_[0], drain, sizeof(drain)) > 0) {
+            }
+            if (!running_.load(std::memory_order_acquire)) {
+                break;
+            }
+            forwardEvents(clients);
+        }
+
+        if (fds[1].revents & POLLIN) {
+            int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                if (static_cast<int>(clients.size()) >= settings_.max_clients) {
+                    LOG_WARN("Control server rejected connection: {} clients already connected",
+                             clients.size());
+                    close(fd);
+                } else {
+                    clients.push_back(Client{fd, std::string(), 0});
+                    connections_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // 新接受的连接不在本轮fds中，只检查已有的部分
+        for (size_t i = 2; i < fds.size(); ++i) {
+            if (!fds[i].revents || clients[i - 2].fd < 0) {
+                continue;
+            }
+            Client& client = clients[i - 2];
+            bool closed = false;
+
+            ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                closed = n == 0 || (errno != EINTR && errno != EAGAIN);
+            } else {
+                client.input.append(buffer, static_cast<size_t>(n));
+                size_t start = 0;
+                size_t newline;
+                while (!closed && (newline = client.input.find('\n', start)) != std::string::npos) {
+                    std::string line = client.input.substr(start, newline - start);
+                    start = newline + 1;
+                    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                        continue;
+                    }
+
+                    std::string response = handleRequest(line, &client);
+                    if (!response.empty()) {
+                        response += '\n';
+                        closed = !sendAll(client.fd, response);
+                    }
+                }
+                client.input.erase(0, start);
+                if (client.input.size() > settings_.max_request_bytes) {
+                    LOG_WARN("Control server closing client: request exceeds {} bytes",
+                             settings_.max_request_bytes);
+                    closed = true;
+                }
+            }
+
+            if (closed) {
+                close(client.fd);
+                client.fd = -1;
+            }
+        }
+
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const Client& client) { return client.fd < 0; }),
+                      clients.end());
+    }
+
+    for (auto& client : clients) {
+        close(client.fd);
+    }
+#endif
+}
+
+void ControlServer::forwardEvents(std::vector<Client>& clients) {
+    std::deque<Event> events;
+    {
+        std::lock_guard<std::mutex> lock(eventsMutex_);
+        events.swap(pendingEvents_);
+    }
+
+    for (const auto& event : events) {
+        uint32_t bit = eventMask(event.type);
+        std::string line;
+        for (auto& client : clients) {
+            if (client.fd < 0 || !(client.eventMask & bit)) {
+                continue;
+            }
+            if (line.empty()) {
+                JsonValue params = JsonValue::object();
+                params.set("type", eventTypeName(event.type));
+                params.set("subject", std::string(event.subject));
+                params.set("value", event.value);
+                params.set("timestamp_us", event.timestamp);
+
+                JsonValue notification = JsonValue::object();
+                notification.set("jsonrpc", "2.0");
+                notification.set("method", "event");
+                notification.set("params", std::move(params));
+                line = notification.dump() + '\n';
+            }
+            if (sendAll(client.fd, line)) {
+                eventsSent_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+#ifndef _WIN32
+                close(client.fd);
+#endif
+                client.fd = -1;
+            }
+        }
+    }
+}
+
+std::string ControlServer::handleRequest(const std::string& request, Client* client) {
+    requests_.fetch_add(1, std::memory_order_relaxed);
+
+    JsonValue message;
+    std::string parseError;
+    if (!JsonValue::parse(request, message, &parseError)) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        return makeError(JsonValue(), kParseError, "Parse error: " + parseError).dump();
+    }
+
+    const JsonValue& id = message["id"];
+    const JsonValue& method = message["method"];
+    if (!message.isObject() || message["jsonrpc"].asString() != "2.0" || !method.isString() ||
+        !(id.isNull() || id.isString() || id.isNumber())) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        return makeError(id, kInvalidRequest, "Invalid request").dump();
+    }
+
+    const JsonValue& params = message["params"];
+    JsonValue result;
+    int code = 0;
+    std::string error;
+    bool ok = (params.isNull() || params.isObject()) &&
+              dispatch(method.asString(), params, client, result, code, error);
+    if (!ok && code == 0) {
+        code = kInvalidParams;
+        error = "params must be an object";
+    }
+    if (!ok) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        LOG_DEBUG("Control request {} failed: {}", method.asString(), error);
+    }
+
+    // 没有id的请求是通知，不回复
+    if (!message.contains("id")) {
+        return std::string();
+    }
+    if (!ok) {
+        return makeError(id, code, error).dump();
+    }
+
+    JsonValue response = JsonValue::object();
+    response.set("jsonrpc", "2.0");
+    response.set("result", std::move(result));
+    response.set("id", id);
+    return response.dump();
+}
+
+bool ControlServer::dispatch(const std::string& method, const JsonValue& params, Client* client,
+                             JsonValue& result, int& code, std::string& message) {
+    auto requireString = [&](const char* key, std::string& out) {
+        out = params[key].asString();
+        if (out.empty()) {
+            code = kInvalidParams;
+            message = std::string("missing string parameter '") + key + "'";
+            return false;
+        }
+        return true;
+    };
+
+    if (method == "scene.list") {
+        JsonValue scenes = JsonValue::array();
+        for (const auto& name : engine_.getSceneNames()) {
+            scenes.push(name);
+        }
+        auto current = engine_.getCurrentScene();
+        result = JsonValue::object();
+        result.set("scenes", std::move(scenes));
+        result.set("current", current ? JsonValue(current->getName()) : JsonValue());
+        return true;
+    }
+
+    if (method == "stats.get") {
+        result = collectStats();
+        return true;
+    }
+
+    if (method == "recorder.dump") {
+        const JsonValue& reason = params["reason"];
+        std::string path = engine_.getWatchdog().dump(reason.isString() ? reason.asString() : "requested");
+        if (path.empty()) {
+            code = kDumpFailed;
+            message = "flight recorder dump failed";
+            return false;
+        }
+        result = JsonValue::object();
+        result.set("path", path);
+        return true;
+    }
+
+    if (method == "screenshot.capture") {
+        ScreenshotRequest request;
+        request.scene = params["scene"].asString();
+        request.source = params["source"].asString();
+        const std::string format = params["format"].isString() ? params["format"].asString() : "png";
+        if (format == "jpeg" || format == "jpg") {
+            request.format = ImageFormat::Jpeg;
+        } else if (format != "png") {
+            code = kInvalidParams;
+            message = "format must be 'png' or 'jpeg'";
+            return false;
+        }
+        if (params["quality"].isNumber()) {
+            request.quality = static_cast<int>(params["quality"].asNumber());
+        }
+        if (params["max_width"].isNumber()) {
+            request.max_width = static_cast<int>(params["max_width"].asNumber());
+        }
+        if (params["max_height"].isNumber()) {
+            request.max_height = static_cast<int>(params["max_height"].asNumber());
+        }
+        if (!engine_.isStreaming()) {
+            code = kRejected;
+            message = "screenshots require the engine to be streaming";
+            return false;
+        }
+
+        // 回调可能在超时返回后才执行，结果放在共享状态中
+        struct Pending {
+            std::atomic<bool> done{false};
+            Screenshot shot;
+        };
+        auto pending = std::make_shared<Pending>();
+        if (!engine_.requestScreenshot(request, [pending](const Screenshot& shot) {
+                pending->shot = shot;
+                pending->done.store(true, std::memory_order_release);
+            })) {
+            code = kNotFound;
+            message = "scene or source not found, or too many pending screenshots";
+            return false;
+        }
+
+        // 与命令相同，只轮询原子状态
+        const auto deadline = std::chrono::steady_clock::now() + kScreenshotTimeout;
+        while (!pending->done.load(std::memory_order_acquire)) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                code = kScreenshotFailed;
+                message = "screenshot timed out";
+                return false;
+            }
+            std::this_thread::sleep_for(kCommandPollInterval);
+        }
+        const Screenshot& shot = pending->shot;
+        if (!shot.ok) {
+            code = kScreenshotFailed;
+            message = shot.error;
+            return false;
+        }
+
+        result = JsonValue::object();
+        result.set("format", shot.format == ImageFormat::Jpeg ? "jpeg" : "png");
+        result.set("width", shot.width);
+        result.set("height", shot.height);
+        result.set("timestamp_us", toMicroseconds(shot.timestamp));
+        result.set("bytes", static_cast<uint64_t>(shot.data.size()));
+        const std::string path = params["path"].asString();
+        if (path.empty()) {
+            result.set("data", base64Encode(shot.data));
+            return true;
+        }
+        std::ofstream file(path, std::ios::binary);
+        if (!file.write(reinterpret_cast<const char*>(shot.data.data()), static_cast<std::streamsize>(shot.data.size()))) {
+            code = kScreenshotFailed;
+            message = "cannot write " + path;
+            return false;
+        }
+        result.set("path", path);
+        return true;
+    }
+
+    if (method == "events.subscribe" || method == "events.unsubscribe") {
+        if (!client) {
+            code = kInvalidRequest;
+            message = "event subscription requires a socket connection";
+            return false;
+        }
+        uint32_t mask = 0;
+        JsonValue names = JsonValue::array();
+        if (method == "events.subscribe") {
+            const JsonValue& events = params["events"];
+            if (events.isNull()) {
+                mask = kAllEvents;
+            }
+            for (const auto& name : events.items()) {
+                EventType type;
+                if (!eventTypeFromName(name.asString(), type)) {
+                    code = kInvalidParams;
+                    message = "unknown event: " + name.toString();
+                    return false;
+                }
+                mask |= eventMask(type);
+            }
+            for (int i = 0; i < static_cast<int>(EventType::Count); ++i) {
+                if (mask & eventMask(static_cast<EventType>(i))) {
+                    names.push(eventTypeName(static_cast<EventType>(i)));
+                }
+            }
+        }
+        client->eventMask = mask;
+        result = JsonValue::object();
+        result.set("subscribed", std::move(names));
+        return true;
+    }
+
+    EngineCommand command;
+    if (method == "scene.switch") {
+        command.type = EngineCommand::Type::SwitchScene;
+        if (!requireString("name", command.scene)) {
+            return false;
+        }
+    } else if (method == "source.add") {
+        command.type = EngineCommand::Type::AddSource;
+        std::string id;
+        if (!requireString("scene", command.scene) || !requireString("id", id) ||
+            !requireString("name", command.source)) {
+            return false;
+        }
+        // 源在控制线程创建，渲染线程只负责挂到场景上
+        command.source_ptr = engine_.createSource(id, command.source);
+        if (!command.source_ptr) {
+            code = kRejected;
+            message = "cannot create source of type '" + id + "'";
+            return false;
+        }
+    } else if (method == "source.remove") {
+        command.type = EngineCommand::Type::RemoveSource;
+        if (!requireString("scene", command.scene) || !requireString("name", command.source)) {
+            return false;
+        }
+    } else if (method == "property.set") {
+        command.type = EngineCommand::Type::SetProperty;
+        if (!requireString("scene", command.scene) || !requireString("key", command.key)) {
+            return false;
+        }
+        if (!params.contains("value")) {
+            code = kInvalidParams;
+            message = "missing parameter 'value'";
+            return false;
+        }
+        command.source = params["source"].asString();
+        command.filter = params["filter"].asString();
+        command.value = params["value"].toString();
+    } else if (method == "filter.add") {
+        command.type = EngineCommand::Type::AddFilter;
+        std::string id;
+        if (!requireString("scene", command.scene) || !requireString("id", id) ||
+            !requireString("name", command.filter)) {
+            return false;
+        }
+        command.source = params["source"].asString();
+        // 滤镜在控制线程创建并设置初始属性，渲染线程只负责挂到场景或源上
+        command.filter_ptr = engine_.createFilter(id, command.filter);
+        if (!command.filter_ptr) {
+            code = kRejected;
+            message = "cannot create filter of type '" + id + "'";
+            return false;
+        }
+        const JsonValue& properties = params["properties"];
+        if (properties.isObject()) {
+            for (const auto& entry : properties.members()) {
+                if (!command.filter_ptr->setProperty(entry.first, entry.second.toString())) {
+                    code = kInvalidParams;
+                    message = "property not supported or invalid value: " + entry.first;
+                    return false;
+                }
+            }
+        }
+    } else if (method == "filter.remove") {
+        command.type = EngineCommand::Type::RemoveFilter;
+        if (!requireString("scene", command.scene) || !requireString("name", command.filter)) {
+            return false;
+        }
+        command.source = params["source"].asString();
+    } else {
+        code = kMethodNotFound;
+        message = "Method not found: " + method;
+        return false;
+    }
+
+    if (!runCommand(command, code, message)) {
+        return false;
+    }
+    result = true;
+    return true;
+}
+
+bool ControlServer::runCommand(EngineCommand& command, int& code, std::string& message) {
+    if (!engine_.postCommand(&command)) {
+        code = kBusy;
+        message = "engine command queue is full";
+        return false;
+    }
+
+    // 推流时渲染线程最多一个渲染周期后执行；这里只轮询原子状态，不等待任何锁
+    EngineCommand::Status status;
+    while ((status = command.status.load(std::memory_order_acquire)) == EngineCommand::Status::Pending) {
+        std::this_thread::sleep_for(kCommandPollInterval);
+    }
+    // 切换场景后被换下场景的源在控制线程中停止
+    engine_.finishCommand(&command);
+
+    switch (status) {
+    case EngineCommand::Status::Ok:
+        return true;
+    case EngineCommand::Status::NotFound:
+        code = kNotFound;
+        if (!command.filter.empty() && command.type != EngineCommand::Type::AddFilter) {
+            message = "scene, source or filter not found: " + command.scene + "/" +
+                      (command.source.empty() ? "" : command.source + "/") + command.filter;
+        } else {
+            message = command.source.empty() || command.type == EngineCommand::Type::SwitchScene
+                ? "scene not found: " + command.scene
+                : "scene or source not found: " + command.scene + "/" + command.source;
+        }
+        return false;
+    default:
+        code = kRejected;
+        message = command.type == EngineCommand::Type::SetProperty
+            ? "property not supported or invalid value: " + command.key
+            : "command rejected by engine";
+        return false;
+    }
+}
+
+JsonValue ControlServer::collectStats() const {
+    JsonValue stats = JsonValue::object();
+    stats.set("streaming", engine_.isStreaming());
+    auto current = engine_.getCurrentScene();
+    stats.set("current_scene", current ? JsonValue(current->getName()) : JsonValue());
+
+    AudioLatencyStats latency = engine_.getAudioLatencyStats();
+    JsonValue audio = JsonValue::object();
+    audio.set("blocks", latency.blocks);
+    audio.set("block_us", toMicroseconds(latency.block_duration));
+    audio.set("last_us", toMicroseconds(latency.last));
+    audio.set("average_us", toMicroseconds(latency.average));
+    audio.set("min_us", toMicroseconds(latency.min));
+    audio.set("max_us", toMicroseconds(latency.max));
+    stats.set("audio_latency", std::move(audio));
+
+    AudioMonitorStats monitor = engine_.getAudioMonitorStats();
+    JsonValue monitorJson = JsonValue::object();
+    monitorJson.set("running", monitor.running);
+    monitorJson.set("sink", monitor.sink);
+    monitorJson.set("frames_written", monitor.frames_written);
+    monitorJson.set("underruns", monitor.underruns);
+    monitorJson.set("dropped_blocks", monitor.dropped_blocks);
+    monitorJson.set("resample_ratio", monitor.resample_ratio);
+    monitorJson.set("buffered_us", toMicroseconds(monitor.buffered));
+    stats.set("audio_monitor", std::move(monitorJson));
+
+    ControlServerStats server = getStats();
+    JsonValue serverJson = JsonValue::object();
+    serverJson.set("connections", server.connections);
+    serverJson.set("requests", server.requests);
+    serverJson.set("errors", server.errors);
+    serverJson.set("events_sent", server.events_sent);
+    stats.set("control", std::move(serverJson));
+
+    EventBusStats bus = engine_.getEventBus().getStats();
+    JsonValue busJson = JsonValue::object();
+    busJson.set("published", bus.published);
+    busJson.set("dropped", bus.dropped);
+    busJson.set("dispatched", bus.dispatched);
+    busJson.set("producers", static_cast<int>(bus.producers));
+    busJson.set("subscribers", static_cast<int>(bus.subscribers));
+    stats.set("events", std::move(busJson));
+
+    JsonValue pools = JsonValue::array();
+    for (const FramePoolStats& pool : engine_.getFramePool().getStats()) {
+        JsonValue poolJson = JsonValue::object();
+        poolJson.set("backing", memoryBackingName(pool.backing));
+        poolJson.set("node", pool.node);
+        poolJson.set("frame_bytes", static_cast<uint64_t>(pool.frame_bytes));
+        poolJson.set("arena_bytes", static_cast<uint64_t>(pool.arena_bytes));
+        poolJson.set("frames", static_cast<int>(pool.frames));
+        poolJson.set("free", static_cast<int>(pool.free));
+        poolJson.set("acquire_failures", pool.acquire_failures);
+        poolJson.set("remote_acquires", pool.remote_acquires);
+        pools.push(std::move(poolJson));
+    }
+    stats.set("frame_pool", std::move(pools));
+
+    MemoryStats memory = engine_.getMemoryStats();
+    JsonValue memoryJson = JsonValue::object();
+    memoryJson.set("limit", memory.limit);
+    memoryJson.set("used", memory.used);
+    memoryJson.set("peak", memory.peak);
+    memoryJson.set("evicted", memory.evicted);
+    memoryJson.set("failed_reservations", memory.failed_reservations);
+    JsonValue subsystems = JsonValue::array();
+    for (const auto& sub : memory.subsystems) {
+        JsonValue subJson = JsonValue::object();
+        subJson.set("name", sub.name);
+        subJson.set("priority", memoryPriorityName(static_cast<MemoryPriority>(sub.priority)));
+        subJson.set("used", sub.used);
+        subJson.set("peak", sub.peak);
+        subJson.set("evicted", sub.evicted);
+        subJson.set("failed_reservations", sub.failed_reservations);
+        subsystems.push(std::move(subJson));
+    }
+    memoryJson.set("subsystems", std::move(subsystems));
+    stats.set("memory", std::move(memoryJson));
+
+    JsonValue content = JsonValue::array();
+    if (auto scene = std::dynamic_pointer_cast<SceneImpl>(current)) {
+        for (const ContentStats& source : scene->getContentStats()) {
+            JsonValue sourceJson = JsonValue::object();
+            sourceJson.set("source", source.source);
+            sourceJson.set("frames", source.frames);
+            sourceJson.set("unchanged_frames", source.unchanged_frames);
+            sourceJson.set("skipped_composites", source.skipped_composites);
+            sourceJson.set("passthrough_frames", source.passthrough_frames);
+            sourceJson.set("culled_frames", source.culled_frames);
+            sourceJson.set("luma", source.luma);
+            sourceJson.set("rms_db", static_cast<double>(source.rms_db));
+            sourceJson.set("frozen", source.frozen);
+            sourceJson.set("black", source.black);
+            sourceJson.set("silent", source.silent);
+            content.push(std::move(sourceJson));
+        }
+    }
+    stats.set("content", std::move(content));
+
+    JsonValue frameRate = JsonValue::object();
+    if (auto scene = std::dynamic_pointer_cast<SceneImpl>(current)) {
+        frameRate.set("mode", frameRateModeName(scene->getFrameRateMode()));
+        const std::vector<ContentStats> names = scene->getContentStats();
+        const std::vector<FrameRateStats> rates = scene->getFrameRateStats();
+        JsonValue sources = JsonValue::array();
+        for (size_t i = 0; i < rates.size() && i < names.size(); ++i) {
+            const FrameRateStats& rate = rates[i];
+            JsonValue sourceJson = JsonValue::object();
+            sourceJson.set("source", names[i].source);
+            sourceJson.set("source_fps", rate.source_fps);
+            sourceJson.set("drift_ppm", rate.drift_ppm);
+            sourceJson.set("converting", rate.converting);
+            sourceJson.set("source_frames", rate.source_frames);
+            sourceJson.set("repeated", rate.repeated);
+            sourceJson.set("skipped", rate.skipped);
+            sourceJson.set("blended", rate.blended);
+            sourceJson.set("copied", rate.copied);
+            sources.push(std::move(sourceJson));
+        }
+        frameRate.set("sources", std::move(sources));
+    }
+    stats.set("frame_rate", std::move(frameRate));
+
+    SourceActivationStats activation = engine_.getSourceActivation().getStats();
+    JsonValue activationJson = JsonValue::object();
+    activationJson.set("visible", activation.visible);
+    activationJson.set("starts", activation.starts);
+    activationJson.set("stops", activation.stops);
+    stats.set("activation", std::move(activationJson));
+
+    ScreenshotStats screenshots = engine_.getScreenshots().getStats();
+    JsonValue screenshotJson = JsonValue::object();
+    screenshotJson.set("requested", screenshots.requested);
+    screenshotJson.set("rejected", screenshots.rejected);
+    screenshotJson.set("completed", screenshots.completed);
+    screenshotJson.set("failed", screenshots.failed);
+    screenshotJson.set("zero_copy", screenshots.zero_copy);
+    screenshotJson.set("rendered", screenshots.rendered);
+    screenshotJson.set("deferred", screenshots.deferred);
+    screenshotJson.set("last_encode_us", screenshots.last_encode_us);
+    stats.set("screenshots", std::move(screenshotJson));
+
+    WatchdogStats watchdog = engine_.getWatchdog().getStats();
+    JsonValue watchdogJson = JsonValue::object();
+    watchdogJson.set("stalls", watchdog.stalls);
+    watchdogJson.set("dumps", watchdog.dumps);
+    watchdogJson.set("last_dump", watchdog.last_dump);
+    watchdogJson.set("recorded", engine_.getFlightRecorder().recorded());
+    stats.set("watchdog", std::move(watchdogJson));
+    return stats;
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,153 @@
+/**
+ * @file ControlServer.h
+ * @brief JSON-RPC控制服务器（Unix域套接字）
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了引擎的远程控制接口：在Unix域套接字上接收换行分隔的JSON-RPC 2.0请求，
+ * 支持场景切换、源和滤镜的添加/移除、属性设置和统计查询。
+ * 修改类请求转换为EngineCommand投递到引擎的无锁命令队列，由渲染线程在两次渲染之间执行；
+ * 查询类请求只读取引擎的原子统计量。
+ *
+ * @note
+ * - 控制线程不持有任何渲染线程需要的锁，客户端再慢也不会拖慢渲染
+ * - 所有连接由同一个服务线程通过poll处理，请求按到达顺序依次执行
+ *
+ * 支持的方法：
+ * - scene.list：返回场景列表和当前场景
+ * - scene.switch {name}
+ * - source.add {scene, id, name}
+ * - source.remove {scene, name}
+ * - property.set {scene, source?, filter?, key, value}：filter给出时设置该源（或场景）上的滤镜
+ * - filter.add {scene, source?, id, name, properties?}：source缺省时为场景级滤镜，properties为初始属性
+ * - filter.remove {scene, source?, name}
+ * - stats.get：推流状态、音频延迟、监听、事件总线、帧池、内存、看门狗、内容检测、帧率转换和截图统计
+ * - recorder.dump {reason?}：立即转储飞行记录器，返回文件路径
+ * - screenshot.capture {scene?, source?, format?, quality?, max_width?, max_height?, path?}：
+ *   截取场景或源，format为"png"（缺省）或"jpeg"；给出path时写入文件并返回路径，否则返回base64数据
+ * - events.subscribe {events?}：之后以"event"通知推送引擎事件，events为事件名称数组，缺省为全部
+ * - events.unsubscribe
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include "EventBus.h"
+#include "Json.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 控制服务器配置
+ */
+struct ControlServerSettings {
+    std::string path = "/tmp/simpleobs.sock";   ///< 套接字路径，启动时删除同名旧文件
+    int max_clients = 8;                        ///< 最大同时连接数
+    size_t max_request_bytes = 64 * 1024;       ///< 单个请求的最大长度，超出时断开连接
+    size_t max_pending_events = 1024;           ///< 待推送事件的上限，超出时丢弃最旧的
+};
+
+/**
+ * @brief 控制服务器统计
+ */
+struct ControlServerStats {
+    uint64_t connections = 0;   ///< 累计接受的连接数
+    uint64_t requests = 0;      ///< 累计处理的请求数
+    uint64_t errors = 0;        ///< 返回错误的请求数
+    uint64_t events_sent = 0;   ///< 推送给客户端的事件通知数
+};
+
+/**
+ * @brief JSON-RPC控制服务器
+ */
+class ControlServer {
+public:
+    /// JSON-RPC错误码
+    static constexpr int kParseError = -32700;
+    static constexpr int kInvalidRequest = -32600;
+    static constexpr int kMethodNotFound = -32601;
+    static constexpr int kInvalidParams = -32602;
+    static constexpr int kNotFound = -32001;        ///< 场景或源不存在
+    static constexpr int kRejected = -32002;        ///< 命令被引擎拒绝
+    static constexpr int kBusy = -32003;            ///< 命令队列已满
+    static constexpr int kDumpFailed = -32004;      ///< 飞行记录器转储失败
+    static constexpr int kScreenshotFailed = -32005; ///< 截图失败或超时
+
+    /**
+     * @brief 构造函数
+     * @param[in] engine 被控制的引擎
+     */
+    explicit ControlServer(Engine& engine);
+    ~ControlServer();
+
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    /**
+     * @brief 创建套接字并启动服务线程
+     * @param[in] settings 服务器配置
+     * @return true表示启动成功
+     */
+    bool start(const ControlServerSettings& settings = ControlServerSettings{});
+
+    /**
+     * @brief 关闭所有连接并停止服务线程
+     */
+    void stop();
+
+    /**
+     * @brief 是否正在运行
+     */
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 处理一个JSON-RPC请求
+     * @param[in] request 请求文本（单个JSON对象）
+     * @return 响应文本，通知类请求（无id）返回空字符串
+     *
+     * @note 服务线程对每个请求调用此函数，也可直接用于进程内控制
+     */
+    std::string handleRequest(const std::string& request) { return handleRequest(request, nullptr); }
+
+    /**
+     * @brief 获取统计信息
+     * @return 统计快照
+     */
+    ControlServerStats getStats() const;
+
+private:
+    struct Client;
+
+    void serverLoop();
+    void forwardEvents(std::vector<Client>& clients);
+    std::string handleRequest(const std::string& request, Client* client);
+    bool dispatch(const std::string& method, const JsonValue& params, Client* client,
+                  JsonValue& result, int& code, std::string& message);
+    bool runCommand(EngineCommand& command, int& code, std::string& message);
+    JsonValue collectStats() const;
+
+    Engine& engine_;
+    ControlServerSettings settings_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    int listenFd_ = -1;
+    int wakeFds_[2] = {-1, -1};     ///< 停止或有新事件时唤醒poll的管道
+
+    uint64_t subscription_ = 0;     ///< 事件总线订阅ID
+    std::mutex eventsMutex_;        ///< 保护待推送事件（分发线程与服务线程之间）
+    std::deque<Event> pendingEvents_;
+
+    std::atomic<uint64_t> connections_{0};
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> eventsSent_{0};
+};
+
+} // namespace SimpleOBS
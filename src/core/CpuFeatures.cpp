@@ -0,0 +1,63 @@
+/**
+ * @file CpuFeatures.cpp
+ * @brief CPU指令集检测实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "CpuFeatures.h"
+
+#if defined(SIMPLEOBS_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+struct CpuFeatureSet {
+    bool sse2 = false;
+    bool sse41 = false;
+    bool avx2 = false;
+
+    CpuFeatureSet() {
+#if defined(SIMPLEOBS_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        sse2 = __builtin_cpu_supports("sse2");
+        sse41 = __builtin_cpu_supports("sse4.1");
+        avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(SIMPLEOBS_X86) && defined(_MSC_VER)
+        int info[4] = {};
+        __cpuid(info, 1);
+        sse2 = (info[3] & (1 << 26)) != 0;
+        sse41 = (info[2] & (1 << 19)) != 0;
+        bool fma = (info[2] & (1 << 12)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        __cpuidex(info, 7, 0);
+        bool avx2Bit = (info[1] & (1 << 5)) != 0;
+        avx2 = fma && avx2Bit && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#endif
+    }
+};
+
+const CpuFeatureSet& features() {
+    static const CpuFeatureSet set;
+    return set;
+}
+
+} // namespace
+
+bool cpuHasSse2() {
+    return features().sse2;
+}
+
+bool cpuHasSse41() {
+    return features().sse41;
+}
+
+bool cpuHasAvx2() {
+    return features().avx2;
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,52 @@
+/**
+ * @file CpuFeatures.h
+ * @brief CPU指令集检测与SIMD编译辅助
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件提供运行时CPU特性检测，以及为单个函数启用AVX2等指令集的编译宏。
+ * 各SIMD内核按"AVX2 -> SSE2 -> 标量"的顺序在运行时选择实现。
+ *
+ * @note
+ * - 检测结果在首次调用时缓存
+ * - 非x86平台上所有检测均返回false，调用方回退到标量实现
+ */
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMPLEOBS_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(SIMPLEOBS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMPLEOBS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SIMPLEOBS_TARGET_SSE41 __attribute__((target("sse4.1")))
+#else
+#define SIMPLEOBS_TARGET_AVX2
+#define SIMPLEOBS_TARGET_SSE41
+#endif
+
+namespace SimpleOBS {
+
+/**
+ * @brief 检查CPU是否支持SSE2
+ * @return true表示支持
+ */
+bool cpuHasSse2();
+
+/**
+ * @brief 检查CPU是否支持SSE4.1
+ * @return true表示支持
+ */
+bool cpuHasSse41();
+
+/**
+ * @brief 检查CPU是否支持AVX2和FMA
+ * @return true表示支持
+ */
+bool cpuHasAvx2();
+
+} // namespace SimpleOBS
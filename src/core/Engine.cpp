@@ -18,7 +18,22 @@
 
 #include "SimpleOBS.h"
 #include "SceneImpl.h"
+#include "AudioProcessing.h"
+#include "AudioMonitor.h"
+#include "EventBus.h"
+#include "FlightRecorder.h"
+#include "FramePool.h"
+#include "MemoryBudget.h"
+#include "ModuleRegistry.h"
+#include "MpscQueue.h"
+#include "Numa.h"
+#include "Screenshot.h"
+#include "SourceActivation.h"
+#include "Watchdog.h"
 #include "Logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
 #include <unordered_map>
 #include <mutex>
 #include <thread>
@@ -38,7 +53,11 @@ public:
      * @brief 构造函数
      * @details 初始化引擎内部状态
      */
-    Impl() : streaming_(false) {}
+    Impl() : streaming_(false), watchdog_(recorder_, &events_), commands_(kCommandQueueSize) {
+        framePoolMemory_ = memory_.registerSubsystem("frame_pool", MemoryPriority::Required);
+        audioStage_ = watchdog_.addStage("audio", kMinStallDeadline);
+        videoStage_ = watchdog_.addStage("video", kMinStallDeadline);
+    }
 
     /**
      * @brief 析构函数
@@ -56,13 +75,30 @@ public:
      * @details
      * 1. 初始化OpenGL context
      * 2. 初始化音频系统
-     * 3. 初始化网络模块
+     * 3. 登记SIMPLEOBS_PLUGIN_PATH（冒号分隔）中的插件，只读清单不加载
      */
     bool initialize() {
         LOG_INFO_DETAIL("SimpleOBS Engine initializing...");
         // Initialize OpenGL context
         // Initialize audio system
-        // Initialize network modules
+        if (const char* pluginPath = std::getenv("SIMPLEOBS_PLUGIN_PATH")) {
+            std::stringstream paths(pluginPath);
+            std::string directory;
+            while (std::getline(paths, directory, ':')) {
+                if (!directory.empty()) {
+                    modules_.scanPluginDirectory(directory);
+                }
+            }
+        }
+        events_.start();
+        if (!recorderSubscription_) {
+            // 事件在分发线程上写入飞行记录器，不占用发布方时间
+            recorderSubscription_ = events_.subscribe([this](const Event& event) {
+                recorder_.record(RecordKind::Event, event.subject, event.value, static_cast<int64_t>(event.type));
+            });
+        }
+        watchdog_.start();
+        screenshots_.start();
         LOG_INFO_DETAIL("SimpleOBS Engine initialized successfully");
         return true;
     }
@@ -73,6 +109,10 @@ public:
      */
     void shutdown() {
         stopStreaming();
+        stopAudioMonitor();
+        screenshots_.stop();
+        watchdog_.stop();
+        events_.stop();
         LOG_INFO_DETAIL("SimpleOBS Engine shutting down...");
     }
 
@@ -89,7 +129,16 @@ public:
      */
     ScenePtr createScene(const std::string& name) {
         auto scene = std::make_shared<SceneImpl>(name);
-        scenes_[name] = scene;
+        scene->setAudioSettings(getAudioSettings());
+        scene->setFrameInterval(FrameTime(1000000 / getVideoSettings().fps));
+        scene->setSourceActivation(&activation_);
+        {
+            // 写时复制：渲染线程和控制线程持有的旧表不受影响
+            std::lock_guard<std::mutex> lock(scenesMutex_);
+            auto scenes = std::make_shared<SceneMap>(*loadScenes());
+            (*scenes)[name] = scene;
+            std::atomic_store(&scenes_, std::shared_ptr<const SceneMap>(std::move(scenes)));
+        }
         LOG_DEBUG_DETAIL("Created scene: {}", name);
         return scene;
     }
@@ -101,18 +150,12 @@ public:
      * @return 源的智能指针，失败时返回nullptr
      *
      * @details
-     * 1. 验证参数的有效性
-     * 2. 根据ID创建对应类型的源
+     * 1. 从模块注册表按ID查找工厂，所属模块未加载时先加载
+     * 2. 创建源实例
      * 3. 初始化源组件
-     * 4. 注册到源管理器中
      */
     SourcePtr createSource(const std::string& id, const std::string& name) {
-        // Should create different types of sources based on id
-        // Currently returns nullptr, will implement specific source types later
-        (void)id;  // Avoid unused parameter warning
-        (void)name;
-        LOG_WARN_DETAIL("Source creation not implemented yet. ID: {}, Name: {}", id, name);
-        return nullptr;
+        return initialized(modules_.createSource(id, name), "Source", id, name);
     }
 
     /**
@@ -122,11 +165,7 @@ public:
      * @return 编码器的智能指针，失败时返回nullptr
      */
     EncoderPtr createEncoder(const std::string& id, const std::string& name) {
-        // Should create different types of encoders based on id
-        (void)id;  // Avoid unused parameter warning
-        (void)name;
-        LOG_WARN_DETAIL("Encoder creation not implemented yet. ID: {}, Name: {}", id, name);
-        return nullptr;
+        return initialized(modules_.createEncoder(id, name), "Encoder", id, name);
     }
 
     /**
@@ -136,11 +175,7 @@ public:
      * @return 输出的智能指针，失败时返回nullptr
      */
     OutputPtr createOutput(const std::string& id, const std::string& name) {
-        // Should create different types of outputs based on id
-        (void)id;  // Avoid unused parameter warning
-        (void)name;
-        LOG_WARN_DETAIL("Output creation not implemented yet. ID: {}, Name: {}", id, name);
-        return nullptr;
+        return initialized(modules_.createOutput(id, name), "Output", id, name);
     }
 
     /**
@@ -150,11 +185,15 @@ public:
      * @return 滤镜的智能指针，失败时返回nullptr
      */
     FilterPtr createFilter(const std::string& id, const std::string& name) {
-        // Should create different types of filters based on id
-        (void)id;  // Avoid unused parameter warning
-        (void)name;
-        LOG_WARN_DETAIL("Filter creation not implemented yet. ID: {}, Name: {}", id, name);
-        return nullptr;
+        return initialized(modules_.createFilter(id, name), "Filter", id, name);
+    }
+
+    /**
+     * @brief 获取模块注册表
+     * @return 模块注册表
+     */
+    ModuleRegistry& getModuleRegistry() {
+        return modules_;
     }
 
     /**
@@ -173,10 +212,22 @@ public:
             return false;
         }
 
+        if (!prepareCanvasPool()) {
+            return false;
+        }
+        // 帧率只能在停播时修改，开播时同步给所有场景的帧率转换
+        const FrameTime frameInterval(1000000 / getVideoSettings().fps);
+        for (auto& entry : *loadScenes()) {
+            entry.second->setFrameInterval(frameInterval);
+        }
+
+        resetAudioLatency();
+        armWatchdog();
         streaming_ = true;
         streaming_thread_ = std::thread([this]() {
             streamingLoop();
         });
+        events_.publish(EventType::StreamingStarted);
 
         LOG_INFO_DETAIL("Starting streaming...");
         return true;
@@ -191,11 +242,19 @@ public:
             return;
         }
 
+        watchdog_.setActive(audioStage_, false);
+        watchdog_.setActive(videoStage_, false);
         streaming_ = false;
         if (streaming_thread_.joinable()) {
             streaming_thread_.join();
         }
 
+        // 渲染线程退出前可能还有已入队的命令
+        drainCommands();
+        // 下次推流可能重新分配帧池，先收回截图占用的帧
+        screenshots_.cancelPending("streaming stopped");
+        events_.publish(EventType::StreamingStopped);
+
         LOG_INFO_DETAIL("Stopping streaming...");
     }
 
@@ -207,28 +266,742 @@ public:
         return streaming_;
     }
 
+    /**
+     * @brief 设置引擎音频配置
+     * @param[in] settings 新的音频配置
+     * @return true表示设置成功，false表示参数无效或正在流媒体
+     *
+     * @details 校验通过后同步到所有场景的混音器
+     */
+    bool setAudioSettings(const AudioSettings& settings) {
+        if (!validateAudioSettings(settings)) {
+            LOG_ERROR_DETAIL("Invalid audio settings: rate={}, channels={}, block={} (allowed block size {}-{})",
+                             settings.sample_rate, settings.channels, settings.block_size,
+                             kMinAudioBlockSize, kMaxAudioBlockSize);
+            return false;
+        }
+        if (streaming_) {
+            LOG_WARN_DETAIL("Cannot change audio settings while streaming");
+            return false;
+        }
+
+        std::atomic_store(&audioSettings_, std::make_shared<const AudioSettings>(settings));
+        for (auto& entry : *loadScenes()) {
+            entry.second->setAudioSettings(settings);
+        }
+
+        // 监听链路的缓冲区按引擎格式分配，需要重建
+        if (std::atomic_load(&monitor_)) {
+            startAudioMonitor(monitorSettings_);
+        }
+
+        LOG_INFO_DETAIL("Audio settings changed: rate={}, channels={}, block={} ({} us)",
+                        settings.sample_rate, settings.channels, settings.block_size,
+                        audioBlockDuration(settings).count());
+        return true;
+    }
+
+    /**
+     * @brief 获取引擎音频配置
+     * @return 当前音频配置
+     */
+    AudioSettings getAudioSettings() const {
+        return *std::atomic_load(&audioSettings_);
+    }
+
+    /**
+     * @brief 设置引擎视频配置
+     * @param[in] settings 新的视频配置
+     * @return true表示设置成功，false表示参数无效或正在流媒体
+     */
+    bool setVideoSettings(const VideoSettings& settings) {
+        int linesize[4];
+        size_t offsets[4];
+        if (settings.width > kMaxCanvasSize || settings.height > kMaxCanvasSize ||
+            settings.fps <= 0 || settings.fps > kMaxFps || settings.frame_pool_size < 2 ||
+            settings.numa_node >= numaNodeCount() ||
+            videoFrameLayout(settings.format, settings.width, settings.height, linesize, offsets) == 0) {
+            LOG_ERROR("Invalid video settings: {}x{} @ {} fps, format {}, pool {}, NUMA node {}",
+                      settings.width, settings.height, settings.fps, settings.format, settings.frame_pool_size,
+                      settings.numa_node);
+            return false;
+        }
+        if (streaming_) {
+            LOG_WARN_DETAIL("Cannot change video settings while streaming");
+            return false;
+        }
+
+        std::atomic_store(&videoSettings_, std::make_shared<const VideoSettings>(settings));
+        LOG_INFO("Video settings changed: {}x{} @ {} fps, format {}, pool {} frames",
+                 settings.width, settings.height, settings.fps, settings.format, settings.frame_pool_size);
+        return true;
+    }
+
+    /**
+     * @brief 获取引擎视频配置
+     * @return 当前视频配置
+     */
+    VideoSettings getVideoSettings() const {
+        return *std::atomic_load(&videoSettings_);
+    }
+
+    /**
+     * @brief 获取画布帧池
+     * @return 帧池
+     */
+    NumaFramePool& getFramePool() {
+        return canvasPool_;
+    }
+
+    /**
+     * @brief 获取内存预算
+     * @return 内存预算
+     */
+    MemoryBudget& getMemoryBudget() {
+        return memory_;
+    }
+
+    /**
+     * @brief 获取内存统计
+     * @return 内存统计
+     */
+    MemoryStats getMemoryStats() const {
+        return memory_.getStats();
+    }
+
+    /**
+     * @brief 获取音频链路延迟统计
+     * @return 端到端延迟统计
+     */
+    AudioLatencyStats getAudioLatencyStats() const {
+        AudioLatencyStats stats;
+        stats.block_duration = audioBlockDuration(getAudioSettings());
+        stats.blocks = latencyBlocks_.load(std::memory_order_relaxed);
+        if (stats.blocks == 0) {
+            return stats;
+        }
+        stats.last = FrameTime(latencyLast_.load(std::memory_order_relaxed));
+        stats.min = FrameTime(latencyMin_.load(std::memory_order_relaxed));
+        stats.max = FrameTime(latencyMax_.load(std::memory_order_relaxed));
+        stats.average = FrameTime(latencySum_.load(std::memory_order_relaxed) /
+                                  static_cast<int64_t>(stats.blocks));
+        return stats;
+    }
+
+    /**
+     * @brief 设置当前输出场景
+     * @param[in] name 场景名称
+     * @return true表示切换成功，false表示场景不存在
+     */
+    bool setCurrentScene(const std::string& name) {
+        auto scene = findScene(name);
+        if (!scene) {
+            LOG_WARN_DETAIL("Scene not found: {}", name);
+            return false;
+        }
+        switchScene(scene);
+        events_.publish(EventType::SceneSwitched, name.c_str());
+        LOG_INFO_DETAIL("Current scene switched to: {}", name);
+        return true;
+    }
+
+    /**
+     * @brief 切换当前输出场景并转移源的激活计数
+     * @param[in] scene 新的当前场景
+     *
+     * @details 先显示新场景再隐藏旧场景，两个场景共有的源不会被停止再启动
+     */
+    void switchScene(const std::shared_ptr<SceneImpl>& scene) {
+        scene->show();
+        std::shared_ptr<SceneImpl> previous = std::atomic_exchange(&currentScene_, scene);
+        if (previous) {
+            previous->hide();
+        }
+    }
+
+    /**
+     * @brief 获取源激活计数
+     * @return 源激活计数
+     */
+    SourceActivation& getSourceActivation() {
+        return activation_;
+    }
+
+    /**
+     * @brief 获取当前输出场景
+     * @return 当前场景，未设置时返回nullptr
+     */
+    ScenePtr getCurrentScene() const {
+        return std::atomic_load(&currentScene_);
+    }
+
+    /**
+     * @brief 获取所有场景名称
+     * @return 场景名称列表
+     */
+    std::vector<std::string> getSceneNames() const {
+        auto scenes = loadScenes();
+        std::vector<std::string> names;
+        names.reserve(scenes->size());
+        for (const auto& entry : *scenes) {
+            names.push_back(entry.first);
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    /**
+     * @brief 提交控制命令
+     * @param[in] command 命令
+     * @return true表示已入队，false表示队列已满
+     *
+     * @details
+     * 推流时只入队，由渲染线程在下一次渲染前执行；
+     * 未推流时调用线程自己清空队列。两者通过draining_标志互斥，
+     * 渲染线程抢不到标志时直接跳过本次执行，不会等待。
+     */
+    bool postCommand(EngineCommand* command) {
+        if (!command) {
+            return false;
+        }
+        command->status.store(EngineCommand::Status::Pending, std::memory_order_relaxed);
+        if (command->type == EngineCommand::Type::SwitchScene) {
+            // 新场景的源在提交线程中启动，渲染线程执行时只交换当前场景
+            if (auto scene = findScene(command->scene)) {
+                scene->show();
+                command->scene_ptr = scene;
+            }
+        }
+        if (!commands_.push(command)) {
+            LOG_WARN_DETAIL("Engine command queue full, command rejected");
+            finishCommand(command);
+            return false;
+        }
+
+        // 未推流时没有渲染线程，由提交方执行；另一提交方正在执行时等它把队列清空
+        while (!streaming_ && !commands_.empty()) {
+            if (!drainCommands()) {
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 命令执行完成后的收尾（提交线程）
+     * @param[in,out] command 命令
+     *
+     * @details 切换场景成功时撤销被换下场景的显示，失败时撤销提交时对新场景的显示
+     */
+    void finishCommand(EngineCommand* command) {
+        if (command && command->type == EngineCommand::Type::SwitchScene && command->scene_ptr) {
+            std::static_pointer_cast<SceneImpl>(command->scene_ptr)->hide();
+            command->scene_ptr.reset();
+        }
+    }
+
+    /**
+     * @brief 获取事件总线
+     * @return 事件总线
+     */
+    EventBus& getEventBus() {
+        return events_;
+    }
+
+    /**
+     * @brief 获取飞行记录器
+     * @return 飞行记录器
+     */
+    FlightRecorder& getFlightRecorder() {
+        return recorder_;
+    }
+
+    /**
+     * @brief 获取看门狗
+     * @return 看门狗
+     */
+    Watchdog& getWatchdog() {
+        return watchdog_;
+    }
+
+    /**
+     * @brief 提交截图请求
+     * @param[in] request 截图请求
+     * @param[in] callback 完成回调
+     * @return true表示已受理
+     *
+     * @details 场景和源在调用线程中解析，渲染线程只拿到解析好的指针
+     */
+    bool requestScreenshot(const ScreenshotRequest& request, ScreenshotCallback callback) {
+        if (!streaming_) {
+            LOG_WARN("Screenshot rejected: not streaming");
+            return false;
+        }
+
+        auto scenes = loadScenes();
+        std::shared_ptr<SceneImpl> scene;
+        if (!request.scene.empty()) {
+            auto it = scenes->find(request.scene);
+            if (it == scenes->end()) {
+                LOG_WARN("Screenshot rejected: scene not found: {}", request.scene);
+                return false;
+            }
+            scene = it->second;
+        }
+
+        SourcePtr source;
+        if (!request.source.empty()) {
+            auto search = scene ? scene : std::atomic_load(&currentScene_);
+            if (search) {
+                source = search->findSource(request.source);
+            }
+            for (auto it = scenes->begin(); !source && request.scene.empty() && it != scenes->end(); ++it) {
+                source = it->second->findSource(request.source);
+            }
+            if (!source) {
+                LOG_WARN("Screenshot rejected: source not found: {}", request.source);
+                return false;
+            }
+        }
+
+        return screenshots_.submit(request, std::move(scene), std::move(source), std::move(callback));
+    }
+
+    /**
+     * @brief 获取截图服务
+     * @return 截图服务
+     */
+    ScreenshotService& getScreenshots() {
+        return screenshots_;
+    }
+
+    /**
+     * @brief 启动音频监听
+     * @param[in] settings 监听配置
+     * @return true表示启动成功
+     */
+    bool startAudioMonitor(const AudioMonitorSettings& settings) {
+        if (!validateMonitorSettings(settings)) {
+            LOG_ERROR("Invalid audio monitor settings: rate={}, period={}, latency={} ms, clock scale={}",
+                      settings.sample_rate, settings.period_frames, settings.target_latency_ms,
+                      settings.clock_scale);
+            return false;
+        }
+        stopAudioMonitor();
+
+        auto sink = createMonitorSink(settings);
+        if (!sink) {
+            return false;
+        }
+
+        auto monitor = std::make_shared<AudioMonitor>(getAudioSettings(), settings, std::move(sink));
+        if (!monitor->start()) {
+            LOG_ERROR_DETAIL("Failed to start audio monitor: {}", settings.sink);
+            return false;
+        }
+
+        monitorSettings_ = settings;
+        std::atomic_store(&monitor_, monitor);
+        return true;
+    }
+
+    /**
+     * @brief 停止音频监听
+     */
+    void stopAudioMonitor() {
+        auto monitor = std::atomic_exchange(&monitor_, std::shared_ptr<AudioMonitor>());
+        if (monitor) {
+            monitor->stop();
+        }
+    }
+
+    /**
+     * @brief 获取音频监听统计
+     * @return 监听统计，未启动时running为false
+     */
+    AudioMonitorStats getAudioMonitorStats() const {
+        auto monitor = std::atomic_load(&monitor_);
+        return monitor ? monitor->getStats() : AudioMonitorStats{};
+    }
+
 private:
+    using SceneMap = std::unordered_map<std::string, std::shared_ptr<SceneImpl>>;
+
+    /**
+     * @brief 获取场景表快照
+     * @return 当前场景表，任意线程可读，不受之后的修改影响
+     */
+    std::shared_ptr<const SceneMap> loadScenes() const {
+        return std::atomic_load(&scenes_);
+    }
+
+    /**
+     * @brief 按名称查找场景
+     * @param[in] name 场景名称
+     * @return 场景，不存在时返回nullptr
+     */
+    std::shared_ptr<SceneImpl> findScene(const std::string& name) const {
+        auto scenes = loadScenes();
+        auto it = scenes->find(name);
+        return it != scenes->end() ? it->second : nullptr;
+    }
+
     /**
      * @brief 流媒体循环
      * @details 实现流媒体处理逻辑
+     *
+     * 音频按块时长驱动（block_size / sample_rate），视频按固定帧间隔驱动，
+     * 两者共用同一线程，按最近的截止时间休眠。
      */
     void streamingLoop() {
         LOG_DEBUG_DETAIL("Streaming loop started");
+
+        const AudioSettings audio = getAudioSettings();
+        const auto audioInterval = std::chrono::nanoseconds(
+            static_cast<int64_t>(audio.block_size) * 1000000000 / audio.sample_rate);
+        const VideoSettings video = getVideoSettings();
+        const auto videoInterval = std::chrono::nanoseconds(1000000000 / video.fps);
+
+        // 渲染线程与画布帧池在同一节点，合成结果不跨节点互连
+        if (video.numa_node >= 0 && !pinThreadToNode(video.numa_node)) {
+            LOG_WARN("Cannot pin streaming thread to NUMA node {}", video.numa_node);
+        }
+
+        auto nextAudio = std::chrono::steady_clock::now();
+        auto nextVideo = nextAudio;
+
         while (streaming_) {
-            // Main rendering loop
-            // 1. Render scenes
-            // 2. Encode video/audio
-            // 3. Output to targets
+            // 控制命令只在两次渲染之间执行，渲染过程中场景结构不会变化
+            drainCommands();
+
+            auto now = std::chrono::steady_clock::now();
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(16)); // ~60 FPS
+            if (now >= nextAudio) {
+                renderAudioBlock();
+                recordStage(audioStage_, "audio", now, nextAudio);
+                nextAudio += audioInterval;
+                // 落后太多时重新对齐，避免补偿性突发
+                if (now - nextAudio > audioInterval * 8) {
+                    nextAudio = now + audioInterval;
+                }
+            }
+
+            if (now >= nextVideo) {
+                // Main rendering loop
+                // 1. Render scenes
+                // 2. Encode video/audio
+                // 3. Output to targets
+                // 截图的额外渲染须在下一个音频块和下一帧之前完成
+                renderVideoFrame(std::min(nextAudio, nextVideo + videoInterval));
+                recordStage(videoStage_, "video", now, nextVideo);
+                nextVideo += videoInterval;
+                if (now - nextVideo > videoInterval * 4) {
+                    nextVideo = now + videoInterval;
+                }
+            }
+
+            std::this_thread::sleep_until(std::min(nextAudio, nextVideo));
         }
         LOG_DEBUG_DETAIL("Streaming loop ended");
     }
 
-    std::unordered_map<std::string, ScenePtr> scenes_;
+    /**
+     * @brief 按当前音视频节拍设置看门狗截止时间并激活渲染阶段
+     * @details 截止时间取8个节拍与kMinStallDeadline中的较大者，偶发的单帧超时不算停顿
+     */
+    void armWatchdog() {
+        const FrameTime audioBlock = audioBlockDuration(getAudioSettings());
+        const FrameTime videoFrame(1000000 / getVideoSettings().fps);
+        watchdog_.setDeadline(audioStage_, std::max(kMinStallDeadline, audioBlock * 8));
+        watchdog_.setDeadline(videoStage_, std::max(kMinStallDeadline, videoFrame * 8));
+        watchdog_.setActive(audioStage_, true);
+        watchdog_.setActive(videoStage_, true);
+    }
+
+    /**
+     * @brief 记录一个渲染节拍的耗时并心跳
+     * @param[in] stage 看门狗阶段
+     * @param[in] name 阶段名称
+     * @param[in] start 本节拍开始时刻
+     * @param[in] deadline 本节拍的计划时刻
+     */
+    void recordStage(Watchdog::StageId stage, const char* name,
+                     std::chrono::steady_clock::time_point start,
+                     std::chrono::steady_clock::time_point deadline) {
+        auto end = std::chrono::steady_clock::now();
+        recorder_.record(RecordKind::FrameTiming, name,
+                         std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+                         std::chrono::duration_cast<std::chrono::microseconds>(start - deadline).count());
+        watchdog_.heartbeat(stage);
+    }
+
+    /**
+     * @brief 按当前视频配置准备画布帧池
+     * @return true表示帧池可用
+     *
+     * @details 配置未变化时复用已有帧池，避免每次开播都重新映射和预触页
+     */
+    bool prepareCanvasPool() {
+        const VideoSettings video = getVideoSettings();
+        FramePoolSettings pool;
+        pool.width = video.width;
+        pool.height = video.height;
+        pool.format = video.format;
+        pool.frames = video.frame_pool_size;
+        pool.huge_pages = video.huge_pages ? HugePageMode::Auto : HugePageMode::Off;
+        pool.node = video.numa_node;
+        pool.budget = &memory_;
+        pool.budget_subsystem = framePoolMemory_;
+
+        const FramePoolSettings& current = canvasPool_.getSettings();
+        if (canvasPool_.isInitialized() && current.width == pool.width && current.height == pool.height &&
+            current.format == pool.format && current.frames == pool.frames &&
+            current.huge_pages == pool.huge_pages && current.node == pool.node) {
+            return true;
+        }
+        // 新帧池的缓冲区地址可能与旧帧池重合，场景记住的画布内容随之失效
+        SceneImpl::invalidateCanvases();
+        if (!canvasPool_.initialize(pool)) {
+            LOG_ERROR("Failed to allocate canvas frame pool");
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 初始化新创建的组件
+     * @param[in] component 组件，可为nullptr
+     * @param[in] kind 组件类别名称（用于日志）
+     * @param[in] id 类型ID
+     * @param[in] name 组件名称
+     * @return 初始化成功的组件，失败时返回nullptr
+     */
+    template <typename Ptr>
+    Ptr initialized(Ptr component, const char* kind, const std::string& id, const std::string& name) {
+        if (!component) {
+            LOG_WARN("{} type not available: {} (name: {})", kind, id, name);
+            return nullptr;
+        }
+        if (!component->initialize()) {
+            LOG_ERROR("{} failed to initialize: {} (name: {})", kind, id, name);
+            return nullptr;
+        }
+        LOG_DEBUG("Created {}: {} (name: {})", kind, id, name);
+        return component;
+    }
+
+    /**
+     * @brief 执行队列中的全部控制命令
+     * @return false表示其他线程正在执行命令，本次未执行
+     */
+    bool drainCommands() {
+        if (draining_.exchange(true, std::memory_order_acquire)) {
+            return false;
+        }
+        EngineCommand* command = nullptr;
+        while (commands_.pop(command)) {
+            command->status.store(executeCommand(*command), std::memory_order_release);
+        }
+        draining_.store(false, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 执行一条控制命令
+     * @param[in,out] command 命令
+     * @return 执行结果
+     *
+     * @note 被移除的源保存在命令中，由提交方释放，渲染线程不做析构
+     */
+    EngineCommand::Status executeCommand(EngineCommand& command) {
+        auto target = findScene(command.scene);
+        if (!target) {
+            return EngineCommand::Status::NotFound;
+        }
+        SceneImpl& scene = *target;
+
+        switch (command.type) {
+        case EngineCommand::Type::SwitchScene:
+            // 只切换提交时已显示的场景；被换下的场景交还提交方撤销显示，渲染线程不启停源
+            if (command.scene_ptr != target) {
+                return EngineCommand::Status::Rejected;
+            }
+            command.scene_ptr = std::atomic_exchange(&currentScene_, target);
+            events_.publish(EventType::SceneSwitched, command.scene.c_str());
+            LOG_INFO("Current scene switched to: {}", command.scene);
+            return EngineCommand::Status::Ok;
+
+        case EngineCommand::Type::AddSource:
+            if (!command.source_ptr || scene.findSource(command.source_ptr->getName())) {
+                return EngineCommand::Status::Rejected;
+            }
+            scene.addSource(command.source_ptr);
+            return EngineCommand::Status::Ok;
+
+        case EngineCommand::Type::RemoveSource: {
+            SourcePtr source = scene.findSource(command.source);
+            if (!source) {
+                return EngineCommand::Status::NotFound;
+            }
+            command.removed_filters = scene.takeSourceFilters(command.source);
+            scene.removeSource(source);
+            command.source_ptr = std::move(source);
+            return EngineCommand::Status::Ok;
+        }
+
+        case EngineCommand::Type::SetProperty: {
+            IBase* target = &scene;
+            SourcePtr source;
+            FilterPtr filter;
+            if (!command.filter.empty()) {
+                filter = scene.findFilter(command.source, command.filter);
+                if (!filter) {
+                    return EngineCommand::Status::NotFound;
+                }
+                target = filter.get();
+            } else if (!command.source.empty()) {
+                source = scene.findSource(command.source);
+                if (!source) {
+                    return EngineCommand::Status::NotFound;
+                }
+                target = source.get();
+            }
+            return target->setProperty(command.key, command.value)
+                ? EngineCommand::Status::Ok : EngineCommand::Status::Rejected;
+        }
+
+        case EngineCommand::Type::AddFilter:
+            if (!command.filter_ptr || scene.findFilter(command.source, command.filter_ptr->getName())) {
+                return EngineCommand::Status::Rejected;
+            }
+            if (command.source.empty()) {
+                scene.addFilter(command.filter_ptr);
+                return EngineCommand::Status::Ok;
+            }
+            return scene.addSourceFilter(command.source, command.filter_ptr)
+                ? EngineCommand::Status::Ok : EngineCommand::Status::NotFound;
+
+        case EngineCommand::Type::RemoveFilter:
+            command.filter_ptr = scene.removeFilter(command.source, command.filter);
+            return command.filter_ptr ? EngineCommand::Status::Ok : EngineCommand::Status::NotFound;
+        }
+        return EngineCommand::Status::Rejected;
+    }
+
+    /**
+     * @brief 渲染一个音频块并统计延迟
+     */
+    void renderAudioBlock() {
+        auto scene = std::atomic_load(&currentScene_);
+        if (!scene) {
+            return;
+        }
+
+        AudioFrame frame{};
+        if (!scene->render(frame)) {
+            return;
+        }
+
+        // 监听链路只做一次无锁写入，设备再慢也不会阻塞混音器
+        if (auto monitor = std::atomic_load(&monitor_)) {
+            monitor->push(frame);
+        }
+
+        // 混音块交付给下游的时刻减去其中最早采样的采集时刻
+        recordAudioLatency(currentFrameTime() - frame.timestamp);
+    }
+
+    /**
+     * @brief 渲染一帧视频
+     * @param[in] deadline 下一个渲染节拍的计划时刻，截图的额外渲染只在此之前进行
+     */
+    void renderVideoFrame(std::chrono::steady_clock::time_point deadline) {
+        auto scene = std::atomic_load(&currentScene_);
+
+        // 渲染目标取自预分配的帧池，渲染线程不分配内存
+        VideoFrame frame{};
+        if (scene && canvasPool_.acquire(frame)) {
+            const VideoFrame canvas = frame;
+            bool rendered = scene->render(frame);
+            if (rendered && frame.data[0] != canvas.data[0] && screenshots_.hasPending()) {
+                // 直通的帧指向源的缓冲区，只在本节拍内有效；截图要跨线程持有，复制进画布
+                VideoFrame copy = canvas;
+                rendered = copyVideoFrame(copy, frame);
+                frame = copy;
+            }
+            // 有截取当前场景的请求时画布帧直接交给截图工作线程，由其归还帧池
+            if (!rendered || frame.data[0] != canvas.data[0] || !screenshots_.takeCanvas(scene.get(), frame)) {
+                canvasPool_.release(canvas);
+            }
+        }
+        screenshots_.renderPending(scene.get(), deadline);
+    }
+
+    /**
+     * @brief 记录一个音频块的延迟
+     * @param[in] latency 端到端延迟
+     */
+    void recordAudioLatency(FrameTime latency) {
+        int64_t us = std::max<int64_t>(latency.count(), 0);
+        latencyLast_.store(us, std::memory_order_relaxed);
+        latencySum_.fetch_add(us, std::memory_order_relaxed);
+        if (us < latencyMin_.load(std::memory_order_relaxed)) {
+            latencyMin_.store(us, std::memory_order_relaxed);
+        }
+        if (us > latencyMax_.load(std::memory_order_relaxed)) {
+            latencyMax_.store(us, std::memory_order_relaxed);
+        }
+        latencyBlocks_.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 重置延迟统计
+     */
+    void resetAudioLatency() {
+        latencyBlocks_ = 0;
+        latencyLast_ = 0;
+        latencySum_ = 0;
+        latencyMin_ = INT64_MAX;
+        latencyMax_ = 0;
+    }
+
+    static constexpr size_t kCommandQueueSize = 256;
+    static constexpr int kMaxCanvasSize = 16384;
+    static constexpr int kMaxFps = 240;
+    static constexpr FrameTime kMinStallDeadline{500000};
+
+    SourceActivation activation_;                  ///< 源激活计数（须比场景存活更久）
+    std::shared_ptr<const SceneMap> scenes_{std::make_shared<const SceneMap>()};   ///< 场景表（原子访问，写时复制）
+    std::mutex scenesMutex_;                       ///< 串行化场景表的修改，读取不加锁
+    std::shared_ptr<SceneImpl> currentScene_;
     std::atomic<bool> streaming_;
     std::thread streaming_thread_;
-    std::mutex mutex_;
+
+    ModuleRegistry modules_;                       ///< 组件类型注册表
+    MemoryBudget memory_;                          ///< 全局内存预算（须先于帧池构造）
+    MemoryBudget::SubsystemId framePoolMemory_ = -1;   ///< 帧池在预算中的子系统ID
+    FlightRecorder recorder_;                      ///< 飞行记录器（订阅了事件总线，须比总线存活更久）
+    EventBus events_;                              ///< 状态变化事件总线
+    Watchdog watchdog_;                            ///< 管线停顿看门狗
+    uint64_t recorderSubscription_ = 0;            ///< 记录器的事件订阅ID
+    Watchdog::StageId audioStage_ = -1;            ///< 音频混音阶段
+    Watchdog::StageId videoStage_ = -1;            ///< 视频渲染阶段
+    MpscQueue<EngineCommand*> commands_;           ///< 待执行的控制命令
+    std::atomic<bool> draining_{false};            ///< 是否有线程正在执行命令
+
+    // 配置以不可变快照原子替换，渲染线程和统计查询读取时不加锁
+    std::shared_ptr<const AudioSettings> audioSettings_{std::make_shared<const AudioSettings>()};   ///< 引擎音频配置
+    std::shared_ptr<const VideoSettings> videoSettings_{std::make_shared<const VideoSettings>()};   ///< 引擎视频配置
+    NumaFramePool canvasPool_;                     ///< 画布帧池（按NUMA节点划分）
+    ScreenshotService screenshots_{canvasPool_};   ///< 截图服务（须在帧池之后构造、之前析构）
+    std::atomic<uint64_t> latencyBlocks_{0};       ///< 已统计的音频块数
+    std::atomic<int64_t> latencyLast_{0};          ///< 最近延迟（微秒）
+    std::atomic<int64_t> latencySum_{0};           ///< 延迟累计（微秒）
+    std::atomic<int64_t> latencyMin_{INT64_MAX};   ///< 最小延迟（微秒）
+    std::atomic<int64_t> latencyMax_{0};           ///< 最大延迟（微秒）
+
+    std::shared_ptr<AudioMonitor> monitor_;        ///< 音频监听链路（原子访问）
+    AudioMonitorSettings monitorSettings_;         ///< 最近一次的监听配置
 };
 
 // Singleton implementation
@@ -343,4 +1116,194 @@ bool Engine::isStreaming() const {
     return pImpl->isStreaming();
 }
 
+/**
+ * @brief 设置引擎音频配置
+ * @param[in] settings 新的音频配置
+ * @return true表示设置成功，false表示参数无效或正在流媒体
+ */
+bool Engine::setAudioSettings(const AudioSettings& settings) {
+    return pImpl->setAudioSettings(settings);
+}
+
+/**
+ * @brief 获取引擎音频配置
+ * @return 当前音频配置
+ */
+AudioSettings Engine::getAudioSettings() const {
+    return pImpl->getAudioSettings();
+}
+
+/**
+ * @brief 获取音频链路延迟统计
+ * @return 端到端延迟统计
+ */
+AudioLatencyStats Engine::getAudioLatencyStats() const {
+    return pImpl->getAudioLatencyStats();
+}
+
+/**
+ * @brief 设置引擎视频配置
+ * @param[in] settings 新的视频配置
+ * @return true表示设置成功，false表示参数无效或正在流媒体
+ */
+bool Engine::setVideoSettings(const VideoSettings& settings) {
+    return pImpl->setVideoSettings(settings);
+}
+
+/**
+ * @brief 获取引擎视频配置
+ * @return 当前视频配置
+ */
+VideoSettings Engine::getVideoSettings() const {
+    return pImpl->getVideoSettings();
+}
+
+/**
+ * @brief 获取画布帧池
+ * @return 帧池
+ */
+NumaFramePool& Engine::getFramePool() {
+    return pImpl->getFramePool();
+}
+
+/**
+ * @brief 获取引擎内存预算
+ * @return 内存预算
+ */
+MemoryBudget& Engine::getMemoryBudget() {
+    return pImpl->getMemoryBudget();
+}
+
+/**
+ * @brief 获取源激活计数
+ * @return 源激活计数
+ */
+SourceActivation& Engine::getSourceActivation() {
+    return pImpl->getSourceActivation();
+}
+
+/**
+ * @brief 获取内存统计
+ * @return 内存统计
+ */
+MemoryStats Engine::getMemoryStats() const {
+    return pImpl->getMemoryStats();
+}
+
+/**
+ * @brief 设置当前输出场景
+ * @param[in] name 场景名称
+ * @return true表示切换成功，false表示场景不存在
+ */
+bool Engine::setCurrentScene(const std::string& name) {
+    return pImpl->setCurrentScene(name);
+}
+
+/**
+ * @brief 获取当前输出场景
+ * @return 当前场景，未设置时返回nullptr
+ */
+ScenePtr Engine::getCurrentScene() const {
+    return pImpl->getCurrentScene();
+}
+
+/**
+ * @brief 获取所有场景名称
+ * @return 场景名称列表
+ */
+std::vector<std::string> Engine::getSceneNames() const {
+    return pImpl->getSceneNames();
+}
+
+/**
+ * @brief 提交控制命令
+ * @param[in] command 命令，执行完成前必须保持有效
+ * @return true表示已入队，false表示命令队列已满
+ */
+bool Engine::postCommand(EngineCommand* command) {
+    return pImpl->postCommand(command);
+}
+
+/**
+ * @brief 命令执行完成后的收尾
+ * @param[in,out] command status已离开Pending的命令
+ */
+void Engine::finishCommand(EngineCommand* command) {
+    pImpl->finishCommand(command);
+}
+
+/**
+ * @brief 获取组件类型注册表
+ * @return 模块注册表
+ */
+ModuleRegistry& Engine::getModuleRegistry() {
+    return pImpl->getModuleRegistry();
+}
+
+/**
+ * @brief 获取引擎事件总线
+ * @return 事件总线
+ */
+EventBus& Engine::getEventBus() {
+    return pImpl->getEventBus();
+}
+
+/**
+ * @brief 获取飞行记录器
+ * @return 飞行记录器
+ */
+FlightRecorder& Engine::getFlightRecorder() {
+    return pImpl->getFlightRecorder();
+}
+
+/**
+ * @brief 获取管线看门狗
+ * @return 看门狗
+ */
+Watchdog& Engine::getWatchdog() {
+    return pImpl->getWatchdog();
+}
+
+/**
+ * @brief 异步截取场景或源的画面
+ * @param[in] request 截图请求
+ * @param[in] callback 完成回调
+ * @return true表示已受理
+ */
+bool Engine::requestScreenshot(const ScreenshotRequest& request, ScreenshotCallback callback) {
+    return pImpl->requestScreenshot(request, std::move(callback));
+}
+
+/**
+ * @brief 获取截图服务
+ * @return 截图服务
+ */
+ScreenshotService& Engine::getScreenshots() {
+    return pImpl->getScreenshots();
+}
+
+/**
+ * @brief 启动音频监听
+ * @param[in] settings 监听配置
+ * @return true表示启动成功
+ */
+bool Engine::startAudioMonitor(const AudioMonitorSettings& settings) {
+    return pImpl->startAudioMonitor(settings);
+}
+
+/**
+ * @brief 停止音频监听
+ */
+void Engine::stopAudioMonitor() {
+    pImpl->stopAudioMonitor();
+}
+
+/**
+ * @brief 获取音频监听统计
+ * @return 监听统计
+ */
+AudioMonitorStats Engine::getAudioMonitorStats() const {
+    return pImpl->getAudioMonitorStats();
+}
+
 } // namespace SimpleOBS
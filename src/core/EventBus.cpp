@@ -0,0 +1,241 @@
+/**
+ * @file EventBus.cpp
+ * @brief 无锁引擎事件总线实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "EventBus.h"
+#include "AudioProcessing.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace SimpleOBS {
+
+namespace {
+
+std::atomic<uint64_t> g_nextBusId{1};
+
+/**
+ * @brief 线程本地的发布队列登记
+ * @details 线程退出时释放占用的队列，供之后的新线程复用
+ */
+struct ThreadProducers {
+    struct Entry {
+        uint64_t busId;
+        void* producer;
+        std::atomic<bool>* owned;
+    };
+
+    ~ThreadProducers() {
+        for (auto& entry : entries) {
+            entry.owned->store(false, std::memory_order_release);
+        }
+    }
+
+    std::vector<Entry> entries;
+};
+
+thread_local ThreadProducers t_producers;
+
+} // anonymous namespace
+
+const char* eventTypeName(EventType type) {
+    switch (type) {
+    case EventType::StreamingStarted: return "streaming.started";
+    case EventType::StreamingStopped: return "streaming.stopped";
+    case EventType::SceneSwitched: return "scene.switched";
+    case EventType::SourceAdded: return "source.added";
+    case EventType::SourceRemoved: return "source.removed";
+    case EventType::SourceStalled: return "source.stalled";
+    case EventType::SourceResumed: return "source.resumed";
+    case EventType::OutputDropped: return "output.dropped";
+    case EventType::PipelineStalled: return "pipeline.stalled";
+    case EventType::SourceFrozen: return "source.frozen";
+    case EventType::SourceBlack: return "source.black";
+    case EventType::SourceSilent: return "source.silent";
+    default: return "unknown";
+    }
+}
+
+void Event::setSubject(const char* name) {
+    if (!name) {
+        subject[0] = '\0';
+        return;
+    }
+    size_t length = std::min(std::strlen(name), kSubjectSize - 1);
+    std::memcpy(subject, name, length);
+    subject[length] = '\0';
+}
+
+EventBus::EventBus(size_t queueSize, std::chrono::milliseconds dispatchInterval)
+    : queueSize_(queueSize), dispatchInterval_(dispatchInterval),
+      busId_(g_nextBusId.fetch_add(1, std::memory_order_relaxed)) {}
+
+EventBus::~EventBus() {
+    stop();
+    Producer* producer = producers_.load(std::memory_order_acquire);
+    while (producer) {
+        Producer* next = producer->next;
+        delete producer;
+        producer = next;
+    }
+}
+
+void EventBus::start() {
+    std::lock_guard<std::mutex> lock(threadMutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&EventBus::dispatchLoop, this);
+}
+
+void EventBus::stop() {
+    {
+        std::lock_guard<std::mutex> lock(threadMutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    threadCv_.notify_one();
+    thread_.join();
+    dispatchPending();
+}
+
+bool EventBus::publish(EventType type, const char* subject, int64_t value) {
+    Event event;
+    event.type = type;
+    event.value = value;
+    event.setSubject(subject);
+    return publish(event);
+}
+
+bool EventBus::publish(const Event& event) {
+    Producer* producer = acquireProducer();
+
+    Event copy = event;
+    copy.thread = producer->index;
+    if (copy.timestamp == 0) {
+        copy.timestamp = currentFrameTime().count();
+    }
+    if (!producer->ring.tryPush(copy)) {
+        producer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    published_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+EventBus::Producer* EventBus::acquireProducer() {
+    for (const auto& entry : t_producers.entries) {
+        if (entry.busId == busId_) {
+            return static_cast<Producer*>(entry.producer);
+        }
+    }
+
+    // 先尝试复用已退出线程留下的队列，其中未分发的事件照常分发
+    Producer* producer = nullptr;
+    for (Producer* p = producers_.load(std::memory_order_acquire); p; p = p->next) {
+        bool expected = false;
+        if (p->owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            producer = p;
+            break;
+        }
+    }
+
+    if (!producer) {
+        producer = new Producer(queueSize_);
+        producer->index = producerCount_.fetch_add(1, std::memory_order_relaxed);
+        Producer* head = producers_.load(std::memory_order_relaxed);
+        do {
+            producer->next = head;
+        } while (!producers_.compare_exchange_weak(head, producer, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+    }
+
+    t_producers.entries.push_back({busId_, producer, &producer->owned});
+    return producer;
+}
+
+uint64_t EventBus::subscribe(Callback callback, uint32_t mask) {
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    Subscriber subscriber;
+    subscriber.id = nextSubscriberId_++;
+    subscriber.mask = mask;
+    subscriber.callback = std::move(callback);
+    subscribers_.push_back(std::move(subscriber));
+    return subscribers_.back().id;
+}
+
+void EventBus::unsubscribe(uint64_t id) {
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                      [id](const Subscriber& s) { return s.id == id; }),
+                       subscribers_.end());
+}
+
+size_t EventBus::dispatchPending() {
+    std::lock_guard<std::mutex> dispatchLock(dispatchMutex_);
+
+    batch_.clear();
+    Event event;
+    for (Producer* p = producers_.load(std::memory_order_acquire); p; p = p->next) {
+        while (p->ring.tryPop(event)) {
+            batch_.push_back(event);
+        }
+    }
+    if (batch_.empty()) {
+        return 0;
+    }
+
+    // 各线程的队列内部有序，合并后按发布时间排序
+    std::stable_sort(batch_.begin(), batch_.end(),
+                     [](const Event& a, const Event& b) { return a.timestamp < b.timestamp; });
+
+    {
+        std::lock_guard<std::mutex> lock(subscribersMutex_);
+        for (const auto& e : batch_) {
+            uint32_t bit = eventMask(e.type);
+            for (const auto& subscriber : subscribers_) {
+                if (subscriber.mask & bit) {
+                    subscriber.callback(e);
+                }
+            }
+        }
+    }
+
+    dispatched_.fetch_add(batch_.size(), std::memory_order_relaxed);
+    return batch_.size();
+}
+
+EventBusStats EventBus::getStats() const {
+    EventBusStats stats;
+    stats.published = published_.load(std::memory_order_relaxed);
+    stats.dispatched = dispatched_.load(std::memory_order_relaxed);
+    stats.producers = producerCount_.load(std::memory_order_relaxed);
+    for (Producer* p = producers_.load(std::memory_order_acquire); p; p = p->next) {
+        stats.dropped += p->dropped.load(std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    stats.subscribers = static_cast<uint32_t>(subscribers_.size());
+    return stats;
+}
+
+void EventBus::dispatchLoop() {
+    LOG_DEBUG("Event bus dispatcher started");
+    std::unique_lock<std::mutex> lock(threadMutex_);
+    while (running_) {
+        // 发布方不做唤醒（那需要系统调用），分发线程按固定间隔轮询
+        threadCv_.wait_for(lock, dispatchInterval_, [this] { return !running_; });
+        lock.unlock();
+        dispatchPending();
+        lock.lock();
+    }
+    LOG_DEBUG("Event bus dispatcher stopped");
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,224 @@
+/**
+ * @file EventBus.h
+ * @brief 无锁引擎事件总线
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了引擎的状态变化通知机制。每个发布线程第一次发布时获得一个专属的SPSC队列，
+ * 之后发布只是一次定长拷贝和一次原子写入，不加锁、不分配内存、不做系统调用，
+ * 可以在渲染线程和编码线程中直接调用。
+ * 分发线程定期收集所有队列中的事件，按时间排序后依次交给订阅者。
+ *
+ * @note
+ * - 事件为定长的可平凡拷贝结构，名称超长时截断
+ * - 队列满时丢弃新事件并计数，发布方永不等待
+ * - 订阅回调在分发线程中执行，不应长时间阻塞
+ * - 发布线程退出后其队列被标记为空闲，可被之后的新线程复用
+ * - 总线必须比所有发布线程存活更久（由Engine持有）
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 事件类型
+ */
+enum class EventType : uint16_t {
+    StreamingStarted,   ///< 开始推流
+    StreamingStopped,   ///< 停止推流
+    SceneSwitched,      ///< 当前场景切换（subject为新场景）
+    SourceAdded,        ///< 源加入场景（subject为源名称）
+    SourceRemoved,      ///< 源移出场景（subject为源名称）
+    SourceStalled,      ///< 活动源超时未提供数据（value为已停顿的微秒数）
+    SourceResumed,      ///< 停顿的源恢复提供数据
+    OutputDropped,      ///< 输出丢弃数据包（value为累计丢弃数）
+    PipelineStalled,    ///< 管线阶段超时没有心跳（subject为阶段名，value为已停顿的微秒数）
+    SourceFrozen,       ///< 源画面冻结（value为已持续的微秒数，0表示恢复）
+    SourceBlack,        ///< 源持续黑场（value为已持续的微秒数，0表示恢复）
+    SourceSilent,       ///< 源持续静音（value为已持续的微秒数，0表示恢复）
+    Count
+};
+
+/**
+ * @brief 获取事件类型名称
+ * @param[in] type 事件类型
+ * @return 形如"scene.switched"的名称
+ */
+const char* eventTypeName(EventType type);
+
+/**
+ * @brief 订阅掩码：订阅单个事件类型
+ */
+constexpr uint32_t eventMask(EventType type) {
+    return 1u << static_cast<uint32_t>(type);
+}
+
+/// 订阅全部事件类型
+constexpr uint32_t kAllEvents = 0xFFFFFFFFu;
+
+/**
+ * @brief 定长事件
+ */
+struct Event {
+    static constexpr size_t kSubjectSize = 40;
+
+    EventType type = EventType::Count;
+    uint16_t reserved = 0;
+    uint32_t thread = 0;                ///< 发布线程的队列编号
+    int64_t timestamp = 0;              ///< 发布时间（微秒，同FrameTime时钟）
+    int64_t value = 0;                  ///< 事件相关数值
+    char subject[kSubjectSize] = {};    ///< 事件主体名称（场景/源/输出），以0结尾
+
+    /**
+     * @brief 设置主体名称，超长时截断
+     * @param[in] name 名称
+     */
+    void setSubject(const char* name);
+};
+
+static_assert(sizeof(Event) == 64, "Event must stay one cache line");
+
+/**
+ * @brief 事件总线统计
+ */
+struct EventBusStats {
+    uint64_t published = 0;     ///< 成功入队的事件数
+    uint64_t dropped = 0;       ///< 因队列满丢弃的事件数
+    uint64_t dispatched = 0;    ///< 已分发的事件数
+    uint32_t producers = 0;     ///< 已分配的发布队列数
+    uint32_t subscribers = 0;   ///< 当前订阅者数
+};
+
+/**
+ * @brief 无锁事件总线
+ */
+class EventBus {
+public:
+    using Callback = std::function<void(const Event&)>;
+
+    /**
+     * @brief 构造函数
+     * @param[in] queueSize 每个发布线程的队列容量（事件个数）
+     * @param[in] dispatchInterval 分发线程的轮询间隔
+     */
+    explicit EventBus(size_t queueSize = 1024,
+                      std::chrono::milliseconds dispatchInterval = std::chrono::milliseconds(5));
+    ~EventBus();
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    /**
+     * @brief 启动分发线程
+     */
+    void start();
+
+    /**
+     * @brief 分发剩余事件后停止分发线程
+     */
+    void stop();
+
+    /**
+     * @brief 发布事件（任意线程）
+     * @param[in] type 事件类型
+     * @param[in] subject 主体名称，可为nullptr
+     * @param[in] value 事件数值
+     * @return true表示已入队，false表示队列已满被丢弃
+     *
+     * @note 线程第一次发布时需要登记队列（无锁，但可能分配一次内存），之后的发布为wait-free
+     */
+    bool publish(EventType type, const char* subject = nullptr, int64_t value = 0);
+
+    /**
+     * @brief 发布事件（任意线程）
+     * @param[in] event 事件，timestamp为0时填入当前时间
+     * @return true表示已入队，false表示队列已满被丢弃
+     */
+    bool publish(const Event& event);
+
+    /**
+     * @brief 订阅事件
+     * @param[in] callback 回调，在分发线程中执行
+     * @param[in] mask 事件类型掩码，见eventMask()
+     * @return 订阅ID，用于取消订阅
+     */
+    uint64_t subscribe(Callback callback, uint32_t mask = kAllEvents);
+
+    /**
+     * @brief 取消订阅
+     * @param[in] id 订阅ID
+     *
+     * @note 返回后该回调不会再被调用；不能在订阅回调内部调用
+     */
+    void unsubscribe(uint64_t id);
+
+    /**
+     * @brief 立即在调用线程中分发所有已入队的事件
+     * @return 分发的事件数
+     */
+    size_t dispatchPending();
+
+    /**
+     * @brief 获取统计信息
+     * @return 统计快照
+     */
+    EventBusStats getStats() const;
+
+private:
+    /**
+     * @brief 单个发布线程的队列
+     */
+    struct Producer {
+        explicit Producer(size_t capacity) : ring(capacity) {}
+        SpscRing<Event> ring;
+        std::atomic<bool> owned{true};      ///< 是否被某个线程占用
+        std::atomic<uint64_t> dropped{0};
+        uint32_t index = 0;
+        Producer* next = nullptr;           ///< 链表后继，登记后不再修改
+    };
+
+    struct Subscriber {
+        uint64_t id = 0;
+        uint32_t mask = 0;
+        Callback callback;
+    };
+
+    Producer* acquireProducer();
+    void dispatchLoop();
+
+    const size_t queueSize_;
+    const std::chrono::milliseconds dispatchInterval_;
+    const uint64_t busId_;                  ///< 区分不同总线实例的线程本地登记
+
+    std::atomic<Producer*> producers_{nullptr};     ///< 只增不减的发布队列链表
+    std::atomic<uint32_t> producerCount_{0};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dispatched_{0};
+
+    std::mutex dispatchMutex_;              ///< 串行化分发，发布方从不获取
+    std::vector<Event> batch_;              ///< 分发批次，容量复用
+
+    mutable std::mutex subscribersMutex_;   ///< 保护订阅者列表，发布方从不获取
+    std::vector<Subscriber> subscribers_;
+    uint64_t nextSubscriberId_ = 1;
+
+    std::thread thread_;
+    std::mutex threadMutex_;
+    std::condition_variable threadCv_;
+    bool running_ = false;
+};
+
+} // namespace SimpleOBS
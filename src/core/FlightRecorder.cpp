@@ -0,0 +1,123 @@
+/**
+ * @file FlightRecorder.cpp
+ * @brief 渲染管线飞行记录器实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "FlightRecorder.h"
+#include "AudioProcessing.h"
+#include "EventBus.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace SimpleOBS {
+
+namespace {
+
+const char* kindName(RecordKind kind) {
+    switch (kind) {
+    case RecordKind::FrameTiming: return "timing";
+    case RecordKind::QueueDepth: return "queue";
+    case RecordKind::Event: return "event";
+    case RecordKind::Stall: return "STALL";
+    default: return "unknown";
+    }
+}
+
+} // anonymous namespace
+
+void FlightRecord::setLabel(const char* name) {
+    if (!name) {
+        label[0] = '\0';
+        return;
+    }
+    size_t length = std::min(std::strlen(name), kLabelSize - 1);
+    std::memcpy(label, name, length);
+    label[length] = '\0';
+}
+
+FlightRecorder::FlightRecorder(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    slots_.reset(new Slot[size]);
+    mask_ = size - 1;
+}
+
+void FlightRecorder::record(RecordKind kind, const char* label, int64_t value, int64_t extra) {
+    uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[index & mask_];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.record.timestamp = currentFrameTime().count();
+    slot.record.kind = kind;
+    slot.record.value = value;
+    slot.record.extra = extra;
+    slot.record.setLabel(label);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<FlightRecord> FlightRecorder::snapshot(FrameTime window) const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t count = std::min<uint64_t>(head, capacity());
+    const int64_t since = currentFrameTime().count() - window.count();
+
+    std::vector<FlightRecord> records;
+    records.reserve(count);
+    for (uint64_t index = head - count; index < head; ++index) {
+        const Slot& slot = slots_[index & mask_];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) {
+            continue;   // 写入中或已被更新的记录覆盖
+        }
+        FlightRecord copy = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        if (copy.timestamp >= since) {
+            records.push_back(copy);
+        }
+    }
+
+    // 多线程写入时槽位顺序与时间顺序可能略有出入
+    std::stable_sort(records.begin(), records.end(),
+                     [](const FlightRecord& a, const FlightRecord& b) { return a.timestamp < b.timestamp; });
+    return records;
+}
+
+bool FlightRecorder::dump(const std::string& path, FrameTime window, const std::string& reason) const {
+    std::vector<FlightRecord> records = snapshot(window);
+
+    std::ofstream file(path);
+    if (!file) {
+        LOG_ERROR("Cannot write flight recorder dump {}", path);
+        return false;
+    }
+
+    const int64_t end = records.empty() ? currentFrameTime().count() : records.back().timestamp;
+    file << "# SimpleOBS flight recorder\n";
+    file << "# reason: " << reason << "\n";
+    file << "# window: " << window.count() << " us, records: " << records.size()
+         << ", total recorded: " << recorded() << "\n";
+    file << "# columns: offset_us kind label value extra (offset relative to last record)\n";
+    for (const auto& r : records) {
+        file << (r.timestamp - end) << ' ' << kindName(r.kind) << ' '
+             << (r.label[0] ? r.label : "-") << ' ' << r.value << ' ';
+        if (r.kind == RecordKind::Event) {
+            file << eventTypeName(static_cast<EventType>(r.extra));
+        } else {
+            file << r.extra;
+        }
+        file << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,123 @@
+/**
+ * @file FlightRecorder.h
+ * @brief 渲染管线飞行记录器
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了常驻内存的飞行记录器。渲染线程、输出线程和事件分发线程持续写入
+ * 每帧耗时、队列深度和引擎事件，记录保存在预分配的环形缓冲区中，新记录覆盖最旧的记录。
+ * 管线停顿时由看门狗把最近几秒的记录转储到文件，事后据此分析播出中的卡顿。
+ *
+ * @note
+ * - 写入为wait-free：一次fetch_add取槽位，写入定长记录，不加锁、不分配内存
+ * - 每个槽位带序号（seqlock），转储时跳过正在被覆盖的记录
+ * - 记录器必须比所有写入线程存活更久（由Engine持有）
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 记录类型
+ */
+enum class RecordKind : uint16_t {
+    FrameTiming,    ///< 一帧/一块的处理耗时（value为耗时，extra为相对截止时间的延迟，微秒）
+    QueueDepth,     ///< 队列深度（value为当前深度，extra为容量）
+    Event,          ///< 引擎事件（value为事件数值，extra为EventType）
+    Stall           ///< 看门狗检测到的停顿（value为距上次心跳的微秒数）
+};
+
+/**
+ * @brief 定长记录
+ */
+struct FlightRecord {
+    static constexpr size_t kLabelSize = 32;
+
+    int64_t timestamp = 0;              ///< 记录时间（微秒，同FrameTime时钟）
+    RecordKind kind = RecordKind::Event;
+    uint16_t reserved = 0;
+    uint32_t reserved2 = 0;
+    int64_t value = 0;                  ///< 主数值，含义见RecordKind
+    int64_t extra = 0;                  ///< 附加数值，含义见RecordKind
+    char label[kLabelSize] = {};        ///< 阶段/队列/事件主体名称，以0结尾
+
+    /**
+     * @brief 设置名称，超长时截断
+     * @param[in] name 名称
+     */
+    void setLabel(const char* name);
+};
+
+static_assert(sizeof(FlightRecord) == 64, "FlightRecord must stay one cache line");
+
+/**
+ * @brief 飞行记录器
+ */
+class FlightRecorder {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] capacity 记录容量（向上取整为2的幂）
+     */
+    explicit FlightRecorder(size_t capacity = 16384);
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    /**
+     * @brief 写入一条记录（任意线程，wait-free）
+     * @param[in] kind 记录类型
+     * @param[in] label 名称
+     * @param[in] value 主数值
+     * @param[in] extra 附加数值
+     */
+    void record(RecordKind kind, const char* label, int64_t value, int64_t extra = 0);
+
+    /**
+     * @brief 取出最近一段时间的记录
+     * @param[in] window 时间窗口
+     * @return 按时间排序的记录
+     */
+    std::vector<FlightRecord> snapshot(FrameTime window) const;
+
+    /**
+     * @brief 把最近一段时间的记录写入文本文件
+     * @param[in] path 文件路径
+     * @param[in] window 时间窗口
+     * @param[in] reason 转储原因，写在文件头
+     * @return true表示写入成功
+     */
+    bool dump(const std::string& path, FrameTime window, const std::string& reason) const;
+
+    /**
+     * @brief 已写入的记录总数
+     */
+    uint64_t recorded() const { return head_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 记录容量
+     */
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  ///< 2*序号+1表示写入中，2*序号+2表示写入完成
+        FlightRecord record;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    std::atomic<uint64_t> head_{0};
+};
+
+} // namespace SimpleOBS
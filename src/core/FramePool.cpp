@@ -0,0 +1,378 @@
+/**
+ * @file FramePool.cpp
+ * @brief 大页内存支撑的视频帧池实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "FramePool.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include "Numa.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+constexpr size_t kFrameAlignment = 64;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief 系统是否允许对madvise区域使用透明大页
+ * @details enabled为[never]时madvise不生效，此时如实报告为普通页
+ */
+bool transparentHugePagesAvailable() {
+    std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string line;
+    if (!file || !std::getline(file, line)) {
+        return false;
+    }
+    return line.find("[never]") == std::string::npos;
+}
+
+} // anonymous namespace
+
+const char* memoryBackingName(MemoryBacking backing) {
+    switch (backing) {
+    case MemoryBacking::HugeTlb: return "hugetlb";
+    case MemoryBacking::TransparentHugePages: return "thp";
+    default: return "normal";
+    }
+}
+
+FrameArena::~FrameArena() {
+    release();
+}
+
+bool FrameArena::allocate(size_t bytes, HugePageMode mode, int node) {
+    release();
+    if (bytes == 0) {
+        return false;
+    }
+    const size_t size = alignUp(bytes, kHugePageSize);
+
+    if (node < 0 || node >= numaNodeCount()) {
+        return map(size, mode, -1);
+    }
+
+    // 在绑定到目标节点的临时线程上映射和触页：mbind不可用时，首次触页策略也会把页放在该节点
+    bool ok = false;
+    std::thread worker([&] {
+        if (!pinThreadToNode(node)) {
+            LOG_DEBUG("Cannot pin frame arena thread to NUMA node {}", node);
+        }
+        ok = map(size, mode, node);
+    });
+    worker.join();
+    return ok;
+}
+
+bool FrameArena::map(size_t size, HugePageMode mode, int node) {
+#if defined(__linux__)
+    // 1. 显式大页：需要系统预留（vm.nr_hugepages），失败很常见，静默退回
+    if (mode == HugePageMode::Auto) {
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (p != MAP_FAILED) {
+            mapping_ = p;
+            mappingSize_ = size;
+            data_ = static_cast<uint8_t*>(p);
+            size_ = size;
+            backing_ = MemoryBacking::HugeTlb;
+            node_ = numaNodeOfAddress(data_);
+            return true;
+        }
+    }
+
+    // 2. 普通映射，多映射2MB以便起始地址按大页对齐，对齐后才能整页使用透明大页
+    const size_t mappingSize = size + kHugePageSize;
+    void* p = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        LOG_ERROR("Frame arena mmap of {} bytes failed: {}", mappingSize, std::strerror(errno));
+        return false;
+    }
+    mapping_ = p;
+    mappingSize_ = mappingSize;
+    data_ = reinterpret_cast<uint8_t*>(alignUp(reinterpret_cast<uintptr_t>(p), kHugePageSize));
+    size_ = size;
+    backing_ = MemoryBacking::Normal;
+
+    if (mode != HugePageMode::Off && transparentHugePagesAvailable() &&
+        madvise(data_, size_, MADV_HUGEPAGE) == 0) {
+        backing_ = MemoryBacking::TransparentHugePages;
+    }
+    if (node >= 0 && !bindMemoryToNode(data_, size_, node)) {
+        LOG_DEBUG("mbind to NUMA node {} unavailable, relying on first touch", node);
+    }
+
+    // 预触页：缺页（以及透明大页的整理）发生在初始化阶段而不是渲染时
+    for (size_t offset = 0; offset < size_; offset += 4096) {
+        data_[offset] = 0;
+    }
+    node_ = numaNodeOfAddress(data_);
+    return true;
+#else
+    (void)mode;
+    (void)node;
+    void* p = std::malloc(size + kHugePageSize);
+    if (!p) {
+        LOG_ERROR("Frame arena allocation of {} bytes failed", size);
+        return false;
+    }
+    mapping_ = p;
+    mappingSize_ = size + kHugePageSize;
+    data_ = reinterpret_cast<uint8_t*>(alignUp(reinterpret_cast<uintptr_t>(p), kFrameAlignment));
+    size_ = size;
+    backing_ = MemoryBacking::Normal;
+    std::memset(data_, 0, size_);
+    return true;
+#endif
+}
+
+void FrameArena::release() {
+    if (!mapping_) {
+        return;
+    }
+#if defined(__linux__)
+    munmap(mapping_, mappingSize_);
+#else
+    std::free(mapping_);
+#endif
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+    backing_ = MemoryBacking::Normal;
+    node_ = -1;
+}
+
+FramePool::~FramePool() {
+    reset();
+}
+
+bool FramePool::initialize(const FramePoolSettings& settings) {
+    reset();
+
+    frameBytes_ = videoFrameLayout(settings.format, settings.width, settings.height, linesize_, offsets_);
+    if (frameBytes_ == 0 || settings.frames <= 0) {
+        LOG_ERROR("Frame pool settings invalid: {}x{} format {} x{} frames",
+                  settings.width, settings.height, settings.format, settings.frames);
+        return false;
+    }
+    frameStride_ = alignUp(frameBytes_, kFrameAlignment);
+    const size_t arenaBytes = alignUp(frameStride_ * static_cast<size_t>(settings.frames), FrameArena::kHugePageSize);
+
+    // 先向预算登记，超出上限时不做映射
+    if (settings.budget && !settings.budget->reserve(settings.budget_subsystem, arenaBytes)) {
+        LOG_ERROR("Frame pool of {} MB exceeds the memory budget", arenaBytes >> 20);
+        return false;
+    }
+    settings_ = settings;
+    reservedBytes_ = settings.budget ? arenaBytes : 0;
+
+    if (!arena_.allocate(arenaBytes, settings.huge_pages, settings.node)) {
+        reset();
+        return false;
+    }
+
+    frameCount_ = static_cast<uint32_t>(settings.frames);
+    next_.reset(new std::atomic<uint32_t>[frameCount_]);
+    head_.store(kNil, std::memory_order_relaxed);
+    freeCount_.store(0, std::memory_order_relaxed);
+    acquireFailures_.store(0, std::memory_order_relaxed);
+    remoteAcquires_.store(0, std::memory_order_relaxed);
+    for (uint32_t i = frameCount_; i-- > 0;) {
+        pushFree(i);
+    }
+
+    LOG_INFO("Frame pool: {} x {}x{} frames ({} bytes each), {} MB, backing {}, NUMA node {}",
+             frameCount_, settings.width, settings.height, frameBytes_,
+             arena_.size() >> 20, memoryBackingName(arena_.backing()), arena_.node());
+    return true;
+}
+
+void FramePool::reset() {
+    arena_.release();
+    if (reservedBytes_ && settings_.budget) {
+        settings_.budget->release(settings_.budget_subsystem, reservedBytes_);
+    }
+    reservedBytes_ = 0;
+    next_.reset();
+    frameCount_ = 0;
+    frameBytes_ = 0;
+    frameStride_ = 0;
+    head_.store(kNil, std::memory_order_relaxed);
+    freeCount_.store(0, std::memory_order_relaxed);
+}
+
+bool FramePool::acquire(VideoFrame& frame) {
+    uint32_t index = popFree();
+    if (index == kNil) {
+        acquireFailures_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint8_t* base = frameData(index);
+    for (int i = 0; i < 4; ++i) {
+        frame.data[i] = linesize_[i] ? base + offsets_[i] : nullptr;
+        frame.linesize[i] = linesize_[i];
+    }
+    frame.width = settings_.width;
+    frame.height = settings_.height;
+    frame.format = settings_.format;
+    frame.timestamp = FrameTime(0);
+    return true;
+}
+
+bool FramePool::release(const VideoFrame& frame) {
+    if (!owns(frame)) {
+        return false;
+    }
+    size_t offset = static_cast<size_t>(frame.data[0] - arena_.data());
+    pushFree(static_cast<uint32_t>(offset / frameStride_));
+    return true;
+}
+
+bool FramePool::owns(const VideoFrame& frame) const {
+    if (!frameCount_ || frame.data[0] < arena_.data()) {
+        return false;
+    }
+    size_t offset = static_cast<size_t>(frame.data[0] - arena_.data());
+    return offset < frameStride_ * frameCount_ && offset % frameStride_ == offsets_[0];
+}
+
+FramePoolStats FramePool::getStats() const {
+    FramePoolStats stats;
+    stats.backing = arena_.backing();
+    stats.node = arena_.node();
+    stats.frame_bytes = frameStride_;
+    stats.arena_bytes = arena_.size();
+    stats.frames = frameCount_;
+    stats.free = freeCount_.load(std::memory_order_relaxed);
+    stats.acquire_failures = acquireFailures_.load(std::memory_order_relaxed);
+    stats.remote_acquires = remoteAcquires_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FramePool::pushFree(uint32_t index) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | index;
+    } while (!head_.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+    freeCount_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t FramePool::popFree() {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t next;
+    do {
+        uint32_t index = static_cast<uint32_t>(head);
+        if (index == kNil) {
+            return kNil;
+        }
+        next = ((head >> 32) + 1) << 32 | next_[index].load(std::memory_order_relaxed);
+    } while (!head_.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire));
+    freeCount_.fetch_sub(1, std::memory_order_relaxed);
+    return static_cast<uint32_t>(head);
+}
+
+bool NumaFramePool::initialize(const FramePoolSettings& settings) {
+    reset();
+    settings_ = settings;
+
+    const int nodes = numaNodeCount();
+    poolOfNode_.assign(nodes, -1);
+    std::vector<int> targets;
+    if (settings.node >= 0) {
+        targets.push_back(settings.node);
+    } else if (nodes > 1) {
+        for (int node = 0; node < nodes; ++node) {
+            if (!numaNodeCpus(node).empty()) {
+                targets.push_back(node);
+            }
+        }
+    }
+    if (targets.empty()) {
+        // 单节点：不绑定，行为与普通帧池相同
+        targets.push_back(-1);
+    }
+
+    for (int node : targets) {
+        FramePoolSettings sub = settings;
+        sub.node = node;
+        auto pool = std::make_unique<FramePool>();
+        if (!pool->initialize(sub)) {
+            reset();
+            return false;
+        }
+        if (node >= 0 && node < nodes) {
+            poolOfNode_[node] = static_cast<int>(pools_.size());
+        }
+        pools_.push_back(std::move(pool));
+    }
+    return true;
+}
+
+void NumaFramePool::reset() {
+    pools_.clear();
+    poolOfNode_.clear();
+}
+
+bool NumaFramePool::acquire(VideoFrame& frame, int node) {
+    if (pools_.empty()) {
+        return false;
+    }
+    if (node < 0) {
+        node = pools_.size() > 1 ? currentNumaNode() : -1;
+    }
+    int local = node >= 0 && node < static_cast<int>(poolOfNode_.size()) ? poolOfNode_[node] : -1;
+    if (local < 0) {
+        local = 0;
+    }
+    if (pools_[local]->acquire(frame)) {
+        return true;
+    }
+    for (size_t i = 0; i < pools_.size(); ++i) {
+        if (static_cast<int>(i) != local && pools_[i]->acquire(frame)) {
+            pools_[i]->countRemoteAcquire();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NumaFramePool::release(const VideoFrame& frame) {
+    for (auto& pool : pools_) {
+        if (pool->release(frame)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<FramePoolStats> NumaFramePool::getStats() const {
+    std::vector<FramePoolStats> stats;
+    stats.reserve(pools_.size());
+    for (const auto& pool : pools_) {
+        stats.push_back(pool->getStats());
+    }
+    return stats;
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,184 @@
+/**
+ * @file FramePoolLoader.cpp
+ * @brief 在后台线程分配的帧池实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "FramePoolLoader.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SimpleOBS {
+
+namespace {
+
+bool samePool(const FramePoolSettings& a, const FramePoolSettings& b) {
+    return a.width == b.width && a.height == b.height && a.format == b.format && a.frames == b.frames;
+}
+
+} // anonymous namespace
+
+/**
+ * @brief 所有FramePoolLoader共享的分配线程
+ */
+struct FramePoolLoader::Worker {
+    std::mutex mutex;
+    std::condition_variable wake;       ///< 有新请求或待释放的帧池
+    std::condition_variable idle;       ///< 某个对象的分配或释放已完成
+    std::vector<FramePoolLoader*> loaders;
+    std::thread thread;
+
+    Worker() { thread = std::thread(&Worker::run, this); }
+
+    FramePoolLoader* findWork() const {
+        for (FramePoolLoader* loader : loaders) {
+            if (loader->requested_ || loader->retired_) {
+                return loader;
+            }
+        }
+        return nullptr;
+    }
+
+    void run();
+};
+
+/**
+ * @brief 分配线程主循环
+ *
+ * @details 映射、预触页和释放都在锁外进行，只在交接指针时持有互斥锁。
+ *          新请求到来时先释放尚未换入的旧结果再分配，内存预算中不会同时保留两份
+ */
+void FramePoolLoader::Worker::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        FramePoolLoader* loader = nullptr;
+        wake.wait(lock, [&] {
+            loader = findWork();
+            return loader != nullptr;
+        });
+        loader->busy_ = true;
+        std::unique_ptr<FramePool> garbage = std::move(loader->retired_);
+        const bool allocate = loader->requested_;
+        FramePoolSettings settings = loader->request_;
+        loader->requested_ = false;
+        std::unique_ptr<FramePool> stale = allocate ? std::move(loader->ready_) : nullptr;
+        const std::string budgetName = loader->budgetName_;
+        lock.unlock();
+
+        garbage.reset();
+        stale.reset();
+        std::unique_ptr<FramePool> pool;
+        if (allocate) {
+            MemoryBudget& budget = Engine::getInstance().getMemoryBudget();
+            settings.budget = &budget;
+            settings.budget_subsystem = budget.registerSubsystem(budgetName, MemoryPriority::Required);
+            pool = std::make_unique<FramePool>();
+            if (!pool->initialize(settings)) {
+                LOG_WARN("Cannot allocate {} {} frames of {}x{}", budgetName, settings.frames,
+                         settings.width, settings.height);
+                pool.reset();
+            }
+        }
+
+        lock.lock();
+        if (allocate) {
+            if (pool) {
+                loader->ready_ = std::move(pool);
+                loader->poolFailed_ = false;
+            } else {
+                loader->failed_ = settings;
+                loader->poolFailed_ = true;
+            }
+        }
+        loader->busy_ = false;
+        idle.notify_all();
+    }
+}
+
+/**
+ * @brief 获取共享的分配线程
+ *
+ * @note 有意不析构：进程退出时静态对象的析构顺序不确定，仍可能有场景持有FramePoolLoader
+ */
+FramePoolLoader::Worker& FramePoolLoader::worker() {
+    static Worker* instance = new Worker();
+    return *instance;
+}
+
+FramePoolLoader::FramePoolLoader(const std::string& budgetName) : budgetName_(budgetName) {
+    Worker& shared = worker();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.loaders.push_back(this);
+}
+
+/**
+ * @brief 析构
+ * @details 等待后台线程完成本对象正在进行的分配，剩余的帧池在调用线程中释放
+ */
+FramePoolLoader::~FramePoolLoader() {
+    Worker& shared = worker();
+    std::unique_lock<std::mutex> lock(shared.mutex);
+    shared.idle.wait(lock, [this] { return !busy_; });
+    shared.loaders.erase(std::remove(shared.loaders.begin(), shared.loaders.end(), this), shared.loaders.end());
+}
+
+/**
+ * @brief 取得与配置一致的帧池（渲染线程）
+ * @param[in] settings 所需的尺寸、格式和帧数
+ * @return 可用的帧池；尚未就绪、后台线程正占用锁或分配失败时返回nullptr
+ *
+ * @details 配置不变时直接返回当前帧池；变化时换入已就绪的帧池，换下的交给后台线程释放；
+ *          没有就绪的帧池时提交请求
+ */
+FramePool* FramePoolLoader::prepare(const FramePoolSettings& settings) {
+    if (pool_ && samePool(pool_->getSettings(), settings)) {
+        return pool_.get();
+    }
+
+    Worker& shared = worker();
+    std::unique_lock<std::mutex> lock(shared.mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return nullptr;
+    }
+    if (ready_ && samePool(ready_->getSettings(), settings)) {
+        if (retired_) {
+            // 上一个换下的帧池还没释放完，下一帧再换
+            return nullptr;
+        }
+        retired_ = std::move(pool_);
+        pool_ = std::move(ready_);
+        shared.wake.notify_one();
+        return pool_.get();
+    }
+    if (!(poolFailed_ && samePool(failed_, settings)) && !(requested_ && samePool(request_, settings))) {
+        request_ = settings;
+        requested_ = true;
+        shared.wake.notify_one();
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 把当前帧池交给后台线程释放（渲染线程）
+ */
+void FramePoolLoader::release() {
+    if (!pool_) {
+        return;
+    }
+    Worker& shared = worker();
+    std::unique_lock<std::mutex> lock(shared.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || retired_) {
+        return;
+    }
+    retired_ = std::move(pool_);
+    shared.wake.notify_one();
+}
+
+} // namespace SimpleOBS
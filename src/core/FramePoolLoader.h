@@ -0,0 +1,83 @@
+/**
+ * @file FramePoolLoader.h
+ * @brief 在后台线程分配的帧池
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 渲染线程中的组件（帧率转换、格式转换）要按源画面的尺寸和格式准备帧池，
+ * 但映射和预触页可能耗时数毫秒，不能在渲染线程中进行。
+ * FramePoolLoader把分配请求交给进程内共享的一个后台线程，渲染线程只在池已就绪时换入：
+ * - prepare()：当前帧池与所需配置一致时直接返回；否则换入已就绪的帧池，
+ *   尚未就绪时提交请求并返回nullptr，调用方本帧跳过需要帧池的处理
+ * - 换下的帧池交给后台线程释放，映射、预触页和释放都不在渲染线程中进行
+ *
+ * @note
+ * - prepare()和release()只在渲染线程中调用，只尝试加锁，不阻塞
+ * - 帧池按名称登记到内存预算，超出预算时分配失败，相同配置不再重试
+ * - 后台线程在第一个FramePoolLoader构造时启动，之后常驻
+ */
+
+#pragma once
+
+#include "FramePool.h"
+#include <memory>
+#include <string>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 在后台线程分配的帧池
+ */
+class FramePoolLoader {
+public:
+    /**
+     * @brief 构造
+     * @param[in] budgetName 内存预算中的子系统名称
+     */
+    explicit FramePoolLoader(const std::string& budgetName);
+    ~FramePoolLoader();
+
+    FramePoolLoader(const FramePoolLoader&) = delete;
+    FramePoolLoader& operator=(const FramePoolLoader&) = delete;
+
+    /**
+     * @brief 取得与配置一致的帧池（渲染线程）
+     * @param[in] settings 所需的尺寸、格式和帧数，其余字段由后台线程填写
+     * @return 可用的帧池；尚未就绪或分配失败时返回nullptr
+     *
+     * @note 换入新帧池后，之前从旧帧池取出的帧失效，调用方要从新帧池重新取帧
+     */
+    FramePool* prepare(const FramePoolSettings& settings);
+
+    /**
+     * @brief 把当前帧池交给后台线程释放（渲染线程）
+     *
+     * @note 后台线程忙时保留当前帧池，之后相同配置的prepare()可以直接使用
+     */
+    void release();
+
+    /**
+     * @brief 当前帧池，未换入时为nullptr（渲染线程）
+     */
+    FramePool* current() const { return pool_.get(); }
+
+private:
+    struct Worker;
+    static Worker& worker();
+
+    std::string budgetName_;
+    std::unique_ptr<FramePool> pool_;   ///< 渲染线程正在使用的帧池
+
+    // 以下由Worker的互斥锁保护
+    FramePoolSettings request_;
+    bool requested_ = false;
+    std::unique_ptr<FramePool> ready_;      ///< 已分配、等待换入
+    std::unique_ptr<FramePool> retired_;    ///< 已换下、等待释放
+    FramePoolSettings failed_;          ///< 上次分配失败的配置，相同配置不再重试
+    bool poolFailed_ = false;
+    bool busy_ = false;                 ///< 后台线程正在为本对象分配或释放
+};
+
+} // namespace SimpleOBS
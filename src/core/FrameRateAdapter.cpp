@@ -0,0 +1,406 @@
+/**
+ * @file FrameRateAdapter.cpp
+ * @brief 源帧率转换实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "FrameRateAdapter.h"
+#include "CpuFeatures.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace SimpleOBS {
+
+namespace {
+
+// 源与引擎帧间隔相差在该比例内视为同一帧率，直接使用源帧
+constexpr double kMatchTolerance = 0.005;
+
+// 帧间隔估计的平滑系数
+constexpr double kIntervalSmoothing = 1.0 / 16.0;
+
+// 超过该间隔的时间戳跳变视为源重启，重新估计
+constexpr int64_t kMaxSourceIntervalUs = 1000000;
+
+// 混合权重接近端点时直接使用该端点的帧，省去一次混合
+constexpr int kBlendSnap = 8;
+
+// ---------------------------------------------------------------------------
+// 混合内核：out = (a * (256 - w) + b * w + 128) >> 8，16位中间值不会溢出
+// ---------------------------------------------------------------------------
+
+void blendRowScalar(uint8_t* dst, const uint8_t* a, const uint8_t* b, int bytes, int weight) {
+    const int inverse = 256 - weight;
+    for (int i = 0; i < bytes; ++i) {
+        dst[i] = static_cast<uint8_t>((a[i] * inverse + b[i] * weight + 128) >> 8);
+    }
+}
+
+#ifdef SIMPLEOBS_X86
+void blendRowSse2(uint8_t* dst, const uint8_t* a, const uint8_t* b, int bytes, int weight) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16(static_cast<int16_t>(256 - weight));
+    const __m128i wb = _mm_set1_epi16(static_cast<int16_t>(weight));
+    const __m128i round = _mm_set1_epi16(128);
+    int i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    blendRowScalar(dst + i, a + i, b + i, bytes - i, weight);
+}
+
+SIMPLEOBS_TARGET_AVX2
+void blendRowAvx2(uint8_t* dst, const uint8_t* a, const uint8_t* b, int bytes, int weight) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i wa = _mm256_set1_epi16(static_cast<int16_t>(256 - weight));
+    const __m256i wb = _mm256_set1_epi16(static_cast<int16_t>(weight));
+    const __m256i round = _mm256_set1_epi16(128);
+    int i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        // unpack和packus都在128位通道内进行，字节顺序保持不变
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(va, zero), wa),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(vb, zero), wb));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(va, zero), wa),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(vb, zero), wb));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    blendRowScalar(dst + i, a + i, b + i, bytes - i, weight);
+}
+#endif
+
+using BlendRowFn = void (*)(uint8_t*, const uint8_t*, const uint8_t*, int, int);
+
+BlendRowFn selectBlendRow() {
+#ifdef SIMPLEOBS_X86
+    if (cpuHasAvx2()) {
+        return blendRowAvx2;
+    }
+    if (cpuHasSse2()) {
+        return blendRowSse2;
+    }
+#endif
+    return blendRowScalar;
+}
+
+const BlendRowFn blendRow = selectBlendRow();
+
+// ---------------------------------------------------------------------------
+// 10位混合内核：采样为16位，右移shift位取出10位有效值后按相同公式混合再移回。
+// a、b交错后与(256 - w, w)做madd，10位值与权重的乘积和不超过32位有符号范围
+// ---------------------------------------------------------------------------
+
+void blendRow16Scalar(uint8_t* dst, const uint8_t* a, const uint8_t* b, int samples, int weight, int shift) {
+    const int inverse = 256 - weight;
+    for (int i = 0; i < samples; ++i) {
+        uint16_t va;
+        uint16_t vb;
+        std::memcpy(&va, a + i * 2, 2);
+        std::memcpy(&vb, b + i * 2, 2);
+        const uint16_t out = static_cast<uint16_t>(
+            (((va >> shift) * inverse + (vb >> shift) * weight + 128) >> 8) << shift);
+        std::memcpy(dst + i * 2, &out, 2);
+    }
+}
+
+#ifdef SIMPLEOBS_X86
+void blendRow16Sse2(uint8_t* dst, const uint8_t* a, const uint8_t* b, int samples, int weight, int shift) {
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    const __m128i weights = _mm_set1_epi32((weight << 16) | (256 - weight));
+    const __m128i round = _mm_set1_epi32(128);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m128i va = _mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i * 2)), count);
+        __m128i vb = _mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i * 2)), count);
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(va, vb), weights);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(va, vb), weights);
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 8);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 8);
+        // 结果不超过1023，有符号饱和打包不会截断
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_sll_epi16(_mm_packs_epi32(lo, hi), count));
+    }
+    blendRow16Scalar(dst + i * 2, a + i * 2, b + i * 2, samples - i, weight, shift);
+}
+
+SIMPLEOBS_TARGET_AVX2
+void blendRow16Avx2(uint8_t* dst, const uint8_t* a, const uint8_t* b, int samples, int weight, int shift) {
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    const __m256i weights = _mm256_set1_epi32((weight << 16) | (256 - weight));
+    const __m256i round = _mm256_set1_epi32(128);
+    int i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m256i va = _mm256_srl_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i * 2)), count);
+        __m256i vb = _mm256_srl_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i * 2)), count);
+        __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(va, vb), weights);
+        __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(va, vb), weights);
+        lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), 8);
+        hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), 8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2),
+                            _mm256_sll_epi16(_mm256_packs_epi32(lo, hi), count));
+    }
+    blendRow16Scalar(dst + i * 2, a + i * 2, b + i * 2, samples - i, weight, shift);
+}
+#endif
+
+using BlendRow16Fn = void (*)(uint8_t*, const uint8_t*, const uint8_t*, int, int, int);
+
+BlendRow16Fn selectBlendRow16() {
+#ifdef SIMPLEOBS_X86
+    if (cpuHasAvx2()) {
+        return blendRow16Avx2;
+    }
+    if (cpuHasSse2()) {
+        return blendRow16Sse2;
+    }
+#endif
+    return blendRow16Scalar;
+}
+
+const BlendRow16Fn blendRow16 = selectBlendRow16();
+
+} // anonymous namespace
+
+const char* frameRateModeName(FrameRateMode mode) {
+    switch (mode) {
+    case FrameRateMode::Passthrough:
+        return "passthrough";
+    case FrameRateMode::Blend:
+        return "blend";
+    default:
+        return "nearest";
+    }
+}
+
+bool parseFrameRateMode(const std::string& name, FrameRateMode& mode) {
+    if (name == "passthrough") {
+        mode = FrameRateMode::Passthrough;
+    } else if (name == "nearest") {
+        mode = FrameRateMode::Nearest;
+    } else if (name == "blend") {
+        mode = FrameRateMode::Blend;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool blendVideoFrames(VideoFrame& dst, const VideoFrame& a, const VideoFrame& b, int weight) {
+    if (a.format != b.format || a.format != dst.format || a.width != b.width || a.height != b.height ||
+        !a.data[0] || !b.data[0] || !dst.data[0]) {
+        return false;
+    }
+    weight = std::clamp(weight, 0, 256);
+    const bool wide = videoFormatBitDepth(dst.format) > 8;
+    const int shift = dst.format == kVideoFormatP010 ? 6 : 0;
+    for (int plane = 0; plane < 4 && dst.data[plane] && a.data[plane] && b.data[plane]; ++plane) {
+        // 除打包RGBA外，第二个平面起是2x2下采样的色度平面
+        const bool chroma = plane > 0 && dst.format != kVideoFormatRGBA;
+        const int rows = chroma ? (std::min(dst.height, a.height) + 1) / 2 : std::min(dst.height, a.height);
+        const int bytes = std::min({dst.linesize[plane], a.linesize[plane], b.linesize[plane]});
+        for (int y = 0; y < rows; ++y) {
+            uint8_t* out = dst.data[plane] + static_cast<size_t>(y) * dst.linesize[plane];
+            const uint8_t* rowA = a.data[plane] + static_cast<size_t>(y) * a.linesize[plane];
+            const uint8_t* rowB = b.data[plane] + static_cast<size_t>(y) * b.linesize[plane];
+            if (wide) {
+                blendRow16(out, rowA, rowB, bytes / 2, weight, shift);
+            } else {
+                blendRow(out, rowA, rowB, bytes, weight);
+            }
+        }
+    }
+    dst.timestamp = a.timestamp + (b.timestamp - a.timestamp) * weight / 256;
+    return true;
+}
+
+void FrameRateAdapter::setMode(FrameRateMode mode) {
+    mode_ = mode;
+    if (mode_ == FrameRateMode::Passthrough) {
+        reset();
+    }
+}
+
+void FrameRateAdapter::setEngineInterval(FrameTime interval) {
+    if (interval.count() > 0) {
+        engineInterval_ = interval;
+    }
+}
+
+/**
+ * @brief 根据新帧的时间戳更新源帧间隔估计
+ * @param[in] timestamp 新帧的时间戳
+ */
+void FrameRateAdapter::trackInterval(FrameTime timestamp) {
+    const int64_t delta = (timestamp - lastTimestamp_).count();
+    lastTimestamp_ = timestamp;
+    if (!hasTimestamp_ || delta <= 0 || delta > kMaxSourceIntervalUs) {
+        hasTimestamp_ = true;
+        return;
+    }
+
+    if (interval_ <= 0.0) {
+        interval_ = static_cast<double>(delta);
+    } else {
+        // 两次拉取之间源产生了多帧：按已估计的间隔计入未拉取的帧，用平均间隔更新估计
+        const double frames = std::round(delta / interval_);
+        if (frames >= 2.0) {
+            skipped_.fetch_add(static_cast<uint64_t>(frames) - 1, std::memory_order_relaxed);
+            interval_ += (delta / frames - interval_) * kIntervalSmoothing;
+        } else {
+            interval_ += (delta - interval_) * kIntervalSmoothing;
+        }
+    }
+
+    const double engine = static_cast<double>(engineInterval_.count());
+    sourceFps_.store(1000000.0 / interval_, std::memory_order_relaxed);
+    driftPpm_.store((engine / interval_ - 1.0) * 1000000.0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 按源帧尺寸和格式准备帧池，并取出常驻的三帧
+ * @param[in] frame 源帧
+ * @return false表示帧池尚未就绪或分配失败
+ *
+ * @details 帧池由后台线程分配，换入新帧池时之前的三帧和历史失效
+ */
+bool FrameRateAdapter::preparePool(const VideoFrame& frame) {
+    FramePoolSettings settings;
+    settings.width = frame.width;
+    settings.height = frame.height;
+    settings.format = frame.format;
+    settings.frames = 3;
+    FramePool* pool = pool_.prepare(settings);
+    if (!pool) {
+        return false;
+    }
+    if (pool == framesPool_) {
+        return true;
+    }
+
+    framesPool_ = nullptr;
+    prev_ = VideoFrame{};
+    cur_ = VideoFrame{};
+    blend_ = VideoFrame{};
+    hasPrev_ = false;
+    hasCur_ = false;
+    if (!pool->acquire(prev_) || !pool->acquire(cur_) || !pool->acquire(blend_)) {
+        pool->release(prev_);
+        pool->release(cur_);
+        pool->release(blend_);
+        return false;
+    }
+    framesPool_ = pool;
+    return true;
+}
+
+/**
+ * @brief 把源的最新帧转换为当前节拍的输出
+ * @param[in,out] frame 输入为源的最新帧，输出为当前节拍的画面
+ * @param[in] now 当前节拍时刻
+ *
+ * @details
+ * 1. 时间戳与上次相同表示源没有新帧；新帧更新帧间隔估计
+ * 2. 未估计出帧间隔、帧率一致或源更快时直接使用源帧
+ * 3. 否则新帧复制进帧池，目标时刻取当前时刻减一个源帧间隔，
+ *    保证目标时刻两侧通常都有帧；按目标时刻在两帧间的位置选择或混合
+ */
+void FrameRateAdapter::process(VideoFrame& frame, FrameTime now) {
+    const bool fresh = !hasTimestamp_ || frame.timestamp != lastTimestamp_;
+    if (fresh) {
+        sourceFrames_.fetch_add(1, std::memory_order_relaxed);
+        trackInterval(frame.timestamp);
+    } else {
+        repeated_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const double engine = static_cast<double>(engineInterval_.count());
+    const bool convert = mode_ != FrameRateMode::Passthrough && interval_ > 0.0 &&
+                         interval_ > engine * (1.0 + kMatchTolerance);
+    if (!convert || !preparePool(frame)) {
+        converting_.store(false, std::memory_order_relaxed);
+        hasPrev_ = false;
+        hasCur_ = false;
+        return;
+    }
+    converting_.store(true, std::memory_order_relaxed);
+
+    if (fresh || !hasCur_) {
+        std::swap(prev_, cur_);
+        hasPrev_ = hasCur_;
+        if (!copyVideoFrame(cur_, frame)) {
+            hasPrev_ = false;
+            hasCur_ = false;
+            return;
+        }
+        hasCur_ = true;
+        copied_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const VideoFrame* out = &cur_;
+    const FrameTime target = now - FrameTime(static_cast<int64_t>(interval_));
+    if (hasPrev_ && target < cur_.timestamp) {
+        const int64_t span = (cur_.timestamp - prev_.timestamp).count();
+        const int64_t offset = (target - prev_.timestamp).count();
+        const int weight = span > 0 ? static_cast<int>(std::clamp<int64_t>(offset * 256 / span, 0, 256)) : 256;
+        if (mode_ == FrameRateMode::Nearest || weight <= kBlendSnap || weight >= 256 - kBlendSnap) {
+            out = weight < 128 ? &prev_ : &cur_;
+        } else if (blendVideoFrames(blend_, prev_, cur_, weight)) {
+            out = &blend_;
+            blended_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    for (int plane = 0; plane < 4; ++plane) {
+        frame.data[plane] = out->data[plane];
+        frame.linesize[plane] = out->linesize[plane];
+    }
+    frame.timestamp = out == &blend_ ? target : out->timestamp;
+}
+
+/**
+ * @brief 归还常驻帧，帧池交给后台线程释放
+ */
+void FrameRateAdapter::reset() {
+    if (framesPool_ && framesPool_ == pool_.current()) {
+        framesPool_->release(prev_);
+        framesPool_->release(cur_);
+        framesPool_->release(blend_);
+    }
+    framesPool_ = nullptr;
+    pool_.release();
+    prev_ = VideoFrame{};
+    cur_ = VideoFrame{};
+    blend_ = VideoFrame{};
+    hasPrev_ = false;
+    hasCur_ = false;
+    converting_.store(false, std::memory_order_relaxed);
+}
+
+FrameRateStats FrameRateAdapter::getStats() const {
+    FrameRateStats stats;
+    stats.source_fps = sourceFps_.load(std::memory_order_relaxed);
+    stats.drift_ppm = driftPpm_.load(std::memory_order_relaxed);
+    stats.converting = converting_.load(std::memory_order_relaxed);
+    stats.source_frames = sourceFrames_.load(std::memory_order_relaxed);
+    stats.repeated = repeated_.load(std::memory_order_relaxed);
+    stats.skipped = skipped_.load(std::memory_order_relaxed);
+    stats.blended = blended_.load(std::memory_order_relaxed);
+    stats.copied = copied_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace SimpleOBS
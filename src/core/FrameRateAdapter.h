@@ -0,0 +1,143 @@
+/**
+ * @file FrameRateAdapter.h
+ * @brief 源帧率到引擎时钟的转换
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了位于源和场景之间的帧率转换器。场景每个视频节拍从源拉取最新一帧，
+ * 转换器根据源时间戳估计源的帧间隔：
+ * - 与引擎帧率一致（误差在千分之五内）或源比引擎快时，直接使用源的帧，不复制也不计算
+ * - 源比引擎慢时，把每个新帧复制进自有帧池，在目标时刻（当前时刻减一个源帧间隔）
+ *   两侧的相邻两帧中选择时间最近的一帧，或按时间距离加权混合（SIMD）
+ *
+ * @note
+ * - 转换器只在渲染线程中调用；统计量为原子变量，可在任意线程读取
+ * - 输出帧的数据指针指向转换器的帧池，在下一次调用前有效
+ * - 帧池按源帧的尺寸和格式在需要时由后台线程分配，计入内存预算的frame_rate子系统；
+ *   就绪之前直接使用源帧，渲染线程不分配内存
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include "FramePoolLoader.h"
+#include <atomic>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 帧率转换方式
+ */
+enum class FrameRateMode {
+    Passthrough,    ///< 总是使用源的最新帧
+    Nearest,        ///< 选择时间戳最近的帧
+    Blend           ///< 混合相邻两帧
+};
+
+/**
+ * @brief 帧率转换方式名称（"passthrough"、"nearest"、"blend"）
+ */
+const char* frameRateModeName(FrameRateMode mode);
+
+/**
+ * @brief 按名称解析帧率转换方式
+ * @return false表示名称无效
+ */
+bool parseFrameRateMode(const std::string& name, FrameRateMode& mode);
+
+/**
+ * @brief 帧率转换统计
+ */
+struct FrameRateStats {
+    double source_fps = 0.0;        ///< 估计的源帧率，0表示尚未估计
+    double drift_ppm = 0.0;         ///< 源帧率相对引擎帧率的偏差（百万分之一），正值表示源更快
+    bool converting = false;        ///< 当前是否在转换（否则直接使用源帧）
+    uint64_t source_frames = 0;     ///< 收到的新帧数
+    uint64_t repeated = 0;          ///< 源没有新帧的节拍数
+    uint64_t skipped = 0;           ///< 按时间戳推算未被拉取到的源帧数
+    uint64_t blended = 0;           ///< 混合输出的节拍数
+    uint64_t copied = 0;            ///< 复制进帧池的源帧数
+};
+
+/**
+ * @brief 按权重混合两帧：dst = a + (b - a) * weight / 256
+ * @param[out] dst 输出帧，尺寸和格式与输入相同
+ * @param[in] a 权重为0时的帧
+ * @param[in] b 权重为256时的帧
+ * @param[in] weight 权重（0~256）
+ * @return false表示格式或尺寸不一致
+ *
+ * @note 10位格式按16位采样混合，结果仍为10位
+ */
+bool blendVideoFrames(VideoFrame& dst, const VideoFrame& a, const VideoFrame& b, int weight);
+
+/**
+ * @brief 源帧率转换器
+ */
+class FrameRateAdapter {
+public:
+    FrameRateAdapter() = default;
+
+    FrameRateAdapter(const FrameRateAdapter&) = delete;
+    FrameRateAdapter& operator=(const FrameRateAdapter&) = delete;
+
+    /**
+     * @brief 设置转换方式
+     */
+    void setMode(FrameRateMode mode);
+
+    /**
+     * @brief 设置引擎视频帧间隔
+     */
+    void setEngineInterval(FrameTime interval);
+
+    /**
+     * @brief 把源的最新帧转换为当前节拍的输出
+     * @param[in,out] frame 输入为源的最新帧，输出为当前节拍的画面
+     * @param[in] now 当前节拍时刻
+     *
+     * @note 帧池尚未就绪或分配失败时输出源的最新帧
+     */
+    void process(VideoFrame& frame, FrameTime now);
+
+    /**
+     * @brief 归还帧池并清除历史，源被移除或停止时调用
+     */
+    void reset();
+
+    /**
+     * @brief 获取统计信息
+     */
+    FrameRateStats getStats() const;
+
+private:
+    bool preparePool(const VideoFrame& frame);
+    void trackInterval(FrameTime timestamp);
+
+    FrameRateMode mode_ = FrameRateMode::Nearest;
+    FrameTime engineInterval_{1000000 / 60};
+    FrameTime lastTimestamp_{0};
+    bool hasTimestamp_ = false;
+    double interval_ = 0.0;             ///< 估计的源帧间隔（微秒），0表示尚未估计
+
+    FramePoolLoader pool_{"frame_rate"};
+    FramePool* framesPool_ = nullptr;   ///< 取出常驻三帧的帧池
+    VideoFrame prev_{};                 ///< 目标时刻之前的帧
+    VideoFrame cur_{};                  ///< 最新的帧
+    VideoFrame blend_{};                ///< 混合输出
+    bool hasPrev_ = false;
+    bool hasCur_ = false;
+
+    std::atomic<double> sourceFps_{0.0};
+    std::atomic<double> driftPpm_{0.0};
+    std::atomic<bool> converting_{false};
+    std::atomic<uint64_t> sourceFrames_{0};
+    std::atomic<uint64_t> repeated_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> blended_{0};
+    std::atomic<uint64_t> copied_{0};
+};
+
+} // namespace SimpleOBS
@@ -0,0 +1,759 @@
+/**
+ * @file ImageEncoder.cpp
+ * @brief 截图用的PNG/JPEG编码与缩略图缩放实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "ImageEncoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace SimpleOBS {
+
+namespace {
+
+uint8_t clampByte(float value) {
+    return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value + 0.5f)));
+}
+
+void putBigEndian32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putBigEndian16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// ---------------------------------------------------------------------------
+// PNG
+// ---------------------------------------------------------------------------
+
+const uint32_t* crc32Table() {
+    static const auto table = [] {
+        static uint32_t t[256];
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    const uint32_t* table = crc32Table();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t adler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (size > 0) {
+        // 5552是保证32位累加不溢出的最大块长
+        size_t chunk = std::min<size_t>(size, 5552);
+        for (size_t i = 0; i < chunk; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += chunk;
+        size -= chunk;
+    }
+    return (b << 16) | a;
+}
+
+void writeChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size) {
+    putBigEndian32(out, static_cast<uint32_t>(size));
+    const size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size > 0) {
+        out.insert(out.end(), data, data + size);
+    }
+    putBigEndian32(out, crc32(out.data() + start, size + 4));
+}
+
+/**
+ * @brief deflate的低位优先比特流
+ */
+class DeflateBits {
+public:
+    explicit DeflateBits(std::vector<uint8_t>& out) : out_(out) {}
+
+    void put(uint32_t value, int count) {
+        buffer_ |= value << bits_;
+        bits_ += count;
+        while (bits_ >= 8) {
+            out_.push_back(static_cast<uint8_t>(buffer_));
+            buffer_ >>= 8;
+            bits_ -= 8;
+        }
+    }
+
+    /// 霍夫曼码按高位优先定义，需反转后写入
+    void putCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) {
+            reversed |= ((code >> i) & 1u) << (length - 1 - i);
+        }
+        put(reversed, length);
+    }
+
+    void flush() {
+        if (bits_ > 0) {
+            out_.push_back(static_cast<uint8_t>(buffer_));
+        }
+        buffer_ = 0;
+        bits_ = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint32_t buffer_ = 0;
+    int bits_ = 0;
+};
+
+constexpr uint16_t kLengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                      3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t kDistanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                        8193, 12289, 16385, 24577};
+constexpr uint8_t kDistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/// 固定霍夫曼表（RFC 1951 3.2.6）
+void putFixedSymbol(DeflateBits& bits, int symbol) {
+    if (symbol <= 143) {
+        bits.putCode(0x30 + symbol, 8);
+    } else if (symbol <= 255) {
+        bits.putCode(0x190 + symbol - 144, 9);
+    } else if (symbol <= 279) {
+        bits.putCode(symbol - 256, 7);
+    } else {
+        bits.putCode(0xC0 + symbol - 280, 8);
+    }
+}
+
+void putMatch(DeflateBits& bits, int length, int distance) {
+    int l = 28;
+    while (kLengthBase[l] > length) {
+        --l;
+    }
+    putFixedSymbol(bits, 257 + l);
+    bits.put(length - kLengthBase[l], kLengthExtra[l]);
+
+    int d = 29;
+    while (kDistanceBase[d] > distance) {
+        --d;
+    }
+    bits.putCode(d, 5);
+    bits.put(distance - kDistanceBase[d], kDistanceExtra[d]);
+}
+
+/**
+ * @brief zlib格式压缩：单个固定霍夫曼块，贪心LZ77匹配
+ */
+void zlibCompress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out) {
+    constexpr int kWindow = 32768;
+    constexpr int kHashBits = 15;
+    constexpr int kMaxChain = 32;
+    constexpr int kMinMatch = 3;
+    constexpr int kMaxMatch = 258;
+
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    DeflateBits bits(out);
+    bits.put(1, 1);     // BFINAL
+    bits.put(1, 2);     // BTYPE=01 固定霍夫曼
+
+    const int n = static_cast<int>(data.size());
+    const uint8_t* p = data.data();
+    std::vector<int32_t> head(1u << kHashBits, -1);
+    std::vector<int32_t> prev(kWindow, -1);
+
+    auto hashAt = [p](int i) {
+        uint32_t v = (static_cast<uint32_t>(p[i]) << 16) | (static_cast<uint32_t>(p[i + 1]) << 8) | p[i + 2];
+        return (v * 2654435761u) >> (32 - kHashBits);
+    };
+    auto insert = [&](int i) {
+        if (i + kMinMatch <= n) {
+            uint32_t h = hashAt(i);
+            prev[i & (kWindow - 1)] = head[h];
+            head[h] = i;
+        }
+    };
+
+    int i = 0;
+    while (i < n) {
+        int bestLength = 0;
+        int bestDistance = 0;
+        if (i + kMinMatch <= n) {
+            const int limit = std::min(kMaxMatch, n - i);
+            int candidate = head[hashAt(i)];
+            for (int chain = 0; candidate >= 0 && i - candidate <= kWindow && chain < kMaxChain; ++chain) {
+                int length = 0;
+                while (length < limit && p[candidate + length] == p[i + length]) {
+                    ++length;
+                }
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = i - candidate;
+                    if (length == limit) {
+                        break;
+                    }
+                }
+                int next = prev[candidate & (kWindow - 1)];
+                if (next >= candidate) {
+                    break;      // 槽位已被窗口外的新位置覆盖
+                }
+                candidate = next;
+            }
+        }
+
+        if (bestLength >= kMinMatch) {
+            putMatch(bits, bestLength, bestDistance);
+            for (int k = 0; k < bestLength; ++k) {
+                insert(i + k);
+            }
+            i += bestLength;
+        } else {
+            putFixedSymbol(bits, p[i]);
+            insert(i);
+            ++i;
+        }
+    }
+    putFixedSymbol(bits, 256);
+    bits.flush();
+    putBigEndian32(out, adler32(data.data(), data.size()));
+}
+
+int paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+/**
+ * @brief 对每行尝试5种PNG滤波器，取残差绝对值和最小者
+ */
+void filterRows(const RgbImage& image, std::vector<uint8_t>& filtered) {
+    constexpr int kBpp = 3;
+    const size_t stride = static_cast<size_t>(image.width) * kBpp;
+    filtered.resize((stride + 1) * image.height);
+
+    std::vector<uint8_t> candidates[5];
+    for (auto& c : candidates) {
+        c.resize(stride);
+    }
+    const std::vector<uint8_t> zeros(stride, 0);
+
+    for (int y = 0; y < image.height; ++y) {
+        const uint8_t* row = image.pixels.data() + y * stride;
+        const uint8_t* up = y > 0 ? row - stride : zeros.data();
+        uint64_t bestCost = UINT64_MAX;
+        int best = 0;
+        for (int type = 0; type < 5; ++type) {
+            uint8_t* out = candidates[type].data();
+            uint64_t cost = 0;
+            for (size_t x = 0; x < stride; ++x) {
+                int a = x >= kBpp ? row[x - kBpp] : 0;
+                int b = up[x];
+                int c = x >= kBpp ? up[x - kBpp] : 0;
+                int predictor = 0;
+                switch (type) {
+                case 1: predictor = a; break;
+                case 2: predictor = b; break;
+                case 3: predictor = (a + b) / 2; break;
+                case 4: predictor = paeth(a, b, c); break;
+                default: break;
+                }
+                out[x] = static_cast<uint8_t>(row[x] - predictor);
+                cost += static_cast<uint64_t>(std::abs(static_cast<int8_t>(out[x])));
+            }
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = type;
+            }
+        }
+        uint8_t* dst = filtered.data() + y * (stride + 1);
+        dst[0] = static_cast<uint8_t>(best);
+        std::memcpy(dst + 1, candidates[best].data(), stride);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// JPEG
+// ---------------------------------------------------------------------------
+
+constexpr uint8_t kZigzag[64] = {0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+                                 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+                                 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+                                 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+constexpr uint8_t kLumaQuant[64] = {16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+                                    14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+                                    18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+                                    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+
+constexpr uint8_t kChromaQuant[64] = {17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+                                      24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+                                      99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+                                      99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99};
+
+// 标准霍夫曼表（ITU T.81 附录K.3）
+constexpr uint8_t kDcLumaBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+constexpr uint8_t kDcChromaBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+constexpr uint8_t kDcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+constexpr uint8_t kAcLumaBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+constexpr uint8_t kAcLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa};
+
+constexpr uint8_t kAcChromaBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+constexpr uint8_t kAcChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa};
+
+struct HuffmanTable {
+    uint16_t code[256] = {};
+    uint8_t size[256] = {};
+};
+
+HuffmanTable buildHuffman(const uint8_t bits[16], const uint8_t* values) {
+    HuffmanTable table;
+    uint16_t code = 0;
+    int k = 0;
+    for (int length = 1; length <= 16; ++length) {
+        for (int i = 0; i < bits[length - 1]; ++i) {
+            table.code[values[k]] = code++;
+            table.size[values[k]] = static_cast<uint8_t>(length);
+            ++k;
+        }
+        code <<= 1;
+    }
+    return table;
+}
+
+/**
+ * @brief JPEG熵编码段的高位优先比特流，0xFF后填充0x00
+ */
+class JpegBits {
+public:
+    explicit JpegBits(std::vector<uint8_t>& out) : out_(out) {}
+
+    void put(uint32_t value, int count) {
+        buffer_ = (buffer_ << count) | (value & ((1u << count) - 1));
+        bits_ += count;
+        while (bits_ >= 8) {
+            uint8_t byte = static_cast<uint8_t>(buffer_ >> (bits_ - 8));
+            out_.push_back(byte);
+            if (byte == 0xFF) {
+                out_.push_back(0x00);
+            }
+            bits_ -= 8;
+        }
+        buffer_ &= (1u << bits_) - 1;
+    }
+
+    void flush() {
+        if (bits_ > 0) {
+            put((1u << (8 - bits_)) - 1, 8 - bits_);
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint32_t buffer_ = 0;
+    int bits_ = 0;
+};
+
+struct DctMatrix {
+    float m[8][8];
+    DctMatrix() {
+        for (int u = 0; u < 8; ++u) {
+            const float scale = u == 0 ? 0.5f / std::sqrt(2.0f) : 0.5f;
+            for (int x = 0; x < 8; ++x) {
+                m[u][x] = scale * std::cos((2.0f * x + 1.0f) * u * static_cast<float>(M_PI) / 16.0f);
+            }
+        }
+    }
+};
+
+/// 二维DCT：F = M * f * M^T
+void forwardDct(const float in[64], float out[64]) {
+    static const DctMatrix dct;
+    float temp[64];
+    for (int y = 0; y < 8; ++y) {
+        for (int u = 0; u < 8; ++u) {
+            float sum = 0.0f;
+            for (int x = 0; x < 8; ++x) {
+                sum += dct.m[u][x] * in[y * 8 + x];
+            }
+            temp[y * 8 + u] = sum;
+        }
+    }
+    for (int u = 0; u < 8; ++u) {
+        for (int v = 0; v < 8; ++v) {
+            float sum = 0.0f;
+            for (int y = 0; y < 8; ++y) {
+                sum += dct.m[v][y] * temp[y * 8 + u];
+            }
+            out[v * 8 + u] = sum;
+        }
+    }
+}
+
+int magnitudeBits(int value) {
+    int bits = 0;
+    for (int v = std::abs(value); v; v >>= 1) {
+        ++bits;
+    }
+    return bits;
+}
+
+void encodeBlock(JpegBits& bits, const float block[64], const uint8_t quant[64], int& previousDc,
+                 const HuffmanTable& dc, const HuffmanTable& ac) {
+    float coefficients[64];
+    forwardDct(block, coefficients);
+
+    int q[64];
+    for (int k = 0; k < 64; ++k) {
+        const int index = kZigzag[k];
+        q[k] = static_cast<int>(std::lround(coefficients[index] / quant[index]));
+    }
+
+    const int diff = q[0] - previousDc;
+    previousDc = q[0];
+    int category = magnitudeBits(diff);
+    bits.put(dc.code[category], dc.size[category]);
+    if (category > 0) {
+        bits.put(diff < 0 ? diff - 1 : diff, category);
+    }
+
+    int run = 0;
+    for (int k = 1; k < 64; ++k) {
+        if (q[k] == 0) {
+            ++run;
+            continue;
+        }
+        while (run > 15) {
+            bits.put(ac.code[0xF0], ac.size[0xF0]);
+            run -= 16;
+        }
+        category = magnitudeBits(q[k]);
+        const int symbol = (run << 4) | category;
+        bits.put(ac.code[symbol], ac.size[symbol]);
+        bits.put(q[k] < 0 ? q[k] - 1 : q[k], category);
+        run = 0;
+    }
+    if (run > 0) {
+        bits.put(ac.code[0x00], ac.size[0x00]);
+    }
+}
+
+void writeHuffmanSegment(std::vector<uint8_t>& out, uint8_t tableClassId, const uint8_t bits[16],
+                         const uint8_t* values) {
+    int count = 0;
+    for (int i = 0; i < 16; ++i) {
+        count += bits[i];
+    }
+    out.push_back(tableClassId);
+    out.insert(out.end(), bits, bits + 16);
+    out.insert(out.end(), values, values + count);
+}
+
+} // anonymous namespace
+
+bool convertToRgb(const VideoFrame& frame, RgbImage& image) {
+    if (!frame.data[0] || frame.width <= 0 || frame.height <= 0) {
+        return false;
+    }
+    const bool planar = frame.format == kVideoFormatI420 || frame.format == kVideoFormatI010;
+    const bool yuv = planar || frame.format == kVideoFormatNV12 || frame.format == kVideoFormatP010;
+    if (frame.format != kVideoFormatRGBA && !yuv) {
+        return false;
+    }
+    if (yuv && (!frame.data[1] || (planar && !frame.data[2]))) {
+        return false;
+    }
+
+    image.width = frame.width;
+    image.height = frame.height;
+    image.pixels.resize(static_cast<size_t>(frame.width) * frame.height * 3);
+    uint8_t* out = image.pixels.data();
+
+    // 10位采样按16位读取并换算到8位刻度（浮点，不先截断）
+    const bool wide = videoFormatBitDepth(frame.format) > 8;
+    const int shift = frame.format == kVideoFormatP010 ? 6 : 0;
+    auto sample = [wide, shift](const uint8_t* row, int index) -> float {
+        if (!wide) {
+            return row[index];
+        }
+        uint16_t value;
+        std::memcpy(&value, row + index * 2, 2);
+        return (value >> shift) * 0.25f;
+    };
+
+    for (int y = 0; y < frame.height; ++y) {
+        const uint8_t* row = frame.data[0] + static_cast<size_t>(y) * frame.linesize[0];
+        if (!yuv) {
+            for (int x = 0; x < frame.width; ++x) {
+                *out++ = row[x * 4];
+                *out++ = row[x * 4 + 1];
+                *out++ = row[x * 4 + 2];
+            }
+            continue;
+        }
+        const uint8_t* chroma1 = frame.data[1] + static_cast<size_t>(y / 2) * frame.linesize[1];
+        const uint8_t* chroma2 = planar
+            ? frame.data[2] + static_cast<size_t>(y / 2) * frame.linesize[2] : nullptr;
+        for (int x = 0; x < frame.width; ++x) {
+            float u;
+            float v;
+            if (chroma2) {
+                u = sample(chroma1, x / 2);
+                v = sample(chroma2, x / 2);
+            } else {
+                u = sample(chroma1, (x / 2) * 2);
+                v = sample(chroma1, (x / 2) * 2 + 1);
+            }
+            // BT.709 有限范围
+            const float c = 1.164f * (sample(row, x) - 16);
+            const float d = u - 128;
+            const float e = v - 128;
+            *out++ = clampByte(c + 1.793f * e);
+            *out++ = clampByte(c - 0.213f * d - 0.533f * e);
+            *out++ = clampByte(c + 2.112f * d);
+        }
+    }
+    return true;
+}
+
+void downscaleRgb(const RgbImage& input, int maxWidth, int maxHeight, RgbImage& output) {
+    double scale = 1.0;
+    if (maxWidth > 0 && input.width > maxWidth) {
+        scale = std::min(scale, static_cast<double>(maxWidth) / input.width);
+    }
+    if (maxHeight > 0 && input.height > maxHeight) {
+        scale = std::min(scale, static_cast<double>(maxHeight) / input.height);
+    }
+    if (scale >= 1.0) {
+        output = input;
+        return;
+    }
+
+    output.width = std::max(1, static_cast<int>(input.width * scale));
+    output.height = std::max(1, static_cast<int>(input.height * scale));
+    output.pixels.resize(static_cast<size_t>(output.width) * output.height * 3);
+
+    // 区域平均：每个输出像素取其覆盖的输入矩形的均值
+    uint8_t* out = output.pixels.data();
+    for (int oy = 0; oy < output.height; ++oy) {
+        const int y0 = static_cast<int>(static_cast<int64_t>(oy) * input.height / output.height);
+        const int y1 = std::max(y0 + 1, static_cast<int>(static_cast<int64_t>(oy + 1) * input.height / output.height));
+        for (int ox = 0; ox < output.width; ++ox) {
+            const int x0 = static_cast<int>(static_cast<int64_t>(ox) * input.width / output.width);
+            const int x1 = std::max(x0 + 1, static_cast<int>(static_cast<int64_t>(ox + 1) * input.width / output.width));
+            uint32_t sum[3] = {};
+            for (int y = y0; y < y1; ++y) {
+                const uint8_t* p = input.pixels.data() + (static_cast<size_t>(y) * input.width + x0) * 3;
+                for (int x = x0; x < x1; ++x, p += 3) {
+                    sum[0] += p[0];
+                    sum[1] += p[1];
+                    sum[2] += p[2];
+                }
+            }
+            const uint32_t count = static_cast<uint32_t>((y1 - y0) * (x1 - x0));
+            for (int c = 0; c < 3; ++c) {
+                *out++ = static_cast<uint8_t>((sum[c] + count / 2) / count);
+            }
+        }
+    }
+}
+
+bool encodePng(const RgbImage& image, std::vector<uint8_t>& out) {
+    if (image.width <= 0 || image.height <= 0 || image.pixels.empty()) {
+        return false;
+    }
+    static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.assign(kSignature, kSignature + 8);
+
+    std::vector<uint8_t> header;
+    putBigEndian32(header, static_cast<uint32_t>(image.width));
+    putBigEndian32(header, static_cast<uint32_t>(image.height));
+    header.push_back(8);    // 位深
+    header.push_back(2);    // 真彩色RGB
+    header.push_back(0);    // deflate
+    header.push_back(0);    // 自适应滤波
+    header.push_back(0);    // 不隔行
+    writeChunk(out, "IHDR", header.data(), header.size());
+
+    std::vector<uint8_t> filtered;
+    filterRows(image, filtered);
+    std::vector<uint8_t> compressed;
+    compressed.reserve(filtered.size() / 2);
+    zlibCompress(filtered, compressed);
+    writeChunk(out, "IDAT", compressed.data(), compressed.size());
+    writeChunk(out, "IEND", nullptr, 0);
+    return true;
+}
+
+bool encodeJpeg(const RgbImage& image, int quality, std::vector<uint8_t>& out) {
+    if (image.width <= 0 || image.height <= 0 || image.width > 65535 || image.height > 65535 ||
+        image.pixels.empty()) {
+        return false;
+    }
+
+    // 质量缩放与IJG一致
+    quality = std::min(100, std::max(1, quality));
+    const int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    uint8_t quant[2][64];
+    for (int i = 0; i < 64; ++i) {
+        quant[0][i] = static_cast<uint8_t>(std::min(255, std::max(1, (kLumaQuant[i] * scale + 50) / 100)));
+        quant[1][i] = static_cast<uint8_t>(std::min(255, std::max(1, (kChromaQuant[i] * scale + 50) / 100)));
+    }
+
+    out.clear();
+    out.push_back(0xFF);
+    out.push_back(0xD8);
+
+    // APP0 JFIF
+    static const uint8_t kJfif[] = {0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0x01, 0x01,
+                                    0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00};
+    out.insert(out.end(), kJfif, kJfif + sizeof(kJfif));
+
+    // DQT，按之字形顺序
+    out.push_back(0xFF);
+    out.push_back(0xDB);
+    putBigEndian16(out, 2 + 2 * 65);
+    for (int t = 0; t < 2; ++t) {
+        out.push_back(static_cast<uint8_t>(t));
+        for (int k = 0; k < 64; ++k) {
+            out.push_back(quant[t][kZigzag[k]]);
+        }
+    }
+
+    // SOF0：Y 2x2采样，Cb/Cr 1x1
+    out.push_back(0xFF);
+    out.push_back(0xC0);
+    putBigEndian16(out, 17);
+    out.push_back(8);
+    putBigEndian16(out, static_cast<uint32_t>(image.height));
+    putBigEndian16(out, static_cast<uint32_t>(image.width));
+    out.push_back(3);
+    static const uint8_t kComponents[9] = {1, 0x22, 0, 2, 0x11, 1, 3, 0x11, 1};
+    out.insert(out.end(), kComponents, kComponents + 9);
+
+    // DHT
+    std::vector<uint8_t> tables;
+    writeHuffmanSegment(tables, 0x00, kDcLumaBits, kDcValues);
+    writeHuffmanSegment(tables, 0x10, kAcLumaBits, kAcLumaValues);
+    writeHuffmanSegment(tables, 0x01, kDcChromaBits, kDcValues);
+    writeHuffmanSegment(tables, 0x11, kAcChromaBits, kAcChromaValues);
+    out.push_back(0xFF);
+    out.push_back(0xC4);
+    putBigEndian16(out, static_cast<uint32_t>(2 + tables.size()));
+    out.insert(out.end(), tables.begin(), tables.end());
+
+    // SOS
+    static const uint8_t kScan[] = {0xFF, 0xDA, 0x00, 0x0C, 3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0};
+    out.insert(out.end(), kScan, kScan + sizeof(kScan));
+
+    static const HuffmanTable dcLuma = buildHuffman(kDcLumaBits, kDcValues);
+    static const HuffmanTable acLuma = buildHuffman(kAcLumaBits, kAcLumaValues);
+    static const HuffmanTable dcChroma = buildHuffman(kDcChromaBits, kDcValues);
+    static const HuffmanTable acChroma = buildHuffman(kAcChromaBits, kAcChromaValues);
+
+    JpegBits bits(out);
+    int dcY = 0;
+    int dcCb = 0;
+    int dcCr = 0;
+    const int w = image.width;
+    const int h = image.height;
+
+    // 一个MCU为16x16像素：4个Y块和各1个2x2平均后的Cb/Cr块
+    float ys[4][64];
+    float cb[64];
+    float cr[64];
+    for (int my = 0; my < h; my += 16) {
+        for (int mx = 0; mx < w; mx += 16) {
+            float cbFull[16][16];
+            float crFull[16][16];
+            for (int y = 0; y < 16; ++y) {
+                const int sy = std::min(my + y, h - 1);
+                for (int x = 0; x < 16; ++x) {
+                    const int sx = std::min(mx + x, w - 1);
+                    const uint8_t* p = image.pixels.data() + (static_cast<size_t>(sy) * w + sx) * 3;
+                    const float r = p[0];
+                    const float g = p[1];
+                    const float b = p[2];
+                    ys[(y / 8) * 2 + x / 8][(y % 8) * 8 + x % 8] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+                    cbFull[y][x] = -0.168736f * r - 0.331264f * g + 0.5f * b;
+                    crFull[y][x] = 0.5f * r - 0.418688f * g - 0.081312f * b;
+                }
+            }
+            for (int y = 0; y < 8; ++y) {
+                for (int x = 0; x < 8; ++x) {
+                    cb[y * 8 + x] = 0.25f * (cbFull[2 * y][2 * x] + cbFull[2 * y][2 * x + 1] +
+                                             cbFull[2 * y + 1][2 * x] + cbFull[2 * y + 1][2 * x + 1]);
+                    cr[y * 8 + x] = 0.25f * (crFull[2 * y][2 * x] + crFull[2 * y][2 * x + 1] +
+                                             crFull[2 * y + 1][2 * x] + crFull[2 * y + 1][2 * x + 1]);
+                }
+            }
+            for (int b = 0; b < 4; ++b) {
+                encodeBlock(bits, ys[b], quant[0], dcY, dcLuma, acLuma);
+            }
+            encodeBlock(bits, cb, quant[1], dcCb, dcChroma, acChroma);
+            encodeBlock(bits, cr, quant[1], dcCr, dcChroma, acChroma);
+        }
+    }
+    bits.flush();
+
+    out.push_back(0xFF);
+    out.push_back(0xD9);
+    return true;
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,69 @@
+/**
+ * @file ImageEncoder.h
+ * @brief 截图用的PNG/JPEG编码与缩略图缩放
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了把视频帧转换为RGB图像、按比例缩小并编码为PNG或基线JPEG的函数，
+ * 不依赖外部图像库。PNG按行自适应选择滤波器，IDAT使用固定霍夫曼表的deflate；
+ * JPEG为4:2:0基线编码，使用标准量化表和霍夫曼表。
+ *
+ * @note
+ * - 这些函数只在截图工作线程中调用，会分配内存
+ * - YUV帧按BT.709有限范围转换为RGB；10位帧只在这里为编码图片换算到8位
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <cstdint>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 8位RGB图像，逐像素3字节紧密排列
+ */
+struct RgbImage {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * @brief 把视频帧转换为RGB图像
+ * @param[in] frame 视频帧（RGBA/I420/NV12/P010/I010）
+ * @param[out] image 输出图像
+ * @return false表示格式不支持或帧没有数据
+ */
+bool convertToRgb(const VideoFrame& frame, RgbImage& image);
+
+/**
+ * @brief 按比例缩小图像使其不超过给定尺寸（区域平均）
+ * @param[in] input 输入图像
+ * @param[in] maxWidth 最大宽度，0表示不限
+ * @param[in] maxHeight 最大高度，0表示不限
+ * @param[out] output 输出图像，不需要缩小时为输入的拷贝
+ */
+void downscaleRgb(const RgbImage& input, int maxWidth, int maxHeight, RgbImage& output);
+
+/**
+ * @brief 编码PNG
+ * @param[in] image 图像
+ * @param[out] out 编码结果
+ * @return false表示图像为空
+ */
+bool encodePng(const RgbImage& image, std::vector<uint8_t>& out);
+
+/**
+ * @brief 编码基线JPEG
+ * @param[in] image 图像
+ * @param[in] quality 质量（1~100）
+ * @param[out] out 编码结果
+ * @return false表示图像为空
+ */
+bool encodeJpeg(const RgbImage& image, int quality, std::vector<uint8_t>& out);
+
+} // namespace SimpleOBS
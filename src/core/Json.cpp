@@ -0,0 +1,473 @@
+/**
+ * @file Json.cpp
+ * @brief 轻量JSON值类型实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "Json.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace SimpleOBS {
+
+namespace {
+
+/// 嵌套深度上限，防止恶意输入耗尽栈
+constexpr int kMaxDepth = 64;
+
+/**
+ * @brief 递归下降解析器
+ */
+class Parser {
+public:
+    explicit Parser(const std::string& text) : text_(text) {}
+
+    bool parseDocument(JsonValue& value) {
+        skipSpace();
+        if (!parseValue(value, 0)) {
+            return false;
+        }
+        skipSpace();
+        if (pos_ != text_.size()) {
+            return fail("trailing characters");
+        }
+        return true;
+    }
+
+    const std::string& error() const { return error_; }
+
+private:
+    bool fail(const char* message) {
+        if (error_.empty()) {
+            error_ = std::string(message) + " at offset " + std::to_string(pos_);
+        }
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(const char* literal) {
+        size_t length = std::char_traits<char>::length(literal);
+        if (text_.compare(pos_, length, literal) != 0) {
+            return false;
+        }
+        pos_ += length;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, int depth) {
+        if (depth > kMaxDepth) {
+            return fail("nesting too deep");
+        }
+        if (pos_ >= text_.size()) {
+            return fail("unexpected end of input");
+        }
+
+        switch (text_[pos_]) {
+        case '{':
+            return parseObject(value, depth);
+        case '[':
+            return parseArray(value, depth);
+        case '"': {
+            std::string s;
+            if (!parseString(s)) {
+                return false;
+            }
+            value = JsonValue(std::move(s));
+            return true;
+        }
+        case 't':
+            if (consume("true")) {
+                value = JsonValue(true);
+                return true;
+            }
+            return fail("invalid literal");
+        case 'f':
+            if (consume("false")) {
+                value = JsonValue(false);
+                return true;
+            }
+            return fail("invalid literal");
+        case 'n':
+            if (consume("null")) {
+                value = JsonValue();
+                return true;
+            }
+            return fail("invalid literal");
+        default:
+            return parseNumber(value);
+        }
+    }
+
+    bool parseObject(JsonValue& value, int depth) {
+        ++pos_;
+        value = JsonValue::object();
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            ++pos_;
+            return true;
+        }
+        while (true) {
+            skipSpace();
+            if (pos_ >= text_.size() || text_[pos_] != '"') {
+                return fail("expected object key");
+            }
+            std::string key;
+            if (!parseString(key)) {
+                return false;
+            }
+            skipSpace();
+            if (pos_ >= text_.size() || text_[pos_] != ':') {
+                return fail("expected ':'");
+            }
+            ++pos_;
+            skipSpace();
+            JsonValue member;
+            if (!parseValue(member, depth + 1)) {
+                return false;
+            }
+            value.set(key, std::move(member));
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (pos_ < text_.size() && text_[pos_] == '}') {
+                ++pos_;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool parseArray(JsonValue& value, int depth) {
+        ++pos_;
+        value = JsonValue::array();
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            ++pos_;
+            return true;
+        }
+        while (true) {
+            skipSpace();
+            JsonValue item;
+            if (!parseValue(item, depth + 1)) {
+                return false;
+            }
+            value.push(std::move(item));
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (pos_ < text_.size() && text_[pos_] == ']') {
+                ++pos_;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    bool parseHex4(uint32_t& code) {
+        if (pos_ + 4 > text_.size()) {
+            return fail("truncated \\u escape");
+        }
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = text_[pos_++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                code |= static_cast<uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                code |= static_cast<uint32_t>(c - 'A' + 10);
+            } else {
+                return fail("invalid \\u escape");
+            }
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool parseString(std::string& out) {
+        ++pos_;
+        while (pos_ < text_.size()) {
+            char c = text_[pos_++];
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return fail("control character in string");
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                break;
+            }
+            char escape = text_[pos_++];
+            switch (escape) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t code = 0;
+                if (!parseHex4(code)) {
+                    return false;
+                }
+                // 代理对合并为一个码点
+                if (code >= 0xD800 && code <= 0xDBFF && text_.compare(pos_, 2, "\\u") == 0) {
+                    pos_ += 2;
+                    uint32_t low = 0;
+                    if (!parseHex4(low)) {
+                        return false;
+                    }
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return fail("invalid surrogate pair");
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default:
+                return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool parseNumber(JsonValue& value) {
+        size_t start = pos_;
+        if (pos_ < text_.size() && text_[pos_] == '-') {
+            ++pos_;
+        }
+        bool digits = false;
+        while (pos_ < text_.size() &&
+               ((text_[pos_] >= '0' && text_[pos_] <= '9') || text_[pos_] == '.' ||
+                text_[pos_] == 'e' || text_[pos_] == 'E' || text_[pos_] == '+' || text_[pos_] == '-')) {
+            digits = digits || (text_[pos_] >= '0' && text_[pos_] <= '9');
+            ++pos_;
+        }
+        if (!digits) {
+            pos_ = start;
+            return fail("unexpected character");
+        }
+
+        std::string number = text_.substr(start, pos_ - start);
+        char* end = nullptr;
+        double result = std::strtod(number.c_str(), &end);
+        if (end != number.c_str() + number.size()) {
+            pos_ = start;
+            return fail("invalid number");
+        }
+        value = JsonValue(result);
+        return true;
+    }
+
+    const std::string& text_;
+    size_t pos_ = 0;
+    std::string error_;
+};
+
+void dumpString(const std::string& s, std::string& out) {
+    out += '"';
+    for (char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+void dumpNumber(double number, std::string& out) {
+    if (!std::isfinite(number)) {
+        out += "null";
+        return;
+    }
+    char buf[32];
+    // 整数值不带小数部分输出，便于客户端按整数读取计数器
+    if (number == std::floor(number) && std::fabs(number) < 9.007199254740992e15) {
+        std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(number));
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.17g", number);
+    }
+    out += buf;
+}
+
+const JsonValue& nullValue() {
+    static const JsonValue value;
+    return value;
+}
+
+} // anonymous namespace
+
+JsonValue JsonValue::array() {
+    JsonValue value;
+    value.type_ = Type::Array;
+    return value;
+}
+
+JsonValue JsonValue::object() {
+    JsonValue value;
+    value.type_ = Type::Object;
+    return value;
+}
+
+bool JsonValue::parse(const std::string& text, JsonValue& value, std::string* error) {
+    Parser parser(text);
+    if (!parser.parseDocument(value)) {
+        if (error) {
+            *error = parser.error();
+        }
+        return false;
+    }
+    return true;
+}
+
+std::string JsonValue::dump() const {
+    std::string out;
+    dumpTo(out);
+    return out;
+}
+
+const std::string& JsonValue::asString() const {
+    static const std::string empty;
+    return isString() ? string_ : empty;
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const {
+    for (const auto& member : object_) {
+        if (member.first == key) {
+            return member.second;
+        }
+    }
+    return nullValue();
+}
+
+bool JsonValue::contains(const std::string& key) const {
+    for (const auto& member : object_) {
+        if (member.first == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+JsonValue& JsonValue::set(const std::string& key, JsonValue value) {
+    if (type_ != Type::Object) {
+        *this = object();
+    }
+    for (auto& member : object_) {
+        if (member.first == key) {
+            member.second = std::move(value);
+            return *this;
+        }
+    }
+    object_.emplace_back(key, std::move(value));
+    return *this;
+}
+
+JsonValue& JsonValue::push(JsonValue value) {
+    if (type_ != Type::Array) {
+        *this = array();
+    }
+    array_.push_back(std::move(value));
+    return *this;
+}
+
+std::string JsonValue::toString() const {
+    switch (type_) {
+    case Type::String:
+        return string_;
+    case Type::Null:
+        return std::string();
+    default:
+        return dump();
+    }
+}
+
+void JsonValue::dumpTo(std::string& out) const {
+    switch (type_) {
+    case Type::Null:
+        out += "null";
+        break;
+    case Type::Bool:
+        out += bool_ ? "true" : "false";
+        break;
+    case Type::Number:
+        dumpNumber(number_, out);
+        break;
+    case Type::String:
+        dumpString(string_, out);
+        break;
+    case Type::Array:
+        out += '[';
+        for (size_t i = 0; i < array_.size(); ++i) {
+            if (i) {
+                out += ',';
+            }
+            array_[i].dumpTo(out);
+        }
+        out += ']';
+        break;
+    case Type::Object:
+        out += '{';
+        for (size_t i = 0; i < object_.size(); ++i) {
+            if (i) {
+                out += ',';
+            }
+            dumpString(object_[i].first, out);
+            out += ':';
+            object_[i].second.dumpTo(out);
+        }
+        out += '}';
+        break;
+    }
+}
+
+} // namespace SimpleOBS
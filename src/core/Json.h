@@ -0,0 +1,137 @@
+/**
+ * @file Json.h
+ * @brief 轻量JSON值类型与解析/序列化
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了控制接口使用的最小JSON实现：支持null、布尔、数字、字符串、数组和对象，
+ * 对象保留键的插入顺序。只用于控制消息，不追求解析性能。
+ *
+ * @note
+ * - 数字统一保存为double
+ * - 字符串按UTF-8处理，\\u转义（含代理对）解码为UTF-8
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief JSON值
+ */
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    JsonValue() = default;
+    JsonValue(std::nullptr_t) {}
+    JsonValue(bool value) : type_(Type::Bool), bool_(value) {}
+    JsonValue(int value) : type_(Type::Number), number_(value) {}
+    JsonValue(int64_t value) : type_(Type::Number), number_(static_cast<double>(value)) {}
+    JsonValue(uint64_t value) : type_(Type::Number), number_(static_cast<double>(value)) {}
+    JsonValue(double value) : type_(Type::Number), number_(value) {}
+    JsonValue(const char* value) : type_(Type::String), string_(value) {}
+    JsonValue(std::string value) : type_(Type::String), string_(std::move(value)) {}
+
+    /**
+     * @brief 创建空数组
+     */
+    static JsonValue array();
+
+    /**
+     * @brief 创建空对象
+     */
+    static JsonValue object();
+
+    /**
+     * @brief 解析JSON文本
+     * @param[in] text JSON文本
+     * @param[out] value 解析结果
+     * @param[out] error 失败时的错误描述，可为nullptr
+     * @return true表示解析成功
+     */
+    static bool parse(const std::string& text, JsonValue& value, std::string* error = nullptr);
+
+    /**
+     * @brief 序列化为紧凑的JSON文本
+     * @return JSON文本
+     */
+    std::string dump() const;
+
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == Type::Null; }
+    bool isBool() const { return type_ == Type::Bool; }
+    bool isNumber() const { return type_ == Type::Number; }
+    bool isString() const { return type_ == Type::String; }
+    bool isArray() const { return type_ == Type::Array; }
+    bool isObject() const { return type_ == Type::Object; }
+
+    bool asBool(bool fallback = false) const { return isBool() ? bool_ : fallback; }
+    double asNumber(double fallback = 0.0) const { return isNumber() ? number_ : fallback; }
+    const std::string& asString() const;
+
+    /**
+     * @brief 数组元素
+     * @return 非数组时为空
+     */
+    const std::vector<JsonValue>& items() const { return array_; }
+
+    /**
+     * @brief 对象成员（按插入顺序）
+     * @return 非对象时为空
+     */
+    const std::vector<std::pair<std::string, JsonValue>>& members() const { return object_; }
+
+    /**
+     * @brief 查找对象成员
+     * @param[in] key 键
+     * @return 成员值，不存在或非对象时返回null值
+     */
+    const JsonValue& operator[](const std::string& key) const;
+
+    /**
+     * @brief 是否包含对象成员
+     * @param[in] key 键
+     */
+    bool contains(const std::string& key) const;
+
+    /**
+     * @brief 设置对象成员，已存在时覆盖
+     * @param[in] key 键
+     * @param[in] value 值
+     * @return 自身，便于链式调用
+     */
+    JsonValue& set(const std::string& key, JsonValue value);
+
+    /**
+     * @brief 追加数组元素
+     * @param[in] value 值
+     * @return 自身，便于链式调用
+     */
+    JsonValue& push(JsonValue value);
+
+    /**
+     * @brief 转为字符串表示
+     * @details 字符串原样返回，数字/布尔/null转为文本，数组和对象返回JSON文本
+     */
+    std::string toString() const;
+
+private:
+    void dumpTo(std::string& out) const;
+
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<JsonValue> array_;
+    std::vector<std::pair<std::string, JsonValue>> object_;
+};
+
+} // namespace SimpleOBS
@@ -0,0 +1,194 @@
+/**
+ * @file MemoryBudget.cpp
+ * @brief 引擎全局内存预算与按优先级淘汰实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "MemoryBudget.h"
+#include "Logger.h"
+#include <algorithm>
+
+namespace SimpleOBS {
+
+const char* memoryPriorityName(MemoryPriority priority) {
+    switch (priority) {
+    case MemoryPriority::Prefetch: return "prefetch";
+    case MemoryPriority::MipLevels: return "mip_levels";
+    case MemoryPriority::CachedImages: return "cached_images";
+    case MemoryPriority::Buffers: return "buffers";
+    case MemoryPriority::Required: return "required";
+    default: return "unknown";
+    }
+}
+
+void MemoryBudget::setLimit(uint64_t bytes) {
+    limit_.store(bytes, std::memory_order_relaxed);
+    LOG_INFO("Memory budget limit: {} MB", bytes >> 20);
+
+    uint64_t used = used_.load(std::memory_order_relaxed);
+    if (bytes == 0 || used <= bytes) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(evictMutex_);
+    uint64_t freed = evictBelow(MemoryPriority::Required, used - bytes);
+    if (used_.load(std::memory_order_relaxed) > bytes) {
+        LOG_WARN("Memory budget: usage {} MB still above new limit after evicting {} MB",
+                 used_.load(std::memory_order_relaxed) >> 20, freed >> 20);
+    }
+}
+
+MemoryBudget::SubsystemId MemoryBudget::registerSubsystem(const std::string& name, MemoryPriority priority,
+                                                          EvictCallback evict) {
+    std::lock_guard<std::mutex> lock(registerMutex_);
+    int count = subsystemCount_.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (subsystems_[i]->name == name) {
+            subsystems_[i]->priority = priority;
+            subsystems_[i]->evict = std::move(evict);
+            return i;
+        }
+    }
+    if (count == kMaxSubsystems) {
+        LOG_ERROR("Memory budget: too many subsystems, {} not registered", name);
+        return -1;
+    }
+
+    auto entry = std::make_unique<Subsystem>();
+    entry->name = name;
+    entry->priority = priority;
+    entry->evict = std::move(evict);
+    subsystems_[count] = std::move(entry);
+    subsystemCount_.store(count + 1, std::memory_order_release);
+    LOG_DEBUG("Memory budget: subsystem {} registered ({})", name, memoryPriorityName(priority));
+    return count;
+}
+
+void MemoryBudget::detachSubsystem(SubsystemId id) {
+    std::lock_guard<std::mutex> lock(registerMutex_);
+    if (Subsystem* entry = subsystem(id)) {
+        entry->evict = nullptr;
+    }
+}
+
+bool MemoryBudget::reserve(SubsystemId id, uint64_t bytes) {
+    Subsystem* entry = subsystem(id);
+    if (!entry) {
+        return false;
+    }
+
+    uint64_t limit = limit_.load(std::memory_order_relaxed);
+    uint64_t total = used_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (limit == 0 || total <= limit) {
+        updatePeak(peak_, total);
+        updatePeak(entry->peak, entry->used.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        return true;
+    }
+    used_.fetch_sub(bytes, std::memory_order_relaxed);
+
+    // 慢路径：按优先级淘汰比申请方更低的子系统，再重试一次
+    {
+        std::lock_guard<std::mutex> lock(evictMutex_);
+        uint64_t used = used_.load(std::memory_order_relaxed);
+        if (used + bytes > limit) {
+            evictBelow(entry->priority, used + bytes - limit);
+        }
+        total = used_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    }
+    if (total <= limit) {
+        updatePeak(peak_, total);
+        updatePeak(entry->peak, entry->used.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        return true;
+    }
+
+    used_.fetch_sub(bytes, std::memory_order_relaxed);
+    entry->failed.fetch_add(1, std::memory_order_relaxed);
+    failed_.fetch_add(1, std::memory_order_relaxed);
+    LOG_WARN("Memory budget: {} denied {} KB (used {} MB of {} MB)",
+             entry->name, bytes >> 10, used_.load(std::memory_order_relaxed) >> 20, limit >> 20);
+    return false;
+}
+
+void MemoryBudget::release(SubsystemId id, uint64_t bytes) {
+    Subsystem* entry = subsystem(id);
+    if (!entry) {
+        return;
+    }
+    entry->used.fetch_sub(bytes, std::memory_order_relaxed);
+    used_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+MemoryStats MemoryBudget::getStats() const {
+    MemoryStats stats;
+    stats.limit = limit_.load(std::memory_order_relaxed);
+    stats.used = used_.load(std::memory_order_relaxed);
+    stats.peak = peak_.load(std::memory_order_relaxed);
+    stats.evicted = evicted_.load(std::memory_order_relaxed);
+    stats.failed_reservations = failed_.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(registerMutex_);
+    int count = subsystemCount_.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        const Subsystem& entry = *subsystems_[i];
+        MemorySubsystemStats sub;
+        sub.name = entry.name;
+        sub.priority = static_cast<int>(entry.priority);
+        sub.used = entry.used.load(std::memory_order_relaxed);
+        sub.peak = entry.peak.load(std::memory_order_relaxed);
+        sub.evicted = entry.evicted.load(std::memory_order_relaxed);
+        sub.failed_reservations = entry.failed.load(std::memory_order_relaxed);
+        stats.subsystems.push_back(std::move(sub));
+    }
+    std::stable_sort(stats.subsystems.begin(), stats.subsystems.end(),
+                     [](const MemorySubsystemStats& a, const MemorySubsystemStats& b) {
+                         return a.priority < b.priority;
+                     });
+    return stats;
+}
+
+MemoryBudget::Subsystem* MemoryBudget::subsystem(SubsystemId id) const {
+    if (id < 0 || id >= subsystemCount_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return subsystems_[id].get();
+}
+
+void MemoryBudget::updatePeak(std::atomic<uint64_t>& peak, uint64_t value) {
+    uint64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t MemoryBudget::evictBelow(MemoryPriority priority, uint64_t bytes) {
+    // 持有登记锁调用回调，保证回调执行期间子系统不会注销
+    std::lock_guard<std::mutex> lock(registerMutex_);
+    int count = subsystemCount_.load(std::memory_order_acquire);
+    std::vector<Subsystem*> candidates;
+    for (int i = 0; i < count; ++i) {
+        Subsystem* entry = subsystems_[i].get();
+        if (entry->priority < priority && entry->priority != MemoryPriority::Required && entry->evict &&
+            entry->used.load(std::memory_order_relaxed) > 0) {
+            candidates.push_back(entry);
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Subsystem* a, const Subsystem* b) { return a->priority < b->priority; });
+
+    uint64_t freed = 0;
+    for (Subsystem* entry : candidates) {
+        if (freed >= bytes) {
+            break;
+        }
+        uint64_t released = entry->evict(bytes - freed);
+        if (released > 0) {
+            entry->evicted.fetch_add(released, std::memory_order_relaxed);
+            evicted_.fetch_add(released, std::memory_order_relaxed);
+            LOG_DEBUG("Memory budget: evicted {} KB from {}", released >> 10, entry->name);
+        }
+        freed += released;
+    }
+    return freed;
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,153 @@
+/**
+ * @file MemoryBudget.h
+ * @brief 引擎全局内存预算与按优先级淘汰
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了引擎范围的内存预算。帧池、图片缓存、mip层级、幻灯片预解码帧、
+ * 回放缓冲等子系统登记后，每次分配前通过reserve()申请额度，释放后release()归还。
+ * 总占用将超过上限时，按优先级从低到高调用各子系统的淘汰回调
+ * （预取 -> mip -> 缓存图片 -> 工作缓冲），仍不够则拒绝申请，
+ * 由申请方按失败处理，而不是让进程被OOM杀死。
+ *
+ * @note
+ * - 未超限时reserve()/release()只有原子操作，可在渲染线程调用
+ * - 淘汰过程串行执行，淘汰回调在申请线程上调用，回调中应释放内存并调用release()，
+ *   不能调用reserve()或registerSubsystem()
+ * - 申请方只能淘汰优先级低于自己的子系统；Required子系统从不被淘汰
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 子系统的淘汰优先级
+ * @details 数值越小越先被淘汰
+ */
+enum class MemoryPriority : int {
+    Prefetch = 0,       ///< 预取数据，随时可丢弃
+    MipLevels = 1,      ///< mip层级，可按需重新生成
+    CachedImages = 2,   ///< 已解码的图片缓存
+    Buffers = 3,        ///< 回放缓冲等工作缓冲，可缩短
+    Required = 4        ///< 帧池等必需内存，不可淘汰
+};
+
+/**
+ * @brief 获取优先级名称
+ * @param[in] priority 优先级
+ * @return 名称字符串
+ */
+const char* memoryPriorityName(MemoryPriority priority);
+
+/**
+ * @brief 引擎内存预算
+ */
+class MemoryBudget {
+public:
+    using SubsystemId = int;
+
+    /**
+     * @brief 淘汰回调
+     * @param bytes 希望释放的字节数
+     * @return 实际释放的字节数（回调内已调用release()归还）
+     */
+    using EvictCallback = std::function<uint64_t(uint64_t bytes)>;
+
+    MemoryBudget() = default;
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    /**
+     * @brief 设置内存上限
+     * @param[in] bytes 上限字节数，0表示不限制
+     *
+     * @note 新上限低于当前占用时立即按优先级淘汰可淘汰的子系统
+     */
+    void setLimit(uint64_t bytes);
+
+    /**
+     * @brief 获取内存上限
+     */
+    uint64_t getLimit() const { return limit_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 登记子系统
+     * @param[in] name 子系统名称
+     * @param[in] priority 淘汰优先级
+     * @param[in] evict 淘汰回调，Required子系统可为空
+     * @return 子系统ID；同名子系统已存在时返回已有ID
+     */
+    SubsystemId registerSubsystem(const std::string& name, MemoryPriority priority,
+                                  EvictCallback evict = nullptr);
+
+    /**
+     * @brief 注销子系统的淘汰回调
+     * @param[in] id 子系统ID
+     * @details 子系统销毁前调用，之后不会再被淘汰；占用统计保留
+     */
+    void detachSubsystem(SubsystemId id);
+
+    /**
+     * @brief 申请额度
+     * @param[in] id 子系统ID
+     * @param[in] bytes 字节数
+     * @return true表示已登记占用，false表示淘汰后仍超出上限
+     */
+    bool reserve(SubsystemId id, uint64_t bytes);
+
+    /**
+     * @brief 归还额度
+     * @param[in] id 子系统ID
+     * @param[in] bytes 字节数
+     */
+    void release(SubsystemId id, uint64_t bytes);
+
+    /**
+     * @brief 获取统计信息
+     * @return 统计快照，子系统按优先级排序
+     */
+    MemoryStats getStats() const;
+
+private:
+    struct Subsystem {
+        std::string name;
+        MemoryPriority priority = MemoryPriority::Required;
+        EvictCallback evict;
+        std::atomic<uint64_t> used{0};
+        std::atomic<uint64_t> peak{0};
+        std::atomic<uint64_t> evicted{0};
+        std::atomic<uint64_t> failed{0};
+    };
+
+    Subsystem* subsystem(SubsystemId id) const;
+    void updatePeak(std::atomic<uint64_t>& peak, uint64_t value);
+    uint64_t evictBelow(MemoryPriority priority, uint64_t bytes);
+
+    static constexpr int kMaxSubsystems = 64;
+
+    std::atomic<uint64_t> limit_{0};
+    std::atomic<uint64_t> used_{0};
+    std::atomic<uint64_t> peak_{0};
+    std::atomic<uint64_t> evicted_{0};
+    std::atomic<uint64_t> failed_{0};
+
+    // 子系统只增不删，下标即ID，热路径无需加锁
+    std::unique_ptr<Subsystem> subsystems_[kMaxSubsystems];
+    std::atomic<int> subsystemCount_{0};
+    mutable std::mutex registerMutex_;  ///< 保护登记和淘汰回调
+    std::mutex evictMutex_;             ///< 串行化淘汰过程
+};
+
+} // namespace SimpleOBS
@@ -0,0 +1,331 @@
+/**
+ * @file ModuleRegistry.cpp
+ * @brief 组件类型注册表与插件模块加载实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "ModuleRegistry.h"
+#include "Json.h"
+#include "Logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+const char* kindName(ModuleKind kind) {
+    switch (kind) {
+    case ModuleKind::Source: return "source";
+    case ModuleKind::Encoder: return "encoder";
+    case ModuleKind::Output: return "output";
+    case ModuleKind::Filter: return "filter";
+    default: return "unknown";
+    }
+}
+
+const std::vector<std::string>& providedIds(const ModuleDescriptor& module, ModuleKind kind) {
+    switch (kind) {
+    case ModuleKind::Source: return module.sources;
+    case ModuleKind::Encoder: return module.encoders;
+    case ModuleKind::Output: return module.outputs;
+    default: return module.filters;
+    }
+}
+
+bool readIdList(const JsonValue& manifest, const char* key, std::vector<std::string>& ids) {
+    const JsonValue& list = manifest[key];
+    if (list.isNull()) {
+        return true;
+    }
+    if (!list.isArray()) {
+        return false;
+    }
+    for (const auto& id : list.items()) {
+        if (!id.isString() || id.asString().empty()) {
+            return false;
+        }
+        ids.push_back(id.asString());
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+void ModuleRegistry::registerSource(const std::string& id, SourceFactory factory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sources_[id] = std::move(factory);
+}
+
+void ModuleRegistry::registerEncoder(const std::string& id, EncoderFactory factory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    encoders_[id] = std::move(factory);
+}
+
+void ModuleRegistry::registerOutput(const std::string& id, OutputFactory factory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    outputs_[id] = std::move(factory);
+}
+
+void ModuleRegistry::registerFilter(const std::string& id, FilterFactory factory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    filters_[id] = std::move(factory);
+}
+
+bool ModuleRegistry::addModule(ModuleDescriptor module) {
+    if (module.name.empty() || (!module.load && module.library.empty())) {
+        LOG_ERROR("Module descriptor invalid: '{}' has no loader", module.name);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t index = modules_.size();
+    for (int k = 0; k < static_cast<int>(ModuleKind::Count); ++k) {
+        for (const auto& id : providedIds(module, static_cast<ModuleKind>(k))) {
+            auto result = providers_[k].emplace(id, index);
+            if (!result.second) {
+                LOG_WARN("Module {}: {} type '{}' already provided by {}, ignored",
+                         module.name, kindName(static_cast<ModuleKind>(k)), id,
+                         modules_[result.first->second].descriptor.name);
+            }
+        }
+    }
+    LOG_DEBUG("Module registered (not loaded): {}", module.name);
+    modules_.push_back(Module{std::move(module)});
+    return true;
+}
+
+bool ModuleRegistry::addPluginManifest(const std::string& manifestPath) {
+    std::ifstream file(manifestPath);
+    if (!file) {
+        LOG_ERROR("Cannot open plugin manifest {}", manifestPath);
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+
+    JsonValue manifest;
+    std::string error;
+    if (!JsonValue::parse(text.str(), manifest, &error) || !manifest.isObject()) {
+        LOG_ERROR("Plugin manifest {} invalid: {}", manifestPath, error.empty() ? "not an object" : error);
+        return false;
+    }
+
+    ModuleDescriptor module;
+    module.name = manifest["name"].asString();
+    const std::string& library = manifest["library"].asString();
+    int apiVersion = static_cast<int>(manifest["api_version"].asNumber(kModuleApiVersion));
+    if (module.name.empty() || library.empty()) {
+        LOG_ERROR("Plugin manifest {} must have 'name' and 'library'", manifestPath);
+        return false;
+    }
+    if (apiVersion != kModuleApiVersion) {
+        LOG_ERROR("Plugin {} targets module API {}, engine provides {}", module.name, apiVersion, kModuleApiVersion);
+        return false;
+    }
+    if (!readIdList(manifest, "sources", module.sources) || !readIdList(manifest, "encoders", module.encoders) ||
+        !readIdList(manifest, "outputs", module.outputs) || !readIdList(manifest, "filters", module.filters)) {
+        LOG_ERROR("Plugin manifest {}: type lists must be arrays of strings", manifestPath);
+        return false;
+    }
+
+    // 库路径相对于清单所在目录
+    std::filesystem::path libraryPath(library);
+    if (libraryPath.is_relative()) {
+        libraryPath = std::filesystem::path(manifestPath).parent_path() / libraryPath;
+    }
+    module.library = libraryPath.string();
+    return addModule(std::move(module));
+}
+
+size_t ModuleRegistry::scanPluginDirectory(const std::string& directory) {
+    std::error_code ec;
+    std::vector<std::string> manifests;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".json") {
+            manifests.push_back(entry.path().string());
+        }
+    }
+    if (ec) {
+        LOG_WARN("Cannot scan plugin directory {}: {}", directory, ec.message());
+        return 0;
+    }
+
+    // 按文件名排序，保证同名类型的优先级与目录遍历顺序无关
+    std::sort(manifests.begin(), manifests.end());
+    size_t count = 0;
+    for (const auto& manifest : manifests) {
+        count += addPluginManifest(manifest) ? 1 : 0;
+    }
+    LOG_INFO("Plugin directory {}: {} plugins registered", directory, count);
+    return count;
+}
+
+template <typename Factory>
+Factory ModuleRegistry::lookup(ModuleKind kind, const std::map<std::string, Factory>& factories,
+                               const std::string& id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = factories.find(id);
+    if (it != factories.end()) {
+        return it->second;
+    }
+
+    auto& providers = providers_[static_cast<int>(kind)];
+    auto provider = providers.find(id);
+    if (provider == providers.end()) {
+        return nullptr;
+    }
+    size_t index = provider->second;
+    if (!ensureLoaded(index, lock)) {
+        return nullptr;
+    }
+
+    it = factories.find(id);
+    if (it == factories.end()) {
+        LOG_ERROR("Module {} loaded but did not register {} type '{}'",
+                  modules_[index].descriptor.name, kindName(kind), id);
+        return nullptr;
+    }
+    return it->second;
+}
+
+bool ModuleRegistry::ensureLoaded(size_t moduleIndex, std::unique_lock<std::mutex>& lock) {
+    // 加载函数会回调register*，因此加载时不能持有锁；其他线程等待加载结果
+    loadedCv_.wait(lock, [&] { return !modules_[moduleIndex].loading; });
+    if (modules_[moduleIndex].loaded || modules_[moduleIndex].failed) {
+        return modules_[moduleIndex].loaded;
+    }
+
+    modules_[moduleIndex].loading = true;
+    ModuleDescriptor descriptor = modules_[moduleIndex].descriptor;
+    lock.unlock();
+
+    auto start = std::chrono::steady_clock::now();
+    void* handle = nullptr;
+    bool ok;
+    if (descriptor.library.empty()) {
+        ok = descriptor.load(*this);
+    } else {
+        handle = loadLibrary(descriptor);
+        ok = handle != nullptr;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    lock.lock();
+    Module& module = modules_[moduleIndex];
+    module.loading = false;
+    module.loaded = ok;
+    module.failed = !ok;
+    module.handle = handle;
+    loadedCv_.notify_all();
+
+    if (ok) {
+        LOG_INFO("Module loaded on first use: {} ({} us)", descriptor.name, elapsed.count());
+    } else {
+        LOG_ERROR("Module failed to load: {}", descriptor.name);
+    }
+    return ok;
+}
+
+void* ModuleRegistry::loadLibrary(const ModuleDescriptor& descriptor) {
+#ifdef _WIN32
+    LOG_ERROR("Plugin {}: dynamic plugins are not supported on this platform", descriptor.name);
+    return nullptr;
+#else
+    void* handle = dlopen(descriptor.library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        LOG_ERROR("Plugin {}: dlopen failed: {}", descriptor.name, dlerror());
+        return nullptr;
+    }
+
+    using VersionFunc = int (*)();
+    using LoadFunc = bool (*)(ModuleRegistry*);
+    auto version = reinterpret_cast<VersionFunc>(dlsym(handle, "simpleobs_module_api_version"));
+    auto load = reinterpret_cast<LoadFunc>(dlsym(handle, "simpleobs_module_load"));
+    if (!version || !load) {
+        LOG_ERROR("Plugin {}: missing simpleobs_module_api_version/simpleobs_module_load", descriptor.name);
+        dlclose(handle);
+        return nullptr;
+    }
+    if (version() != kModuleApiVersion) {
+        LOG_ERROR("Plugin {}: module API {} does not match engine API {}",
+                  descriptor.name, version(), kModuleApiVersion);
+        dlclose(handle);
+        return nullptr;
+    }
+    if (!load(this)) {
+        LOG_ERROR("Plugin {}: simpleobs_module_load returned false", descriptor.name);
+        // 加载函数可能已注册了部分工厂，库不能卸载
+        return nullptr;
+    }
+    return handle;
+#endif
+}
+
+SourcePtr ModuleRegistry::createSource(const std::string& id, const std::string& name) {
+    auto factory = lookup(ModuleKind::Source, sources_, id);
+    return factory ? factory(name) : nullptr;
+}
+
+EncoderPtr ModuleRegistry::createEncoder(const std::string& id, const std::string& name) {
+    auto factory = lookup(ModuleKind::Encoder, encoders_, id);
+    return factory ? factory(name) : nullptr;
+}
+
+OutputPtr ModuleRegistry::createOutput(const std::string& id, const std::string& name) {
+    auto factory = lookup(ModuleKind::Output, outputs_, id);
+    return factory ? factory(name) : nullptr;
+}
+
+FilterPtr ModuleRegistry::createFilter(const std::string& id, const std::string& name) {
+    auto factory = lookup(ModuleKind::Filter, filters_, id);
+    return factory ? factory(name) : nullptr;
+}
+
+std::vector<std::string> ModuleRegistry::getTypes(ModuleKind kind) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::set<std::string> ids;
+    auto collect = [&](const auto& factories) {
+        for (const auto& entry : factories) {
+            ids.insert(entry.first);
+        }
+    };
+    switch (kind) {
+    case ModuleKind::Source: collect(sources_); break;
+    case ModuleKind::Encoder: collect(encoders_); break;
+    case ModuleKind::Output: collect(outputs_); break;
+    case ModuleKind::Filter: collect(filters_); break;
+    default: break;
+    }
+    if (kind != ModuleKind::Count) {
+        collect(providers_[static_cast<int>(kind)]);
+    }
+    return std::vector<std::string>(ids.begin(), ids.end());
+}
+
+std::vector<ModuleStatus> ModuleRegistry::getModules() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ModuleStatus> modules;
+    modules.reserve(modules_.size());
+    for (const auto& module : modules_) {
+        ModuleStatus status;
+        status.name = module.descriptor.name;
+        status.library = module.descriptor.library;
+        status.loaded = module.loaded;
+        status.failed = module.failed;
+        modules.push_back(std::move(status));
+    }
+    return modules;
+}
+
+} // namespace SimpleOBS
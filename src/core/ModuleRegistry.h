@@ -0,0 +1,195 @@
+/**
+ * @file ModuleRegistry.h
+ * @brief 组件类型注册表与插件模块加载
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了Engine::create*使用的类型注册表。组件按类型ID注册工厂函数；
+ * 模块（内置的一组组件或外部插件）只登记它提供哪些类型ID，
+ * 第一次创建其中某个类型时才加载模块并注册真正的工厂。
+ * 外部插件通过清单文件（*.json）描述，启动时只读取清单，
+ * 共享库在第一次用到其类型时才dlopen。
+ *
+ * @note
+ * - 启动时不加载、不初始化当前节目用不到的编解码器和输出模块
+ * - 插件加载后不会卸载，其创建的对象可以一直存活到进程退出
+ * - 所有接口线程安全；模块加载期间其他线程创建同一模块的类型会等待加载完成
+ *
+ * 插件清单示例（plugins/foo.json）：
+ * @code
+ * {
+ *   "name": "foo",
+ *   "library": "libfoo.so",
+ *   "api_version": 1,
+ *   "sources": ["foo_capture"],
+ *   "outputs": ["foo_stream"]
+ * }
+ * @endcode
+ * 插件库需导出：
+ * @code
+ * extern "C" int simpleobs_module_api_version();
+ * extern "C" bool simpleobs_module_load(SimpleOBS::ModuleRegistry* registry);
+ * @endcode
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SimpleOBS {
+
+class ModuleRegistry;
+
+/// 插件接口版本，插件导出的版本不一致时拒绝加载
+constexpr int kModuleApiVersion = 1;
+
+/**
+ * @brief 组件类别
+ */
+enum class ModuleKind {
+    Source,
+    Encoder,
+    Output,
+    Filter,
+    Count
+};
+
+/**
+ * @brief 模块描述
+ */
+struct ModuleDescriptor {
+    std::string name;                           ///< 模块名称
+    std::vector<std::string> sources;           ///< 提供的源类型ID
+    std::vector<std::string> encoders;          ///< 提供的编码器类型ID
+    std::vector<std::string> outputs;           ///< 提供的输出类型ID
+    std::vector<std::string> filters;           ///< 提供的滤镜类型ID
+    std::string library;                        ///< 外部插件的共享库路径，内置模块为空
+    std::function<bool(ModuleRegistry&)> load;  ///< 内置模块的加载函数，负责注册工厂
+};
+
+/**
+ * @brief 模块状态
+ */
+struct ModuleStatus {
+    std::string name;       ///< 模块名称
+    std::string library;    ///< 共享库路径，内置模块为空
+    bool loaded = false;    ///< 是否已加载
+    bool failed = false;    ///< 是否加载失败
+};
+
+/**
+ * @brief 组件类型注册表
+ */
+class ModuleRegistry {
+public:
+    using SourceFactory = std::function<SourcePtr(const std::string& name)>;
+    using EncoderFactory = std::function<EncoderPtr(const std::string& name)>;
+    using OutputFactory = std::function<OutputPtr(const std::string& name)>;
+    using FilterFactory = std::function<FilterPtr(const std::string& name)>;
+
+    ModuleRegistry() = default;
+    ModuleRegistry(const ModuleRegistry&) = delete;
+    ModuleRegistry& operator=(const ModuleRegistry&) = delete;
+
+    /**
+     * @name 注册工厂
+     * @details 立即可用；同一ID重复注册时后者覆盖前者
+     * @{
+     */
+    void registerSource(const std::string& id, SourceFactory factory);
+    void registerEncoder(const std::string& id, EncoderFactory factory);
+    void registerOutput(const std::string& id, OutputFactory factory);
+    void registerFilter(const std::string& id, FilterFactory factory);
+    /** @} */
+
+    /**
+     * @brief 登记延迟加载的模块
+     * @param[in] module 模块描述，load与library至少有一个
+     * @return true表示登记成功，false表示描述无效
+     *
+     * @note 只记录类型ID到模块的映射，不执行加载
+     */
+    bool addModule(ModuleDescriptor module);
+
+    /**
+     * @brief 扫描插件目录中的清单文件并登记插件
+     * @param[in] directory 目录路径
+     * @return 登记的插件数量
+     */
+    size_t scanPluginDirectory(const std::string& directory);
+
+    /**
+     * @brief 读取单个插件清单并登记插件
+     * @param[in] manifestPath 清单文件路径
+     * @return true表示登记成功
+     */
+    bool addPluginManifest(const std::string& manifestPath);
+
+    /**
+     * @name 按类型ID创建组件
+     * @details 类型所属模块尚未加载时先加载；不存在的类型返回nullptr
+     * @{
+     */
+    SourcePtr createSource(const std::string& id, const std::string& name);
+    EncoderPtr createEncoder(const std::string& id, const std::string& name);
+    OutputPtr createOutput(const std::string& id, const std::string& name);
+    FilterPtr createFilter(const std::string& id, const std::string& name);
+    /** @} */
+
+    /**
+     * @brief 列出某类别所有可用的类型ID（含未加载模块提供的）
+     * @param[in] kind 组件类别
+     * @return 排序后的类型ID
+     */
+    std::vector<std::string> getTypes(ModuleKind kind) const;
+
+    /**
+     * @brief 获取所有模块的状态
+     * @return 模块状态列表
+     */
+    std::vector<ModuleStatus> getModules() const;
+
+private:
+    struct Module {
+        ModuleDescriptor descriptor;
+        bool loading = false;
+        bool loaded = false;
+        bool failed = false;
+        void* handle = nullptr;     ///< dlopen句柄，不关闭
+    };
+
+    template <typename Factory>
+    Factory lookup(ModuleKind kind, const std::map<std::string, Factory>& factories, const std::string& id);
+    bool ensureLoaded(size_t moduleIndex, std::unique_lock<std::mutex>& lock);
+    void* loadLibrary(const ModuleDescriptor& descriptor);
+
+    mutable std::mutex mutex_;
+    std::condition_variable loadedCv_;
+    std::map<std::string, SourceFactory> sources_;
+    std::map<std::string, EncoderFactory> encoders_;
+    std::map<std::string, OutputFactory> outputs_;
+    std::map<std::string, FilterFactory> filters_;
+    std::vector<Module> modules_;
+    std::map<std::string, size_t> providers_[static_cast<int>(ModuleKind::Count)];  ///< 类型ID -> 模块下标
+};
+
+/**
+ * @name 内置模块
+ * @details 由各组件库实现，应用程序在引擎初始化前调用，只登记不加载
+ * @{
+ */
+void registerSourceModules(ModuleRegistry& registry);
+void registerEncoderModules(ModuleRegistry& registry);
+void registerOutputModules(ModuleRegistry& registry);
+void registerFilterModules(ModuleRegistry& registry);
+/** @} */
+
+} // namespace SimpleOBS
@@ -0,0 +1,126 @@
+/**
+ * @file MpscQueue.h
+ * @brief 多生产者单消费者有界无锁队列
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了固定容量的MPSC无锁队列模板（基于每槽序号的有界数组队列）。
+ * 生产者之间通过一次CAS竞争写入位置，消费者只写自己的读索引，
+ * 适合让控制线程向渲染线程投递命令：双方都不会阻塞，也不会调用内存分配。
+ *
+ * @note
+ * - 容量在构造时向上取整为2的幂，之后不再分配内存
+ * - 允许任意多个线程调用push，只允许一个线程调用pop
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace SimpleOBS {
+
+/**
+ * @brief MPSC有界无锁队列
+ * @tparam T 元素类型，需可默认构造和移动赋值
+ */
+template <typename T>
+class MpscQueue {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] capacity 最小容量（元素个数），至少为2
+     */
+    explicit MpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells_.reset(new Cell[size]);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief 获取容量
+     * @return 元素个数
+     */
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * @brief 写入一个元素（任意线程）
+     * @param[in] value 元素
+     * @return true表示写入成功，false表示队列已满
+     */
+    bool push(T value) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 读取一个元素（仅消费者线程）
+     * @param[out] value 读出的元素
+     * @return true表示读取成功，false表示队列为空（或队首元素尚未写完）
+     */
+    bool pop(T& value) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell* cell = &cells_[pos & mask_];
+        if (cell->sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        dequeuePos_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 队列是否为空
+     * @return true表示没有已写入或正在写入的元素（跨线程调用时为近似值）
+     */
+    bool empty() const {
+        return enqueuePos_.load(std::memory_order_acquire) ==
+               dequeuePos_.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) std::atomic<size_t> dequeuePos_{0};
+};
+
+} // namespace SimpleOBS
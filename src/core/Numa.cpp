@@ -0,0 +1,169 @@
+/**
+ * @file Numa.cpp
+ * @brief NUMA拓扑查询、内存绑定与线程绑核实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "Numa.h"
+#include "Logger.h"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+// 与<numaif.h>一致，直接使用系统调用以免链接libnuma
+constexpr int kMpolBind = 2;
+constexpr unsigned kMpolMfMove = 1u << 1;
+constexpr unsigned long kMpolFNode = 1ul << 0;
+constexpr unsigned long kMpolFAddr = 1ul << 1;
+
+/**
+ * @brief 解析sysfs的列表格式，如"0-3,8-11"
+ */
+std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream ranges(text);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int v = first; v <= last; ++v) {
+                values.push_back(v);
+            }
+        } catch (const std::exception&) {
+            return {};
+        }
+    }
+    return values;
+}
+
+std::string readLine(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+constexpr const char* kSysfsNodeRoot = "/sys/devices/system/node";
+
+struct Topology {
+    explicit Topology(const std::string& root) {
+        std::vector<int> online = parseList(readLine(root + "/online"));
+        int maxNode = 0;
+        for (int node : online) {
+            maxNode = std::max(maxNode, node);
+        }
+        cpus.resize(static_cast<size_t>(maxNode) + 1);
+        for (int node : online) {
+            cpus[node] = parseList(readLine(root + "/node" + std::to_string(node) + "/cpulist"));
+        }
+        nodes = online.empty() ? 1 : maxNode + 1;
+        LOG_DEBUG("NUMA topology from {}: {} nodes", root, nodes);
+    }
+
+    int nodes = 1;
+    std::vector<std::vector<int>> cpus;
+};
+
+std::unique_ptr<const Topology>& topologyInstance() {
+    static std::unique_ptr<const Topology> instance = std::make_unique<const Topology>(kSysfsNodeRoot);
+    return instance;
+}
+
+const Topology& topology() {
+    return *topologyInstance();
+}
+
+} // anonymous namespace
+
+void setNumaTopologyRoot(const std::string& root) {
+    topologyInstance() = std::make_unique<const Topology>(root.empty() ? kSysfsNodeRoot : root);
+}
+
+int numaNodeCount() {
+    return topology().nodes;
+}
+
+const std::vector<int>& numaNodeCpus(int node) {
+    static const std::vector<int> empty;
+    const Topology& t = topology();
+    return node >= 0 && node < static_cast<int>(t.cpus.size()) ? t.cpus[node] : empty;
+}
+
+int currentNumaNode() {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 && static_cast<int>(node) < numaNodeCount()) {
+        return static_cast<int>(node);
+    }
+#endif
+    return 0;
+}
+
+bool bindMemoryToNode(void* addr, size_t length, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node < 0 || node >= numaNodeCount() || node >= 64) {
+        return false;
+    }
+    unsigned long mask = 1ul << node;
+    return syscall(SYS_mbind, addr, length, kMpolBind, &mask, sizeof(mask) * 8, kMpolMfMove) == 0;
+#else
+    (void)addr;
+    (void)length;
+    (void)node;
+    return false;
+#endif
+}
+
+int numaNodeOfAddress(void* addr) {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0ul, addr, kMpolFNode | kMpolFAddr) == 0) {
+        return node;
+    }
+#else
+    (void)addr;
+#endif
+    return -1;
+}
+
+bool pinThreadToNode(int node) {
+#if defined(__linux__)
+    const std::vector<int>& cpus = numaNodeCpus(node);
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,82 @@
+/**
+ * @file Numa.h
+ * @brief NUMA拓扑查询、内存绑定与线程绑核
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件提供帧池和渲染线程使用的NUMA辅助函数。拓扑从/sys/devices/system/node读取，
+ * 内存绑定直接使用mbind系统调用，不依赖libnuma。
+ * 在非NUMA机器、非Linux平台或容器屏蔽了相关接口时，退化为单节点（节点0），
+ * 绑定操作返回false，调用方照常运行。
+ *
+ * @note
+ * - 拓扑在首次调用时读取并缓存
+ * - 可用内核参数numa=fake=2在单路机器上模拟多节点，
+ *   或用setNumaTopologyRoot()从伪造的sysfs目录读取拓扑（测试用）
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 从指定目录重新读取NUMA拓扑
+ * @param[in] root 与/sys/devices/system/node结构相同的目录（online、nodeN/cpulist），
+ *                 为空时恢复读取系统目录
+ *
+ * @note 用于在任意机器上测试多节点行为；只能在创建帧池、启动引擎线程之前调用，
+ *       之前由numaNodeCpus()返回的引用在调用后失效
+ */
+void setNumaTopologyRoot(const std::string& root);
+
+/**
+ * @brief 获取在线NUMA节点数
+ * @return 节点数，至少为1
+ */
+int numaNodeCount();
+
+/**
+ * @brief 获取节点上的CPU编号
+ * @param[in] node 节点编号
+ * @return CPU编号列表，节点不存在时为空
+ */
+const std::vector<int>& numaNodeCpus(int node);
+
+/**
+ * @brief 获取调用线程当前所在的节点
+ * @return 节点编号，无法获取时返回0
+ */
+int currentNumaNode();
+
+/**
+ * @brief 把一段内存的物理页限定在指定节点上
+ * @param[in] addr 起始地址（按页对齐）
+ * @param[in] length 字节数
+ * @param[in] node 节点编号
+ * @return true表示绑定成功
+ *
+ * @note 应在首次触页前调用，已分配的页会被迁移（MPOL_MF_MOVE）
+ */
+bool bindMemoryToNode(void* addr, size_t length, int node);
+
+/**
+ * @brief 查询一页内存实际所在的节点
+ * @param[in] addr 地址（该页必须已触页）
+ * @return 节点编号，无法获取时返回-1
+ */
+int numaNodeOfAddress(void* addr);
+
+/**
+ * @brief 把调用线程限定在指定节点的CPU上运行
+ * @param[in] node 节点编号
+ * @return true表示绑定成功
+ */
+bool pinThreadToNode(int node);
+
+} // namespace SimpleOBS
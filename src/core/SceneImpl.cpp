@@ -17,11 +17,31 @@
  */
 
 #include "SceneImpl.h"
+#include "EventBus.h"
 #include "Logger.h"
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
 
 namespace SimpleOBS {
 
+namespace {
+
+// 每个音频块最多从单个源拉取的次数，防止异常源拖住渲染线程
+constexpr int kMaxAudioPullsPerBlock = 16;
+
+// 重采样临时缓冲区每声道容量（采样点）
+constexpr int kResampleBufferSamples = 4 * kMaxAudioBlockSize;
+
+// 活动源超过该时长凑不够一个音频块即视为停顿
+constexpr FrameTime kSourceStallTimeout(500000);
+
+// 全局画布写入序号，任何场景写入画布或画布被重新分配时递增
+std::atomic<uint64_t> gCanvasWrites{1};
+
+} // namespace
+
 /**
  * @brief 构造函数
  * @param[in] name 场景名称
@@ -29,6 +49,7 @@ namespace SimpleOBS {
  */
 SceneImpl::SceneImpl(const std::string& name)
     : name_(name), initialized_(false) {
+    setAudioSettings(AudioSettings{});
     LOG_DEBUG("SceneImpl constructed: {}", name_);
 }
 
@@ -89,10 +110,15 @@ void SceneImpl::shutdown() {
 
     LOG_INFO("SceneImpl shutting down: {}", name_);
 
-    // Stop all sources
-    for (auto& source : sources_) {
-        if (source && source->isActive()) {
-            source->stop();
+    if (shown_.load(std::memory_order_acquire) > 0) {
+        shown_.store(1, std::memory_order_release);
+        hide();
+    }
+    // 停止其余手动启动的源，仍在其他场景中显示的源除外
+    for (auto& item : items_) {
+        if (item->source && item->source->isActive() &&
+            !(activation_ && activation_->isVisible(item->source.get()))) {
+            item->source->stop();
         }
     }
 
@@ -118,13 +144,31 @@ void SceneImpl::addSource(SourcePtr source) {
     }
 
     // Check if already exists
-    auto it = std::find(sources_.begin(), sources_.end(), source);
-    if (it != sources_.end()) {
+    auto it = std::find_if(items_.begin(), items_.end(),
+                           [&](const auto& item) { return item->source == source; });
+    if (it != items_.end()) {
         LOG_WARN("SceneImpl source already exists: {}", source->getName());
         return;
     }
 
-    sources_.push_back(source);
+    auto item = std::make_unique<SceneItem>();
+    item->source = source;
+    item->content.bind(source->getName(), &Engine::getInstance().getEventBus());
+    item->content.setSettings(contentSettings_);
+    item->frameRate.setEngineInterval(frameInterval_);
+    item->frameRate.setMode(frameRateMode_);
+    configureItemAudio(*item);
+    bool shown;
+    {
+        std::lock_guard<std::mutex> lock(itemsMutex_);
+        items_.push_back(std::move(item));
+        shown = isShown();
+    }
+    layers_.reserve(items_.size());
+    if (shown && activation_) {
+        activation_->show(source);
+    }
+    Engine::getInstance().getEventBus().publish(EventType::SourceAdded, source->getName().c_str());
     LOG_INFO("SceneImpl added source: {} to scene: {}", source->getName(), name_);
 }
 
@@ -145,18 +189,45 @@ void SceneImpl::removeSource(SourcePtr source) {
         return;
     }
 
-    auto it = std::find(sources_.begin(), sources_.end(), source);
-    if (it != sources_.end()) {
-        // Stop source
-        if (source->isActive()) {
+    auto it = std::find_if(items_.begin(), items_.end(),
+                           [&](const auto& item) { return item->source == source; });
+    if (it != items_.end()) {
+        if (canvasItem_ == it->get()) {
+            canvasItem_ = nullptr;
+        }
+        std::unique_ptr<SceneItem> removed;
+        bool shown;
+        {
+            std::lock_guard<std::mutex> lock(itemsMutex_);
+            removed = std::move(*it);
+            items_.erase(it);
+            shown = isShown();
+        }
+        // 显示中的场景撤销对源的引用；否则停止源，仍在其他场景中显示的源除外
+        if (shown && activation_) {
+            activation_->hide(source);
+        } else if (source->isActive() && !(activation_ && activation_->isVisible(source.get()))) {
             source->stop();
         }
-
-        sources_.erase(it);
+        Engine::getInstance().getEventBus().publish(EventType::SourceRemoved, source->getName().c_str());
         LOG_INFO("SceneImpl removed source: {} from scene: {}", source->getName(), name_);
     }
 }
 
+/**
+ * @brief 按名称查找源
+ * @param[in] name 源名称
+ * @return 源的智能指针，不存在时返回nullptr
+ */
+SourcePtr SceneImpl::findSource(const std::string& name) const {
+    for (const auto& item : items_) {
+        if (item->source && item->source->getName() == name) {
+            return item->source;
+        }
+    }
+    return nullptr;
+}
+
 /**
  * @brief 渲染视频帧
  * @param[out] frame 输出的合成视频帧
@@ -171,46 +242,870 @@ void SceneImpl::removeSource(SourcePtr source) {
  * @note 线程安全，使用互斥锁保护
  */
 bool SceneImpl::render(VideoFrame& frame) {
-    if (!initialized_ || sources_.empty()) {
+    if (!initialized_ || items_.empty()) {
         return false;
     }
 
-    // Simple rendering logic: render first active source
-    for (auto& source : sources_) {
-        if (source && source->isActive()) {
-            return source->getVideoFrame(frame);
+    const FrameTime now = currentFrameTime();
+    const VideoFrame canvas = frame;
+
+    if (needsCompositing(canvas)) {
+        if (!compositeItems(frame, now)) {
+            return false;
+        }
+        // 直通时输出指向源的缓冲区，此时没有场景级滤镜，不能复制回画布
+        return frame.data[0] != canvas.data[0] || applySceneFilters(frame, canvas);
+    }
+
+    // 单个源：直接把源画面作为输出
+    for (auto& item : items_) {
+        if (item->source && item->source->isActive()) {
+            bool unchanged = false;
+            if (frame.data[0]) {
+                // 调用方提供了画布帧（来自引擎帧池），把源画面复制进去
+                VideoFrame source{};
+                if (!pullVideo(*item, source, now, unchanged) ||
+                    (source.format != frame.format && !convertLayer(*item, source, frame.format))) {
+                    return false;
+                }
+                // 带透明像素的RGBA源要叠加到黑底上，不能直通
+                if (canPassThrough(source, frame) && isOpaqueLayer(source)) {
+                    passThrough(*item, source, frame);
+                    return true;
+                }
+                if (unchanged && canReuseCanvas(*item, frame)) {
+                    // 画布中已是同一源逐字节相同的画面，跳过复制
+                    frame.timestamp = source.timestamp;
+                    item->content.countSkippedComposite();
+                    return true;
+                }
+                if (!copySingleLayer(*item, source, frame)) {
+                    canvasItem_ = nullptr;
+                    return false;
+                }
+                canvasItem_ = filters_.empty() ? item.get() : nullptr;
+                canvasData_ = frame.data[0];
+                canvasWrite_ = gCanvasWrites.fetch_add(1, std::memory_order_relaxed) + 1;
+            } else if (!pullVideo(*item, frame, now, unchanged)) {
+                return false;
+            }
+            return applySceneFilters(frame, canvas);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief 拉取源的当前画面
+ * @param[in,out] item 源条目
+ * @param[out] frame 经过帧率转换和源级滤镜的画面
+ * @param[in] now 当前节拍时刻
+ * @param[out] unchanged 画面是否与上一帧逐字节相同
+ * @return false表示源没有画面
+ */
+bool SceneImpl::pullVideo(SceneItem& item, VideoFrame& frame, FrameTime now, bool& unchanged) {
+    if (!item.source->getVideoFrame(frame)) {
+        return false;
+    }
+    item.frameRate.process(frame, now);
+    for (auto& filter : item.filters) {
+        filter->processVideoFrame(frame);
+    }
+    unchanged = item.content.analyzeVideo(frame, now);
+    return true;
+}
+
+/**
+ * @brief 直接交出源的缓冲区作为输出，不合成也不复制
+ * @param[in,out] item 源条目
+ * @param[in] source 源画面
+ * @param[in,out] frame 画布帧，返回时指向源画面
+ */
+void SceneImpl::passThrough(SceneItem& item, const VideoFrame& source, VideoFrame& frame) {
+    for (int plane = 0; plane < 4; ++plane) {
+        frame.data[plane] = source.data[plane];
+        frame.linesize[plane] = source.linesize[plane];
+    }
+    frame.timestamp = source.timestamp;
+    canvasItem_ = nullptr;
+    item.content.countPassthrough();
+}
+
+/**
+ * @brief 把格式与画布不一致的源画面转换为画布格式
+ * @param[in,out] item 源条目，转换缓冲区属于该条目
+ * @param[in,out] layer 源画面，成功时指向转换结果
+ * @param[in] format 画布格式
+ * @return false表示格式不支持、缓冲区尚未就绪或分配失败，本帧跳过该源
+ *
+ * @details 缓冲区按源画面的尺寸由后台线程分配，尺寸和格式不变时复用，渲染线程不分配内存。
+ *          第一次需要转换时记录一条警告，逐帧转换有额外开销，源应尽量输出画布格式
+ */
+bool SceneImpl::convertLayer(SceneItem& item, VideoFrame& layer, int format) {
+    if (!item.convertWarned) {
+        LOG_WARN("SceneImpl {}: source {} format {} does not match canvas format {}, converting every frame",
+                 name_, item.source->getName(), layer.format, format);
+        item.convertWarned = true;
+    }
+    FramePoolSettings settings;
+    settings.width = layer.width;
+    settings.height = layer.height;
+    settings.format = format;
+    settings.frames = 1;
+    FramePool* pool = item.convertPool.prepare(settings);
+    if (!pool) {
+        return false;
+    }
+    if (pool != item.convertedPool) {
+        // 换入了新的缓冲区，之前取出的帧随旧缓冲区一起失效
+        item.convertedPool = nullptr;
+        if (!pool->acquire(item.converted)) {
+            return false;
         }
+        item.convertedPool = pool;
+    }
+    if (!convertVideoFrame(item.converted, layer)) {
+        return false;
     }
+    layer = item.converted;
+    return true;
+}
 
+/**
+ * @brief 把唯一的活动源画面写入画布
+ * @param[in] item 源条目，位于画布原点且不透明度、混合模式为默认值
+ * @param[in] source 格式与画布相同的源画面
+ * @param[in,out] frame 画布帧
+ * @return false表示写入失败
+ *
+ * @details 盖满画布且不透明时直接复制；源比画布小时先清屏，否则画布上残留上一帧的内容；
+ *          RGBA源带透明像素时清屏后按alpha叠加到黑底上，不把源的alpha复制进输出
+ */
+bool SceneImpl::copySingleLayer(const SceneItem& item, const VideoFrame& source, VideoFrame& frame) {
+    if (coversCanvas(item, source, frame) && isOpaqueLayer(source)) {
+        return copyVideoFrame(frame, source);
+    }
+    if (!clearVideoFrame(frame)) {
+        return false;
+    }
+    const bool drawn = frame.format == kVideoFormatRGBA
+                           ? compositeLayer(frame, source, 0, 0, blendSpace_, BlendMode::Normal, 255)
+                           : blitLayer(frame, source, 0, 0);
+    frame.timestamp = source.timestamp;
+    return drawn;
+}
+
+/**
+ * @brief 判断能否把源画面直接作为输出
+ * @param[in] source 经过帧率转换和源级滤镜的源画面
+ * @param[in] canvas 本次的画布帧
+ * @return true表示可以直通
+ *
+ * @details 要求没有场景级滤镜（滤镜会就地修改源的缓冲区），且源画面的格式和尺寸与画布相同，
+ *          此时复制进画布的结果与源画面逐字节相同
+ */
+bool SceneImpl::canPassThrough(const VideoFrame& source, const VideoFrame& canvas) const {
+    return filters_.empty() && source.data[0] && source.format == canvas.format &&
+           source.width == canvas.width && source.height == canvas.height;
+}
+
+/**
+ * @brief 判断本次渲染是否需要多层合成
+ * @param[in] canvas 调用方提供的画布帧
+ * @return true表示画布上有多个活动源，或唯一的活动源不在画布原点、不透明度或混合模式不是默认值
+ */
+bool SceneImpl::needsCompositing(const VideoFrame& canvas) const {
+    if (!canvas.data[0]) {
+        return false;
+    }
+    int active = 0;
+    for (const auto& item : items_) {
+        if (item->source && item->source->isActive()) {
+            if (++active > 1 || item->x != 0 || item->y != 0 || !item->plainBlend()) {
+                return true;
+            }
+        }
+    }
     return false;
 }
 
+/**
+ * @brief 判断层在画布中的位置是否覆盖整个画布
+ */
+bool SceneImpl::coversCanvas(const SceneItem& item, const VideoFrame& layer, const VideoFrame& canvas) const {
+    // 与blitLayer一致，色度下采样格式的坐标向下取整到偶数
+    const int mask = canvas.format == kVideoFormatRGBA ? ~0 : ~1;
+    const int x = item.x & mask;
+    const int y = item.y & mask;
+    return x <= 0 && y <= 0 && x + layer.width >= canvas.width && y + layer.height >= canvas.height;
+}
+
+/**
+ * @brief 把所有活动源按顺序叠加到画布上
+ * @param[in,out] canvas 画布帧
+ * @param[in] now 当前节拍时刻
+ * @return false表示没有任何源输出画面
+ *
+ * @details
+ * 1. 从最上层往下拉取各源的画面（帧率转换、源级滤镜），遇到覆盖整个画布的不透明层即停止，
+ *    其下的源被完全遮挡，不拉取、不处理也不合成
+ * 2. 只剩一层且与画布格式、尺寸相同时直通输出
+ * 3. 否则从下往上叠加：RGBA画布按alpha、各源的不透明度和混合模式混合；
+ *    YUV画布上的源没有alpha，按不透明度逐平面插值（不透明时直接复制），不经过RGB往返；
+ *    最底层不透明且覆盖整个画布时不清屏，并直接复制
+ * 4. 输出时间戳为参与合成的最早采集时间
+ *
+ * @note 格式与画布不一致的源画面先转换为画布格式，无法转换时被跳过
+ */
+bool SceneImpl::compositeItems(VideoFrame& canvas, FrameTime now) {
+    layers_.clear();
+    const bool blend = canvas.format == kVideoFormatRGBA;
+    bool covered = false;
+    for (auto it = items_.rbegin(); it != items_.rend(); ++it) {
+        SceneItem& item = **it;
+        if (!item.source || !item.source->isActive()) {
+            continue;
+        }
+        if (covered) {
+            item.content.countCulled();
+            continue;
+        }
+        VideoFrame layer{};
+        bool unchanged;
+        if (!pullVideo(item, layer, now, unchanged)) {
+            continue;
+        }
+        if (layer.format != canvas.format && !convertLayer(item, layer, canvas.format)) {
+            continue;
+        }
+        layers_.push_back({&item, layer});
+        // 与下面的绘制一致：YUV画布只看不透明度，RGBA画布还要求普通混合且每个像素不透明
+        covered = coversCanvas(item, layer, canvas) &&
+                  (blend ? item.plainBlend() && isOpaqueLayer(layer) : item.opacity == 255);
+    }
+    if (layers_.empty()) {
+        return false;
+    }
+
+    const ItemLayer& bottom = layers_.back();
+    if (layers_.size() == 1 && covered && bottom.item->x == 0 && bottom.item->y == 0 &&
+        canPassThrough(bottom.frame, canvas)) {
+        passThrough(*bottom.item, bottom.frame, canvas);
+        return true;
+    }
+
+    if (!covered && !clearVideoFrame(canvas)) {
+        return false;
+    }
+    canvasItem_ = nullptr;
+    canvasWrite_ = gCanvasWrites.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    FrameTime oldest = FrameTime::max();
+    for (auto it = layers_.rbegin(); it != layers_.rend(); ++it) {
+        if (!blend) {
+            fadeLayer(canvas, it->frame, it->item->x, it->item->y, it->item->opacity);
+        } else if (covered && it == layers_.rbegin()) {
+            blitLayer(canvas, it->frame, it->item->x, it->item->y);
+        } else {
+            compositeLayer(canvas, it->frame, it->item->x, it->item->y, blendSpace_, it->item->blendMode,
+                           it->item->opacity);
+        }
+        oldest = std::min(oldest, it->frame.timestamp);
+    }
+    canvas.timestamp = oldest;
+    return true;
+}
+
+/**
+ * @brief 应用场景级滤镜
+ * @param[in,out] frame 渲染结果
+ * @param[in] canvas 调用方提供的画布帧，未提供时data[0]为空
+ * @return false表示复制回画布失败
+ *
+ * @details 滤镜把输出指向了自己的内存（如延迟滤镜）时，画布帧要归还引擎帧池，复制回画布
+ */
+bool SceneImpl::applySceneFilters(VideoFrame& frame, const VideoFrame& canvas) {
+    for (auto& filter : filters_) {
+        filter->processVideoFrame(frame);
+    }
+    if (canvas.data[0] && frame.data[0] != canvas.data[0]) {
+        const VideoFrame filtered = frame;
+        frame = canvas;
+        return copyVideoFrame(frame, filtered);
+    }
+    return true;
+}
+
 /**
  * @brief 渲染音频帧
  * @param[out] frame 输出的合成音频帧
  * @return true表示渲染成功，false表示渲染失败
  *
  * @details
- * 1. 从所有源获取音频帧
- * 2. 混合所有音频数据
- * 3. 应用场景级别的音频处理
- * 4. 输出最终的合成音频帧
+ * 1. 从所有活动源拉取音频，转换为引擎采样率和声道布局
+ * 2. 每个源按引擎块大小切分后累加到混音缓冲区
+ * 3. 对混音结果依次应用场景级音频滤镜
+ * 4. 输出时间戳为参与混音的最早采集时间，用于端到端延迟统计
  *
- * @note 线程安全，使用互斥锁保护
+ * @note 数据尚不足一个块的源本次不参与混音，其数据保留到下一块
  */
 bool SceneImpl::render(AudioFrame& frame) {
-    if (!initialized_ || sources_.empty()) {
+    if (!initialized_ || items_.empty()) {
         return false;
     }
 
-    // Simple audio rendering logic: render first active source
-    for (auto& source : sources_) {
-        if (source && source->isActive()) {
-            return source->getAudioFrame(frame);
+    const int block = audioSettings_.block_size;
+    const int channels = audioSettings_.channels;
+    std::fill(mixBuffer_.begin(), mixBuffer_.end(), 0.0f);
+
+    float* mix[kMaxAudioChannels] = {};
+    for (int c = 0; c < channels; ++c) {
+        mix[c] = mixBuffer_.data() + static_cast<size_t>(c) * block;
+    }
+
+    bool anyActive = false;
+    bool mixed = false;
+    FrameTime oldest = FrameTime::max();
+    const FrameTime now = currentFrameTime();
+
+    for (auto& item : items_) {
+        if (!item->source || !item->source->isActive()) {
+            continue;
         }
+        anyActive = true;
+
+        if (!fillItemAudio(*item)) {
+            checkItemStall(*item, now);
+            continue;
+        }
+        if (item->stalled) {
+            item->stalled = false;
+            Engine::getInstance().getEventBus().publish(EventType::SourceResumed,
+                                                        item->source->getName().c_str(),
+                                                        (now - item->lastAudio).count());
+        }
+        item->lastAudio = now;
+
+        oldest = std::min(oldest, item->queue.frontTimestamp());
+        item->queue.popMix(mix, block);
+        mixed = true;
+    }
+
+    if (!anyActive) {
+        return false;
+    }
+
+    for (int c = 0; c < kMaxAudioChannels; ++c) {
+        frame.data[c] = mix[c];
+    }
+    frame.samples = block;
+    frame.sample_rate = audioSettings_.sample_rate;
+    frame.channels = channels;
+    frame.timestamp = mixed ? oldest : now;
+
+    for (auto& filter : filters_) {
+        filter->processAudioFrame(frame);
+    }
+
+    return true;
+}
+
+/**
+ * @brief 设置内容检测配置
+ * @param[in] settings 配置，对已有和之后加入的源生效
+ */
+void SceneImpl::setContentSettings(const ContentSettings& settings) {
+    contentSettings_ = settings;
+    for (auto& item : items_) {
+        item->content.setSettings(settings);
+    }
+}
+
+/**
+ * @brief 获取各源的内容检测统计
+ * @return 按场景中源的顺序排列的统计
+ */
+std::vector<ContentStats> SceneImpl::getContentStats() const {
+    std::vector<ContentStats> stats;
+    stats.reserve(items_.size());
+    for (const auto& item : items_) {
+        stats.push_back(item->content.getStats());
     }
+    return stats;
+}
 
+/**
+ * @brief 设置场景属性
+ * @param[in] key 属性名，支持frame_rate_mode、blend_space，以及position、opacity、blend_mode加".<源名称>"
+ * @param[in] value 属性值，位置为"x,y"，不透明度为0~255
+ * @return false表示属性不支持或取值无效
+ */
+bool SceneImpl::setProperty(const std::string& key, const std::string& value) {
+    if (key == "frame_rate_mode") {
+        FrameRateMode mode;
+        if (!parseFrameRateMode(value, mode)) {
+            return false;
+        }
+        setFrameRateMode(mode);
+        return true;
+    }
+    if (key == "blend_space") {
+        BlendSpace space;
+        if (!parseBlendSpace(value, space)) {
+            return false;
+        }
+        setBlendSpace(space);
+        return true;
+    }
+    const std::string positionPrefix = "position.";
+    if (key.compare(0, positionPrefix.size(), positionPrefix) == 0) {
+        int x;
+        int y;
+        char extra;
+        if (std::sscanf(value.c_str(), "%d,%d%c", &x, &y, &extra) != 2) {
+            return false;
+        }
+        return setSourcePosition(key.substr(positionPrefix.size()), x, y);
+    }
+    const std::string opacityPrefix = "opacity.";
+    if (key.compare(0, opacityPrefix.size(), opacityPrefix) == 0) {
+        int opacity;
+        char extra;
+        if (std::sscanf(value.c_str(), "%d%c", &opacity, &extra) != 1) {
+            return false;
+        }
+        return setSourceOpacity(key.substr(opacityPrefix.size()), opacity);
+    }
+    const std::string modePrefix = "blend_mode.";
+    if (key.compare(0, modePrefix.size(), modePrefix) == 0) {
+        BlendMode mode;
+        if (!parseBlendMode(value, mode)) {
+            return false;
+        }
+        // YUV画布按平面插值，只支持普通混合
+        if (mode != BlendMode::Normal && Engine::getInstance().getVideoSettings().format != kVideoFormatRGBA) {
+            LOG_ERROR("SceneImpl {}: blend mode {} requires an RGBA canvas", name_, value);
+            return false;
+        }
+        return setSourceBlendMode(key.substr(modePrefix.size()), mode);
+    }
     return false;
 }
 
+/**
+ * @brief 设置引擎视频帧间隔
+ * @param[in] interval 帧间隔，对已有和之后加入的源生效
+ */
+void SceneImpl::setFrameInterval(FrameTime interval) {
+    frameInterval_ = interval;
+    for (auto& item : items_) {
+        item->frameRate.setEngineInterval(interval);
+    }
+}
+
+/**
+ * @brief 设置帧率转换方式
+ * @param[in] mode 转换方式，对已有和之后加入的源生效
+ */
+void SceneImpl::setFrameRateMode(FrameRateMode mode) {
+    frameRateMode_ = mode;
+    for (auto& item : items_) {
+        item->frameRate.setMode(mode);
+    }
+    LOG_INFO("SceneImpl frame rate mode of scene {}: {}", name_, frameRateModeName(mode));
+}
+
+/**
+ * @brief 获取各源的帧率转换统计
+ * @return 按场景中源的顺序排列的统计
+ */
+std::vector<FrameRateStats> SceneImpl::getFrameRateStats() const {
+    std::vector<FrameRateStats> stats;
+    stats.reserve(items_.size());
+    for (const auto& item : items_) {
+        stats.push_back(item->frameRate.getStats());
+    }
+    return stats;
+}
+
+/**
+ * @brief 设置多源合成的混合空间
+ * @param[in] space 混合空间
+ */
+void SceneImpl::setBlendSpace(BlendSpace space) {
+    blendSpace_ = space;
+    LOG_INFO("SceneImpl blend space of scene {}: {}", name_, blendSpaceName(space));
+}
+
+/**
+ * @brief 设置源在画布中的位置
+ * @param[in] source 源名称
+ * @param[in] x 左上角横坐标，可为负
+ * @param[in] y 左上角纵坐标，可为负
+ * @return false表示源不存在
+ */
+bool SceneImpl::setSourcePosition(const std::string& source, int x, int y) {
+    SceneItem* item = findItem(source);
+    if (!item) {
+        return false;
+    }
+    item->x = x;
+    item->y = y;
+    return true;
+}
+
+/**
+ * @brief 设置源的整体不透明度
+ * @param[in] source 源名称
+ * @param[in] opacity 不透明度（0~255），并入每像素的混合权重
+ * @return false表示源不存在或取值无效
+ */
+bool SceneImpl::setSourceOpacity(const std::string& source, int opacity) {
+    SceneItem* item = findItem(source);
+    if (!item || opacity < 0 || opacity > 255) {
+        return false;
+    }
+    item->opacity = opacity;
+    return true;
+}
+
+/**
+ * @brief 设置源的混合模式
+ * @param[in] source 源名称
+ * @param[in] mode 混合模式
+ * @return false表示源不存在
+ */
+bool SceneImpl::setSourceBlendMode(const std::string& source, BlendMode mode) {
+    SceneItem* item = findItem(source);
+    if (!item) {
+        return false;
+    }
+    item->blendMode = mode;
+    return true;
+}
+
+/**
+ * @brief 场景开始被显示
+ *
+ * @details 嵌套计数从0变1时对场景中每个源计数加一，未运行的源在此启动，当前节拍即可拉取画面。
+ *          在控制线程或截图提交线程中调用，计数和源列表快照在同一把锁内取得，
+ *          与渲染线程执行的增删源互不遗漏；源的启动在锁外进行
+ */
+void SceneImpl::show() {
+    std::vector<SourcePtr> sources;
+    {
+        std::lock_guard<std::mutex> lock(itemsMutex_);
+        if (shown_.fetch_add(1, std::memory_order_acq_rel) > 0 || !activation_) {
+            return;
+        }
+        sources.reserve(items_.size());
+        for (const auto& item : items_) {
+            sources.push_back(item->source);
+        }
+    }
+    for (const auto& source : sources) {
+        activation_->show(source);
+    }
+}
+
+/**
+ * @brief 撤销一次show()
+ *
+ * @details 嵌套计数从1变0时对场景中每个源计数减一，不再被任何场景显示的源被停止
+ */
+void SceneImpl::hide() {
+    std::vector<SourcePtr> sources;
+    {
+        std::lock_guard<std::mutex> lock(itemsMutex_);
+        const int shown = shown_.load(std::memory_order_acquire);
+        if (shown == 0) {
+            return;
+        }
+        shown_.store(shown - 1, std::memory_order_release);
+        if (shown > 1 || !activation_) {
+            return;
+        }
+        sources.reserve(items_.size());
+        for (const auto& item : items_) {
+            sources.push_back(item->source);
+        }
+    }
+    for (const auto& source : sources) {
+        activation_->hide(source);
+    }
+}
+
+/**
+ * @brief 使所有场景记住的画布内容失效
+ */
+void SceneImpl::invalidateCanvases() {
+    gCanvasWrites.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 判断画布是否仍保存着该源上一帧的合成结果
+ * @param[in] item 源条目
+ * @param[in] canvas 本次的画布帧
+ * @return true表示可以跳过合成
+ *
+ * @details 要求上一次写入画布的是同一源且未经场景滤镜、画布缓冲区相同（帧池LIFO复用），
+ *          且此后没有任何场景写入过画布；哈希为抽样计算时不跳过
+ */
+bool SceneImpl::canReuseCanvas(const SceneItem& item, const VideoFrame& canvas) const {
+    return canvasItem_ == &item && filters_.empty() && canvasData_ == canvas.data[0] &&
+           canvasWrite_ == gCanvasWrites.load(std::memory_order_relaxed) && item.content.exactHash();
+}
+
+/**
+ * @brief 添加场景级滤镜
+ * @param[in] filter 要添加的滤镜
+ */
+void SceneImpl::addFilter(FilterPtr filter) {
+    if (!filter) {
+        return;
+    }
+    if (std::find(filters_.begin(), filters_.end(), filter) != filters_.end()) {
+        return;
+    }
+    filters_.push_back(filter);
+    LOG_INFO("SceneImpl added filter: {} to scene: {}", filter->getName(), name_);
+}
+
+/**
+ * @brief 移除场景级滤镜
+ * @param[in] filter 要移除的滤镜
+ */
+void SceneImpl::removeFilter(FilterPtr filter) {
+    auto it = std::find(filters_.begin(), filters_.end(), filter);
+    if (it != filters_.end()) {
+        filters_.erase(it);
+        LOG_INFO("SceneImpl removed filter: {} from scene: {}", filter->getName(), name_);
+    }
+}
+
+/**
+ * @brief 添加源级滤镜
+ * @param[in] source 源名称
+ * @param[in] filter 要添加的滤镜
+ * @return false表示源不存在或该源已有同名滤镜
+ *
+ * @details 源级滤镜在合成和混音之前处理源的画面和声音；
+ *          滤镜可以把输出帧的数据指针指向自己的内存，在下一次调用前有效
+ */
+bool SceneImpl::addSourceFilter(const std::string& source, FilterPtr filter) {
+    SceneItem* item = findItem(source);
+    if (!item || !filter) {
+        return false;
+    }
+    for (const auto& existing : item->filters) {
+        if (existing->getName() == filter->getName()) {
+            return false;
+        }
+    }
+    item->filters.push_back(std::move(filter));
+    LOG_INFO("SceneImpl added filter: {} to source: {}", item->filters.back()->getName(), source);
+    return true;
+}
+
+/**
+ * @brief 按名称移除滤镜
+ * @param[in] source 源名称，为空时移除场景级滤镜
+ * @param[in] name 滤镜名称
+ * @return 被移除的滤镜，由调用方在渲染线程之外释放；不存在时返回nullptr
+ */
+FilterPtr SceneImpl::removeFilter(const std::string& source, const std::string& name) {
+    std::vector<FilterPtr>* filters = &filters_;
+    if (!source.empty()) {
+        SceneItem* item = findItem(source);
+        if (!item) {
+            return nullptr;
+        }
+        filters = &item->filters;
+    }
+    auto it = std::find_if(filters->begin(), filters->end(),
+                           [&name](const FilterPtr& filter) { return filter->getName() == name; });
+    if (it == filters->end()) {
+        return nullptr;
+    }
+    FilterPtr filter = std::move(*it);
+    filters->erase(it);
+    LOG_INFO("SceneImpl removed filter: {} from scene: {}", name, name_);
+    return filter;
+}
+
+/**
+ * @brief 按名称查找滤镜
+ * @param[in] source 源名称，为空时查找场景级滤镜
+ * @param[in] name 滤镜名称
+ * @return 滤镜，不存在时返回nullptr
+ */
+FilterPtr SceneImpl::findFilter(const std::string& source, const std::string& name) const {
+    const std::vector<FilterPtr>* filters = &filters_;
+    if (!source.empty()) {
+        const SceneItem* item = findItem(source);
+        if (!item) {
+            return nullptr;
+        }
+        filters = &item->filters;
+    }
+    for (const auto& filter : *filters) {
+        if (filter->getName() == name) {
+            return filter;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 取出源的所有源级滤镜
+ * @param[in] source 源名称
+ * @return 滤镜列表，源不存在时为空
+ */
+std::vector<FilterPtr> SceneImpl::takeSourceFilters(const std::string& source) {
+    SceneItem* item = findItem(source);
+    if (!item) {
+        return {};
+    }
+    std::vector<FilterPtr> filters = std::move(item->filters);
+    item->filters.clear();
+    return filters;
+}
+
+/**
+ * @brief 按源名称查找条目
+ */
+SceneItem* SceneImpl::findItem(const std::string& source) const {
+    for (const auto& item : items_) {
+        if (item->source && item->source->getName() == source) {
+            return item.get();
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 设置混音格式
+ * @param[in] settings 引擎音频配置
+ *
+ * @details 重新分配混音缓冲区并重置所有源的重采样和分块状态
+ */
+void SceneImpl::setAudioSettings(const AudioSettings& settings) {
+    audioSettings_ = settings;
+    mixBuffer_.assign(static_cast<size_t>(settings.channels) * settings.block_size, 0.0f);
+    resampleCapacity_ = kResampleBufferSamples;
+    resampleBuffer_.assign(static_cast<size_t>(settings.channels) * resampleCapacity_, 0.0f);
+
+    for (auto& item : items_) {
+        configureItemAudio(*item);
+    }
+}
+
+/**
+ * @brief 配置源条目的分块队列
+ * @param[in,out] item 源条目
+ */
+void SceneImpl::configureItemAudio(SceneItem& item) {
+    const int capacity = std::max(8 * audioSettings_.block_size, 2 * kMaxAudioBlockSize);
+    item.queue.configure(audioSettings_.channels, audioSettings_.sample_rate, capacity);
+    item.sourceRate = 0;
+}
+
+/**
+ * @brief 检查源是否停顿
+ * @param[in,out] item 源条目
+ * @param[in] now 当前时间
+ *
+ * @details 只检查已经提供过音频的源，纯视频源不会被误报；
+ * 每次停顿只发布一次事件，恢复时发布恢复事件
+ */
+void SceneImpl::checkItemStall(SceneItem& item, FrameTime now) {
+    if (item.stalled || item.sourceRate == 0) {
+        return;
+    }
+    if (item.lastAudio.count() == 0) {
+        item.lastAudio = now;
+        return;
+    }
+    if (now - item.lastAudio > kSourceStallTimeout) {
+        item.stalled = true;
+        Engine::getInstance().getEventBus().publish(EventType::SourceStalled,
+                                                    item.source->getName().c_str(),
+                                                    (now - item.lastAudio).count());
+    }
+}
+
+/**
+ * @brief 从源拉取音频直到队列中至少有一个块
+ * @param[in,out] item 源条目
+ * @return true表示队列中已有一个完整的块
+ *
+ * @details
+ * 拉取前在帧中填入引擎的块大小和采样率作为期望格式，源无需为此访问Engine；
+ * 源的声道按索引映射到引擎声道，声道不足时重复最后一个声道；
+ * 采样率不同的源先经过重采样器再进入队列。
+ */
+bool SceneImpl::fillItemAudio(SceneItem& item) {
+    const int block = audioSettings_.block_size;
+    const int channels = audioSettings_.channels;
+
+    for (int pulls = 0; item.queue.available() < block && pulls < kMaxAudioPullsPerBlock; ++pulls) {
+        AudioFrame in{};
+        in.samples = block;
+        in.sample_rate = audioSettings_.sample_rate;
+        if (!item.source->getAudioFrame(in) || in.samples <= 0 || in.channels <= 0 ||
+            in.sample_rate <= 0) {
+            break;
+        }
+        for (auto& filter : item.filters) {
+            filter->processAudioFrame(in);
+        }
+        item.content.analyzeAudio(in, currentFrameTime());
+
+        if (in.sample_rate != item.sourceRate) {
+            item.resampler.configure(in.sample_rate, audioSettings_.sample_rate, channels);
+            item.sourceRate = in.sample_rate;
+        }
+
+        const float* mapped[kMaxAudioChannels] = {};
+        for (int c = 0; c < channels; ++c) {
+            mapped[c] = in.data[std::min(c, std::min(in.channels, kMaxAudioChannels) - 1)];
+            if (!mapped[c]) {
+                mapped[c] = in.data[0];
+            }
+        }
+        if (!mapped[0]) {
+            break;
+        }
+
+        if (item.resampler.isPassthrough()) {
+            item.queue.push(mapped, in.samples, in.timestamp);
+            continue;
+        }
+
+        // 分段重采样，保证每段输出不超过临时缓冲区
+        float* scratch[kMaxAudioChannels] = {};
+        for (int c = 0; c < channels; ++c) {
+            scratch[c] = resampleBuffer_.data() + static_cast<size_t>(c) * resampleCapacity_;
+        }
+        int chunk = kMaxAudioBlockSize;
+        while (chunk > 1 && item.resampler.maxOutputSamples(chunk) > resampleCapacity_) {
+            chunk /= 2;
+        }
+
+        for (int offset = 0; offset < in.samples; offset += chunk) {
+            int n = std::min(chunk, in.samples - offset);
+            const float* segment[kMaxAudioChannels] = {};
+            for (int c = 0; c < channels; ++c) {
+                segment[c] = mapped[c] + offset;
+            }
+            int produced = item.resampler.process(segment, n, scratch, resampleCapacity_);
+            FrameTime ts = in.timestamp + FrameTime(static_cast<int64_t>(offset) * 1000000 / in.sample_rate);
+            item.queue.push(scratch, produced, ts);
+        }
+    }
+
+    return item.queue.available() >= block;
+}
+
 } // namespace SimpleOBS
@@ -1,12 +1,44 @@
 #pragma once
 
 #include "SimpleOBS.h"
+#include "AudioProcessing.h"
+#include "ContentAnalysis.h"
+#include "FrameRateAdapter.h"
+#include "FramePoolLoader.h"
+#include "Compositor.h"
+#include "SourceActivation.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 
 namespace SimpleOBS {
 
+// 场景中的单个源条目，保存该源的混音状态
+struct SceneItem {
+    SourcePtr source;
+    AudioResampler resampler;   // 源采样率 -> 引擎采样率
+    AudioBlockQueue queue;      // 按引擎块大小切分的待混音数据
+    int sourceRate = 0;         // 上次配置重采样器时的源采样率
+    FrameTime lastAudio{0};     // 最近一次凑够一个块的时刻
+    bool stalled = false;       // 是否已发布停顿事件
+    ContentDetector content;    // 冻结/黑场/静音检测
+    FrameRateAdapter frameRate; // 源帧率 -> 引擎帧率
+    std::vector<FilterPtr> filters;  // 源级滤镜，在合成和混音之前按顺序处理该源的画面和声音
+    int x = 0;                  // 多源合成时在画布中的左上角位置
+    int y = 0;
+    int opacity = 255;          // 整体不透明度（0~255）
+    BlendMode blendMode = BlendMode::Normal;
+    FramePoolLoader convertPool{"format_convert"};  // 源画面格式与画布不一致时的转换缓冲区，只有一帧，后台分配
+    FramePool* convertedPool = nullptr;  // 取出converted的帧池
+    VideoFrame converted{};     // 从convertPool取出的常驻帧
+    bool convertWarned = false; // 是否已记录格式不一致的警告
+
+    // 是否按普通方式不透明叠加，只有这样的源能遮挡下层或直通
+    bool plainBlend() const { return opacity == 255 && blendMode == BlendMode::Normal; }
+};
+
 // Scene接口的具体实现类
 class SceneImpl : public Scene {
 public:
@@ -18,6 +50,10 @@ public:
     std::string getId() const override;
     bool initialize() override;
     void shutdown() override;
+    // 支持frame_rate_mode（passthrough/nearest/blend）、blend_space（gamma/linear）、
+    // position.<源名称>（"x,y"）、opacity.<源名称>（0~255）、
+    // blend_mode.<源名称>（normal/add/multiply/screen/overlay，非normal只用于RGBA画布）
+    bool setProperty(const std::string& key, const std::string& value) override;
 
     // Scene接口实现
     void addSource(SourcePtr source) override;
@@ -25,10 +61,107 @@ public:
     bool render(VideoFrame& frame) override;
     bool render(AudioFrame& frame) override;
 
+    // 按名称查找场景中的源，不存在时返回nullptr
+    SourcePtr findSource(const std::string& name) const;
+
+    // 场景级滤镜，音频滤镜每次处理恰好一个引擎音频块
+    void addFilter(FilterPtr filter);
+    void removeFilter(FilterPtr filter);
+
+    // 源级滤镜，source不存在或同名滤镜已存在时返回false
+    bool addSourceFilter(const std::string& source, FilterPtr filter);
+    // 移除并返回源级滤镜（source为空时为场景级滤镜），不存在时返回nullptr
+    FilterPtr removeFilter(const std::string& source, const std::string& name);
+    // 按名称查找滤镜，source为空时查找场景级滤镜
+    FilterPtr findFilter(const std::string& source, const std::string& name) const;
+    // 取出源的所有源级滤镜，移除源前调用，使滤镜不在渲染线程中析构
+    std::vector<FilterPtr> takeSourceFilters(const std::string& source);
+
+    // 设置混音格式，由Engine在创建场景和修改配置时调用
+    void setAudioSettings(const AudioSettings& settings);
+    const AudioSettings& getAudioSettings() const { return audioSettings_; }
+
+    // 内容检测配置，对场景中所有源生效
+    void setContentSettings(const ContentSettings& settings);
+    const ContentSettings& getContentSettings() const { return contentSettings_; }
+
+    // 各源的内容检测统计
+    std::vector<ContentStats> getContentStats() const;
+
+    // 帧率转换，由Engine在创建场景和开播时设置引擎帧间隔
+    void setFrameInterval(FrameTime interval);
+    void setFrameRateMode(FrameRateMode mode);
+    FrameRateMode getFrameRateMode() const { return frameRateMode_; }
+
+    // 各源的帧率转换统计，按场景中源的顺序排列
+    std::vector<FrameRateStats> getFrameRateStats() const;
+
+    // 多源合成的混合空间
+    void setBlendSpace(BlendSpace space);
+    BlendSpace getBlendSpace() const { return blendSpace_; }
+
+    // 设置源在画布中的位置，source不存在时返回false
+    bool setSourcePosition(const std::string& source, int x, int y);
+
+    // 设置源的不透明度（0~255）和混合模式，source不存在或取值无效时返回false
+    bool setSourceOpacity(const std::string& source, int opacity);
+    bool setSourceBlendMode(const std::string& source, BlendMode mode);
+
+    // 源激活计数，由Engine在创建场景时设置
+    void setSourceActivation(SourceActivation* activation) { activation_ = activation; }
+
+    // 场景开始/停止被显示（节目输出、截图），可嵌套；显示中的场景里的源保持运行。
+    // 源的启停可能较慢，只在控制线程、截图提交线程或工作线程中调用，不在渲染线程中调用
+    void show();
+    void hide();
+    bool isShown() const { return shown_.load(std::memory_order_acquire) > 0; }
+
+    // 使所有场景记住的画布内容失效，画布缓冲区被重新分配时调用
+    static void invalidateCanvases();
+
 private:
+    void configureItemAudio(SceneItem& item);
+    bool fillItemAudio(SceneItem& item);
+    void checkItemStall(SceneItem& item, FrameTime now);
+    bool canReuseCanvas(const SceneItem& item, const VideoFrame& canvas) const;
+    bool canPassThrough(const VideoFrame& source, const VideoFrame& canvas) const;
+    bool pullVideo(SceneItem& item, VideoFrame& frame, FrameTime now, bool& unchanged);
+    void passThrough(SceneItem& item, const VideoFrame& source, VideoFrame& frame);
+    bool copySingleLayer(const SceneItem& item, const VideoFrame& source, VideoFrame& frame);
+    bool convertLayer(SceneItem& item, VideoFrame& layer, int format);
+    bool coversCanvas(const SceneItem& item, const VideoFrame& layer, const VideoFrame& canvas) const;
+    bool needsCompositing(const VideoFrame& canvas) const;
+    bool compositeItems(VideoFrame& canvas, FrameTime now);
+    bool applySceneFilters(VideoFrame& frame, const VideoFrame& canvas);
+    SceneItem* findItem(const std::string& source) const;
+
     std::string name_;
-    std::vector<SourcePtr> sources_;
+    std::vector<std::unique_ptr<SceneItem>> items_;
+
+    // 本次合成拉取到画面的源，从上到下排列
+    struct ItemLayer {
+        SceneItem* item;
+        VideoFrame frame;
+    };
+    std::vector<ItemLayer> layers_;
+    std::vector<FilterPtr> filters_;
     bool initialized_;
+
+    AudioSettings audioSettings_;
+    std::vector<float> mixBuffer_;       // 平面混音缓冲区，channels * block_size
+    std::vector<float> resampleBuffer_;  // 重采样临时缓冲区
+    int resampleCapacity_ = 0;           // 重采样缓冲区每声道容量
+
+    ContentSettings contentSettings_;
+    FrameTime frameInterval_{1000000 / 60};
+    FrameRateMode frameRateMode_ = FrameRateMode::Nearest;
+    BlendSpace blendSpace_ = BlendSpace::Gamma;
+    SourceActivation* activation_ = nullptr;
+    std::atomic<int> shown_{0};              // show()的嵌套次数，控制线程也会读取
+    std::mutex itemsMutex_;                  // 渲染线程增删源与其他线程中的show()/hide()互斥
+    const SceneItem* canvasItem_ = nullptr;  // 最近一次写入画布的源条目（未经滤镜）
+    const uint8_t* canvasData_ = nullptr;    // 最近一次写入的画布缓冲区
+    uint64_t canvasWrite_ = 0;               // 最近一次写入时的全局画布写入序号
 };
 
 } // namespace SimpleOBS
@@ -0,0 +1,437 @@
+/**
+ * @file Screenshot.cpp
+ * @brief 异步截图与缩略图服务实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "Screenshot.h"
+#include "AudioProcessing.h"
+#include "FramePool.h"
+#include "ImageEncoder.h"
+#include "Logger.h"
+#include "SceneImpl.h"
+#include <algorithm>
+
+namespace SimpleOBS {
+
+namespace {
+
+// 同时被截图占用的帧池帧数上限，保证渲染线程总有空闲画布
+constexpr int kMaxHeldFrames = 2;
+
+// 请求超过该时长仍未取得画面即失败
+constexpr FrameTime kPendingTimeout(1000000);
+
+// 截取非当前场景后该场景保持显示的时长，轮询缩略图时其中的源不会反复启停
+constexpr FrameTime kWarmSceneGrace(5000000);
+
+// 工作线程轮询间隔：渲染线程只写无锁队列，不负责唤醒
+constexpr std::chrono::milliseconds kWorkerPollInterval(5);
+
+} // anonymous namespace
+
+ScreenshotService::ScreenshotService(NumaFramePool& pool, size_t capacity)
+    : pool_(pool), capacity_(std::max<size_t>(capacity, 1)), inbox_(capacity_), outbox_(capacity_) {
+    // 渲染线程只在预留的容量内增删，不会重新分配
+    waiting_.reserve(inbox_.capacity());
+}
+
+ScreenshotService::~ScreenshotService() {
+    stop();
+    // 工作线程已停止，剩余请求在当前线程中以失败结束
+    collectInbox();
+    for (Job* job : waiting_) {
+        job->error = "screenshot service stopped";
+        job->next = nullptr;
+        process(job);
+    }
+    waiting_.clear();
+    Job* job;
+    while (outbox_.pop(job)) {
+        process(job);
+    }
+    releaseWarmScenes(FrameTime::max());
+}
+
+void ScreenshotService::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&ScreenshotService::workerLoop, this);
+}
+
+void ScreenshotService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_one();
+    thread_.join();
+    releaseWarmScenes(FrameTime::max());
+}
+
+bool ScreenshotService::submit(const ScreenshotRequest& request, std::shared_ptr<SceneImpl> scene,
+                               SourcePtr source, ScreenshotCallback callback) {
+    if (outstanding_.fetch_add(1, std::memory_order_acq_rel) >= capacity_) {
+        outstanding_.fetch_sub(1, std::memory_order_acq_rel);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto job = std::make_unique<Job>();
+    job->request = request;
+    job->scene = std::move(scene);
+    job->source = std::move(source);
+    job->callback = std::move(callback);
+    job->submitted = currentFrameTime();
+    if (job->scene) {
+        // 在提交线程中启动场景中的源，渲染线程只渲染已显示的场景
+        job->scene->show();
+        job->shown = true;
+    }
+    if (!inbox_.push(job.get())) {
+        if (job->shown) {
+            job->scene->hide();
+        }
+        outstanding_.fetch_sub(1, std::memory_order_acq_rel);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    job.release();
+    requested_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ScreenshotService::collectInbox() {
+    Job* job;
+    while (waiting_.size() < waiting_.capacity() && inbox_.pop(job)) {
+        waiting_.push_back(job);
+    }
+}
+
+bool ScreenshotService::takeCanvas(const SceneImpl* scene, const VideoFrame& canvas) {
+    if (outstanding_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    collectInbox();
+    if (heldFrames_.load(std::memory_order_acquire) >= kMaxHeldFrames) {
+        return false;
+    }
+
+    // 所有截取当前场景的请求共用这一帧
+    Job* head = nullptr;
+    Job** tail = &head;
+    for (auto it = waiting_.begin(); it != waiting_.end();) {
+        Job* job = *it;
+        if (!job->source && (!job->scene || job->scene.get() == scene)) {
+            *tail = job;
+            tail = &job->next;
+            it = waiting_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!head) {
+        return false;
+    }
+
+    head->frame = canvas;
+    head->pooled = true;
+    heldFrames_.fetch_add(1, std::memory_order_acq_rel);
+    zeroCopy_.fetch_add(1, std::memory_order_relaxed);
+    dispatch(head);
+    return true;
+}
+
+void ScreenshotService::renderPending(const SceneImpl* current, std::chrono::steady_clock::time_point deadline) {
+    const FrameTime now = currentFrameTime();
+    if (outstanding_.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    collectInbox();
+
+    for (auto it = waiting_.begin(); it != waiting_.end();) {
+        if (now - (*it)->submitted > kPendingTimeout) {
+            fail(*it, "no frame rendered in time");
+            it = waiting_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (heldFrames_.load(std::memory_order_acquire) >= kMaxHeldFrames) {
+        return;
+    }
+
+    auto target = std::find_if(waiting_.begin(), waiting_.end(), [current](const Job* job) {
+        return job->source || (job->scene && job->scene.get() != current);
+    });
+    if (target == waiting_.end()) {
+        return;
+    }
+    // 额外渲染不能挤占下一个节拍：按以往耗时估计来不及（包括本节拍已经迟到）时留到之后的节拍，
+    // 持续没有余量的请求最终按超时失败
+    const auto start = std::chrono::steady_clock::now();
+    if (start + std::chrono::microseconds(renderCostUs_) > deadline) {
+        deferred_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const SourcePtr source = (*target)->source;
+    const std::shared_ptr<SceneImpl> scene = (*target)->scene;
+
+    // 未运行的源不在渲染线程中临时启动，直接失败
+    if (source && !source->isActive()) {
+        failChain(takeMatching(source, nullptr), "source is not active");
+        return;
+    }
+
+    VideoFrame frame{};
+    if (!pool_.acquire(frame)) {
+        return;
+    }
+    bool ok;
+    if (source) {
+        VideoFrame sourceFrame{};
+        ok = source->getVideoFrame(sourceFrame) && copyVideoFrame(frame, sourceFrame);
+        if (ok) {
+            frame.width = std::min(frame.width, sourceFrame.width);
+            frame.height = std::min(frame.height, sourceFrame.height);
+        }
+    } else {
+        const VideoFrame canvas = frame;
+        // 场景在提交时已显示，其中的源已启动
+        ok = scene->render(frame);
+        if (ok && frame.data[0] != canvas.data[0]) {
+            // 场景直通时输出指向源的缓冲区，复制进画布后才能交给工作线程
+            const VideoFrame passthrough = frame;
+            frame = canvas;
+            ok = copyVideoFrame(frame, passthrough);
+        } else if (!ok) {
+            frame = canvas;
+        }
+    }
+    const int64_t cost = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    renderCostUs_ = renderCostUs_ == 0 ? cost : (renderCostUs_ * 7 + cost) / 8;
+
+    Job* head = takeMatching(source, scene.get());
+    if (!ok) {
+        pool_.release(frame);
+        failChain(head, source ? "source has no compatible frame" : "scene has no active source");
+        return;
+    }
+    head->frame = frame;
+    head->pooled = true;
+    heldFrames_.fetch_add(1, std::memory_order_acq_rel);
+    rendered_.fetch_add(1, std::memory_order_relaxed);
+    dispatch(head);
+}
+
+void ScreenshotService::cancelPending(const char* reason) {
+    collectInbox();
+    for (Job* job : waiting_) {
+        fail(job, reason);
+    }
+    waiting_.clear();
+
+    // 帧池重新分配前必须拿回所有被占用的帧
+    while (heldFrames_.load(std::memory_order_acquire) > 0 || !outbox_.empty()) {
+        bool running;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running = running_;
+        }
+        if (!running) {
+            Job* job;
+            while (outbox_.pop(job)) {
+                process(job);
+            }
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    releaseWarmScenes(FrameTime::max());
+}
+
+void ScreenshotService::dispatch(Job* head) {
+    // 受理数不超过容量，队列不会满
+    outbox_.push(head);
+}
+
+void ScreenshotService::fail(Job* job, const char* error) {
+    job->error = error;
+    job->next = nullptr;
+    dispatch(job);
+}
+
+void ScreenshotService::failChain(Job* head, const char* error) {
+    while (head) {
+        Job* next = head->next;
+        fail(head, error);
+        head = next;
+    }
+}
+
+ScreenshotService::Job* ScreenshotService::takeMatching(const SourcePtr& source, const SceneImpl* scene) {
+    Job* head = nullptr;
+    Job** tail = &head;
+    for (auto it = waiting_.begin(); it != waiting_.end();) {
+        Job* job = *it;
+        if (job->source == source && (source || job->scene.get() == scene)) {
+            *tail = job;
+            tail = &job->next;
+            it = waiting_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return head;
+}
+
+/**
+ * @brief 接管请求对场景的一次显示，保持显示一段时间（工作线程）
+ * @param[in] scene 请求提交时显示的场景
+ * @param[in] now 当前时刻
+ *
+ * @details 场景已在保持显示时只延长期限并撤销这次显示，计数只是减一，不会停止源
+ */
+void ScreenshotService::keepSceneWarm(const std::shared_ptr<SceneImpl>& scene, FrameTime now) {
+    {
+        std::lock_guard<std::mutex> lock(warmMutex_);
+        auto it = std::find_if(warmScenes_.begin(), warmScenes_.end(),
+                               [&](const WarmScene& warm) { return warm.scene == scene; });
+        if (it == warmScenes_.end()) {
+            warmScenes_.push_back({scene, now + kWarmSceneGrace});
+            return;
+        }
+        it->expires = now + kWarmSceneGrace;
+    }
+    scene->hide();
+}
+
+/**
+ * @brief 撤销到期的保持显示（非渲染线程）
+ * @param[in] now 当前时刻，FrameTime::max()表示全部撤销
+ *
+ * @details 源的停止在锁外进行
+ */
+void ScreenshotService::releaseWarmScenes(FrameTime now) {
+    std::vector<std::shared_ptr<SceneImpl>> expired;
+    {
+        std::lock_guard<std::mutex> lock(warmMutex_);
+        for (auto it = warmScenes_.begin(); it != warmScenes_.end();) {
+            if (now >= it->expires) {
+                expired.push_back(std::move(it->scene));
+                it = warmScenes_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (const auto& scene : expired) {
+        scene->hide();
+    }
+}
+
+ScreenshotStats ScreenshotService::getStats() const {
+    ScreenshotStats stats;
+    stats.requested = requested_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.completed = completed_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.zero_copy = zeroCopy_.load(std::memory_order_relaxed);
+    stats.rendered = rendered_.load(std::memory_order_relaxed);
+    stats.deferred = deferred_.load(std::memory_order_relaxed);
+    stats.last_encode_us = lastEncode_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ScreenshotService::workerLoop() {
+    LOG_DEBUG("Screenshot worker started");
+    while (true) {
+        Job* job;
+        while (outbox_.pop(job)) {
+            process(job);
+        }
+        releaseWarmScenes(currentFrameTime());
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!running_) {
+            break;
+        }
+        cv_.wait_for(lock, kWorkerPollInterval, [this] { return !running_; });
+    }
+    LOG_DEBUG("Screenshot worker stopped");
+}
+
+/**
+ * @brief 处理共用一帧的一组请求
+ * @details 先转换为RGB并立即归还帧池，之后的缩放和编码不再占用画布帧
+ */
+void ScreenshotService::process(Job* head) {
+    const auto start = std::chrono::steady_clock::now();
+    const FrameTime timestamp = head->frame.timestamp;
+
+    RgbImage image;
+    const char* error = head->error;
+    if (!error && !convertToRgb(head->frame, image)) {
+        error = "unsupported frame format";
+    }
+    if (head->pooled) {
+        pool_.release(head->frame);
+        heldFrames_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    for (Job* job = head; job;) {
+        Screenshot shot;
+        shot.format = job->request.format;
+        shot.timestamp = timestamp;
+        if (error) {
+            shot.error = error;
+        } else {
+            const RgbImage* target = &image;
+            RgbImage scaled;
+            if (job->request.max_width > 0 || job->request.max_height > 0) {
+                downscaleRgb(image, job->request.max_width, job->request.max_height, scaled);
+                target = &scaled;
+            }
+            shot.ok = job->request.format == ImageFormat::Jpeg
+                ? encodeJpeg(*target, job->request.quality, shot.data)
+                : encodePng(*target, shot.data);
+            shot.width = target->width;
+            shot.height = target->height;
+            if (!shot.ok) {
+                shot.error = "encoding failed";
+            }
+        }
+
+        if (shot.ok) {
+            completed_.fetch_add(1, std::memory_order_relaxed);
+            lastEncode_.store(std::chrono::duration_cast<std::chrono::microseconds>(
+                                  std::chrono::steady_clock::now() - start).count(),
+                              std::memory_order_relaxed);
+        } else {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+            LOG_DEBUG("Screenshot failed: {}", shot.error);
+        }
+        if (job->callback) {
+            job->callback(shot);
+        }
+
+        if (job->shown) {
+            keepSceneWarm(job->scene, currentFrameTime());
+        }
+        Job* next = job->next;
+        delete job;
+        outstanding_.fetch_sub(1, std::memory_order_acq_rel);
+        job = next;
+    }
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,186 @@
+/**
+ * @file Screenshot.h
+ * @brief 异步截图与缩略图服务
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了截图服务。渲染线程以外的任意线程提交请求，渲染线程在每个节拍结束时处理：
+ * 截取当前场景时直接把刚合成的画布帧（帧池中的帧）连同请求交给工作线程，不复制像素；
+ * 截取其他场景或单个源时从帧池取一帧渲染，每个节拍最多一次，且只在节拍余量足够时进行。
+ * 工作线程把帧转换为RGB后立即归还帧池，再按请求缩放并编码为PNG/JPEG，最后调用回调。
+ *
+ * @note
+ * - 渲染线程侧只有原子操作和无锁队列，不加锁、不分配内存、不做系统调用
+ * - 同时被截图占用的帧池帧数有上限，超出时请求留到后续节拍
+ * - 超过一定时间仍未取得画面的请求以失败结束
+ * - 截取未运行的源直接失败
+ * - 截取非当前场景时在提交线程中显示该场景（启动其中的源），渲染线程不启停源；
+ *   请求完成后由工作线程保持显示一段时间再撤销，轮询缩略图时其中的源不会每次截图都启停
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include "MpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SimpleOBS {
+
+class NumaFramePool;
+class SceneImpl;
+
+/**
+ * @brief 截图统计
+ */
+struct ScreenshotStats {
+    uint64_t requested = 0;     ///< 受理的请求数
+    uint64_t rejected = 0;      ///< 因待处理请求过多被拒绝的请求数
+    uint64_t completed = 0;     ///< 成功编码的截图数
+    uint64_t failed = 0;        ///< 失败的请求数
+    uint64_t zero_copy = 0;     ///< 直接使用画布帧的截取次数
+    uint64_t rendered = 0;      ///< 为截图额外渲染的次数
+    uint64_t deferred = 0;      ///< 节拍余量不足、额外渲染推迟到之后节拍的次数
+    int64_t last_encode_us = 0; ///< 最近一次转换+编码的耗时
+};
+
+/**
+ * @brief 截图服务
+ */
+class ScreenshotService {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] pool 画布帧池
+     * @param[in] capacity 最多同时处理的请求数
+     */
+    explicit ScreenshotService(NumaFramePool& pool, size_t capacity = 64);
+    ~ScreenshotService();
+
+    ScreenshotService(const ScreenshotService&) = delete;
+    ScreenshotService& operator=(const ScreenshotService&) = delete;
+
+    /**
+     * @brief 启动工作线程
+     */
+    void start();
+
+    /**
+     * @brief 处理完已取得画面的请求后停止工作线程
+     */
+    void stop();
+
+    /**
+     * @brief 提交请求（控制线程等非渲染线程）
+     * @param[in] request 截图请求
+     * @param[in] scene 目标场景，nullptr表示渲染时的当前场景
+     * @param[in] source 目标源，非空时截取该源
+     * @param[in] callback 完成回调
+     * @return false表示待处理请求过多
+     *
+     * @note scene非空时在调用线程中显示该场景并启动其中的源，不要在渲染线程中调用
+     */
+    bool submit(const ScreenshotRequest& request, std::shared_ptr<SceneImpl> scene, SourcePtr source,
+                ScreenshotCallback callback);
+
+    /**
+     * @brief 接收当前场景刚合成的画布帧（渲染线程）
+     * @param[in] scene 当前场景
+     * @param[in] canvas 画布帧
+     * @return true表示帧已被截图占用，由工作线程归还帧池
+     */
+    bool takeCanvas(const SceneImpl* scene, const VideoFrame& canvas);
+
+    /**
+     * @brief 是否有尚未完成的请求（任意线程）
+     */
+    bool hasPending() const { return outstanding_.load(std::memory_order_acquire) > 0; }
+
+    /**
+     * @brief 渲染一个其他场景或源的截图，并让超时的请求失败（渲染线程）
+     * @param[in] current 当前场景，可为nullptr
+     * @param[in] deadline 下一个渲染节拍的计划时刻，预计在此之前做不完时推迟到之后的节拍
+     */
+    void renderPending(const SceneImpl* current, std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief 让尚未取得画面的请求失败，并等待工作线程归还所有帧
+     * @param[in] reason 失败原因
+     *
+     * @note 渲染线程停止后调用
+     */
+    void cancelPending(const char* reason);
+
+    /**
+     * @brief 获取统计信息
+     */
+    ScreenshotStats getStats() const;
+
+private:
+    struct Job {
+        ScreenshotRequest request;
+        std::shared_ptr<SceneImpl> scene;
+        SourcePtr source;
+        ScreenshotCallback callback;
+        FrameTime submitted{0};
+        VideoFrame frame{};         ///< 链表头持有的帧
+        bool pooled = false;        ///< frame是否来自帧池
+        const char* error = nullptr;
+        bool shown = false;         ///< 提交时是否显示了scene，完成后由工作线程撤销
+        Job* next = nullptr;        ///< 共用同一帧的后续请求
+    };
+
+    /**
+     * @brief 因截图保持显示的非当前场景
+     */
+    struct WarmScene {
+        std::shared_ptr<SceneImpl> scene;
+        FrameTime expires{0};       ///< 到期后撤销显示
+    };
+
+    void collectInbox();
+    void dispatch(Job* head);
+    void fail(Job* job, const char* error);
+    void failChain(Job* head, const char* error);
+    Job* takeMatching(const SourcePtr& source, const SceneImpl* scene);
+    void keepSceneWarm(const std::shared_ptr<SceneImpl>& scene, FrameTime now);
+    void releaseWarmScenes(FrameTime now);
+    void workerLoop();
+    void process(Job* head);
+
+    NumaFramePool& pool_;
+    const size_t capacity_;
+
+    MpscQueue<Job*> inbox_;                 ///< 提交 -> 渲染线程
+    MpscQueue<Job*> outbox_;                ///< 渲染线程 -> 工作线程
+    std::vector<Job*> waiting_;             ///< 渲染线程持有的待取画面请求
+    int64_t renderCostUs_ = 0;              ///< 额外渲染耗时的滑动平均（仅渲染线程）
+    std::atomic<size_t> outstanding_{0};    ///< 已受理未完成的请求数
+    std::atomic<int> heldFrames_{0};        ///< 被截图占用的帧池帧数
+
+    std::atomic<uint64_t> requested_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> zeroCopy_{0};
+    std::atomic<uint64_t> rendered_{0};
+    std::atomic<uint64_t> deferred_{0};
+    std::atomic<int64_t> lastEncode_{0};
+
+    std::mutex warmMutex_;                  ///< 保护warmScenes_，渲染线程不使用
+    std::vector<WarmScene> warmScenes_;     ///< 请求完成后保持显示的场景
+
+    std::mutex mutex_;                      ///< 只在工作线程启停时使用
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool running_ = false;
+};
+
+} // namespace SimpleOBS
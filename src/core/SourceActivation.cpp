@@ -0,0 +1,93 @@
+/**
+ * @file SourceActivation.cpp
+ * @brief 源激活引用计数实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "SourceActivation.h"
+#include "Logger.h"
+
+namespace SimpleOBS {
+
+/**
+ * @brief 源被一个显示中的场景引用
+ * @param[in] source 源
+ *
+ * @details 计数从0变1时启动源；源已被手动启动时只计数。
+ *          启动时不持有计数锁，同一时刻的isVisible()和getStats()不被阻塞
+ */
+void SourceActivation::show(const SourcePtr& source) {
+    if (!source) {
+        return;
+    }
+    std::lock_guard<std::mutex> transition(transitionMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (counts_[source.get()]++ > 0) {
+            return;
+        }
+    }
+    if (!source->isActive()) {
+        source->start();
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++starts_;
+        LOG_DEBUG("Source {} shown, started", source->getName());
+    }
+}
+
+/**
+ * @brief 撤销一次show()
+ * @param[in] source 源
+ *
+ * @details 计数从1变0时停止源；未被show()的源不受影响
+ */
+void SourceActivation::hide(const SourcePtr& source) {
+    if (!source) {
+        return;
+    }
+    std::lock_guard<std::mutex> transition(transitionMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = counts_.find(source.get());
+        if (it == counts_.end()) {
+            return;
+        }
+        if (--it->second > 0) {
+            return;
+        }
+        counts_.erase(it);
+    }
+    if (source->isActive()) {
+        source->stop();
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stops_;
+        LOG_DEBUG("Source {} hidden, stopped", source->getName());
+    }
+}
+
+/**
+ * @brief 源是否被任何显示中的场景引用
+ * @param[in] source 源
+ * @return true表示可见
+ */
+bool SourceActivation::isVisible(const Source* source) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return counts_.count(source) > 0;
+}
+
+/**
+ * @brief 获取统计信息
+ * @return 统计快照
+ */
+SourceActivationStats SourceActivation::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SourceActivationStats stats;
+    stats.visible = counts_.size();
+    stats.starts = starts_;
+    stats.stops = stops_;
+    return stats;
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,77 @@
+/**
+ * @file SourceActivation.h
+ * @brief 源激活引用计数
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了引擎级的源激活计数。场景被显示（节目输出、截图）时对其中每个源计数加一，
+ * 不再显示时减一：
+ * - 计数从0变1时调用Source::start()，源开始采集/解码，当前节拍即可拉取画面
+ * - 计数从1变0时调用Source::stop()，不可见的源不再占用CPU
+ * 同一个源加入多个场景时，只要有一个场景在显示就保持运行，切换场景时不会重启。
+ *
+ * @note
+ * - 计数按源对象（而非名称）区分
+ * - 只在场景切换、增删源和截图时调用，可在任意线程使用
+ * - start()/stop()可能较慢，只在串行化show()/hide()的锁内调用；
+ *   计数和统计用另一把锁保护，isVisible()和getStats()不会等待源启停
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 源激活统计
+ */
+struct SourceActivationStats {
+    size_t visible = 0;         ///< 当前被显示的源数
+    uint64_t starts = 0;        ///< 因变为可见而启动的次数
+    uint64_t stops = 0;         ///< 因不再可见而停止的次数
+};
+
+/**
+ * @brief 源激活引用计数
+ */
+class SourceActivation {
+public:
+    SourceActivation() = default;
+
+    SourceActivation(const SourceActivation&) = delete;
+    SourceActivation& operator=(const SourceActivation&) = delete;
+
+    /**
+     * @brief 源被一个显示中的场景引用，计数从0变1时启动源
+     */
+    void show(const SourcePtr& source);
+
+    /**
+     * @brief 撤销一次show()，计数从1变0时停止源
+     */
+    void hide(const SourcePtr& source);
+
+    /**
+     * @brief 源是否被任何显示中的场景引用
+     */
+    bool isVisible(const Source* source) const;
+
+    /**
+     * @brief 获取统计信息
+     */
+    SourceActivationStats getStats() const;
+
+private:
+    std::mutex transitionMutex_;    ///< 串行化show()/hide()，源的启停在此锁内进行
+    mutable std::mutex mutex_;      ///< 保护计数和统计
+    std::unordered_map<const Source*, int> counts_;
+    uint64_t starts_ = 0;
+    uint64_t stops_ = 0;
+};
+
+} // namespace SimpleOBS
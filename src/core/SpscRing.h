@@ -0,0 +1,146 @@
+/**
+ * @file SpscRing.h
+ * @brief 单生产者单消费者无锁环形缓冲区
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了固定容量的SPSC无锁环形缓冲区模板。
+ * 生产者和消费者各自只写自己的索引，读写操作都是wait-free的，
+ * 适合在渲染线程与设备线程之间传递数据。
+ *
+ * @note
+ * - 容量在构造时向上取整为2的幂，之后不再分配内存
+ * - 只允许一个线程调用写接口、一个线程调用读接口
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief SPSC无锁环形缓冲区
+ * @tparam T 元素类型，需可默认构造和拷贝赋值
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] capacity 最小容量（元素个数）
+     */
+    explicit SpscRing(size_t capacity = 0) {
+        reset(capacity);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief 重新分配并清空缓冲区
+     * @param[in] capacity 最小容量（元素个数）
+     *
+     * @note 调用时生产者和消费者都不能在访问缓冲区
+     */
+    void reset(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buffer_.assign(capacity ? size : 0, T{});
+        mask_ = buffer_.empty() ? 0 : size - 1;
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 获取容量
+     * @return 元素个数
+     */
+    size_t capacity() const { return buffer_.size(); }
+
+    /**
+     * @brief 获取可读元素个数
+     * @return 当前缓冲的元素个数（近似值，跨线程调用时可能已过时）
+     */
+    size_t size() const {
+        // 先读head再读tail：head只会追赶tail，反过来读时消费者可能在两次读取之间越过旧的tail而下溢
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return std::min(tail - head, capacity());
+    }
+
+    /**
+     * @brief 获取可写空间
+     * @return 可写入的元素个数
+     */
+    size_t freeSpace() const { return capacity() - size(); }
+
+    /**
+     * @brief 写入单个元素（仅生产者调用）
+     * @param[in] value 要写入的元素
+     * @return true表示写入成功，false表示缓冲区已满
+     */
+    bool tryPush(const T& value) {
+        return tryPush(&value, 1);
+    }
+
+    /**
+     * @brief 整体写入一组元素（仅生产者调用）
+     * @param[in] values 元素数组
+     * @param[in] count 元素个数
+     * @return true表示全部写入，false表示空间不足且未写入任何元素
+     */
+    bool tryPush(const T* values, size_t count) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        if (capacity() - (tail - head) < count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            buffer_[(tail + i) & mask_] = values[i];
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 读取单个元素（仅消费者调用）
+     * @param[out] value 读取到的元素
+     * @return true表示读取成功，false表示缓冲区为空
+     */
+    bool tryPop(T& value) {
+        return pop(&value, 1) == 1;
+    }
+
+    /**
+     * @brief 读取最多count个元素（仅消费者调用）
+     * @param[out] values 输出数组
+     * @param[in] count 最多读取的元素个数
+     * @return 实际读取的元素个数
+     */
+    size_t pop(T* values, size_t count) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t n = std::min(count, tail - head);
+        for (size_t i = 0; i < n; ++i) {
+            values[i] = buffer_[(head + i) & mask_];
+        }
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    std::vector<T> buffer_;                     ///< 元素存储
+    size_t mask_ = 0;                           ///< 容量掩码
+    alignas(64) std::atomic<size_t> head_{0};   ///< 读索引（消费者写）
+    alignas(64) std::atomic<size_t> tail_{0};   ///< 写索引（生产者写）
+};
+
+} // namespace SimpleOBS
@@ -1,8 +1,253 @@
 #include "SimpleOBS.h"
+#include <algorithm>
+#include <cstring>
 
 namespace SimpleOBS {
 
-// 视频帧工具函数可以在这里实现
-// 目前为空，后续可以添加帧格式转换、内存管理等功能
+namespace {
+
+// 行对齐到缓存行，SIMD内核可以整行对齐加载
+constexpr int kLineAlignment = 64;
+
+int alignLine(int bytes) {
+    return (bytes + kLineAlignment - 1) & ~(kLineAlignment - 1);
+}
+
+// YUV采样统一按10位刻度读写，8位采样左移2位
+int readSample(const VideoFrame& frame, int plane, int index) {
+    const uint8_t* row = frame.data[plane];
+    switch (frame.format) {
+    case kVideoFormatP010:
+        return reinterpret_cast<const uint16_t*>(row)[index] >> 6;
+    case kVideoFormatI010:
+        return reinterpret_cast<const uint16_t*>(row)[index] & 0x3FF;
+    default:
+        return row[index] << 2;
+    }
+}
+
+void writeSample(VideoFrame& frame, int plane, int index, int value) {
+    value = std::clamp(value, 0, 1023);
+    uint8_t* row = frame.data[plane];
+    switch (frame.format) {
+    case kVideoFormatP010:
+        reinterpret_cast<uint16_t*>(row)[index] = static_cast<uint16_t>(value << 6);
+        break;
+    case kVideoFormatI010:
+        reinterpret_cast<uint16_t*>(row)[index] = static_cast<uint16_t>(value);
+        break;
+    default:
+        row[index] = static_cast<uint8_t>(std::min((value + 2) >> 2, 255));
+        break;
+    }
+}
+
+/**
+ * @brief 一个2x2像素块：四个亮度和一对色度，10位刻度
+ */
+struct YuvBlock {
+    int y[4] = {};
+    int u = 0;
+    int v = 0;
+};
+
+// 指向给定亮度行和色度行的帧视图
+VideoFrame rowView(const VideoFrame& frame, int lumaRow, int chromaRow) {
+    VideoFrame view = frame;
+    view.data[0] = frame.data[0] + static_cast<size_t>(lumaRow) * frame.linesize[0];
+    for (int plane = 1; plane < 3; ++plane) {
+        if (frame.data[plane]) {
+            view.data[plane] = frame.data[plane] + static_cast<size_t>(chromaRow) * frame.linesize[plane];
+        }
+    }
+    return view;
+}
+
+bool isPlanarYuv(int format) {
+    return format == kVideoFormatI420 || format == kVideoFormatI010;
+}
+
+void readBlock(const VideoFrame& frame, int cx, int cy, int columns, int rows, YuvBlock& block) {
+    for (int j = 0; j < rows; ++j) {
+        const VideoFrame row = rowView(frame, cy * 2 + j, cy);
+        for (int i = 0; i < columns; ++i) {
+            const int x = cx * 2 + i;
+            if (frame.format == kVideoFormatRGBA) {
+                const uint8_t* p = row.data[0] + x * 4;
+                // BT.709 有限范围，10位刻度
+                block.y[j * 2 + i] = static_cast<int>(64.0f + 0.7304f * p[0] + 2.4568f * p[1] + 0.2480f * p[2] + 0.5f);
+                block.u += static_cast<int>(-0.4024f * p[0] - 1.3544f * p[1] + 1.7568f * p[2]);
+                block.v += static_cast<int>(1.7568f * p[0] - 1.5956f * p[1] - 0.1612f * p[2]);
+            } else {
+                block.y[j * 2 + i] = readSample(row, 0, x);
+            }
+        }
+    }
+    if (frame.format == kVideoFormatRGBA) {
+        const int count = columns * rows;
+        block.u = 512 + block.u / count;
+        block.v = 512 + block.v / count;
+        return;
+    }
+    const VideoFrame row = rowView(frame, 0, cy);
+    if (isPlanarYuv(frame.format)) {
+        block.u = readSample(row, 1, cx);
+        block.v = readSample(row, 2, cx);
+    } else {
+        block.u = readSample(row, 1, cx * 2);
+        block.v = readSample(row, 1, cx * 2 + 1);
+    }
+}
+
+uint8_t clampByte(float value) {
+    return static_cast<uint8_t>(std::clamp(value + 0.5f, 0.0f, 255.0f));
+}
+
+void writeBlock(VideoFrame& frame, int cx, int cy, int columns, int rows, const YuvBlock& block) {
+    for (int j = 0; j < rows; ++j) {
+        VideoFrame row = rowView(frame, cy * 2 + j, cy);
+        for (int i = 0; i < columns; ++i) {
+            const int x = cx * 2 + i;
+            if (frame.format == kVideoFormatRGBA) {
+                // BT.709 有限范围，输入为10位刻度
+                const float c = 1.164f * (block.y[j * 2 + i] - 64) * 0.25f;
+                const float d = (block.u - 512) * 0.25f;
+                const float e = (block.v - 512) * 0.25f;
+                uint8_t* p = row.data[0] + x * 4;
+                p[0] = clampByte(c + 1.793f * e);
+                p[1] = clampByte(c - 0.213f * d - 0.533f * e);
+                p[2] = clampByte(c + 2.112f * d);
+                p[3] = 255;
+            } else {
+                writeSample(row, 0, x, block.y[j * 2 + i]);
+            }
+        }
+    }
+    if (frame.format == kVideoFormatRGBA) {
+        return;
+    }
+    VideoFrame row = rowView(frame, 0, cy);
+    if (isPlanarYuv(frame.format)) {
+        writeSample(row, 1, cx, block.u);
+        writeSample(row, 2, cx, block.v);
+    } else {
+        writeSample(row, 1, cx * 2, block.u);
+        writeSample(row, 1, cx * 2 + 1, block.v);
+    }
+}
+
+} // anonymous namespace
+
+int videoFormatBitDepth(int format) {
+    switch (format) {
+    case kVideoFormatRGBA:
+    case kVideoFormatI420:
+    case kVideoFormatNV12:
+        return 8;
+    case kVideoFormatP010:
+    case kVideoFormatI010:
+        return 10;
+    default:
+        return 0;
+    }
+}
+
+size_t videoFrameLayout(int format, int width, int height, int linesize[4], size_t offsets[4]) {
+    for (int i = 0; i < 4; ++i) {
+        linesize[i] = 0;
+        offsets[i] = 0;
+    }
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    int planes = 0;
+    int heights[4] = {};
+
+    switch (format) {
+    case kVideoFormatRGBA:
+        linesize[0] = alignLine(width * 4);
+        heights[0] = height;
+        planes = 1;
+        break;
+    case kVideoFormatI420:
+        linesize[0] = alignLine(width);
+        linesize[1] = linesize[2] = alignLine(chromaWidth);
+        heights[0] = height;
+        heights[1] = heights[2] = chromaHeight;
+        planes = 3;
+        break;
+    case kVideoFormatNV12:
+        linesize[0] = alignLine(width);
+        linesize[1] = alignLine(chromaWidth * 2);
+        heights[0] = height;
+        heights[1] = chromaHeight;
+        planes = 2;
+        break;
+    case kVideoFormatP010:
+        linesize[0] = alignLine(width * 2);
+        linesize[1] = alignLine(chromaWidth * 4);
+        heights[0] = height;
+        heights[1] = chromaHeight;
+        planes = 2;
+        break;
+    case kVideoFormatI010:
+        linesize[0] = alignLine(width * 2);
+        linesize[1] = linesize[2] = alignLine(chromaWidth * 2);
+        heights[0] = height;
+        heights[1] = heights[2] = chromaHeight;
+        planes = 3;
+        break;
+    default:
+        return 0;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < planes; ++i) {
+        offsets[i] = total;
+        total += static_cast<size_t>(linesize[i]) * heights[i];
+    }
+    return total;
+}
+
+bool copyVideoFrame(VideoFrame& dst, const VideoFrame& src) {
+    if (src.format != dst.format || !src.data[0]) {
+        return false;
+    }
+    for (int plane = 0; plane < 4 && dst.data[plane] && src.data[plane]; ++plane) {
+        // 除打包RGBA外，第二个平面起是2x2下采样的色度平面
+        const bool chroma = plane > 0 && dst.format != kVideoFormatRGBA;
+        const int rows = chroma ? (std::min(dst.height, src.height) + 1) / 2
+                                : std::min(dst.height, src.height);
+        const int bytes = std::min(dst.linesize[plane], src.linesize[plane]);
+        for (int y = 0; y < rows; ++y) {
+            std::memcpy(dst.data[plane] + static_cast<size_t>(y) * dst.linesize[plane],
+                        src.data[plane] + static_cast<size_t>(y) * src.linesize[plane], bytes);
+        }
+    }
+    dst.timestamp = src.timestamp;
+    return true;
+}
+
+bool convertVideoFrame(VideoFrame& dst, const VideoFrame& src) {
+    if (!src.data[0] || !dst.data[0] || src.width != dst.width || src.height != dst.height ||
+        videoFormatBitDepth(src.format) == 0 || videoFormatBitDepth(dst.format) == 0) {
+        return false;
+    }
+    // 按2x2块处理，奇数尺寸的最后一行、一列只有一个像素
+    for (int cy = 0; cy < (src.height + 1) / 2; ++cy) {
+        const int rows = std::min(2, src.height - cy * 2);
+        for (int cx = 0; cx < (src.width + 1) / 2; ++cx) {
+            const int columns = std::min(2, src.width - cx * 2);
+            YuvBlock block;
+            readBlock(src, cx, cy, columns, rows, block);
+            writeBlock(dst, cx, cy, columns, rows, block);
+        }
+    }
+    dst.timestamp = src.timestamp;
+    return true;
+}
 
 } // namespace SimpleOBS
@@ -0,0 +1,191 @@
+/**
+ * @file Watchdog.cpp
+ * @brief 管线停顿看门狗实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "Watchdog.h"
+#include "AudioProcessing.h"
+#include "EventBus.h"
+#include "FlightRecorder.h"
+#include "Logger.h"
+#include <algorithm>
+#include <ctime>
+
+namespace SimpleOBS {
+
+Watchdog::Watchdog(FlightRecorder& recorder, EventBus* events)
+    : recorder_(recorder), events_(events) {}
+
+Watchdog::~Watchdog() {
+    stop();
+}
+
+void Watchdog::setSettings(const WatchdogSettings& settings) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    settings_ = settings;
+}
+
+WatchdogSettings Watchdog::getSettings() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return settings_;
+}
+
+void Watchdog::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&Watchdog::watchLoop, this);
+}
+
+void Watchdog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+Watchdog::StageId Watchdog::addStage(const std::string& name, FrameTime deadline) {
+    std::lock_guard<std::mutex> lock(stageMutex_);
+    int count = stageCount_.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (stages_[i]->name == name) {
+            stages_[i]->deadline.store(deadline.count(), std::memory_order_relaxed);
+            return i;
+        }
+    }
+    if (count == kMaxStages) {
+        LOG_ERROR("Watchdog: too many stages, {} not added", name);
+        return -1;
+    }
+    auto stage = std::make_unique<Stage>();
+    stage->name = name;
+    stage->deadline.store(deadline.count(), std::memory_order_relaxed);
+    stages_[count] = std::move(stage);
+    stageCount_.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void Watchdog::setDeadline(StageId stage, FrameTime deadline) {
+    if (stage >= 0 && stage < stageCount_.load(std::memory_order_acquire)) {
+        stages_[stage]->deadline.store(deadline.count(), std::memory_order_relaxed);
+    }
+}
+
+void Watchdog::setActive(StageId stage, bool active) {
+    if (stage < 0 || stage >= stageCount_.load(std::memory_order_acquire)) {
+        return;
+    }
+    stages_[stage]->lastBeat.store(currentFrameTime().count(), std::memory_order_relaxed);
+    stages_[stage]->active.store(active, std::memory_order_release);
+}
+
+void Watchdog::heartbeat(StageId stage) {
+    if (stage >= 0) {
+        stages_[stage]->lastBeat.store(currentFrameTime().count(), std::memory_order_relaxed);
+    }
+}
+
+std::string Watchdog::dump(const std::string& reason) {
+    WatchdogSettings settings = getSettings();
+
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sequence = stats_.dumps + 1;
+    }
+    std::string path = settings.dump_directory + "/simpleobs-flight-" + stamp + "-" +
+                       std::to_string(sequence) + ".log";
+    if (!recorder_.dump(path, FrameTime(static_cast<int64_t>(settings.recorder_window_ms) * 1000), reason)) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.dumps++;
+    stats_.last_dump = path;
+    LOG_WARN("Flight recorder dumped to {} ({})", path, reason);
+    return path;
+}
+
+WatchdogStats Watchdog::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void Watchdog::watchLoop() {
+    LOG_DEBUG("Watchdog started");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        auto interval = std::chrono::milliseconds(std::max(1, settings_.check_interval_ms));
+        cv_.wait_for(lock, interval, [this] { return !running_; });
+        if (!running_) {
+            break;
+        }
+        lock.unlock();
+        checkStages();
+        lock.lock();
+    }
+    LOG_DEBUG("Watchdog stopped");
+}
+
+void Watchdog::checkStages() {
+    const int64_t now = currentFrameTime().count();
+    const int count = stageCount_.load(std::memory_order_acquire);
+
+    for (int i = 0; i < count; ++i) {
+        Stage& stage = *stages_[i];
+        bool active = stage.active.load(std::memory_order_acquire);
+        int64_t silent = now - stage.lastBeat.load(std::memory_order_relaxed);
+        int64_t deadline = stage.deadline.load(std::memory_order_relaxed);
+
+        if (!active || silent <= deadline) {
+            if (stage.stalled) {
+                stage.stalled = false;
+                recorder_.record(RecordKind::Stall, stage.name.c_str(), 0, deadline);
+                LOG_INFO("Pipeline stage {} resumed", stage.name);
+            }
+            continue;
+        }
+        if (stage.stalled) {
+            continue;
+        }
+
+        stage.stalled = true;
+        recorder_.record(RecordKind::Stall, stage.name.c_str(), silent, deadline);
+        LOG_WARN("Pipeline stage {} stalled: no heartbeat for {} ms (deadline {} ms)",
+                 stage.name, silent / 1000, deadline / 1000);
+        if (events_) {
+            events_->publish(EventType::PipelineStalled, stage.name.c_str(), silent);
+        }
+
+        bool dumpNow;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.stalls++;
+            dumpNow = now - lastDump_ >= static_cast<int64_t>(settings_.min_dump_interval_ms) * 1000;
+            if (dumpNow) {
+                lastDump_ = now;
+            }
+        }
+        if (dumpNow) {
+            dump("stage " + stage.name + " stalled for " + std::to_string(silent / 1000) + " ms");
+        }
+    }
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,165 @@
+/**
+ * @file Watchdog.h
+ * @brief 管线停顿看门狗
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了检查各管线阶段心跳的看门狗。每个阶段（音频混音、视频渲染、输出发送等）
+ * 在每次处理时调用heartbeat()，看门狗线程定期检查，某阶段超过截止时间没有心跳即视为停顿：
+ * 记录日志、发布PipelineStalled事件，并把飞行记录器最近几秒的内容转储到文件。
+ *
+ * @note
+ * - heartbeat()只有一次原子写入，可在实时线程中调用
+ * - 同一次停顿只转储一次，阶段恢复心跳后才会再次触发；两次转储之间有最小间隔
+ * - 未激活的阶段（如未推流时的渲染阶段）不做检查
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace SimpleOBS {
+
+class EventBus;
+class FlightRecorder;
+
+/**
+ * @brief 看门狗配置
+ */
+struct WatchdogSettings {
+    int check_interval_ms = 100;        ///< 检查间隔
+    int recorder_window_ms = 5000;      ///< 转储的时间窗口
+    int min_dump_interval_ms = 10000;   ///< 两次转储的最小间隔
+    std::string dump_directory = ".";   ///< 转储文件目录
+};
+
+/**
+ * @brief 看门狗统计
+ */
+struct WatchdogStats {
+    uint64_t stalls = 0;            ///< 检测到的停顿次数
+    uint64_t dumps = 0;             ///< 写出的转储文件数
+    std::string last_dump;          ///< 最近一次转储文件路径
+};
+
+/**
+ * @brief 管线停顿看门狗
+ */
+class Watchdog {
+public:
+    using StageId = int;
+
+    /**
+     * @brief 构造函数
+     * @param[in] recorder 飞行记录器
+     * @param[in] events 事件总线，可为空
+     */
+    Watchdog(FlightRecorder& recorder, EventBus* events);
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    /**
+     * @brief 设置配置，下次检查时生效
+     * @param[in] settings 配置
+     */
+    void setSettings(const WatchdogSettings& settings);
+
+    /**
+     * @brief 获取配置
+     */
+    WatchdogSettings getSettings() const;
+
+    /**
+     * @brief 启动看门狗线程
+     */
+    void start();
+
+    /**
+     * @brief 停止看门狗线程
+     */
+    void stop();
+
+    /**
+     * @brief 登记阶段
+     * @param[in] name 阶段名称
+     * @param[in] deadline 心跳截止时间
+     * @return 阶段ID，阶段过多时返回-1；同名阶段已存在时返回已有ID并更新截止时间
+     *
+     * @note 新登记的阶段处于未激活状态
+     */
+    StageId addStage(const std::string& name, FrameTime deadline);
+
+    /**
+     * @brief 修改阶段的截止时间
+     * @param[in] stage 阶段ID
+     * @param[in] deadline 心跳截止时间
+     */
+    void setDeadline(StageId stage, FrameTime deadline);
+
+    /**
+     * @brief 激活或停用阶段
+     * @param[in] stage 阶段ID
+     * @param[in] active true表示开始检查（同时视为一次心跳）
+     */
+    void setActive(StageId stage, bool active);
+
+    /**
+     * @brief 心跳（任意线程，wait-free）
+     * @param[in] stage 阶段ID
+     */
+    void heartbeat(StageId stage);
+
+    /**
+     * @brief 立即转储飞行记录器
+     * @param[in] reason 原因
+     * @return 转储文件路径，失败时为空
+     */
+    std::string dump(const std::string& reason);
+
+    /**
+     * @brief 获取统计信息
+     */
+    WatchdogStats getStats() const;
+
+private:
+    struct Stage {
+        std::string name;
+        std::atomic<int64_t> deadline{0};       ///< 微秒
+        std::atomic<int64_t> lastBeat{0};       ///< 微秒
+        std::atomic<bool> active{false};
+        bool stalled = false;                   ///< 仅看门狗线程访问
+    };
+
+    void watchLoop();
+    void checkStages();
+
+    static constexpr int kMaxStages = 32;
+
+    FlightRecorder& recorder_;
+    EventBus* events_;
+
+    std::unique_ptr<Stage> stages_[kMaxStages];
+    std::atomic<int> stageCount_{0};
+    std::mutex stageMutex_;
+
+    mutable std::mutex mutex_;      ///< 保护配置、统计和线程状态
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool running_ = false;
+    WatchdogSettings settings_;
+    WatchdogStats stats_;
+    int64_t lastDump_ = INT64_MIN / 2;
+};
+
+} // namespace SimpleOBS
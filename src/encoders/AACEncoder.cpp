@@ -0,0 +1,210 @@
+/**
+ * @file AACEncoder.cpp
+ * @brief 基于fdk-aac的AAC-LC编码器实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "AACEncoder.h"
+
+#ifdef SIMPLEOBS_HAVE_FDK_AAC
+
+#include "Logger.h"
+#include <fdk-aac/aacenc_lib.h>
+#include <algorithm>
+#include <cmath>
+
+namespace SimpleOBS {
+
+AACEncoder::AACEncoder(const std::string& name, const AudioEncoderSettings& settings)
+    : BaseEncoder(name), settings_(settings) {}
+
+AACEncoder::~AACEncoder() {
+    shutdown();
+}
+
+/**
+ * @brief 初始化编码器
+ * @return true表示初始化成功
+ *
+ * @details
+ * 1. 打开fdk-aac编码器并设置AAC-LC、采样率、声道和码率
+ * 2. 输出格式为原始AAC帧（TT_MP4_RAW）
+ * 3. 读取帧长和AudioSpecificConfig
+ */
+bool AACEncoder::initialize() {
+    if (handle_) {
+        return true;
+    }
+    if (settings_.channels < 1 || settings_.channels > 2) {
+        LOG_ERROR("AAC encoder {} supports mono or stereo only, got {} channels", name_, settings_.channels);
+        return false;
+    }
+
+    if (aacEncOpen(&handle_, 0, static_cast<UINT>(settings_.channels)) != AACENC_OK) {
+        LOG_ERROR("AAC encoder {} failed to open", name_);
+        handle_ = nullptr;
+        return false;
+    }
+
+    bool ok = aacEncoder_SetParam(handle_, AACENC_AOT, AOT_AAC_LC) == AACENC_OK &&
+              aacEncoder_SetParam(handle_, AACENC_SAMPLERATE, static_cast<UINT>(settings_.sample_rate)) == AACENC_OK &&
+              aacEncoder_SetParam(handle_, AACENC_CHANNELMODE, settings_.channels == 1 ? MODE_1 : MODE_2) == AACENC_OK &&
+              aacEncoder_SetParam(handle_, AACENC_CHANNELORDER, 1) == AACENC_OK &&
+              aacEncoder_SetParam(handle_, AACENC_BITRATE, static_cast<UINT>(settings_.bitrate)) == AACENC_OK &&
+              aacEncoder_SetParam(handle_, AACENC_TRANSMUX, TT_MP4_RAW) == AACENC_OK &&
+              aacEncoder_SetParam(handle_, AACENC_AFTERBURNER, 1) == AACENC_OK &&
+              aacEncEncode(handle_, nullptr, nullptr, nullptr, nullptr) == AACENC_OK;
+
+    AACENC_InfoStruct info = {};
+    if (!ok || aacEncInfo(handle_, &info) != AACENC_OK) {
+        LOG_ERROR("AAC encoder {} failed to configure: rate={}, channels={}, bitrate={}",
+                  name_, settings_.sample_rate, settings_.channels, settings_.bitrate);
+        aacEncClose(&handle_);
+        handle_ = nullptr;
+        return false;
+    }
+
+    frameLength_ = static_cast<int>(info.frameLength);
+    delay_ = static_cast<int>(info.nDelay);
+    pcm_.assign(static_cast<size_t>(frameLength_) * settings_.channels, 0);
+    output_.assign(static_cast<size_t>(info.maxOutBufBytes), 0);
+    buffered_ = 0;
+    outputFrames_ = 0;
+    resetTimeline();
+    setExtraData(std::vector<uint8_t>(info.confBuf, info.confBuf + info.confSize));
+
+    LOG_INFO("AAC encoder {} initialized: rate={}, channels={}, bitrate={}, frame={}, delay={}",
+             name_, settings_.sample_rate, settings_.channels, settings_.bitrate, frameLength_, info.nDelay);
+    return true;
+}
+
+void AACEncoder::shutdown() {
+    if (!handle_) {
+        return;
+    }
+    // 编码器每次可能只接收部分输入，直到缓冲区清空或不再有进展
+    for (int previous = -1; buffered_ > 0 && buffered_ != previous;) {
+        previous = buffered_;
+        encodeBuffered(false);
+    }
+    // 冲刷编码器延迟中的剩余数据
+    while (encodeBuffered(true)) {
+    }
+    aacEncClose(&handle_);
+    handle_ = nullptr;
+    LOG_INFO("AAC encoder {} shut down after {} frames", name_, outputFrames_);
+}
+
+bool AACEncoder::encodeFrame(const AudioFrame& frame) {
+    if (!handle_ || frame.samples <= 0 || frame.channels <= 0 || !frame.data[0]) {
+        return false;
+    }
+    if (frame.sample_rate != settings_.sample_rate) {
+        LOG_ERROR("AAC encoder {} expects {} Hz, got {} Hz", name_, settings_.sample_rate, frame.sample_rate);
+        return false;
+    }
+
+    trackAudioInput(frame.timestamp, buffered_, settings_.sample_rate);
+
+    const int channels = settings_.channels;
+    int offset = 0;
+    while (offset < frame.samples) {
+        int count = std::min(frameLength_ - buffered_, frame.samples - offset);
+        for (int c = 0; c < channels; ++c) {
+            const float* src = frame.data[std::min(c, frame.channels - 1)];
+            if (!src) {
+                src = frame.data[0];
+            }
+            for (int i = 0; i < count; ++i) {
+                float v = std::max(-1.0f, std::min(1.0f, src[offset + i]));
+                pcm_[static_cast<size_t>(buffered_ + i) * channels + c] =
+                    static_cast<int16_t>(std::lrint(v * 32767.0f));
+            }
+        }
+        buffered_ += count;
+        offset += count;
+
+        if (buffered_ == frameLength_) {
+            encodeBuffered(false);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 把缓冲的采样送入编码器
+ * @param[in] flush true表示冲刷模式（不送入新采样）
+ * @return true表示本次产生了数据包
+ */
+bool AACEncoder::encodeBuffered(bool flush) {
+    AACENC_BufDesc inDesc = {};
+    AACENC_BufDesc outDesc = {};
+    AACENC_InArgs inArgs = {};
+    AACENC_OutArgs outArgs = {};
+
+    void* inPtr = pcm_.data();
+    INT inId = IN_AUDIO_DATA;
+    INT inSize = static_cast<INT>(buffered_ * settings_.channels * sizeof(int16_t));
+    INT inElemSize = sizeof(int16_t);
+    inDesc.numBufs = 1;
+    inDesc.bufs = &inPtr;
+    inDesc.bufferIdentifiers = &inId;
+    inDesc.bufSizes = &inSize;
+    inDesc.bufElSizes = &inElemSize;
+
+    void* outPtr = output_.data();
+    INT outId = OUT_BITSTREAM_DATA;
+    INT outSize = static_cast<INT>(output_.size());
+    INT outElemSize = 1;
+    outDesc.numBufs = 1;
+    outDesc.bufs = &outPtr;
+    outDesc.bufferIdentifiers = &outId;
+    outDesc.bufSizes = &outSize;
+    outDesc.bufElSizes = &outElemSize;
+
+    inArgs.numInSamples = flush ? -1 : buffered_ * settings_.channels;
+
+    AACENC_ERROR err = aacEncEncode(handle_, &inDesc, &outDesc, &inArgs, &outArgs);
+    if (!flush) {
+        // 只移除编码器实际接收的采样，其余留在缓冲区开头等待下次送入；
+        // 出错或缓冲区已满却毫无进展时丢弃整个缓冲区，避免卡死
+        int consumed = buffered_;
+        if (err == AACENC_OK && outArgs.numInSamples >= 0 &&
+            outArgs.numInSamples < buffered_ * settings_.channels) {
+            consumed = outArgs.numInSamples / settings_.channels;
+            if (consumed == 0 && buffered_ == frameLength_) {
+                LOG_WARN("AAC encoder {} accepted no input, dropping {} samples", name_, buffered_);
+                consumed = buffered_;
+            }
+        }
+        std::copy(pcm_.begin() + static_cast<size_t>(consumed) * settings_.channels,
+                  pcm_.begin() + static_cast<size_t>(buffered_) * settings_.channels, pcm_.begin());
+        encodedSamples_ += consumed;
+        buffered_ -= consumed;
+    }
+    if (err != AACENC_OK || outArgs.numOutBytes <= 0) {
+        if (err != AACENC_OK && err != AACENC_ENCODE_EOF) {
+            LOG_ERROR("AAC encoder {} encode failed: {}", name_, static_cast<int>(err));
+        }
+        return false;
+    }
+
+    EncodedPacket packet;
+    packet.data.assign(output_.data(), output_.data() + outArgs.numOutBytes);
+    // 编码器输出比输入晚delay_个采样（启动时的预填充），减去后首个解码采样与输入对齐
+    packet.pts = audioTimestamp(outputFrames_ * frameLength_ - delay_, settings_.sample_rate);
+    packet.dts = packet.pts;
+    packet.duration = FrameTime(static_cast<int64_t>(frameLength_) * 1000000 / settings_.sample_rate);
+    packet.type = PacketType::Audio;
+    packet.track = settings_.track;
+    packet.keyframe = true;
+    pushPacket(std::move(packet));
+    ++outputFrames_;
+    return true;
+}
+
+} // namespace SimpleOBS
+
+#endif // SIMPLEOBS_HAVE_FDK_AAC
@@ -0,0 +1,71 @@
+/**
+ * @file AACEncoder.h
+ * @brief 基于fdk-aac的AAC-LC音频编码器
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了AAC-LC编码器，仅在构建时检测到fdk-aac库时可用
+ * （SIMPLEOBS_HAVE_FDK_AAC）。输出为原始AAC帧（不带ADTS头），
+ * AudioSpecificConfig通过getExtraData()提供。
+ *
+ * @note
+ * - 输出时间戳按已输出帧数推算，编码器延迟（priming）由封装层处理
+ */
+
+#pragma once
+
+#include "BaseEncoder.h"
+
+#ifdef SIMPLEOBS_HAVE_FDK_AAC
+
+#include <cstdint>
+#include <vector>
+
+struct AACENCODER;
+
+namespace SimpleOBS {
+
+/**
+ * @brief AAC-LC编码器
+ */
+class AACEncoder : public BaseEncoder {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] name 编码器名称
+     * @param[in] settings 编码配置，使用sample_rate、channels、bitrate和track
+     */
+    explicit AACEncoder(const std::string& name,
+                        const AudioEncoderSettings& settings = AudioEncoderSettings{});
+    ~AACEncoder() override;
+
+    std::string getId() const override { return "aac"; }
+    bool initialize() override;
+
+    /**
+     * @brief 关闭编码器
+     * @details 冲刷编码器内部缓冲，剩余数据包仍可取走
+     */
+    void shutdown() override;
+
+    using BaseEncoder::encodeFrame;
+    bool encodeFrame(const AudioFrame& frame) override;
+
+private:
+    bool encodeBuffered(bool flush);
+
+    AudioEncoderSettings settings_;      ///< 编码配置
+    AACENCODER* handle_ = nullptr;       ///< fdk-aac编码器句柄
+    int frameLength_ = 1024;             ///< 每帧采样点数
+    std::vector<int16_t> pcm_;           ///< 交错16位输入缓冲区
+    int buffered_ = 0;                   ///< 已缓冲的采样点数
+    int64_t outputFrames_ = 0;           ///< 已输出的帧数
+    int delay_ = 0;                      ///< 编码器延迟（采样点），输出包时间戳需减去该值
+    std::vector<uint8_t> output_;        ///< 编码输出缓冲区
+};
+
+} // namespace SimpleOBS
+
+#endif // SIMPLEOBS_HAVE_FDK_AAC
@@ -1,9 +1,97 @@
-#include "SimpleOBS.h"
-#include <iostream>
+/**
+ * @file BaseEncoder.cpp
+ * @brief 编码器基类实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "BaseEncoder.h"
+#include "Logger.h"
 
 namespace SimpleOBS {
 
-// 基础编码器实现
-// 这个文件暂时为空，后续可以实现编码器基类
+namespace {
+
+// 输入时间戳与推算值相差超过该阈值时视为断流，重新对齐时间基准
+constexpr int64_t kResyncThresholdUs = 100000;
+
+} // namespace
+
+BaseEncoder::BaseEncoder(const std::string& name) : name_(name) {}
+
+bool BaseEncoder::encodeFrame(const VideoFrame& frame) {
+    (void)frame;
+    LOG_WARN("Encoder {} does not accept video frames", name_);
+    return false;
+}
+
+bool BaseEncoder::encodeFrame(const AudioFrame& frame) {
+    (void)frame;
+    LOG_WARN("Encoder {} does not accept audio frames", name_);
+    return false;
+}
+
+bool BaseEncoder::receivePacket(EncodedPacket& packet) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (packets_.empty()) {
+        return false;
+    }
+    packet = std::move(packets_.front());
+    packets_.pop_front();
+    return true;
+}
+
+bool BaseEncoder::getExtraData(std::vector<uint8_t>& data) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (extraData_.empty()) {
+        return false;
+    }
+    data = extraData_;
+    return true;
+}
+
+size_t BaseEncoder::pendingPackets() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return packets_.size();
+}
+
+void BaseEncoder::pushPacket(EncodedPacket&& packet) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    packets_.push_back(std::move(packet));
+}
+
+void BaseEncoder::setExtraData(std::vector<uint8_t> data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    extraData_ = std::move(data);
+}
+
+void BaseEncoder::trackAudioInput(FrameTime timestamp, int64_t bufferedSamples, int sampleRate) {
+    const int64_t position = encodedSamples_ + bufferedSamples;
+    if (!timeBaseValid_) {
+        timeBase_ = timestamp - FrameTime(position * 1000000 / sampleRate);
+        timeBaseValid_ = true;
+        return;
+    }
+
+    FrameTime expected = audioTimestamp(position, sampleRate);
+    int64_t drift = (timestamp - expected).count();
+    if (drift > kResyncThresholdUs || drift < -kResyncThresholdUs) {
+        LOG_WARN("Encoder {} audio discontinuity of {} us, resyncing timestamps", name_, drift);
+        timeBase_ = timestamp - FrameTime(position * 1000000 / sampleRate);
+    }
+}
+
+FrameTime BaseEncoder::audioTimestamp(int64_t sampleIndex, int sampleRate) const {
+    return timeBase_ + FrameTime(sampleIndex * 1000000 / sampleRate);
+}
+
+void BaseEncoder::resetTimeline() {
+    encodedSamples_ = 0;
+    timeBaseValid_ = false;
+    timeBase_ = FrameTime(0);
+    std::lock_guard<std::mutex> lock(mutex_);
+    packets_.clear();
+}
 
 } // namespace SimpleOBS
@@ -0,0 +1,107 @@
+/**
+ * @file BaseEncoder.h
+ * @brief 编码器基类与音频编码配置
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了编码器的公共基类BaseEncoder，负责数据包队列、配置数据
+ * 以及基于采样计数的音频时间戳推算，具体编码器只需实现编码逻辑。
+ *
+ * @note
+ * - 音频时间戳按已编码采样数推算，不受源时间戳抖动影响
+ * - 输入时间戳与推算值偏差过大时重新对齐（视为断流）
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 音频编码器配置
+ */
+struct AudioEncoderSettings {
+    int sample_rate = 48000;      ///< 采样率（Hz）
+    int channels = 2;             ///< 声道数
+    int bits_per_sample = 16;     ///< 无损编码的采样位深（FLAC：16或24）
+    int block_size = 4096;        ///< 无损编码的块大小（采样点）
+    int max_lpc_order = 8;        ///< 无损编码的最大线性预测阶数（0表示只用固定预测器）
+    int bitrate = 160000;         ///< 有损编码的码率（bps）
+    int track = 0;                ///< 输出数据包的轨道索引
+};
+
+/**
+ * @brief 编码器基类
+ * @details 实现数据包队列和配置数据管理，子类通过pushPacket()输出
+ */
+class BaseEncoder : public Encoder {
+public:
+    explicit BaseEncoder(const std::string& name);
+    ~BaseEncoder() override = default;
+
+    std::string getName() const override { return name_; }
+
+    bool encodeFrame(const VideoFrame& frame) override;
+    bool encodeFrame(const AudioFrame& frame) override;
+    bool receivePacket(EncodedPacket& packet) override;
+    bool getExtraData(std::vector<uint8_t>& data) const override;
+
+    /**
+     * @brief 获取尚未取走的数据包数量
+     * @return 数据包数量
+     */
+    size_t pendingPackets() const;
+
+protected:
+    /**
+     * @brief 输出一个数据包
+     * @param[in] packet 编码完成的数据包
+     */
+    void pushPacket(EncodedPacket&& packet);
+
+    /**
+     * @brief 设置编解码器配置数据
+     * @param[in] data 配置数据
+     */
+    void setExtraData(std::vector<uint8_t> data);
+
+    /**
+     * @brief 记录输入音频的时间戳，用于推算输出时间戳
+     * @param[in] timestamp 输入帧第一个采样的时间戳
+     * @param[in] bufferedSamples 输入帧之前已缓冲但未编码的采样数
+     * @param[in] sampleRate 采样率
+     */
+    void trackAudioInput(FrameTime timestamp, int64_t bufferedSamples, int sampleRate);
+
+    /**
+     * @brief 推算指定采样位置的时间戳
+     * @param[in] sampleIndex 从时间基准起算的采样序号
+     * @param[in] sampleRate 采样率
+     * @return 时间戳
+     */
+    FrameTime audioTimestamp(int64_t sampleIndex, int sampleRate) const;
+
+    /**
+     * @brief 清空内部状态
+     */
+    void resetTimeline();
+
+    std::string name_;                 ///< 编码器名称
+    int64_t encodedSamples_ = 0;       ///< 已送入编码的采样数（相对时间基准）
+
+private:
+    mutable std::mutex mutex_;         ///< 保护数据包队列
+    std::deque<EncodedPacket> packets_;  ///< 待取走的数据包
+    std::vector<uint8_t> extraData_;   ///< 编解码器配置数据
+    FrameTime timeBase_{0};            ///< 采样序号0对应的时间戳
+    bool timeBaseValid_ = false;       ///< 时间基准是否已建立
+};
+
+} // namespace SimpleOBS
@@ -0,0 +1,59 @@
+/**
+ * @file EncoderModules.cpp
+ * @brief 内置编码器模块登记
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "ModuleRegistry.h"
+#include "FLACEncoder.h"
+#ifdef SIMPLEOBS_HAVE_FDK_AAC
+#include "AACEncoder.h"
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+/**
+ * @brief 按引擎音频格式生成编码配置
+ */
+AudioEncoderSettings engineAudioSettings() {
+    const AudioSettings audio = Engine::getInstance().getAudioSettings();
+    AudioEncoderSettings settings;
+    settings.sample_rate = audio.sample_rate;
+    settings.channels = audio.channels;
+    return settings;
+}
+
+} // anonymous namespace
+
+/**
+ * @brief 登记内置编码器模块
+ * @param[in] registry 模块注册表
+ *
+ * @note 编码器在第一次创建对应类型时才注册工厂
+ */
+void registerEncoderModules(ModuleRegistry& registry) {
+    ModuleDescriptor audio;
+    audio.name = "encoders.audio";
+    audio.encoders = {"flac"};
+#ifdef SIMPLEOBS_HAVE_FDK_AAC
+    audio.encoders.push_back("aac");
+#endif
+    audio.load = [](ModuleRegistry& r) {
+        r.registerEncoder("flac", [](const std::string& name) -> EncoderPtr {
+            return std::make_shared<FLACEncoder>(name, engineAudioSettings());
+        });
+#ifdef SIMPLEOBS_HAVE_FDK_AAC
+        r.registerEncoder("aac", [](const std::string& name) -> EncoderPtr {
+            return std::make_shared<AACEncoder>(name, engineAudioSettings());
+        });
+#endif
+        return true;
+    };
+    registry.addModule(std::move(audio));
+}
+
+} // namespace SimpleOBS
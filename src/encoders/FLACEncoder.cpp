@@ -0,0 +1,878 @@
+/**
+ * @file FLACEncoder.cpp
+ * @brief FLAC无损音频编码器实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件实现了FLAC比特流的帧、子帧与残差编码。
+ * 线性预测系数由加窗自相关经Levinson-Durbin递推求得，
+ * 阶数按误差估计选择，最终方案以精确的位数比较决定。
+ *
+ * @note
+ * - 流头（fLaC + STREAMINFO）通过getExtraData()提供，数据包只包含帧
+ * - 总采样数与MD5在实时编码时未知，按规范填0
+ */
+
+#include "FLACEncoder.h"
+#include "CpuFeatures.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace SimpleOBS {
+
+namespace {
+
+constexpr int kMaxLpcOrder = 32;
+constexpr int kMaxPartitionOrder = 8;
+
+/**
+ * @brief FLAC使用的CRC表
+ */
+struct CrcTables {
+    uint8_t crc8[256];
+    uint16_t crc16[256];
+
+    CrcTables() {
+        for (int i = 0; i < 256; ++i) {
+            uint8_t c8 = static_cast<uint8_t>(i);
+            for (int b = 0; b < 8; ++b) {
+                c8 = static_cast<uint8_t>((c8 & 0x80) ? (c8 << 1) ^ 0x07 : (c8 << 1));
+            }
+            crc8[i] = c8;
+
+            uint16_t c16 = static_cast<uint16_t>(i << 8);
+            for (int b = 0; b < 8; ++b) {
+                c16 = static_cast<uint16_t>((c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : (c16 << 1));
+            }
+            crc16[i] = c16;
+        }
+    }
+};
+
+const CrcTables& crcTables() {
+    static const CrcTables tables;
+    return tables;
+}
+
+uint8_t crc8(const uint8_t* data, size_t size) {
+    const auto& t = crcTables();
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc = t.crc8[crc ^ data[i]];
+    }
+    return crc;
+}
+
+uint16_t crc16(const uint8_t* data, size_t size) {
+    const auto& t = crcTables();
+    uint16_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc = static_cast<uint16_t>((crc << 8) ^ t.crc16[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+// ---------------------------------------------------------------------------
+// 自相关内核
+// ---------------------------------------------------------------------------
+
+void autocorrelationScalar(const double* x, int n, int maxLag, double* r) {
+    for (int lag = 0; lag <= maxLag; ++lag) {
+        double sum = 0.0;
+        for (int i = lag; i < n; ++i) {
+            sum += x[i] * x[i - lag];
+        }
+        r[lag] = sum;
+    }
+}
+
+#ifdef SIMPLEOBS_X86
+void autocorrelationSse2(const double* x, int n, int maxLag, double* r) {
+    for (int lag = 0; lag <= maxLag; ++lag) {
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        int i = lag;
+        for (; i + 4 <= n; i += 4) {
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(x + i - lag)));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(x + i + 2 - lag)));
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+        double sum = lanes[0] + lanes[1];
+        for (; i < n; ++i) {
+            sum += x[i] * x[i - lag];
+        }
+        r[lag] = sum;
+    }
+}
+
+SIMPLEOBS_TARGET_AVX2
+void autocorrelationAvx2(const double* x, int n, int maxLag, double* r) {
+    for (int lag = 0; lag <= maxLag; ++lag) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        int i = lag;
+        for (; i + 8 <= n; i += 8) {
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(x + i - lag), acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(x + i + 4 - lag), acc1);
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+        double sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        for (; i < n; ++i) {
+            sum += x[i] * x[i - lag];
+        }
+        r[lag] = sum;
+    }
+}
+#endif
+
+using AutocorrelationFn = void (*)(const double*, int, int, double*);
+
+AutocorrelationFn selectAutocorrelation() {
+#ifdef SIMPLEOBS_X86
+    if (cpuHasAvx2()) {
+        return autocorrelationAvx2;
+    }
+    if (cpuHasSse2()) {
+        return autocorrelationSse2;
+    }
+#endif
+    return autocorrelationScalar;
+}
+
+const AutocorrelationFn autocorrelation = selectAutocorrelation();
+
+/**
+ * @brief Tukey(0.5)窗
+ */
+void buildWindow(std::vector<double>& window, int n) {
+    const double alpha = 0.5;
+    const int edge = static_cast<int>(alpha / 2.0 * (n - 1));
+    for (int i = 0; i < n; ++i) {
+        double w = 1.0;
+        if (edge > 0 && i < edge) {
+            w = 0.5 * (1.0 - std::cos(M_PI * i / edge));
+        } else if (edge > 0 && i > n - 1 - edge) {
+            w = 0.5 * (1.0 - std::cos(M_PI * (n - 1 - i) / edge));
+        }
+        window[i] = w;
+    }
+}
+
+int blockSizeCode(int n) {
+    switch (n) {
+        case 192: return 1;
+        case 576: return 2;
+        case 1152: return 3;
+        case 2304: return 4;
+        case 4608: return 5;
+        case 256: return 8;
+        case 512: return 9;
+        case 1024: return 10;
+        case 2048: return 11;
+        case 4096: return 12;
+        case 8192: return 13;
+        case 16384: return 14;
+        case 32768: return 15;
+        default: return n <= 256 ? 6 : 7;
+    }
+}
+
+int sampleRateCode(int rate) {
+    switch (rate) {
+        case 88200: return 1;
+        case 176400: return 2;
+        case 192000: return 3;
+        case 8000: return 4;
+        case 16000: return 5;
+        case 22050: return 6;
+        case 24000: return 7;
+        case 32000: return 8;
+        case 44100: return 9;
+        case 48000: return 10;
+        case 96000: return 11;
+        default: return 0;  // 从STREAMINFO读取
+    }
+}
+
+int sampleSizeCode(int bps) {
+    switch (bps) {
+        case 8: return 1;
+        case 12: return 2;
+        case 16: return 4;
+        case 20: return 5;
+        case 24: return 6;
+        default: return 0;
+    }
+}
+
+inline uint32_t foldSigned(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+/**
+ * @brief 二阶差分绝对值之和，用于快速比较声道组合的代价
+ */
+uint64_t estimateChannelCost(const int32_t* x, int n) {
+    uint64_t sum = 0;
+    for (int i = 2; i < n; ++i) {
+        int64_t d = static_cast<int64_t>(x[i]) - 2 * static_cast<int64_t>(x[i - 1]) + x[i - 2];
+        sum += static_cast<uint64_t>(d < 0 ? -d : d);
+    }
+    return sum;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// BitWriter
+// ---------------------------------------------------------------------------
+
+void FLACEncoder::BitWriter::put(uint32_t value, int count) {
+    if (count <= 0) {
+        return;
+    }
+    uint64_t mask = (count >= 32) ? 0xFFFFFFFFull : ((1ull << count) - 1);
+    acc_ = (acc_ << count) | (value & mask);
+    bits_ += count;
+    while (bits_ >= 8) {
+        bits_ -= 8;
+        bytes_.push_back(static_cast<uint8_t>(acc_ >> bits_));
+    }
+    acc_ &= (1ull << bits_) - 1;
+}
+
+void FLACEncoder::BitWriter::putSigned(int32_t value, int count) {
+    put(static_cast<uint32_t>(value), count);
+}
+
+void FLACEncoder::BitWriter::putUnary(uint32_t zeros) {
+    while (zeros >= 31) {
+        put(0, 31);
+        zeros -= 31;
+    }
+    put(1, static_cast<int>(zeros) + 1);
+}
+
+void FLACEncoder::BitWriter::putRice(int32_t value, int parameter) {
+    uint32_t folded = foldSigned(value);
+    putUnary(folded >> parameter);
+    put(folded, parameter);
+}
+
+void FLACEncoder::BitWriter::alignZero() {
+    if (bits_ > 0) {
+        put(0, 8 - bits_);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// FLACEncoder
+// ---------------------------------------------------------------------------
+
+FLACEncoder::FLACEncoder(const std::string& name, const AudioEncoderSettings& settings)
+    : BaseEncoder(name), settings_(settings) {}
+
+FLACEncoder::~FLACEncoder() {
+    shutdown();
+}
+
+/**
+ * @brief 初始化编码器
+ * @return true表示初始化成功，false表示配置无效
+ *
+ * @details
+ * 1. 校验采样率、声道数、位深和块大小
+ * 2. 分配输入、分析窗和残差缓冲区
+ * 3. 生成流头作为配置数据
+ */
+bool FLACEncoder::initialize() {
+    if (initialized_) {
+        return true;
+    }
+
+    const auto& s = settings_;
+    if (s.sample_rate <= 0 || s.sample_rate > 655350 || s.channels < 1 || s.channels > 8 ||
+        s.bits_per_sample < 8 || s.bits_per_sample > 24 || s.block_size < 16 || s.block_size > 65535) {
+        LOG_ERROR("FLAC encoder {} invalid settings: rate={}, channels={}, bps={}, block={}",
+                  name_, s.sample_rate, s.channels, s.bits_per_sample, s.block_size);
+        return false;
+    }
+    settings_.max_lpc_order = std::max(0, std::min(settings_.max_lpc_order, kMaxLpcOrder));
+
+    const size_t block = static_cast<size_t>(s.block_size);
+    input_.assign(block * s.channels, 0);
+    window_.assign(block, 0.0);
+    windowed_.assign(block, 0.0);
+    stereo_.assign(block * 2, 0);
+    residualA_.assign(block, 0);
+    residualB_.assign(block, 0);
+    folded_.assign(block, 0);
+    // 最坏情况为原始子帧，外加帧头与对齐
+    writer_.bytes().reserve(block * s.channels * (s.bits_per_sample + 1) / 8 + 64);
+    buildWindow(window_, s.block_size);
+
+    buffered_ = 0;
+    frameNumber_ = 0;
+    resetTimeline();
+    writeStreamHeader();
+
+    initialized_ = true;
+    LOG_INFO("FLAC encoder {} initialized: rate={}, channels={}, bps={}, block={}, lpc={}",
+             name_, s.sample_rate, s.channels, s.bits_per_sample, s.block_size, settings_.max_lpc_order);
+    return true;
+}
+
+void FLACEncoder::shutdown() {
+    if (!initialized_) {
+        return;
+    }
+    if (buffered_ > 0) {
+        encodeBlock(buffered_);
+        buffered_ = 0;
+    }
+    initialized_ = false;
+    LOG_INFO("FLAC encoder {} shut down after {} frames", name_, frameNumber_);
+}
+
+/**
+ * @brief 编码音频帧
+ * @param[in] frame 输入音频帧（平面float，采样率需与配置一致）
+ * @return true表示成功
+ *
+ * @details 输入被量化为整数后累积，每满一个块编码一帧
+ */
+bool FLACEncoder::encodeFrame(const AudioFrame& frame) {
+    if (!initialized_ || frame.samples <= 0 || frame.channels <= 0 || !frame.data[0]) {
+        return false;
+    }
+    if (frame.sample_rate != settings_.sample_rate) {
+        LOG_ERROR("FLAC encoder {} expects {} Hz, got {} Hz", name_, settings_.sample_rate, frame.sample_rate);
+        return false;
+    }
+
+    trackAudioInput(frame.timestamp, buffered_, settings_.sample_rate);
+
+    const int block = settings_.block_size;
+    const int channels = settings_.channels;
+    const int bps = settings_.bits_per_sample;
+    const float scale = static_cast<float>((1 << (bps - 1)) - 1);
+    const int32_t maxValue = (1 << (bps - 1)) - 1;
+    const int32_t minValue = -(1 << (bps - 1));
+
+    int offset = 0;
+    while (offset < frame.samples) {
+        int count = std::min(block - buffered_, frame.samples - offset);
+        for (int c = 0; c < channels; ++c) {
+            const float* src = frame.data[std::min(c, frame.channels - 1)];
+            if (!src) {
+                src = frame.data[0];
+            }
+            int32_t* dst = input_.data() + static_cast<size_t>(c) * block + buffered_;
+            for (int i = 0; i < count; ++i) {
+                long v = std::lrint(src[offset + i] * scale);
+                dst[i] = static_cast<int32_t>(std::max<long>(minValue, std::min<long>(maxValue, v)));
+            }
+        }
+        buffered_ += count;
+        offset += count;
+
+        if (buffered_ == block) {
+            encodeBlock(block);
+            buffered_ = 0;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 生成流头：fLaC标记与STREAMINFO元数据块
+ */
+void FLACEncoder::writeStreamHeader() {
+    BitWriter header;
+    header.bytes().reserve(42);
+    header.put('f', 8);
+    header.put('L', 8);
+    header.put('a', 8);
+    header.put('C', 8);
+    header.put(1, 1);                    // 最后一个元数据块
+    header.put(0, 7);                    // STREAMINFO
+    header.put(34, 24);
+    header.put(static_cast<uint32_t>(settings_.block_size), 16);
+    header.put(static_cast<uint32_t>(settings_.block_size), 16);
+    header.put(0, 24);                   // 最小帧长未知
+    header.put(0, 24);                   // 最大帧长未知
+    header.put(static_cast<uint32_t>(settings_.sample_rate), 20);
+    header.put(static_cast<uint32_t>(settings_.channels - 1), 3);
+    header.put(static_cast<uint32_t>(settings_.bits_per_sample - 1), 5);
+    header.put(0, 4);                    // 总采样数未知（36位）
+    header.put(0, 32);
+    for (int i = 0; i < 4; ++i) {
+        header.put(0, 32);               // MD5未计算
+    }
+    setExtraData(header.bytes());
+}
+
+/**
+ * @brief 编码一帧
+ * @param[in] samples 本帧采样点数
+ *
+ * @details
+ * 1. 立体声时估算四种声道组合的代价并选择最小者
+ * 2. 写入帧头与CRC-8
+ * 3. 逐声道规划并写入子帧
+ * 4. 字节对齐后写入CRC-16，输出数据包
+ */
+void FLACEncoder::encodeBlock(int samples) {
+    const int block = settings_.block_size;
+    const int channels = settings_.channels;
+    const int bps = settings_.bits_per_sample;
+
+    if (samples != block) {
+        // 尾帧长度不同，临时重建分析窗
+        buildWindow(window_, samples);
+    }
+
+    const int32_t* subframes[8] = {};
+    int subframeBps[8] = {};
+    for (int c = 0; c < channels; ++c) {
+        subframes[c] = input_.data() + static_cast<size_t>(c) * block;
+        subframeBps[c] = bps;
+    }
+
+    int channelCode = channels - 1;
+    if (channels == 2) {
+        const int32_t* left = subframes[0];
+        const int32_t* right = subframes[1];
+        int32_t* mid = stereo_.data();
+        int32_t* side = stereo_.data() + block;
+        for (int i = 0; i < samples; ++i) {
+            mid[i] = (left[i] + right[i]) >> 1;
+            side[i] = left[i] - right[i];
+        }
+
+        uint64_t costL = estimateChannelCost(left, samples);
+        uint64_t costR = estimateChannelCost(right, samples);
+        uint64_t costM = estimateChannelCost(mid, samples);
+        uint64_t costS = estimateChannelCost(side, samples);
+
+        uint64_t best = costL + costR;
+        if (costL + costS < best) {
+            best = costL + costS;
+            channelCode = 8;
+            subframes[1] = side;
+            subframeBps[1] = bps + 1;
+        }
+        if (costR + costS < best) {
+            best = costR + costS;
+            channelCode = 9;
+            subframes[0] = side;
+            subframeBps[0] = bps + 1;
+            subframes[1] = right;
+            subframeBps[1] = bps;
+        }
+        if (costM + costS < best) {
+            channelCode = 10;
+            subframes[0] = mid;
+            subframeBps[0] = bps;
+            subframes[1] = side;
+            subframeBps[1] = bps + 1;
+        }
+    }
+
+    writer_.clear();
+
+    // 帧头：同步码、固定块大小策略
+    const int bsCode = blockSizeCode(samples);
+    writer_.put(0xFFF8, 16);
+    writer_.put(static_cast<uint32_t>(bsCode), 4);
+    writer_.put(static_cast<uint32_t>(sampleRateCode(settings_.sample_rate)), 4);
+    writer_.put(static_cast<uint32_t>(channelCode), 4);
+    writer_.put(static_cast<uint32_t>(sampleSizeCode(bps)), 3);
+    writer_.put(0, 1);
+
+    // 帧序号使用UTF-8风格的变长编码
+    uint32_t number = frameNumber_ & 0x7FFFFFFF;
+    if (number < 0x80) {
+        writer_.put(number, 8);
+    } else {
+        int extra = number < 0x800 ? 1 : number < 0x10000 ? 2 : number < 0x200000 ? 3 :
+                    number < 0x4000000 ? 4 : 5;
+        uint32_t lead = (0xFF00u >> (extra + 1)) & 0xFF;
+        writer_.put(lead | (number >> (6 * extra)), 8);
+        for (int i = extra - 1; i >= 0; --i) {
+            writer_.put(0x80 | ((number >> (6 * i)) & 0x3F), 8);
+        }
+    }
+
+    if (bsCode == 6) {
+        writer_.put(static_cast<uint32_t>(samples - 1), 8);
+    } else if (bsCode == 7) {
+        writer_.put(static_cast<uint32_t>(samples - 1), 16);
+    }
+    writer_.put(crc8(writer_.data(), writer_.size()), 8);
+
+    for (int c = 0; c < channels; ++c) {
+        SubframePlan plan;
+        planSubframe(subframes[c], samples, subframeBps[c], plan);
+        const int32_t* residual = (plan.type == SubframePlan::Type::Fixed) ? residualA_.data() : residualB_.data();
+        writeSubframe(subframes[c], samples, subframeBps[c], plan, residual);
+    }
+
+    writer_.alignZero();
+    writer_.put(crc16(writer_.data(), writer_.size()), 16);
+
+    EncodedPacket packet;
+    packet.data.assign(writer_.data(), writer_.data() + writer_.size());
+    packet.pts = audioTimestamp(encodedSamples_, settings_.sample_rate);
+    packet.dts = packet.pts;
+    packet.duration = FrameTime(static_cast<int64_t>(samples) * 1000000 / settings_.sample_rate);
+    packet.type = PacketType::Audio;
+    packet.track = settings_.track;
+    packet.keyframe = true;
+    pushPacket(std::move(packet));
+
+    encodedSamples_ += samples;
+    ++frameNumber_;
+
+    if (samples != block) {
+        buildWindow(window_, block);
+    }
+}
+
+/**
+ * @brief 规划子帧编码方案
+ * @param[in] x 声道采样
+ * @param[in] n 采样点数
+ * @param[in] bps 该声道的位深（侧声道多1位）
+ * @param[out] plan 编码方案
+ *
+ * @details
+ * 固定预测器的残差写入residualA_，LPC残差写入residualB_，
+ * 按精确位数在常量、原始、固定预测器和LPC之间选择。
+ */
+void FLACEncoder::planSubframe(const int32_t* x, int n, int bps, SubframePlan& plan) {
+    plan = SubframePlan{};
+
+    bool constant = true;
+    for (int i = 1; i < n && constant; ++i) {
+        constant = (x[i] == x[0]);
+    }
+    if (constant) {
+        plan.type = SubframePlan::Type::Constant;
+        plan.bits = 8 + static_cast<uint64_t>(bps);
+        return;
+    }
+
+    plan.type = SubframePlan::Type::Verbatim;
+    plan.bits = 8 + static_cast<uint64_t>(n) * bps;
+
+    // 固定预测器：按残差绝对值之和选阶
+    const int maxFixed = std::min(4, n - 1);
+    uint64_t sums[5] = {};
+    for (int i = maxFixed; i < n; ++i) {
+        int64_t e0 = x[i];
+        int64_t e1 = e0 - x[i - 1];
+        int64_t e2 = maxFixed >= 2 ? e1 - (static_cast<int64_t>(x[i - 1]) - x[i - 2]) : 0;
+        int64_t e3 = maxFixed >= 3 ? e2 - (static_cast<int64_t>(x[i - 1]) - 2 * static_cast<int64_t>(x[i - 2]) + x[i - 3]) : 0;
+        int64_t e4 = maxFixed >= 4 ? e3 - (static_cast<int64_t>(x[i - 1]) - 3 * static_cast<int64_t>(x[i - 2]) +
+                                            3 * static_cast<int64_t>(x[i - 3]) - x[i - 4]) : 0;
+        sums[0] += static_cast<uint64_t>(std::llabs(e0));
+        sums[1] += static_cast<uint64_t>(std::llabs(e1));
+        sums[2] += static_cast<uint64_t>(std::llabs(e2));
+        sums[3] += static_cast<uint64_t>(std::llabs(e3));
+        sums[4] += static_cast<uint64_t>(std::llabs(e4));
+    }
+    int fixedOrder = 0;
+    for (int o = 1; o <= maxFixed; ++o) {
+        if (sums[o] < sums[fixedOrder]) {
+            fixedOrder = o;
+        }
+    }
+
+    int32_t* resA = residualA_.data();
+    for (int i = fixedOrder; i < n; ++i) {
+        int64_t e;
+        switch (fixedOrder) {
+            case 0: e = x[i]; break;
+            case 1: e = static_cast<int64_t>(x[i]) - x[i - 1]; break;
+            case 2: e = static_cast<int64_t>(x[i]) - 2 * static_cast<int64_t>(x[i - 1]) + x[i - 2]; break;
+            case 3: e = static_cast<int64_t>(x[i]) - 3 * static_cast<int64_t>(x[i - 1]) +
+                        3 * static_cast<int64_t>(x[i - 2]) - x[i - 3]; break;
+            default: e = static_cast<int64_t>(x[i]) - 4 * static_cast<int64_t>(x[i - 1]) +
+                         6 * static_cast<int64_t>(x[i - 2]) - 4 * static_cast<int64_t>(x[i - 3]) + x[i - 4]; break;
+        }
+        resA[i] = static_cast<int32_t>(e);
+    }
+
+    SubframePlan fixed;
+    fixed.type = SubframePlan::Type::Fixed;
+    fixed.order = fixedOrder;
+    fixed.bits = 8 + static_cast<uint64_t>(fixedOrder) * bps + planResidual(resA, n, fixedOrder, fixed);
+    if (fixed.bits < plan.bits) {
+        plan = fixed;
+    }
+
+    // 线性预测
+    const int maxOrder = std::min(settings_.max_lpc_order, n / 2);
+    if (maxOrder < 1) {
+        return;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        windowed_[i] = x[i] * window_[i];
+    }
+    double r[kMaxLpcOrder + 1] = {};
+    autocorrelation(windowed_.data(), n, maxOrder, r);
+    if (r[0] <= 0.0) {
+        return;
+    }
+    r[0] *= 1.0 + 1e-9;  // 轻微正则化，避免病态矩阵
+
+    // Levinson-Durbin递推，保存每一阶的系数与预测误差
+    double lpc[kMaxLpcOrder][kMaxLpcOrder] = {};
+    double errors[kMaxLpcOrder + 1] = {};
+    double a[kMaxLpcOrder + 1] = {};
+    double err = r[0];
+    int orders = 0;
+    for (int i = 1; i <= maxOrder; ++i) {
+        double acc = r[i];
+        for (int j = 1; j < i; ++j) {
+            acc -= a[j] * r[i - j];
+        }
+        double k = acc / err;
+        double next[kMaxLpcOrder + 1] = {};
+        next[i] = k;
+        for (int j = 1; j < i; ++j) {
+            next[j] = a[j] - k * a[i - j];
+        }
+        std::copy(next, next + i + 1, a);
+        err *= (1.0 - k * k);
+        if (err <= 0.0) {
+            break;
+        }
+        for (int j = 0; j < i; ++j) {
+            lpc[i - 1][j] = a[j + 1];
+        }
+        errors[i] = err;
+        orders = i;
+    }
+    if (orders == 0) {
+        return;
+    }
+
+    const int precision = bps <= 16 ? 14 : 15;
+
+    // 按残差能量估计每阶位数，选择最优阶数
+    int order = 1;
+    double bestEstimate = 1e300;
+    for (int o = 1; o <= orders; ++o) {
+        double perSample = 0.5 * std::log2(std::max(errors[o] / n, 1e-12));
+        double estimate = std::max(0.0, perSample) * (n - o) + static_cast<double>(o) * (precision + bps);
+        if (estimate < bestEstimate) {
+            bestEstimate = estimate;
+            order = o;
+        }
+    }
+
+    // 量化系数，使用误差反馈减小舍入损失
+    double cmax = 0.0;
+    for (int j = 0; j < order; ++j) {
+        cmax = std::max(cmax, std::fabs(lpc[order - 1][j]));
+    }
+    if (cmax <= 0.0) {
+        return;
+    }
+    int exponent = 0;
+    std::frexp(cmax, &exponent);
+    int shift = std::max(0, std::min(15, precision - 1 - exponent));
+    const int32_t qmax = (1 << (precision - 1)) - 1;
+    const int32_t qmin = -(1 << (precision - 1));
+
+    SubframePlan lpcPlan;
+    lpcPlan.type = SubframePlan::Type::Lpc;
+    lpcPlan.order = order;
+    lpcPlan.precision = precision;
+    lpcPlan.shift = shift;
+    double carry = 0.0;
+    for (int j = 0; j < order; ++j) {
+        double value = lpc[order - 1][j] * (1 << shift) + carry;
+        long q = std::lround(value);
+        q = std::max<long>(qmin, std::min<long>(qmax, q));
+        carry = value - q;
+        lpcPlan.coefs[j] = static_cast<int32_t>(q);
+    }
+
+    int32_t* resB = residualB_.data();
+    for (int i = order; i < n; ++i) {
+        int64_t prediction = 0;
+        for (int j = 0; j < order; ++j) {
+            prediction += static_cast<int64_t>(lpcPlan.coefs[j]) * x[i - j - 1];
+        }
+        int64_t e = x[i] - (prediction >> shift);
+        if (e > INT32_MAX / 2 || e < INT32_MIN / 2) {
+            return;  // 残差溢出，放弃LPC
+        }
+        resB[i] = static_cast<int32_t>(e);
+    }
+
+    lpcPlan.bits = 8 + static_cast<uint64_t>(order) * bps + 4 + 5 +
+                   static_cast<uint64_t>(order) * precision + planResidual(resB, n, order, lpcPlan);
+    if (lpcPlan.bits < plan.bits) {
+        plan = lpcPlan;
+    }
+}
+
+/**
+ * @brief 规划残差的Rice分区
+ * @param[in] residual 残差（从order开始有效）
+ * @param[in] n 块长度
+ * @param[in] order 预测阶数
+ * @param[in,out] plan 写入分区阶数与各分区参数
+ * @return 残差部分的位数上界
+ *
+ * @details
+ * 先在最细分区上累计折叠值之和，再逐级合并得到较粗的分区，
+ * 每个分区用 c*(k+1) + (sum>>k) 作为k的代价（精确代价的上界）。
+ */
+uint64_t FLACEncoder::planResidual(const int32_t* residual, int n, int order, SubframePlan& plan) {
+    uint32_t* folded = folded_.data();
+    for (int i = order; i < n; ++i) {
+        folded[i] = foldSigned(residual[i]);
+    }
+
+    int maxPartition = 0;
+    while (maxPartition < kMaxPartitionOrder && (n % (2 << maxPartition)) == 0 &&
+           (n >> (maxPartition + 1)) > order) {
+        ++maxPartition;
+    }
+
+    uint64_t sums[1 << kMaxPartitionOrder] = {};
+    {
+        const int parts = 1 << maxPartition;
+        const int size = n >> maxPartition;
+        for (int p = 0; p < parts; ++p) {
+            int start = (p == 0) ? order : p * size;
+            uint64_t sum = 0;
+            for (int i = start; i < (p + 1) * size; ++i) {
+                sum += folded[i];
+            }
+            sums[p] = sum;
+        }
+    }
+
+    uint64_t bestBits = UINT64_MAX;
+    for (int porder = maxPartition; porder >= 0; --porder) {
+        const int parts = 1 << porder;
+        const int size = n >> porder;
+        uint64_t bits = 6;
+        int params[1 << kMaxPartitionOrder];
+        bool escape5 = false;
+
+        for (int p = 0; p < parts; ++p) {
+            uint64_t count = static_cast<uint64_t>(size - (p == 0 ? order : 0));
+            uint64_t sum = sums[p];
+            int k = 0;
+            if (count > 0 && sum > count) {
+                uint64_t mean = sum / count;
+                while (k < 30 && (mean >> (k + 1)) > 0) {
+                    ++k;
+                }
+            }
+            uint64_t best = UINT64_MAX;
+            int bestK = k;
+            for (int candidate = std::max(0, k - 1); candidate <= std::min(30, k + 1); ++candidate) {
+                uint64_t cost = count * (candidate + 1) + (sum >> candidate);
+                if (cost < best) {
+                    best = cost;
+                    bestK = candidate;
+                }
+            }
+            params[p] = bestK;
+            escape5 = escape5 || bestK > 14;
+            bits += 4 + best;
+        }
+        if (escape5) {
+            bits += parts;
+        }
+
+        if (bits < bestBits) {
+            bestBits = bits;
+            plan.partitionOrder = porder;
+            plan.escape5 = escape5;
+            std::copy(params, params + parts, plan.riceParams);
+        }
+
+        // 合并相邻分区得到上一级
+        for (int p = 0; p < parts / 2; ++p) {
+            sums[p] = sums[2 * p] + sums[2 * p + 1];
+        }
+    }
+
+    return bestBits;
+}
+
+void FLACEncoder::writeResidual(const int32_t* residual, int n, int order, const SubframePlan& plan) {
+    const int parts = 1 << plan.partitionOrder;
+    const int size = n >> plan.partitionOrder;
+    const int paramBits = plan.escape5 ? 5 : 4;
+
+    writer_.put(plan.escape5 ? 1 : 0, 2);
+    writer_.put(static_cast<uint32_t>(plan.partitionOrder), 4);
+    for (int p = 0; p < parts; ++p) {
+        const int k = plan.riceParams[p];
+        writer_.put(static_cast<uint32_t>(k), paramBits);
+        int start = (p == 0) ? order : p * size;
+        for (int i = start; i < (p + 1) * size; ++i) {
+            writer_.putRice(residual[i], k);
+        }
+    }
+}
+
+void FLACEncoder::writeSubframe(const int32_t* x, int n, int bps, const SubframePlan& plan,
+                                const int32_t* residual) {
+    writer_.put(0, 1);
+    switch (plan.type) {
+        case SubframePlan::Type::Constant:
+            writer_.put(0x00, 6);
+            writer_.put(0, 1);
+            writer_.putSigned(x[0], bps);
+            break;
+        case SubframePlan::Type::Verbatim:
+            writer_.put(0x01, 6);
+            writer_.put(0, 1);
+            for (int i = 0; i < n; ++i) {
+                writer_.putSigned(x[i], bps);
+            }
+            break;
+        case SubframePlan::Type::Fixed:
+            writer_.put(0x08 | static_cast<uint32_t>(plan.order), 6);
+            writer_.put(0, 1);
+            for (int i = 0; i < plan.order; ++i) {
+                writer_.putSigned(x[i], bps);
+            }
+            writeResidual(residual, n, plan.order, plan);
+            break;
+        case SubframePlan::Type::Lpc:
+            writer_.put(0x20 | static_cast<uint32_t>(plan.order - 1), 6);
+            writer_.put(0, 1);
+            for (int i = 0; i < plan.order; ++i) {
+                writer_.putSigned(x[i], bps);
+            }
+            writer_.put(static_cast<uint32_t>(plan.precision - 1), 4);
+            writer_.putSigned(plan.shift, 5);
+            for (int i = 0; i < plan.order; ++i) {
+                writer_.putSigned(plan.coefs[i], plan.precision);
+            }
+            writeResidual(residual, n, plan.order, plan);
+            break;
+    }
+}
+
+} // namespace SimpleOBS
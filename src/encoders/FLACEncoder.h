@@ -0,0 +1,120 @@
+/**
+ * @file FLACEncoder.h
+ * @brief 自包含的FLAC无损音频编码器
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了FLAC编码器，用于归档录制。
+ * 每个声道在常量、原始、固定预测器和线性预测（LPC）子帧中选择最短的编码，
+ * 残差使用分区Rice编码，立体声自动选择左/右/中/侧声道组合。
+ *
+ * @note
+ * - 自相关计算使用AVX2/SSE2加速，运行时选择
+ * - 所有缓冲区在initialize()时分配，编码过程不分配内存（输出数据包除外）
+ * - 多轨录制时每条音轨使用一个独立实例
+ */
+
+#pragma once
+
+#include "BaseEncoder.h"
+#include <cstdint>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief FLAC编码器
+ */
+class FLACEncoder : public BaseEncoder {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] name 编码器名称
+     * @param[in] settings 编码配置，使用sample_rate、channels、bits_per_sample、
+     *                     block_size、max_lpc_order和track
+     */
+    explicit FLACEncoder(const std::string& name,
+                         const AudioEncoderSettings& settings = AudioEncoderSettings{});
+    ~FLACEncoder() override;
+
+    std::string getId() const override { return "flac"; }
+    bool initialize() override;
+
+    /**
+     * @brief 关闭编码器
+     * @details 把缓冲中不足一块的采样编码为最后一帧，数据包仍可取走
+     */
+    void shutdown() override;
+
+    using BaseEncoder::encodeFrame;
+    bool encodeFrame(const AudioFrame& frame) override;
+
+    /**
+     * @brief 获取编码配置
+     * @return 当前配置
+     */
+    const AudioEncoderSettings& getSettings() const { return settings_; }
+
+private:
+    /**
+     * @brief 位写入器
+     */
+    class BitWriter {
+    public:
+        void clear() { bytes_.clear(); acc_ = 0; bits_ = 0; }
+        void put(uint32_t value, int count);
+        void putSigned(int32_t value, int count);
+        void putUnary(uint32_t zeros);
+        void putRice(int32_t value, int parameter);
+        void alignZero();
+        size_t size() const { return bytes_.size(); }
+        const uint8_t* data() const { return bytes_.data(); }
+        std::vector<uint8_t>& bytes() { return bytes_; }
+
+    private:
+        std::vector<uint8_t> bytes_;
+        uint64_t acc_ = 0;
+        int bits_ = 0;
+    };
+
+    /**
+     * @brief 子帧编码方案
+     */
+    struct SubframePlan {
+        enum class Type { Constant, Verbatim, Fixed, Lpc } type = Type::Verbatim;
+        int order = 0;                 ///< 预测阶数
+        int precision = 0;             ///< LPC系数精度
+        int shift = 0;                 ///< LPC量化移位
+        int32_t coefs[32] = {};        ///< 量化后的LPC系数
+        int partitionOrder = 0;        ///< Rice分区阶数
+        int riceParams[256] = {};      ///< 各分区Rice参数
+        bool escape5 = false;          ///< 是否使用5位Rice参数
+        uint64_t bits = 0;             ///< 估计的子帧位数
+    };
+
+    void encodeBlock(int samples);
+    void planSubframe(const int32_t* x, int n, int bps, SubframePlan& plan);
+    void writeSubframe(const int32_t* x, int n, int bps, const SubframePlan& plan, const int32_t* residual);
+    uint64_t planResidual(const int32_t* residual, int n, int order, SubframePlan& plan);
+    void writeResidual(const int32_t* residual, int n, int order, const SubframePlan& plan);
+    void writeStreamHeader();
+
+    AudioEncoderSettings settings_;     ///< 编码配置
+    bool initialized_ = false;          ///< 初始化状态标志
+
+    std::vector<int32_t> input_;        ///< 平面输入缓冲区，channels * block_size
+    int buffered_ = 0;                  ///< 已缓冲的采样点数
+    uint32_t frameNumber_ = 0;          ///< 帧序号
+
+    std::vector<double> window_;        ///< 自相关分析窗
+    std::vector<double> windowed_;      ///< 加窗后的采样
+    std::vector<int32_t> stereo_;       ///< 中/侧声道缓冲区
+    std::vector<int32_t> residualA_;    ///< 候选残差
+    std::vector<int32_t> residualB_;    ///< 候选残差
+    std::vector<uint32_t> folded_;      ///< 残差折叠后的无符号值
+    BitWriter writer_;                  ///< 帧写入器
+};
+
+} // namespace SimpleOBS
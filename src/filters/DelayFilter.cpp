@@ -0,0 +1,573 @@
+/**
+ * @file DelayFilter.cpp
+ * @brief 音视频延迟滤镜实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "DelayFilter.h"
+#include "AudioProcessing.h"
+#include "Logger.h"
+#include <algorithm>
+
+namespace SimpleOBS {
+
+namespace {
+
+// 环容量上限，防止误配置一次映射过多内存
+constexpr int kMaxRingFrames = 1800;
+
+bool samePool(const FramePoolSettings& a, const FramePoolSettings& b) {
+    return a.width == b.width && a.height == b.height && a.format == b.format && a.frames == b.frames;
+}
+
+size_t roundUpPow2(int value) {
+    size_t size = 1;
+    while (size < static_cast<size_t>(std::max(1, value))) {
+        size <<= 1;
+    }
+    return size;
+}
+
+bool parseInt(const std::string& value, int minValue, int maxValue, int& out) {
+    int parsed;
+    try {
+        parsed = std::stoi(value);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (parsed < minValue || parsed > maxValue) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+} // anonymous namespace
+
+/**
+ * @brief 构造函数
+ * @param[in] name 滤镜名称
+ * @param[in] target 延迟对象
+ *
+ * @details 在此登记内存预算子系统并启动分配线程，渲染线程不分配帧池和延迟线
+ */
+DelayFilter::DelayFilter(const std::string& name, DelayTarget target)
+    : name_(name), target_(target) {
+    budgetSubsystem_ = Engine::getInstance().getMemoryBudget().registerSubsystem(
+        "delay:" + name_, MemoryPriority::Required);
+    allocator_ = std::thread(&DelayFilter::allocatorLoop, this);
+}
+
+DelayFilter::AudioStore::~AudioStore() {
+    if (budget && reserved > 0) {
+        budget->release(subsystem, reserved);
+    }
+}
+
+DelayFilter::~DelayFilter() {
+    if (allocator_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(allocMutex_);
+            allocStop_ = true;
+        }
+        allocCv_.notify_one();
+        allocator_.join();
+    }
+    retired_.reset();
+    audioRetired_.reset();
+    shutdown();
+    if (budgetSubsystem_ >= 0) {
+        Engine::getInstance().getMemoryBudget().detachSubsystem(budgetSubsystem_);
+    }
+}
+
+std::string DelayFilter::getId() const {
+    switch (target_) {
+    case DelayTarget::Video:
+        return "video_delay";
+    case DelayTarget::Audio:
+        return "audio_delay";
+    default:
+        return "delay";
+    }
+}
+
+/**
+ * @brief 释放帧池和延迟线
+ */
+void DelayFilter::shutdown() {
+    flushVideo();
+    store_.reset();
+    {
+        std::lock_guard<std::mutex> lock(allocMutex_);
+        ready_.reset();
+        requested_ = false;
+        audioReady_.reset();
+        audioRequested_ = false;
+    }
+    ringFrames_.store(0, std::memory_order_relaxed);
+    audio_.reset();
+    flushAudio();
+}
+
+/**
+ * @brief 设置属性
+ * @param[in] key delay_ms或frames
+ * @param[in] value 属性值
+ * @return false表示属性不支持或取值无效
+ *
+ * @details 修改后已缓存的画面和声音被丢弃，延迟从头开始累积；
+ *          需要的帧池和延迟线立即交给后台线程分配，不等第一帧到来
+ */
+bool DelayFilter::setProperty(const std::string& key, const std::string& value) {
+    int parsed;
+    if (key == "delay_ms") {
+        if (!parseInt(value, 0, kMaxDelayMs, parsed)) {
+            return false;
+        }
+        delayMs_.store(parsed, std::memory_order_relaxed);
+    } else if (key == "frames") {
+        if (!parseInt(value, 0, kMaxRingFrames, parsed)) {
+            return false;
+        }
+        frames_ = parsed;
+    } else {
+        return false;
+    }
+    flushVideo();
+    flushAudio();
+    {
+        std::lock_guard<std::mutex> lock(allocMutex_);
+        poolFailed_ = false;
+        audioFailed_ = false;
+    }
+    if (target_ != DelayTarget::Video && delayMs_.load(std::memory_order_relaxed) > 0) {
+        const AudioSettings audio = Engine::getInstance().getAudioSettings();
+        requestAudio(audioLayout(audio.sample_rate, std::min(audio.channels, kMaxAudioChannels), audio.block_size));
+    }
+    if (target_ != DelayTarget::Audio && delayMs_.load(std::memory_order_relaxed) > 0) {
+        if (lastWidth_ > 0) {
+            requestPool(poolSettings(lastWidth_, lastHeight_, lastFormat_));
+        } else {
+            // 还没有见过帧时按画布尺寸分配，多数源与画布同尺寸
+            const VideoSettings video = Engine::getInstance().getVideoSettings();
+            requestPool(poolSettings(video.width, video.height, video.format));
+        }
+    }
+    LOG_INFO("Delay filter {}: {} = {}", name_, key, parsed);
+    return true;
+}
+
+/**
+ * @brief 计算视频环容量
+ */
+int DelayFilter::ringCapacity() const {
+    if (frames_ > 0) {
+        return frames_;
+    }
+    // 按引擎帧率计算，多留一帧余量，吸收帧间隔抖动
+    const int64_t delayMs = delayMs_.load(std::memory_order_relaxed);
+    const int64_t fps = std::max(1, Engine::getInstance().getVideoSettings().fps);
+    return static_cast<int>(std::min<int64_t>((delayMs * fps + 999) / 1000 + 1, kMaxRingFrames));
+}
+
+/**
+ * @brief 按帧尺寸、格式和当前环容量生成帧池配置
+ * @details 帧池比环多一帧，用于保存当前输出的帧
+ */
+FramePoolSettings DelayFilter::poolSettings(int width, int height, int format) const {
+    FramePoolSettings settings;
+    settings.width = width;
+    settings.height = height;
+    settings.format = format;
+    settings.frames = ringCapacity() + 1;
+    settings.huge_pages = HugePageMode::Auto;
+    settings.budget = &Engine::getInstance().getMemoryBudget();
+    settings.budget_subsystem = budgetSubsystem_;
+    return settings;
+}
+
+/**
+ * @brief 请求后台线程分配帧池（任意线程）
+ * @param[in] settings 帧池配置
+ *
+ * @details 已就绪、已请求或上次失败的相同配置不重复请求
+ */
+void DelayFilter::requestPool(const FramePoolSettings& settings) {
+    std::lock_guard<std::mutex> lock(allocMutex_);
+    if ((poolFailed_ && samePool(failedPool_, settings)) ||
+        (ready_ && samePool(ready_->pool.getSettings(), settings)) ||
+        (requested_ && samePool(request_, settings))) {
+        return;
+    }
+    request_ = settings;
+    requested_ = true;
+    allocCv_.notify_one();
+}
+
+/**
+ * @brief 按采样率、声道数和单帧长度生成延迟线布局，延迟长度取当前设置
+ * @details 单帧长度向上取整到2的幂，帧长小幅变化时不必重新分配
+ */
+DelayFilter::AudioLayout DelayFilter::audioLayout(int sampleRate, int channels, int samples) const {
+    AudioLayout layout;
+    layout.sampleRate = sampleRate;
+    layout.channels = channels;
+    layout.delaySamples =
+        static_cast<int>(static_cast<int64_t>(delayMs_.load(std::memory_order_relaxed)) * sampleRate / 1000);
+    layout.blockSamples = static_cast<int>(roundUpPow2(std::max(samples, kDefaultAudioBlockSize)));
+    return layout;
+}
+
+/**
+ * @brief 请求后台线程分配音频延迟线（任意线程）
+ * @param[in] layout 延迟线布局
+ *
+ * @details 已就绪、已请求或上次失败的相同布局不重复请求
+ */
+void DelayFilter::requestAudio(const AudioLayout& layout) {
+    auto same = [](const AudioLayout& a, const AudioLayout& b) {
+        return a.sampleRate == b.sampleRate && a.channels == b.channels && a.delaySamples == b.delaySamples &&
+               a.blockSamples == b.blockSamples;
+    };
+    std::lock_guard<std::mutex> lock(allocMutex_);
+    if ((audioFailed_ && same(failedAudio_, layout)) || (audioReady_ && same(audioReady_->layout, layout)) ||
+        (audioRequested_ && same(audioRequest_, layout))) {
+        return;
+    }
+    audioRequest_ = layout;
+    audioRequested_ = true;
+    allocCv_.notify_one();
+}
+
+/**
+ * @brief 帧池和延迟线分配线程
+ *
+ * @details 映射、预触页和释放都在这里完成，只在交接指针时持有互斥锁。
+ *          新请求到来时丢弃尚未换入的旧结果，先释放再分配，内存预算中不会同时保留两份
+ */
+void DelayFilter::allocatorLoop() {
+    std::unique_lock<std::mutex> lock(allocMutex_);
+    while (true) {
+        allocCv_.wait(lock, [this] {
+            return allocStop_ || requested_ || audioRequested_ || retired_ || audioRetired_;
+        });
+        std::unique_ptr<VideoStore> garbage = std::move(retired_);
+        std::unique_ptr<AudioStore> audioGarbage = std::move(audioRetired_);
+        if (allocStop_) {
+            lock.unlock();
+            return;
+        }
+
+        const bool video = requested_;
+        const FramePoolSettings settings = request_;
+        requested_ = false;
+        const bool audio = audioRequested_;
+        const AudioLayout layout = audioRequest_;
+        audioRequested_ = false;
+        std::unique_ptr<VideoStore> stale = video ? std::move(ready_) : nullptr;
+        std::unique_ptr<AudioStore> audioStale = audio ? std::move(audioReady_) : nullptr;
+        lock.unlock();
+
+        garbage.reset();
+        audioGarbage.reset();
+        stale.reset();
+        audioStale.reset();
+        std::unique_ptr<VideoStore> store = video ? allocateVideo(settings) : nullptr;
+        std::unique_ptr<AudioStore> audioStore = audio ? allocateAudio(layout) : nullptr;
+
+        lock.lock();
+        if (video) {
+            if (store) {
+                ready_ = std::move(store);
+            } else {
+                failedPool_ = settings;
+                poolFailed_ = true;
+            }
+        }
+        if (audio) {
+            if (audioStore) {
+                audioReady_ = std::move(audioStore);
+            } else {
+                failedAudio_ = layout;
+                audioFailed_ = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 分配帧池和环（分配线程）
+ * @return 失败时返回nullptr
+ */
+std::unique_ptr<DelayFilter::VideoStore> DelayFilter::allocateVideo(const FramePoolSettings& settings) const {
+    auto store = std::make_unique<VideoStore>();
+    if (!store->pool.initialize(settings)) {
+        LOG_WARN("Delay filter {} cannot allocate {} frames of {}x{}, video passes through",
+                 name_, settings.frames, settings.width, settings.height);
+        return nullptr;
+    }
+    store->ring.assign(static_cast<size_t>(settings.frames - 1), VideoFrame{});
+    return store;
+}
+
+/**
+ * @brief 分配音频延迟线和输出缓冲区（分配线程）
+ * @return 超出内存预算时返回nullptr
+ *
+ * @details 延迟线长度为延迟加一帧，保证同一帧中读出的采样不会被本帧写入覆盖
+ */
+std::unique_ptr<DelayFilter::AudioStore> DelayFilter::allocateAudio(const AudioLayout& layout) const {
+    auto store = std::make_unique<AudioStore>();
+    store->layout = layout;
+    store->capacity = static_cast<size_t>(layout.delaySamples) + static_cast<size_t>(layout.blockSamples);
+    const uint64_t bytes = static_cast<uint64_t>(layout.channels) *
+                           (store->capacity + static_cast<size_t>(layout.blockSamples)) * sizeof(float);
+    MemoryBudget& budget = Engine::getInstance().getMemoryBudget();
+    if (!budget.reserve(budgetSubsystem_, bytes)) {
+        LOG_WARN("Delay filter {} cannot reserve {} KB for the audio delay line, audio passes through",
+                 name_, bytes >> 10);
+        return nullptr;
+    }
+    store->budget = &budget;
+    store->subsystem = budgetSubsystem_;
+    store->reserved = bytes;
+    store->line.assign(static_cast<size_t>(layout.channels), std::vector<float>(store->capacity, 0.0f));
+    store->out.assign(static_cast<size_t>(layout.channels),
+                      std::vector<float>(static_cast<size_t>(layout.blockSamples), 0.0f));
+    return store;
+}
+
+/**
+ * @brief 按当前帧的尺寸、格式和环容量准备帧池（渲染线程）
+ * @param[in] frame 输入帧
+ * @return false表示帧池尚未就绪，本帧不延迟
+ *
+ * @details 配置不变时直接返回；变化时换入后台线程已分配好的帧池，
+ *          尚未分配时提交请求。换下的帧池交给后台线程释放，渲染线程不映射也不释放内存
+ */
+bool DelayFilter::preparePool(const VideoFrame& frame) {
+    lastWidth_ = frame.width;
+    lastHeight_ = frame.height;
+    lastFormat_ = frame.format;
+    const FramePoolSettings settings = poolSettings(frame.width, frame.height, frame.format);
+    if (store_ && samePool(store_->pool.getSettings(), settings)) {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(allocMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+    if (ready_ && samePool(ready_->pool.getSettings(), settings) && !retired_) {
+        flushVideo();
+        retired_ = std::move(store_);
+        store_ = std::move(ready_);
+        ringFrames_.store(static_cast<int>(store_->ring.size()), std::memory_order_relaxed);
+        allocCv_.notify_one();
+        return true;
+    }
+    lock.unlock();
+    requestPool(settings);
+    return false;
+}
+
+/**
+ * @brief 归还环中所有帧和当前输出帧
+ */
+void DelayFilter::flushVideo() {
+    if (store_) {
+        for (size_t i = 0; i < ringCount_; ++i) {
+            store_->pool.release(store_->ring[(ringHead_ + i) % store_->ring.size()]);
+        }
+        if (hasOutput_) {
+            store_->pool.release(output_);
+        }
+    }
+    ringHead_ = 0;
+    ringCount_ = 0;
+    hasOutput_ = false;
+    buffered_.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 处理视频帧
+ * @param[in,out] frame 输入帧；返回时指向延迟后的画面
+ * @return false表示帧无效
+ *
+ * @details
+ * 1. 把输入帧复制进帧池中的一帧并记下到达时刻，追加到环尾；环满时丢弃最旧的帧
+ * 2. 从环头取出所有到达时刻不晚于（当前时刻 - 延迟）的帧，最新的一帧作为输出
+ * 3. 没有到期帧时保持上一次的输出；刚开始累积时输出环头的帧
+ * 4. 输出帧沿用输入帧的时间戳，下游的节奏不受影响
+ *
+ * @note 按到达时刻而不是源时间戳计算延迟，源时间戳回退或不变时同样有效
+ */
+bool DelayFilter::processVideoFrame(VideoFrame& frame) {
+    if (target_ == DelayTarget::Audio) {
+        return true;
+    }
+    const int delayMs = delayMs_.load(std::memory_order_relaxed);
+    if (delayMs == 0) {
+        if (ringCount_ > 0 || hasOutput_) {
+            flushVideo();
+        }
+        return true;
+    }
+    if (!frame.data[0] || frame.width <= 0 || frame.height <= 0) {
+        return false;
+    }
+    if (!preparePool(frame)) {
+        return true;
+    }
+    const FrameTime now = currentFrameTime();
+    FramePool& pool = store_->pool;
+    std::vector<VideoFrame>& ring = store_->ring;
+
+    const size_t capacity = ring.size();
+    if (ringCount_ == capacity) {
+        pool.release(ring[ringHead_]);
+        ringHead_ = (ringHead_ + 1) % capacity;
+        --ringCount_;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    VideoFrame& slot = ring[(ringHead_ + ringCount_) % capacity];
+    if (!pool.acquire(slot)) {
+        return true;
+    }
+    copyVideoFrame(slot, frame);
+    slot.timestamp = now;
+    ++ringCount_;
+
+    const FrameTime due = now - FrameTime(static_cast<int64_t>(delayMs) * 1000);
+    while (ringCount_ > 0 && ring[ringHead_].timestamp <= due) {
+        if (hasOutput_) {
+            pool.release(output_);
+        }
+        output_ = ring[ringHead_];
+        hasOutput_ = true;
+        ringHead_ = (ringHead_ + 1) % capacity;
+        --ringCount_;
+    }
+    buffered_.store(static_cast<int>(ringCount_), std::memory_order_relaxed);
+
+    // 环头的帧只在被取出或丢弃时归还，且只在下一次调用中发生，直接指向它是安全的
+    const VideoFrame& out = hasOutput_ ? output_ : ring[ringHead_];
+    for (int plane = 0; plane < 4; ++plane) {
+        frame.data[plane] = out.data[plane];
+        frame.linesize[plane] = out.linesize[plane];
+    }
+    frame.width = out.width;
+    frame.height = out.height;
+    return true;
+}
+
+/**
+ * @brief 清空延迟线，之后从静音开始
+ */
+void DelayFilter::flushAudio() {
+    if (audio_) {
+        for (auto& line : audio_->line) {
+            std::fill(line.begin(), line.end(), 0.0f);
+        }
+    }
+    delayWrite_ = 0;
+}
+
+/**
+ * @brief 按输入格式和延迟长度准备延迟线（渲染线程）
+ * @param[in] frame 输入帧
+ * @param[in] delaySamples 延迟采样点数
+ * @return false表示延迟线尚未就绪，本帧不延迟
+ *
+ * @details 布局不变时直接返回；变化时换入后台线程已分配好的延迟线，尚未分配时提交请求。
+ *          换下的延迟线交给后台线程释放
+ */
+bool DelayFilter::prepareAudio(const AudioFrame& frame, int delaySamples) {
+    const int channels = std::min(frame.channels, kMaxAudioChannels);
+    auto fits = [&](const AudioStore& store) {
+        return store.layout.sampleRate == frame.sample_rate && store.layout.channels == channels &&
+               store.layout.delaySamples == delaySamples && store.layout.blockSamples >= frame.samples;
+    };
+    if (audio_ && fits(*audio_)) {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(allocMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+    if (audioReady_ && fits(*audioReady_) && !audioRetired_) {
+        audioRetired_ = std::move(audio_);
+        audio_ = std::move(audioReady_);
+        delayWrite_ = 0;
+        delaySamples_.store(delaySamples, std::memory_order_relaxed);
+        allocCv_.notify_one();
+        return true;
+    }
+    lock.unlock();
+    requestAudio(audioLayout(frame.sample_rate, channels, frame.samples));
+    return false;
+}
+
+/**
+ * @brief 处理音频帧
+ * @param[in,out] frame 输入帧；返回时各声道指向滤镜的输出缓冲区
+ * @return false表示帧无效
+ *
+ * @note 不修改输入数据，源可以把内部缓冲区直接交给滤镜
+ */
+bool DelayFilter::processAudioFrame(AudioFrame& frame) {
+    if (target_ == DelayTarget::Video) {
+        return true;
+    }
+    if (frame.samples <= 0 || frame.channels <= 0 || frame.sample_rate <= 0 || !frame.data[0]) {
+        return false;
+    }
+    const int delaySamples =
+        static_cast<int>(static_cast<int64_t>(delayMs_.load(std::memory_order_relaxed)) * frame.sample_rate / 1000);
+    if (delaySamples == 0) {
+        return true;
+    }
+    if (!prepareAudio(frame, delaySamples)) {
+        return true;
+    }
+
+    AudioStore& audio = *audio_;
+    const size_t capacity = audio.capacity;
+    const size_t readStart = (delayWrite_ + capacity - static_cast<size_t>(delaySamples)) % capacity;
+    for (int c = 0; c < audio.layout.channels; ++c) {
+        const float* in = frame.data[c] ? frame.data[c] : frame.data[0];
+        float* line = audio.line[c].data();
+        float* out = audio.out[c].data();
+        size_t read = readStart;
+        size_t write = delayWrite_;
+        for (int i = 0; i < frame.samples; ++i) {
+            out[i] = line[read];
+            line[write] = in[i];
+            read = read + 1 == capacity ? 0 : read + 1;
+            write = write + 1 == capacity ? 0 : write + 1;
+        }
+        frame.data[c] = out;
+    }
+    delayWrite_ = (delayWrite_ + static_cast<size_t>(frame.samples)) % capacity;
+    return true;
+}
+
+/**
+ * @brief 获取统计信息
+ * @return 统计快照（任意线程）
+ */
+DelayFilterStats DelayFilter::getStats() const {
+    DelayFilterStats stats;
+    stats.delay_ms = delayMs_.load(std::memory_order_relaxed);
+    stats.ring_frames = ringFrames_.load(std::memory_order_relaxed);
+    stats.buffered_frames = buffered_.load(std::memory_order_relaxed);
+    stats.dropped_frames = dropped_.load(std::memory_order_relaxed);
+    stats.audio_delay_samples = delaySamples_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace SimpleOBS
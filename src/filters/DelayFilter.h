@@ -0,0 +1,184 @@
+/**
+ * @file DelayFilter.h
+ * @brief 音视频延迟滤镜
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了把源或场景的画面/声音延后固定时长的滤镜，用于唇音同步校正和播出延迟。
+ * 视频帧复制一次到滤镜自有帧池中的帧，按时间戳排成环；输出时只把帧描述指向环中到期的帧，
+ * 不再复制。音频写入按延迟长度预分配的环形延迟线，输出指向滤镜的输出缓冲区。
+ *
+ * @note
+ * - 帧池由后台线程按帧尺寸、格式和环容量分配并登记到引擎内存预算，就绪后在渲染线程中换入，
+ *   换下的帧池也由后台线程释放；设置属性时按上一帧（或画布）尺寸提前分配，
+ *   帧池就绪之前视频不延迟直接通过
+ * - 音频延迟线同样由后台线程按采样率、声道数和延迟长度分配，并登记到同一个内存预算条目，
+ *   就绪之前音频不延迟直接通过；渲染线程不分配内存
+ * - 环满时丢弃最旧的帧并计数，实际延迟随之缩短
+ * - 延迟未满时视频保持最早的一帧，音频输出静音
+ * - 输出帧的数据指针指向滤镜内部内存，在下一次调用前有效
+ * - 滤镜只在渲染线程中调用；setProperty由命令队列在渲染线程中执行
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include "FramePool.h"
+#include "MemoryBudget.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 延迟对象
+ */
+enum class DelayTarget {
+    Both,   ///< 音频和视频
+    Video,  ///< 只延迟视频
+    Audio   ///< 只延迟音频
+};
+
+/**
+ * @brief 延迟滤镜统计
+ */
+struct DelayFilterStats {
+    int delay_ms = 0;               ///< 设置的延迟
+    int ring_frames = 0;            ///< 视频环容量（帧）
+    int buffered_frames = 0;        ///< 环中当前帧数
+    uint64_t dropped_frames = 0;    ///< 因环满丢弃的帧数
+    int audio_delay_samples = 0;    ///< 音频延迟线长度（采样点）
+};
+
+/**
+ * @brief 音视频延迟滤镜
+ *
+ * 属性：
+ * - delay_ms：延迟时长（0~kMaxDelayMs毫秒）
+ * - frames：视频环容量，0表示按引擎帧率和延迟时长自动计算
+ */
+class DelayFilter : public Filter {
+public:
+    static constexpr int kMaxDelayMs = 30000;
+
+    /**
+     * @brief 构造函数
+     * @param[in] name 滤镜名称
+     * @param[in] target 延迟对象
+     */
+    DelayFilter(const std::string& name, DelayTarget target);
+    ~DelayFilter() override;
+
+    std::string getName() const override { return name_; }
+    std::string getId() const override;
+    bool initialize() override { return true; }
+    void shutdown() override;
+    bool setProperty(const std::string& key, const std::string& value) override;
+
+    bool processVideoFrame(VideoFrame& frame) override;
+    bool processAudioFrame(AudioFrame& frame) override;
+
+    /**
+     * @brief 获取统计信息
+     */
+    DelayFilterStats getStats() const;
+
+private:
+    /**
+     * @brief 帧池和按时间排列的环，由后台线程整体分配和释放
+     */
+    struct VideoStore {
+        FramePool pool;
+        std::vector<VideoFrame> ring;   ///< 容量为帧池帧数减一，多出的一帧保存当前输出
+    };
+
+    /**
+     * @brief 音频延迟线的布局
+     */
+    struct AudioLayout {
+        int sampleRate = 0;
+        int channels = 0;
+        int delaySamples = 0;
+        int blockSamples = 0;           ///< 单帧最多的采样点数
+    };
+
+    /**
+     * @brief 每声道的延迟线和输出缓冲区，由后台线程整体分配和释放，析构时归还内存预算
+     */
+    struct AudioStore {
+        AudioLayout layout;
+        size_t capacity = 0;                        ///< 延迟线长度：延迟加一帧
+        std::vector<std::vector<float>> line;       ///< 每声道一个环形延迟线
+        std::vector<std::vector<float>> out;        ///< 每声道的输出缓冲区
+        MemoryBudget* budget = nullptr;
+        MemoryBudget::SubsystemId subsystem = -1;
+        uint64_t reserved = 0;                      ///< 已向预算登记的字节数
+
+        ~AudioStore();
+    };
+
+    FramePoolSettings poolSettings(int width, int height, int format) const;
+    AudioLayout audioLayout(int sampleRate, int channels, int samples) const;
+    void requestPool(const FramePoolSettings& settings);
+    void requestAudio(const AudioLayout& layout);
+    void allocatorLoop();
+    std::unique_ptr<VideoStore> allocateVideo(const FramePoolSettings& settings) const;
+    std::unique_ptr<AudioStore> allocateAudio(const AudioLayout& layout) const;
+    bool preparePool(const VideoFrame& frame);
+    void flushVideo();
+    int ringCapacity() const;
+    bool prepareAudio(const AudioFrame& frame, int delaySamples);
+    void flushAudio();
+
+    const std::string name_;
+    const DelayTarget target_;
+    std::atomic<int> delayMs_{0};
+    int frames_ = 0;
+
+    MemoryBudget::SubsystemId budgetSubsystem_ = -1;    ///< 帧池和延迟线共用的预算条目
+
+    // 视频
+    std::unique_ptr<VideoStore> store_; ///< 渲染线程正在使用的帧池和环
+    int lastWidth_ = 0;                 ///< 最近一帧的尺寸和格式，用于提前分配
+    int lastHeight_ = 0;
+    int lastFormat_ = kVideoFormatRGBA;
+    size_t ringHead_ = 0;               ///< 最旧帧的下标
+    size_t ringCount_ = 0;
+    VideoFrame output_{};               ///< 当前输出的帧，被更新的到期帧替换时归还帧池
+    bool hasOutput_ = false;
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<int> buffered_{0};
+    std::atomic<int> ringFrames_{0};
+
+    // 后台分配线程，互斥锁只在交接指针时持有，渲染线程只尝试加锁
+    std::thread allocator_;
+    std::mutex allocMutex_;
+    std::condition_variable allocCv_;
+    bool allocStop_ = false;
+    bool requested_ = false;            ///< 有待处理的分配请求
+    FramePoolSettings request_;         ///< 请求的帧池配置
+    std::unique_ptr<VideoStore> ready_;     ///< 已分配、等待换入
+    std::unique_ptr<VideoStore> retired_;   ///< 已换下、等待释放
+    FramePoolSettings failedPool_;      ///< 上次分配失败的配置，相同配置不再重试
+    bool poolFailed_ = false;
+    bool audioRequested_ = false;
+    AudioLayout audioRequest_;
+    std::unique_ptr<AudioStore> audioReady_;
+    std::unique_ptr<AudioStore> audioRetired_;
+    AudioLayout failedAudio_;
+    bool audioFailed_ = false;
+
+    // 音频
+    std::unique_ptr<AudioStore> audio_; ///< 渲染线程正在使用的延迟线
+    size_t delayWrite_ = 0;             ///< 下一个写入位置
+    std::atomic<int> delaySamples_{0};
+};
+
+} // namespace SimpleOBS
@@ -0,0 +1,37 @@
+/**
+ * @file FilterModules.cpp
+ * @brief 内置滤镜模块登记
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "ModuleRegistry.h"
+#include "DelayFilter.h"
+
+namespace SimpleOBS {
+
+/**
+ * @brief 登记内置滤镜模块
+ * @param[in] registry 模块注册表
+ */
+void registerFilterModules(ModuleRegistry& registry) {
+    ModuleDescriptor delay;
+    delay.name = "filters.delay";
+    delay.filters = {"delay", "video_delay", "audio_delay"};
+    delay.load = [](ModuleRegistry& r) {
+        r.registerFilter("delay", [](const std::string& name) -> FilterPtr {
+            return std::make_shared<DelayFilter>(name, DelayTarget::Both);
+        });
+        r.registerFilter("video_delay", [](const std::string& name) -> FilterPtr {
+            return std::make_shared<DelayFilter>(name, DelayTarget::Video);
+        });
+        r.registerFilter("audio_delay", [](const std::string& name) -> FilterPtr {
+            return std::make_shared<DelayFilter>(name, DelayTarget::Audio);
+        });
+        return true;
+    };
+    registry.addModule(std::move(delay));
+}
+
+} // namespace SimpleOBS
@@ -17,7 +17,14 @@
  */
 
 #include "SimpleOBS.h"
+#include "ControlServer.h"
 #include "Logger.h"
+#include "MemoryBudget.h"
+#include "ModuleRegistry.h"
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -50,8 +57,14 @@ bool initializeApplication() {
     LOG_INFO("Build date: {}", __DATE__);
     LOG_INFO("Build time: {}", __TIME__);
 
-    // 初始化SimpleOBS引擎
+    // 登记内置模块（只登记类型，第一次使用时才加载）
     auto& engine = Engine::getInstance();
+    registerSourceModules(engine.getModuleRegistry());
+    registerEncoderModules(engine.getModuleRegistry());
+    registerOutputModules(engine.getModuleRegistry());
+    registerFilterModules(engine.getModuleRegistry());
+
+    // 初始化SimpleOBS引擎
     if (!engine.initialize()) {
         LOG_ERROR("Failed to initialize SimpleOBS engine");
         return false;
@@ -124,6 +137,8 @@ void demonstrateSceneOperations() {
         if (scene2->initialize()) {
             LOG_INFO("Scene '{}' initialized successfully", scene2->getName());
         }
+
+        engine.setCurrentScene(scene1->getName());
     }
 
     // 演示流媒体控制
@@ -137,11 +152,56 @@ void demonstrateSceneOperations() {
         LOG_INFO("Stopping streaming...");
         engine.stopStreaming();
         LOG_INFO("Streaming stopped");
+
+        auto latency = engine.getAudioLatencyStats();
+        LOG_INFO("Audio latency: blocks={}, block={}us, avg={}us, min={}us, max={}us",
+                 latency.blocks, latency.block_duration.count(), latency.average.count(),
+                 latency.min.count(), latency.max.count());
     } else {
         LOG_ERROR("Failed to start streaming");
     }
 }
 
+namespace {
+
+std::atomic<bool> g_exitRequested{false};
+
+void handleExitSignal(int) {
+    g_exitRequested = true;
+}
+
+} // anonymous namespace
+
+/**
+ * @brief 在控制服务器下运行，直到收到退出信号
+ * @param[in] path 控制套接字路径
+ *
+ * @details 引擎保持推流状态，场景切换、源增删等操作全部通过控制接口完成
+ */
+void runControlled(const std::string& path) {
+    auto& engine = Engine::getInstance();
+    ControlServer server(engine);
+    ControlServerSettings settings;
+    settings.path = path;
+    if (!server.start(settings)) {
+        return;
+    }
+
+    std::signal(SIGINT, handleExitSignal);
+    std::signal(SIGTERM, handleExitSignal);
+    if (!engine.isStreaming()) {
+        engine.startStreaming();
+    }
+
+    LOG_INFO("SimpleOBS running under control socket {}... Press Ctrl+C to exit", path);
+    while (!g_exitRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    server.stop();
+    engine.stopStreaming();
+}
+
 /**
  * @brief 主程序入口点
  * @param[in] argc 命令行参数数量
@@ -161,8 +221,18 @@ int main(int argc, char* argv[]) {
     try {
         // 解析命令行参数（简单实现）
         LOG_INFO_DETAIL("SimpleOBS starting with {} command line arguments", argc);
+        std::string controlSocket;
+        int numaNode = -1;
+        uint64_t memoryLimitMb = 0;
         for (int i = 0; i < argc; ++i) {
             LOG_DEBUG("Argument {}: {}", i, argv[i]);
+            if (std::strcmp(argv[i], "--control-socket") == 0 && i + 1 < argc) {
+                controlSocket = argv[++i];
+            } else if (std::strcmp(argv[i], "--numa-node") == 0 && i + 1 < argc) {
+                numaNode = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--memory-limit") == 0 && i + 1 < argc) {
+                memoryLimitMb = std::strtoull(argv[++i], nullptr, 10);
+            }
         }
 
         // 初始化应用程序
@@ -173,15 +243,35 @@ int main(int argc, char* argv[]) {
 
         LOG_INFO("SimpleOBS application initialized successfully");
 
+        if (memoryLimitMb > 0) {
+            // 硬上限：超出时按优先级淘汰缓存，仍不够则拒绝分配，而不是被OOM杀死
+            Engine::getInstance().getMemoryBudget().setLimit(memoryLimitMb << 20);
+        }
+
+        if (numaNode >= 0) {
+            // 渲染线程和画布帧池固定在同一NUMA节点
+            VideoSettings video = Engine::getInstance().getVideoSettings();
+            video.numa_node = numaNode;
+            if (!Engine::getInstance().setVideoSettings(video)) {
+                std::cerr << "Invalid NUMA node: " << numaNode << std::endl;
+                return 1;
+            }
+        }
+
         // 执行演示操作
         demonstrateSceneOperations();
 
-        // 模拟程序运行
-        LOG_INFO("SimpleOBS running... Press Ctrl+C to exit");
+        if (!controlSocket.empty()) {
+            // 由外部通过控制套接字驱动
+            runControlled(controlSocket);
+        } else {
+            // 模拟程序运行
+            LOG_INFO("SimpleOBS running... Press Ctrl+C to exit");
 
-        // 在实际应用中，这里应该进入主事件循环
-        // 为了演示，我们只是等待一段时间
-        std::this_thread::sleep_for(std::chrono::seconds(3));
+            // 在实际应用中，这里应该进入主事件循环
+            // 为了演示，我们只是等待一段时间
+            std::this_thread::sleep_for(std::chrono::seconds(3));
+        }
 
         LOG_INFO("SimpleOBS demonstration completed");
 
@@ -1,9 +1,122 @@
-#include "SimpleOBS.h"
-#include <iostream>
+/**
+ * @file BaseOutput.cpp
+ * @brief 输出基类实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "BaseOutput.h"
+#include "AudioProcessing.h"
+#include "EventBus.h"
+#include "FlightRecorder.h"
+#include "Logger.h"
+#include "Numa.h"
+#include "Watchdog.h"
 
 namespace SimpleOBS {
 
-// 基础输出实现
-// 这个文件暂时为空，后续可以实现输出基类
+namespace {
+
+/// 同一输出两次丢包事件的最小间隔，持续丢包时事件携带累计丢弃数
+constexpr int64_t kDropEventIntervalUs = 1000000;
+
+/// 发送线程超过该时长没有完成一轮循环即视为停顿
+constexpr FrameTime kOutputStallDeadline(1000000);
+
+/// 队列深度写入飞行记录器的间隔
+constexpr int64_t kQueueDepthRecordIntervalUs = 100000;
+
+} // anonymous namespace
+
+BaseOutput::BaseOutput(const std::string& name) : name_(name) {}
+
+bool BaseOutput::initialize() {
+    LOG_INFO("Output initializing: {} ({})", name_, getId());
+    return true;
+}
+
+void BaseOutput::shutdown() {
+    stop();
+    LOG_INFO("Output shutting down: {}", name_);
+}
+
+OutputStats BaseOutput::getStats() const {
+    OutputStats stats;
+    stats.packets_sent = packetsSent_.load(std::memory_order_relaxed);
+    stats.bytes_sent = bytesSent_.load(std::memory_order_relaxed);
+    stats.packets_dropped = packetsDropped_.load(std::memory_order_relaxed);
+    stats.errors = errors_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void BaseOutput::countSent(uint64_t packets, uint64_t bytes) {
+    packetsSent_.fetch_add(packets, std::memory_order_relaxed);
+    bytesSent_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void BaseOutput::countDropped(uint64_t packets) {
+    uint64_t total = packetsDropped_.fetch_add(packets, std::memory_order_relaxed) + packets;
+
+    // 只尝试一次CAS，抢不到说明其他线程刚发布过，发送路径保持wait-free
+    int64_t now = currentFrameTime().count();
+    int64_t last = lastDropEvent_.load(std::memory_order_relaxed);
+    if (now - last >= kDropEventIntervalUs &&
+        lastDropEvent_.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        Engine::getInstance().getEventBus().publish(EventType::OutputDropped, name_.c_str(),
+                                                    static_cast<int64_t>(total));
+    }
+}
+
+bool BaseOutput::setProperty(const std::string& key, const std::string& value) {
+    if (key != "numa_node") {
+        return false;
+    }
+    int node;
+    try {
+        node = std::stoi(value);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (node < -1 || node >= numaNodeCount()) {
+        return false;
+    }
+    numaNode_.store(node, std::memory_order_relaxed);
+    return true;
+}
+
+void BaseOutput::enterWorkerThread() {
+    int node = numaNode_.load(std::memory_order_relaxed);
+    if (node >= 0 && !pinThreadToNode(node)) {
+        LOG_WARN("Output {}: cannot pin worker thread to NUMA node {}", name_, node);
+    }
+}
+
+void BaseOutput::workerTick(size_t queueDepth, size_t queueCapacity) {
+    Engine& engine = Engine::getInstance();
+    if (watchStage_ < 0) {
+        watchStage_ = engine.getWatchdog().addStage("output:" + name_, kOutputStallDeadline);
+        engine.getWatchdog().setActive(watchStage_, true);
+    }
+    engine.getWatchdog().heartbeat(watchStage_);
+
+    int64_t now = currentFrameTime().count();
+    if (now - lastDepthRecord_ >= kQueueDepthRecordIntervalUs) {
+        lastDepthRecord_ = now;
+        engine.getFlightRecorder().record(RecordKind::QueueDepth, name_.c_str(),
+                                          static_cast<int64_t>(queueDepth), static_cast<int64_t>(queueCapacity));
+    }
+}
+
+void BaseOutput::leaveWorkerThread() {
+    if (watchStage_ >= 0) {
+        Engine::getInstance().getWatchdog().setActive(watchStage_, false);
+        watchStage_ = -1;
+    }
+}
+
+void BaseOutput::countError() {
+    errors_.fetch_add(1, std::memory_order_relaxed);
+}
 
 } // namespace SimpleOBS
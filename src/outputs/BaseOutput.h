@@ -0,0 +1,99 @@
+/**
+ * @file BaseOutput.h
+ * @brief 输出基类
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了输出模块的公共基类BaseOutput，负责名称、运行状态和发送统计，
+ * 具体输出只需实现start/stop和sendPacket。
+ *
+ * @note
+ * - 统计计数器均为原子变量，可在任意线程读取
+ * - 属性numa_node把输出的工作线程绑定到指定NUMA节点，与渲染线程同节点时数据不跨节点
+ * - 发送线程通过workerTick()向看门狗心跳，并定期把队列深度写入飞行记录器
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <atomic>
+#include <string>
+
+namespace SimpleOBS {
+
+/**
+ * @brief 输出统计
+ */
+struct OutputStats {
+    uint64_t packets_sent = 0;      ///< 已发送的数据包（或数据报）数量
+    uint64_t bytes_sent = 0;        ///< 已发送的字节数
+    uint64_t packets_dropped = 0;   ///< 被丢弃的数据包数量
+    uint64_t errors = 0;            ///< 发送错误次数
+};
+
+/**
+ * @brief 输出基类
+ */
+class BaseOutput : public Output {
+public:
+    explicit BaseOutput(const std::string& name);
+    ~BaseOutput() override = default;
+
+    std::string getName() const override { return name_; }
+    bool initialize() override;
+    void shutdown() override;
+    bool isActive() const override { return active_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 设置通用属性
+     * @details 支持"numa_node"（-1表示不绑定），在下次启动工作线程时生效
+     */
+    bool setProperty(const std::string& key, const std::string& value) override;
+
+    /**
+     * @brief 获取发送统计
+     * @return 统计信息快照
+     */
+    OutputStats getStats() const;
+
+protected:
+    void countSent(uint64_t packets, uint64_t bytes);
+    void countDropped(uint64_t packets = 1);   ///< 同时发布限频的OutputDropped事件
+    void countError();
+
+    /**
+     * @brief 工作线程启动时调用，按numa_node属性绑定到节点
+     */
+    void enterWorkerThread();
+
+    /**
+     * @brief 发送线程每轮循环调用：看门狗心跳，按固定间隔记录队列深度
+     * @param[in] queueDepth 当前队列深度
+     * @param[in] queueCapacity 队列容量
+     *
+     * @note 第一次调用时登记看门狗阶段"output:<名称>"
+     */
+    void workerTick(size_t queueDepth, size_t queueCapacity);
+
+    /**
+     * @brief 发送线程退出前调用，停止看门狗对本输出的检查
+     */
+    void leaveWorkerThread();
+
+    std::string name_;                       ///< 输出名称
+    std::atomic<bool> active_{false};        ///< 运行状态
+    std::atomic<int> numaNode_{-1};          ///< 工作线程绑定的NUMA节点，-1表示不绑定
+
+private:
+    std::atomic<uint64_t> packetsSent_{0};
+    std::atomic<uint64_t> bytesSent_{0};
+    std::atomic<uint64_t> packetsDropped_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<int64_t> lastDropEvent_{INT64_MIN / 2};   ///< 最近一次丢包事件的时间（微秒）
+    int watchStage_ = -1;                   ///< 看门狗阶段ID（仅发送线程访问）
+    int64_t lastDepthRecord_ = 0;           ///< 最近一次记录队列深度的时间（仅发送线程访问）
+};
+
+} // namespace SimpleOBS
@@ -0,0 +1,667 @@
+/**
+ * @file MP4Muxer.cpp
+ * @brief 分片MP4（fMP4）封装器实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 文件布局：ftyp | moov(mvhd, trak..., mvex) | [moof(mfhd, traf...) mdat]...
+ * 每个traf使用default-base-is-moof，trun的data_offset相对于moof起点，
+ * 因此分片之间互不依赖，可以直接追加写入。
+ */
+
+#include "MP4Muxer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace SimpleOBS {
+
+namespace {
+
+constexpr uint32_t kVideoTimescale = 90000;
+constexpr uint32_t kSampleFlagsSync = 0x02000000;      // sample_depends_on = 2
+constexpr uint32_t kSampleFlagsNonSync = 0x01010000;   // sample_depends_on = 1, is_non_sync_sample
+constexpr uint32_t kTrunDataOffset = 0x000001;
+constexpr uint32_t kTrunSampleDuration = 0x000100;
+constexpr uint32_t kTrunSampleSize = 0x000200;
+constexpr uint32_t kTrunSampleFlags = 0x000400;
+constexpr uint32_t kTrunCompositionOffset = 0x000800;
+constexpr uint32_t kTfhdDefaultBaseIsMoof = 0x020000;
+constexpr size_t kMaxTracks = 16;
+
+void put8(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put64(std::vector<uint8_t>& out, uint64_t value) {
+    put32(out, static_cast<uint32_t>(value >> 32));
+    put32(out, static_cast<uint32_t>(value));
+}
+
+void putTag(std::vector<uint8_t>& out, const char* tag) {
+    out.insert(out.end(), tag, tag + 4);
+}
+
+void putZeros(std::vector<uint8_t>& out, size_t count) {
+    out.insert(out.end(), count, 0);
+}
+
+void patch32(std::vector<uint8_t>& out, size_t offset, uint32_t value) {
+    out[offset] = static_cast<uint8_t>(value >> 24);
+    out[offset + 1] = static_cast<uint8_t>(value >> 16);
+    out[offset + 2] = static_cast<uint8_t>(value >> 8);
+    out[offset + 3] = static_cast<uint8_t>(value);
+}
+
+/**
+ * @brief 开始一个box，返回大小字段的位置
+ */
+size_t beginBox(std::vector<uint8_t>& out, const char* type) {
+    size_t offset = out.size();
+    put32(out, 0);
+    putTag(out, type);
+    return offset;
+}
+
+size_t beginFullBox(std::vector<uint8_t>& out, const char* type, uint8_t version, uint32_t flags) {
+    size_t offset = beginBox(out, type);
+    put32(out, (uint32_t(version) << 24) | (flags & 0xFFFFFF));
+    return offset;
+}
+
+void endBox(std::vector<uint8_t>& out, size_t offset) {
+    patch32(out, offset, static_cast<uint32_t>(out.size() - offset));
+}
+
+void putMatrix(std::vector<uint8_t>& out) {
+    const uint32_t matrix[9] = {0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000};
+    for (uint32_t value : matrix) {
+        put32(out, value);
+    }
+}
+
+bool isAnnexB(const uint8_t* data, size_t size) {
+    return (size >= 3 && data[0] == 0 && data[1] == 0 && data[2] == 1) ||
+           (size >= 4 && data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 1);
+}
+
+/**
+ * @brief 遍历Annex-B码流中的NAL单元
+ */
+template <typename Fn>
+void forEachAnnexBNal(const uint8_t* data, size_t size, Fn&& fn) {
+    size_t i = 0;
+    size_t start = SIZE_MAX;
+    while (i + 2 < size) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            if (start != SIZE_MAX) {
+                size_t end = i;
+                while (end > start && data[end - 1] == 0) {
+                    --end;
+                }
+                fn(data + start, end - start);
+            }
+            i += 3;
+            start = i;
+        } else {
+            ++i;
+        }
+    }
+    if (start != SIZE_MAX && start < size) {
+        fn(data + start, size - start);
+    }
+}
+
+/**
+ * @brief 遍历4字节长度前缀（AVCC）格式中的NAL单元
+ */
+template <typename Fn>
+void forEachAvccNal(const uint8_t* data, size_t size, Fn&& fn) {
+    size_t i = 0;
+    while (i + 4 <= size) {
+        size_t length = (size_t(data[i]) << 24) | (size_t(data[i + 1]) << 16) |
+                        (size_t(data[i + 2]) << 8) | size_t(data[i + 3]);
+        i += 4;
+        if (length > size - i) {
+            break;
+        }
+        fn(data + i, length);
+        i += length;
+    }
+}
+
+int aacFrequencyIndex(int sampleRate) {
+    static const int rates[] = {96000, 88200, 64000, 48000, 44100, 32000, 24000,
+                                22050, 16000, 12000, 11025, 8000, 7350};
+    for (int i = 0; i < 13; ++i) {
+        if (rates[i] == sampleRate) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+} // anonymous namespace
+
+int FragmentedMP4Muxer::addTrack(const MP4TrackConfig& config) {
+    if (config.codec != "h264" && config.codec != "aac" && config.codec != "flac") {
+        LOG_ERROR("MP4 muxer: unsupported codec {}", config.codec);
+        return 0;
+    }
+    if (tracks_.size() >= kMaxTracks) {
+        LOG_ERROR("MP4 muxer: at most {} tracks are supported", kMaxTracks);
+        return 0;
+    }
+    if ((config.codec == "h264") != (config.type == PacketType::Video)) {
+        LOG_ERROR("MP4 muxer: codec {} does not match track type", config.codec);
+        return 0;
+    }
+
+    Track track;
+    track.config = config;
+    track.id = static_cast<uint32_t>(tracks_.size() + 1);
+    track.timescale = config.type == PacketType::Video ? kVideoTimescale
+                                                       : static_cast<uint32_t>(std::max(1, config.sample_rate));
+    tracks_.push_back(std::move(track));
+    setFragmentDuration(fragmentDuration_);
+    return static_cast<int>(tracks_.back().id);
+}
+
+void FragmentedMP4Muxer::setFragmentDuration(FrameTime duration) {
+    fragmentDuration_ = std::max(duration, FrameTime{100000});
+
+    // 关键帧间隔可能长于分片时长，按两倍预留
+    double seconds = 2.0 * static_cast<double>(fragmentDuration_.count()) / 1000000.0;
+    for (auto& track : tracks_) {
+        double rate = track.config.type == PacketType::Video
+                          ? track.config.frame_rate
+                          : static_cast<double>(track.config.sample_rate) / std::max(1, track.config.samples_per_packet);
+        size_t expected = static_cast<size_t>(std::ceil(seconds * std::max(1.0, rate))) + 16;
+        track.samples.reserve(expected);
+    }
+}
+
+bool FragmentedMP4Muxer::hasPendingSamples() const {
+    for (const auto& track : tracks_) {
+        if (!track.samples.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FragmentedMP4Muxer::reset() {
+    for (auto& track : tracks_) {
+        track.samples.clear();
+        track.data.clear();
+        track.lastDelta = 0;
+        track.dtsOffset = 0;
+    }
+    timelineStarted_ = false;
+    headerWritten_ = false;
+    sequence_ = 0;
+}
+
+FragmentedMP4Muxer::Track* FragmentedMP4Muxer::findTrack(const EncodedPacket& packet) {
+    for (auto& track : tracks_) {
+        if (track.config.type == packet.type && track.config.track == packet.track) {
+            return &track;
+        }
+    }
+    return nullptr;
+}
+
+int64_t FragmentedMP4Muxer::toTimescale(FrameTime time, const Track& track) const {
+    // 早于时间线起点的时刻保留为负值，写第一个分片时整体平移
+    const int64_t scaled = (time - timelineStart_).count() * static_cast<int64_t>(track.timescale);
+    const int64_t units = scaled >= 0 ? (scaled + 500000) / 1000000 : -((500000 - scaled) / 1000000);
+    return units + track.dtsOffset;
+}
+
+void FragmentedMP4Muxer::alignTrackStarts() {
+    // 各轨道样本按DTS递增，第一个样本即最早的样本；向下取整保证平移后没有负值
+    int64_t earliest = 0;
+    for (const auto& track : tracks_) {
+        if (!track.samples.empty() && track.samples.front().dts < 0) {
+            const int64_t scaled = track.samples.front().dts * 1000000;
+            const int64_t micros = -((-scaled + track.timescale - 1) / track.timescale);
+            earliest = std::min(earliest, micros);
+        }
+    }
+    if (earliest == 0) {
+        return;
+    }
+    // 同一平移量换算到各轨道的时间刻度（向上取整），轨道之间保持同步
+    for (auto& track : tracks_) {
+        track.dtsOffset = (-earliest * static_cast<int64_t>(track.timescale) + 999999) / 1000000;
+        for (auto& sample : track.samples) {
+            sample.dts += track.dtsOffset;
+        }
+    }
+}
+
+bool FragmentedMP4Muxer::addPacket(const EncodedPacket& packet, std::vector<uint8_t>& out) {
+    Track* track = findTrack(packet);
+    if (!track) {
+        return false;
+    }
+
+    bool hasVideo = std::any_of(tracks_.begin(), tracks_.end(),
+                                [](const Track& t) { return t.config.type == PacketType::Video; });
+    bool videoKeyframe = packet.type == PacketType::Video && packet.keyframe;
+
+    // 有视频轨时文件必须从视频关键帧开始
+    if (!timelineStarted_) {
+        if (hasVideo && !videoKeyframe) {
+            return true;
+        }
+        timelineStart_ = packet.dts;
+        fragmentStart_ = packet.dts;
+        timelineStarted_ = true;
+    }
+
+    bool boundary = hasVideo ? videoKeyframe : true;
+    if (boundary && hasPendingSamples() && packet.dts - fragmentStart_ >= fragmentDuration_) {
+        writeFragment(out);
+        fragmentStart_ = packet.dts;
+    }
+
+    Sample sample;
+    sample.dts = toTimescale(packet.dts, *track);
+    sample.ctsOffset = static_cast<int32_t>(toTimescale(packet.pts, *track) - sample.dts);
+    sample.duration = static_cast<uint32_t>(std::max<int64_t>(0,
+        packet.duration.count() * static_cast<int64_t>(track->timescale) / 1000000));
+    sample.keyframe = packet.type == PacketType::Audio || packet.keyframe;
+
+    size_t before = track->data.size();
+    appendSampleData(*track, packet);
+    sample.size = static_cast<uint32_t>(track->data.size() - before);
+    track->samples.push_back(sample);
+    return true;
+}
+
+void FragmentedMP4Muxer::appendSampleData(Track& track, const EncodedPacket& packet) {
+    const uint8_t* data = packet.data.data();
+    size_t size = packet.data.size();
+    if (track.config.codec == "h264" && isAnnexB(data, size)) {
+        // Annex-B起始码替换为4字节长度前缀
+        forEachAnnexBNal(data, size, [&](const uint8_t* nal, size_t length) {
+            put32(track.data, static_cast<uint32_t>(length));
+            track.data.insert(track.data.end(), nal, nal + length);
+        });
+        return;
+    }
+    track.data.insert(track.data.end(), data, data + size);
+}
+
+void FragmentedMP4Muxer::flush(std::vector<uint8_t>& out) {
+    if (hasPendingSamples()) {
+        writeFragment(out);
+    }
+}
+
+bool FragmentedMP4Muxer::prepareCodecConfig(Track& track) {
+    const auto& extradata = track.config.extradata;
+    track.codecConfig.clear();
+
+    if (track.config.codec == "h264") {
+        if (!extradata.empty() && extradata[0] == 1) {
+            track.codecConfig = extradata;
+            return true;
+        }
+
+        std::vector<std::pair<const uint8_t*, size_t>> sps;
+        std::vector<std::pair<const uint8_t*, size_t>> pps;
+        auto collect = [&](const uint8_t* nal, size_t length) {
+            if (length == 0) {
+                return;
+            }
+            int type = nal[0] & 0x1F;
+            if (type == 7 && length >= 4) {
+                sps.emplace_back(nal, length);
+            } else if (type == 8) {
+                pps.emplace_back(nal, length);
+            }
+        };
+        if (isAnnexB(extradata.data(), extradata.size())) {
+            forEachAnnexBNal(extradata.data(), extradata.size(), collect);
+        }
+        if (sps.empty() && !track.samples.empty()) {
+            // 没有extradata时从第一个关键帧的带内参数集中提取
+            forEachAvccNal(track.data.data(), track.samples.front().size, collect);
+        }
+        if (sps.empty() || pps.empty()) {
+            LOG_ERROR("MP4 muxer: no SPS/PPS for H.264 track {}", track.id);
+            return false;
+        }
+
+        auto& avcc = track.codecConfig;
+        put8(avcc, 1);
+        put8(avcc, sps[0].first[1]);          // profile
+        put8(avcc, sps[0].first[2]);          // profile compatibility
+        put8(avcc, sps[0].first[3]);          // level
+        put8(avcc, 0xFF);                     // 4字节长度前缀
+        put8(avcc, 0xE0 | static_cast<uint32_t>(sps.size()));
+        for (const auto& nal : sps) {
+            put16(avcc, static_cast<uint32_t>(nal.second));
+            avcc.insert(avcc.end(), nal.first, nal.first + nal.second);
+        }
+        put8(avcc, static_cast<uint32_t>(pps.size()));
+        for (const auto& nal : pps) {
+            put16(avcc, static_cast<uint32_t>(nal.second));
+            avcc.insert(avcc.end(), nal.first, nal.first + nal.second);
+        }
+        return true;
+    }
+
+    if (track.config.codec == "aac") {
+        if (extradata.size() >= 2) {
+            track.codecConfig = extradata;
+            return true;
+        }
+        // 默认按AAC-LC生成AudioSpecificConfig
+        int frequency = aacFrequencyIndex(track.config.sample_rate);
+        if (frequency < 0) {
+            LOG_ERROR("MP4 muxer: unsupported AAC sample rate {}", track.config.sample_rate);
+            return false;
+        }
+        uint32_t asc = (2u << 11) | (uint32_t(frequency) << 7) | (uint32_t(track.config.channels & 0x0F) << 3);
+        put16(track.codecConfig, asc);
+        return true;
+    }
+
+    // FLAC：dfLa只包含元数据块，去掉"fLaC"标记
+    size_t offset = (extradata.size() >= 4 && std::memcmp(extradata.data(), "fLaC", 4) == 0) ? 4 : 0;
+    if (extradata.size() < offset + 4 + 34) {
+        LOG_ERROR("MP4 muxer: FLAC track {} requires STREAMINFO", track.id);
+        return false;
+    }
+    track.codecConfig.assign(extradata.begin() + static_cast<std::ptrdiff_t>(offset), extradata.end());
+    return true;
+}
+
+void FragmentedMP4Muxer::writeHeader(std::vector<uint8_t>& out) {
+    for (auto& track : tracks_) {
+        prepareCodecConfig(track);
+    }
+
+    size_t ftyp = beginBox(out, "ftyp");
+    putTag(out, "iso5");
+    put32(out, 512);
+    putTag(out, "iso5");
+    putTag(out, "iso6");
+    putTag(out, "mp41");
+    endBox(out, ftyp);
+
+    size_t moov = beginBox(out, "moov");
+
+    size_t mvhd = beginFullBox(out, "mvhd", 0, 0);
+    put32(out, 0);                                // creation_time
+    put32(out, 0);                                // modification_time
+    put32(out, 1000);                             // timescale
+    put32(out, 0);                                // duration（分片文件为0）
+    put32(out, 0x00010000);                       // rate
+    put16(out, 0x0100);                           // volume
+    putZeros(out, 10);
+    putMatrix(out);
+    putZeros(out, 24);                            // pre_defined
+    put32(out, static_cast<uint32_t>(tracks_.size() + 1));
+    endBox(out, mvhd);
+
+    for (const auto& track : tracks_) {
+        bool video = track.config.type == PacketType::Video;
+        size_t trak = beginBox(out, "trak");
+
+        size_t tkhd = beginFullBox(out, "tkhd", 0, 0x000003);
+        put32(out, 0);
+        put32(out, 0);
+        put32(out, track.id);
+        put32(out, 0);
+        put32(out, 0);                            // duration
+        putZeros(out, 8);
+        put16(out, 0);                            // layer
+        put16(out, video ? 0 : 1);                // alternate_group
+        put16(out, video ? 0 : 0x0100);           // volume
+        put16(out, 0);
+        putMatrix(out);
+        put32(out, video ? static_cast<uint32_t>(track.config.width) << 16 : 0);
+        put32(out, video ? static_cast<uint32_t>(track.config.height) << 16 : 0);
+        endBox(out, tkhd);
+
+        size_t mdia = beginBox(out, "mdia");
+        size_t mdhd = beginFullBox(out, "mdhd", 0, 0);
+        put32(out, 0);
+        put32(out, 0);
+        put32(out, track.timescale);
+        put32(out, 0);
+        put16(out, 0x55C4);                       // "und"
+        put16(out, 0);
+        endBox(out, mdhd);
+
+        size_t hdlr = beginFullBox(out, "hdlr", 0, 0);
+        put32(out, 0);
+        putTag(out, video ? "vide" : "soun");
+        putZeros(out, 12);
+        const char* handlerName = video ? "SimpleOBS Video" : "SimpleOBS Audio";
+        out.insert(out.end(), handlerName, handlerName + std::strlen(handlerName) + 1);
+        endBox(out, hdlr);
+
+        size_t minf = beginBox(out, "minf");
+        if (video) {
+            size_t vmhd = beginFullBox(out, "vmhd", 0, 1);
+            putZeros(out, 8);
+            endBox(out, vmhd);
+        } else {
+            size_t smhd = beginFullBox(out, "smhd", 0, 0);
+            putZeros(out, 4);
+            endBox(out, smhd);
+        }
+
+        size_t dinf = beginBox(out, "dinf");
+        size_t dref = beginFullBox(out, "dref", 0, 0);
+        put32(out, 1);
+        size_t url = beginFullBox(out, "url ", 0, 1);
+        endBox(out, url);
+        endBox(out, dref);
+        endBox(out, dinf);
+
+        size_t stbl = beginBox(out, "stbl");
+        size_t stsd = beginFullBox(out, "stsd", 0, 0);
+        put32(out, 1);
+        if (video) {
+            size_t avc1 = beginBox(out, "avc1");
+            putZeros(out, 6);
+            put16(out, 1);                        // data_reference_index
+            putZeros(out, 16);
+            put16(out, static_cast<uint32_t>(track.config.width));
+            put16(out, static_cast<uint32_t>(track.config.height));
+            put32(out, 0x00480000);
+            put32(out, 0x00480000);
+            put32(out, 0);
+            put16(out, 1);                        // frame_count
+            putZeros(out, 32);                    // compressorname
+            put16(out, 0x0018);
+            put16(out, 0xFFFF);
+            size_t avcC = beginBox(out, "avcC");
+            out.insert(out.end(), track.codecConfig.begin(), track.codecConfig.end());
+            endBox(out, avcC);
+            endBox(out, avc1);
+        } else {
+            bool flac = track.config.codec == "flac";
+            size_t entry = beginBox(out, flac ? "fLaC" : "mp4a");
+            putZeros(out, 6);
+            put16(out, 1);
+            putZeros(out, 8);
+            put16(out, static_cast<uint32_t>(track.config.channels));
+            put16(out, 16);
+            putZeros(out, 4);
+            put32(out, static_cast<uint32_t>(std::min(track.config.sample_rate, 65535)) << 16);
+            if (flac) {
+                size_t dfla = beginFullBox(out, "dfLa", 0, 0);
+                out.insert(out.end(), track.codecConfig.begin(), track.codecConfig.end());
+                endBox(out, dfla);
+            } else {
+                size_t ascSize = track.codecConfig.size();
+                size_t esds = beginFullBox(out, "esds", 0, 0);
+                put8(out, 0x03);                  // ES_Descriptor
+                // ES_ID + 标志，DecoderConfigDescriptor（含DecoderSpecificInfo），SLConfigDescriptor
+                put8(out, static_cast<uint32_t>(3 + (2 + 13 + 2 + ascSize) + 3));
+                put16(out, track.id);
+                put8(out, 0);
+                put8(out, 0x04);                  // DecoderConfigDescriptor
+                put8(out, static_cast<uint32_t>(13 + 2 + ascSize));
+                put8(out, 0x40);                  // MPEG-4 Audio
+                put8(out, 0x15);                  // AudioStream
+                putZeros(out, 3);                 // bufferSizeDB
+                put32(out, 0);                    // maxBitrate
+                put32(out, 0);                    // avgBitrate
+                put8(out, 0x05);                  // DecoderSpecificInfo
+                put8(out, static_cast<uint32_t>(ascSize));
+                out.insert(out.end(), track.codecConfig.begin(), track.codecConfig.end());
+                put8(out, 0x06);                  // SLConfigDescriptor
+                put8(out, 1);
+                put8(out, 2);
+                endBox(out, esds);
+            }
+            endBox(out, entry);
+        }
+        endBox(out, stsd);
+
+        // 样本全部位于分片中，moov里的样本表为空
+        size_t stts = beginFullBox(out, "stts", 0, 0);
+        put32(out, 0);
+        endBox(out, stts);
+        size_t stsc = beginFullBox(out, "stsc", 0, 0);
+        put32(out, 0);
+        endBox(out, stsc);
+        size_t stsz = beginFullBox(out, "stsz", 0, 0);
+        put32(out, 0);
+        put32(out, 0);
+        endBox(out, stsz);
+        size_t stco = beginFullBox(out, "stco", 0, 0);
+        put32(out, 0);
+        endBox(out, stco);
+        endBox(out, stbl);
+
+        endBox(out, minf);
+        endBox(out, mdia);
+        endBox(out, trak);
+    }
+
+    size_t mvex = beginBox(out, "mvex");
+    for (const auto& track : tracks_) {
+        size_t trex = beginFullBox(out, "trex", 0, 0);
+        put32(out, track.id);
+        put32(out, 1);
+        put32(out, 0);
+        put32(out, 0);
+        put32(out, 0);
+        endBox(out, trex);
+    }
+    endBox(out, mvex);
+
+    endBox(out, moov);
+}
+
+void FragmentedMP4Muxer::writeFragment(std::vector<uint8_t>& out) {
+    if (!headerWritten_) {
+        alignTrackStarts();
+        writeHeader(out);
+        headerWritten_ = true;
+    }
+
+    ++sequence_;
+    size_t moof = beginBox(out, "moof");
+    size_t mfhd = beginFullBox(out, "mfhd", 0, 0);
+    put32(out, sequence_);
+    endBox(out, mfhd);
+
+    size_t dataOffsetFields[kMaxTracks] = {};
+    size_t trackCount = 0;
+    for (auto& track : tracks_) {
+        if (track.samples.empty()) {
+            continue;
+        }
+        bool video = track.config.type == PacketType::Video;
+
+        size_t traf = beginBox(out, "traf");
+        size_t tfhd = beginFullBox(out, "tfhd", 0, kTfhdDefaultBaseIsMoof);
+        put32(out, track.id);
+        endBox(out, tfhd);
+
+        size_t tfdt = beginFullBox(out, "tfdt", 1, 0);
+        put64(out, static_cast<uint64_t>(track.samples.front().dts));
+        endBox(out, tfdt);
+
+        uint32_t flags = kTrunDataOffset | kTrunSampleDuration | kTrunSampleSize | kTrunSampleFlags;
+        if (video) {
+            flags |= kTrunCompositionOffset;
+        }
+        size_t trun = beginFullBox(out, "trun", 1, flags);
+        put32(out, static_cast<uint32_t>(track.samples.size()));
+        dataOffsetFields[trackCount++] = out.size();
+        put32(out, 0);
+
+        // 样本时长取相邻DTS之差；最后一个样本优先用数据包自带时长
+        int64_t fallback = video ? static_cast<int64_t>(track.timescale / std::max(1.0, track.config.frame_rate))
+                                 : track.config.samples_per_packet;
+        size_t count = track.samples.size();
+        for (size_t i = 0; i < count; ++i) {
+            const Sample& sample = track.samples[i];
+            int64_t duration;
+            if (i + 1 < count) {
+                duration = std::max<int64_t>(0, track.samples[i + 1].dts - sample.dts);
+                track.lastDelta = duration;
+            } else if (sample.duration > 0) {
+                duration = sample.duration;
+            } else {
+                duration = track.lastDelta > 0 ? track.lastDelta : fallback;
+            }
+            put32(out, static_cast<uint32_t>(duration));
+            put32(out, sample.size);
+            put32(out, sample.keyframe ? kSampleFlagsSync : kSampleFlagsNonSync);
+            if (video) {
+                put32(out, static_cast<uint32_t>(sample.ctsOffset));
+            }
+        }
+        endBox(out, trun);
+        endBox(out, traf);
+    }
+    endBox(out, moof);
+
+    size_t moofSize = out.size() - moof;
+    size_t payload = 0;
+    size_t index = 0;
+    for (const auto& track : tracks_) {
+        if (track.samples.empty()) {
+            continue;
+        }
+        patch32(out, dataOffsetFields[index++], static_cast<uint32_t>(moofSize + 8 + payload));
+        payload += track.data.size();
+    }
+
+    put32(out, static_cast<uint32_t>(8 + payload));
+    putTag(out, "mdat");
+    for (auto& track : tracks_) {
+        out.insert(out.end(), track.data.begin(), track.data.end());
+        track.samples.clear();
+        track.data.clear();
+    }
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,132 @@
+/**
+ * @file MP4Muxer.h
+ * @brief 分片MP4（fMP4）封装器
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了分片MP4封装器：文件头（ftyp + 不含样本的moov）之后，
+ * 每隔固定时长输出一个moof + mdat分片。分片自带时间线（tfdt），
+ * 写完即可播放，进程崩溃最多丢失最后一个未写出的分片，结束时也无需回写或重封装。
+ *
+ * @note
+ * - 支持H.264（Annex-B或AVCC输入）、AAC和FLAC
+ * - 有视频轨时分片只在视频关键帧处切分
+ * - 早于首个视频关键帧的音频不被截断到0：所有轨道按第一个分片中最早的样本整体平移
+ * - 样本表与负载缓冲区按分片时长预先分配，清空后保留容量，稳定运行时不分配内存
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief MP4轨道配置
+ */
+struct MP4TrackConfig {
+    PacketType type = PacketType::Video;   ///< 匹配的数据包类型
+    int track = 0;                         ///< 匹配的轨道索引
+    std::string codec = "h264";            ///< "h264"、"aac"或"flac"
+    std::vector<uint8_t> extradata;        ///< 编解码器配置（SPS/PPS、AudioSpecificConfig、fLaC流头）
+    int width = 0;                         ///< 视频宽度
+    int height = 0;                        ///< 视频高度
+    double frame_rate = 60.0;              ///< 预期帧率，用于预分配样本表
+    int sample_rate = 48000;               ///< 音频采样率（同时作为音频时间刻度）
+    int channels = 2;                      ///< 音频声道数
+    int samples_per_packet = 1024;         ///< 每个音频包的采样点数，用于预分配样本表
+};
+
+/**
+ * @brief 分片MP4封装器
+ */
+class FragmentedMP4Muxer {
+public:
+    /**
+     * @brief 添加轨道，必须在第一次写入前调用
+     * @param[in] config 轨道配置
+     * @return 轨道ID（从1开始），编解码器不支持时返回0
+     */
+    int addTrack(const MP4TrackConfig& config);
+
+    /**
+     * @brief 设置分片时长并预分配样本表
+     * @param[in] duration 目标分片时长
+     */
+    void setFragmentDuration(FrameTime duration);
+
+    /**
+     * @brief 写入一个数据包
+     * @param[in] packet 编码数据包
+     * @param[out] out 达到分片边界时追加文件头和/或完成的分片
+     * @return true表示已接收，false表示没有匹配的轨道
+     */
+    bool addPacket(const EncodedPacket& packet, std::vector<uint8_t>& out);
+
+    /**
+     * @brief 输出缓冲中的最后一个分片
+     * @param[out] out 追加的数据
+     */
+    void flush(std::vector<uint8_t>& out);
+
+    /**
+     * @brief 是否有尚未输出的样本
+     * @return true表示当前分片非空
+     */
+    bool hasPendingSamples() const;
+
+    /**
+     * @brief 重置封装状态，下一次输出重新生成文件头
+     * @details 轨道配置保留，时间线从下一个数据包重新开始
+     */
+    void reset();
+
+    /**
+     * @brief 获取已输出的分片数
+     * @return 分片数
+     */
+    uint32_t fragmentCount() const { return sequence_; }
+
+private:
+    struct Sample {
+        int64_t dts = 0;           ///< 解码时间（轨道时间刻度）
+        int32_t ctsOffset = 0;     ///< 显示时间偏移
+        uint32_t duration = 0;     ///< 数据包自带时长，0表示未知
+        uint32_t size = 0;
+        bool keyframe = false;
+    };
+
+    struct Track {
+        MP4TrackConfig config;
+        uint32_t id = 0;
+        uint32_t timescale = 0;
+        std::vector<uint8_t> codecConfig;   ///< avcC/esds内容/dfLa内容
+        std::vector<Sample> samples;        ///< 当前分片的样本表
+        std::vector<uint8_t> data;          ///< 当前分片的样本负载
+        int64_t lastDelta = 0;              ///< 最近一次样本间隔
+        int64_t dtsOffset = 0;              ///< 第一个分片确定的时间线平移（轨道时间刻度）
+    };
+
+    Track* findTrack(const EncodedPacket& packet);
+    bool prepareCodecConfig(Track& track);
+    void appendSampleData(Track& track, const EncodedPacket& packet);
+    void alignTrackStarts();
+    void writeHeader(std::vector<uint8_t>& out);
+    void writeFragment(std::vector<uint8_t>& out);
+    int64_t toTimescale(FrameTime time, const Track& track) const;
+
+    std::vector<Track> tracks_;
+    FrameTime fragmentDuration_{2000000};
+    FrameTime timelineStart_{0};
+    FrameTime fragmentStart_{0};
+    bool timelineStarted_ = false;
+    bool headerWritten_ = false;
+    uint32_t sequence_ = 0;
+};
+
+} // namespace SimpleOBS
@@ -0,0 +1,352 @@
+/**
+ * @file MP4Output.cpp
+ * @brief 分片MP4录制输出实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "MP4Output.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+std::vector<MP4TrackConfig> defaultTracks() {
+    MP4TrackConfig video;
+    video.type = PacketType::Video;
+    video.codec = "h264";
+
+    MP4TrackConfig audio;
+    audio.type = PacketType::Audio;
+    audio.codec = "aac";
+    return {video, audio};
+}
+
+/**
+ * @brief 为文件预留磁盘空间，不改变文件长度
+ * @details 预留失败不影响录制，只是失去预分配的好处
+ */
+void preallocate(std::FILE* file, int64_t bytes) {
+#if defined(__linux__)
+    if (bytes > 0) {
+        fallocate(fileno(file), FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(bytes));
+    }
+#else
+    (void)file;
+    (void)bytes;
+#endif
+}
+
+/**
+ * @brief 创建新文件
+ * @details 先删除上次录制留下的同名文件，再独占创建，
+ *          保证不会以截断方式打开本次录制中仍在写入的文件
+ */
+std::FILE* createFile(const std::string& path) {
+    std::remove(path.c_str());
+    return std::fopen(path.c_str(), "wbx");
+}
+
+} // anonymous namespace
+
+MP4Output::MP4Output(const std::string& name, const MP4OutputSettings& settings)
+    : BaseOutput(name), settings_(settings) {
+    if (settings_.tracks.empty()) {
+        settings_.tracks = defaultTracks();
+    }
+}
+
+MP4Output::~MP4Output() {
+    stop();
+}
+
+bool MP4Output::start() {
+    if (active_.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    muxer_ = FragmentedMP4Muxer();
+    muxer_.setFragmentDuration(FrameTime(static_cast<int64_t>(settings_.fragment_duration_ms) * 1000));
+    hasVideo_ = false;
+    for (const auto& track : settings_.tracks) {
+        if (muxer_.addTrack(track) == 0) {
+            return false;
+        }
+        hasVideo_ = hasVideo_ || track.type == PacketType::Video;
+    }
+
+    fileIndex_ = 1;
+    currentPath_ = filePath(fileIndex_);
+    file_ = createFile(currentPath_);
+    if (!file_) {
+        LOG_ERROR("MP4 output {} cannot create {}: {}", name_, currentPath_, std::strerror(errno));
+        return false;
+    }
+    buffer_.clear();
+    fileBytes_ = 0;
+    fileStarted_ = false;
+
+    if (splitEnabled()) {
+        preallocate_ = settings_.preallocate_bytes > 0 ? settings_.preallocate_bytes : settings_.split_size_bytes;
+        preallocate(file_, preallocate_);
+        workerStop_ = false;
+        prepareIndex_ = 0;
+        claimedIndex_ = fileIndex_;
+        preparing_ = false;
+        preparedIndex_ = 0;
+        preparedFile_ = nullptr;
+        worker_ = std::thread(&MP4Output::workerLoop, this);
+        requestPrepare(fileIndex_ + 1);
+    }
+    active_.store(true, std::memory_order_release);
+
+    LOG_INFO("MP4 output {} recording to {} ({} tracks, {} ms fragments, split {} ms / {} bytes)",
+             name_, currentPath_, settings_.tracks.size(), settings_.fragment_duration_ms,
+             settings_.split_duration_ms, settings_.split_size_bytes);
+    return true;
+}
+
+void MP4Output::stop() {
+    if (!active_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    muxer_.flush(buffer_);
+    writeOut();
+    std::fclose(file_);
+    file_ = nullptr;
+
+    if (worker_.joinable()) {
+        {
+            std::lock_guard<std::mutex> workerLock(workerMutex_);
+            workerStop_ = true;
+        }
+        workerCv_.notify_one();
+        worker_.join();
+
+        // 预创建但未使用的文件删除掉，已写入过的文件只关闭
+        if (preparedFile_) {
+            std::fclose(preparedFile_);
+            preparedFile_ = nullptr;
+            if (preparedIndex_ > fileIndex_) {
+                std::remove(filePath(preparedIndex_).c_str());
+            }
+        }
+    }
+
+    OutputStats stats = getStats();
+    LOG_INFO("MP4 output {} finished {}: {} files, {} bytes",
+             name_, currentPath_, fileIndex_, stats.bytes_sent);
+}
+
+bool MP4Output::sendPacket(const EncodedPacket& packet) {
+    if (!active_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) {
+        return false;
+    }
+    if (shouldSplit(packet) && !splitFile()) {
+        return false;
+    }
+    if (!muxer_.addPacket(packet, buffer_)) {
+        return false;
+    }
+    if (!fileStarted_ && muxer_.hasPendingSamples()) {
+        fileStart_ = packet.dts;
+        fileStarted_ = true;
+    }
+    return buffer_.empty() || writeOut();
+}
+
+std::string MP4Output::getCurrentPath() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return currentPath_;
+}
+
+std::string MP4Output::filePath(int index) const {
+    if (!splitEnabled()) {
+        return settings_.path;
+    }
+
+    // recording.mp4 -> recording_0001.mp4
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%04d", index);
+    size_t slash = settings_.path.find_last_of("/\\");
+    size_t dot = settings_.path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return settings_.path + suffix;
+    }
+    return settings_.path.substr(0, dot) + suffix + settings_.path.substr(dot);
+}
+
+bool MP4Output::shouldSplit(const EncodedPacket& packet) const {
+    if (!splitEnabled() || !fileStarted_) {
+        return false;
+    }
+    // 只在能独立解码的位置切分：有视频时为视频关键帧，纯音频时为任意数据包
+    if (hasVideo_ && !(packet.type == PacketType::Video && packet.keyframe)) {
+        return false;
+    }
+    if (settings_.split_duration_ms > 0 &&
+        packet.dts - fileStart_ >= FrameTime(settings_.split_duration_ms * 1000)) {
+        return true;
+    }
+    return settings_.split_size_bytes > 0 && fileBytes_ >= settings_.split_size_bytes;
+}
+
+bool MP4Output::splitFile() {
+    // 当前文件的最后一个分片写完后才切换
+    muxer_.flush(buffer_);
+    writeOut();
+
+    int nextIndex = fileIndex_ + 1;
+    std::FILE* next = nullptr;
+    {
+        std::unique_lock<std::mutex> workerLock(workerMutex_);
+        // 后台线程正在创建这个文件时等它完成，不能在两个线程中打开同一路径
+        preparedCv_.wait(workerLock, [this, nextIndex] {
+            return !preparing_ || claimedIndex_ != nextIndex;
+        });
+        if (preparedFile_ && preparedIndex_ == nextIndex) {
+            next = preparedFile_;
+            preparedFile_ = nullptr;
+        } else {
+            // 由写入线程自行创建，尚未开始的预创建请求随之作废
+            claimedIndex_ = std::max(claimedIndex_, nextIndex);
+            if (prepareIndex_ <= nextIndex) {
+                prepareIndex_ = 0;
+            }
+        }
+        if (settings_.preallocate_bytes <= 0 && settings_.split_size_bytes <= 0) {
+            preallocate_ = std::max(preallocate_, fileBytes_);
+        }
+    }
+
+    std::string nextPath = filePath(nextIndex);
+    if (!next) {
+        // 后台线程尚未就绪，只能在写入线程中创建
+        LOG_WARN("MP4 output {}: next file {} was not ready, creating it inline", name_, nextPath);
+        next = createFile(nextPath);
+        if (!next) {
+            LOG_ERROR("MP4 output {} cannot create {}: {}", name_, nextPath, std::strerror(errno));
+            countError();
+            return false;
+        }
+    }
+
+    std::FILE* previous = file_;
+    file_ = next;
+    LOG_INFO("MP4 output {} split: {} ({} bytes) -> {}", name_, currentPath_, fileBytes_, nextPath);
+    currentPath_ = nextPath;
+    fileIndex_ = nextIndex;
+    fileBytes_ = 0;
+    fileStarted_ = false;
+    muxer_.reset();
+
+    {
+        std::lock_guard<std::mutex> workerLock(workerMutex_);
+        closeQueue_.push_back(previous);
+    }
+    requestPrepare(fileIndex_ + 1);
+    return true;
+}
+
+bool MP4Output::writeOut() {
+    if (buffer_.empty()) {
+        return true;
+    }
+
+    // 分片整体写出后立即刷新，保证文件在任意时刻都以完整分片结尾
+    size_t size = buffer_.size();
+    bool ok = std::fwrite(buffer_.data(), 1, size, file_) == size && std::fflush(file_) == 0;
+#ifndef _WIN32
+    if (ok && settings_.sync_fragments) {
+        ok = fdatasync(fileno(file_)) == 0;
+    }
+#endif
+    buffer_.clear();
+
+    if (!ok) {
+        LOG_ERROR("MP4 output {} write failed: {}", name_, std::strerror(errno));
+        countError();
+        return false;
+    }
+    fileBytes_ += static_cast<int64_t>(size);
+    countSent(1, size);
+    return true;
+}
+
+void MP4Output::requestPrepare(int index) {
+    {
+        std::lock_guard<std::mutex> workerLock(workerMutex_);
+        prepareIndex_ = index;
+    }
+    workerCv_.notify_one();
+}
+
+void MP4Output::workerLoop() {
+    enterWorkerThread();
+    std::unique_lock<std::mutex> lock(workerMutex_);
+    while (true) {
+        workerCv_.wait(lock, [this] {
+            return workerStop_ || !closeQueue_.empty() || (prepareIndex_ != 0 && !preparedFile_);
+        });
+
+        // 关闭已完成的文件（数据已刷新，这里可能因元数据同步而阻塞）
+        while (!closeQueue_.empty()) {
+            std::FILE* file = closeQueue_.back();
+            closeQueue_.pop_back();
+            lock.unlock();
+            std::fclose(file);
+            lock.lock();
+        }
+
+        if (workerStop_) {
+            break;
+        }
+
+        if (prepareIndex_ != 0 && !preparedFile_) {
+            int index = prepareIndex_;
+            int64_t bytes = preallocate_;
+            prepareIndex_ = 0;
+            // 写入线程已自行创建了该序号的文件，放弃过期的请求
+            if (index <= claimedIndex_) {
+                continue;
+            }
+            claimedIndex_ = index;
+            preparing_ = true;
+            lock.unlock();
+
+            std::string path = filePath(index);
+            std::FILE* file = createFile(path);
+            if (file) {
+                preallocate(file, bytes);
+            } else {
+                LOG_ERROR("MP4 output {} cannot pre-create {}: {}", name_, path, std::strerror(errno));
+            }
+
+            lock.lock();
+            preparing_ = false;
+            preparedFile_ = file;
+            preparedIndex_ = index;
+            preparedCv_.notify_all();
+        }
+    }
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,128 @@
+/**
+ * @file MP4Output.h
+ * @brief 分片MP4录制输出
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了录制输出：编码数据包经FragmentedMP4Muxer封装后，
+ * 每完成一个分片就追加写入文件并刷新到磁盘。
+ * 可按时长或大小在关键帧处切分为多个文件，切分点前后的数据包不缓存也不丢弃。
+ *
+ * @note
+ * - 进程崩溃或断电时，已写出的分片仍可直接播放
+ * - 停止录制只需写出最后一个分片，不需要回写文件头或重新封装
+ * - 切分时下一个文件已由后台线程提前创建并预分配空间，旧文件也由后台线程关闭，
+ *   写入线程只需切换文件指针
+ */
+
+#pragma once
+
+#include "BaseOutput.h"
+#include "MP4Muxer.h"
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SimpleOBS {
+
+/**
+ * @brief MP4录制配置
+ */
+struct MP4OutputSettings {
+    std::string path = "recording.mp4";    ///< 输出文件路径，切分时在扩展名前插入序号
+    int fragment_duration_ms = 2000;       ///< 分片时长（有视频时在其后的首个关键帧处切分）
+    bool sync_fragments = true;            ///< 每个分片写出后是否fdatasync
+    int64_t split_duration_ms = 0;         ///< 按时长切分文件，0表示不按时长切分
+    int64_t split_size_bytes = 0;          ///< 按大小切分文件，0表示不按大小切分
+    int64_t preallocate_bytes = 0;         ///< 预分配大小，0表示取切分大小或上一个文件的大小
+    std::vector<MP4TrackConfig> tracks;    ///< 轨道配置，为空时使用H.264 + AAC
+};
+
+/**
+ * @brief 分片MP4录制输出
+ */
+class MP4Output : public BaseOutput {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] name 输出名称
+     * @param[in] settings 录制配置
+     */
+    explicit MP4Output(const std::string& name,
+                       const MP4OutputSettings& settings = MP4OutputSettings{});
+    ~MP4Output() override;
+
+    std::string getId() const override { return "mp4"; }
+
+    /**
+     * @brief 创建文件并开始录制
+     * @return true表示启动成功
+     */
+    bool start() override;
+
+    /**
+     * @brief 写出最后一个分片并关闭文件
+     */
+    void stop() override;
+
+    /**
+     * @brief 写入一个数据包
+     * @param[in] packet 编码数据包
+     * @return true表示已接收，false表示未启动、无匹配轨道或写入失败
+     */
+    bool sendPacket(const EncodedPacket& packet) override;
+
+    /**
+     * @brief 获取录制配置
+     * @return 当前配置
+     */
+    const MP4OutputSettings& getSettings() const { return settings_; }
+
+    /**
+     * @brief 获取当前写入的文件路径
+     * @return 文件路径
+     */
+    std::string getCurrentPath() const;
+
+private:
+    bool splitEnabled() const { return settings_.split_duration_ms > 0 || settings_.split_size_bytes > 0; }
+    std::string filePath(int index) const;
+    bool shouldSplit(const EncodedPacket& packet) const;
+    bool splitFile();
+    bool writeOut();
+    void requestPrepare(int index);
+    void workerLoop();
+
+    MP4OutputSettings settings_;       ///< 录制配置
+    mutable std::mutex mutex_;         ///< 保护封装器和文件
+    FragmentedMP4Muxer muxer_;         ///< 分片封装器
+    std::vector<uint8_t> buffer_;      ///< 待写出的数据，容量复用
+    std::FILE* file_ = nullptr;        ///< 输出文件
+    std::string currentPath_;          ///< 当前文件路径
+    int fileIndex_ = 0;                ///< 当前文件序号（从1开始）
+    int64_t fileBytes_ = 0;            ///< 当前文件已写入字节数
+    FrameTime fileStart_{0};           ///< 当前文件首个数据包的DTS
+    bool fileStarted_ = false;         ///< 当前文件是否已写入数据包
+    bool hasVideo_ = false;            ///< 是否有视频轨（决定切分点）
+
+    // 后台线程：预先创建下一个文件，关闭已完成的文件
+    std::thread worker_;
+    std::mutex workerMutex_;
+    std::condition_variable workerCv_;
+    std::condition_variable preparedCv_;   ///< 后台线程完成一次预创建
+    bool workerStop_ = false;
+    int prepareIndex_ = 0;             ///< 请求预创建的文件序号，0表示无请求
+    int claimedIndex_ = 0;             ///< 本次录制已创建或正在创建的最大文件序号，每个序号只打开一次
+    bool preparing_ = false;           ///< 后台线程正在创建claimedIndex_
+    int preparedIndex_ = 0;            ///< 已预创建的文件序号
+    std::FILE* preparedFile_ = nullptr;
+    int64_t preallocate_ = 0;          ///< 预分配字节数
+    std::vector<std::FILE*> closeQueue_;
+};
+
+} // namespace SimpleOBS
@@ -0,0 +1,49 @@
+/**
+ * @file OutputModules.cpp
+ * @brief 内置输出模块登记
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "ModuleRegistry.h"
+#include "MP4Output.h"
+#include "ReliableUDPOutput.h"
+#include "UDPOutput.h"
+
+namespace SimpleOBS {
+
+/**
+ * @brief 登记内置输出模块
+ * @param[in] registry 模块注册表
+ *
+ * @note 网络输出和录制输出分属两个模块，只录制时不会加载网络输出
+ */
+void registerOutputModules(ModuleRegistry& registry) {
+    ModuleDescriptor network;
+    network.name = "outputs.network";
+    network.outputs = {"udp", "rudp"};
+    network.load = [](ModuleRegistry& r) {
+        r.registerOutput("udp", [](const std::string& name) -> OutputPtr {
+            return std::make_shared<UDPOutput>(name);
+        });
+        r.registerOutput("rudp", [](const std::string& name) -> OutputPtr {
+            return std::make_shared<ReliableUDPOutput>(name);
+        });
+        return true;
+    };
+    registry.addModule(std::move(network));
+
+    ModuleDescriptor recording;
+    recording.name = "outputs.recording";
+    recording.outputs = {"mp4"};
+    recording.load = [](ModuleRegistry& r) {
+        r.registerOutput("mp4", [](const std::string& name) -> OutputPtr {
+            return std::make_shared<MP4Output>(name);
+        });
+        return true;
+    };
+    registry.addModule(std::move(recording));
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,945 @@
+/**
+ * @file ReliableUDPOutput.cpp
+ * @brief 可靠UDP输出及接收器实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 线路格式（多字节字段均为网络字节序）：
+ * - 数据：type=1 | flags(bit0重传) | 负载长度(2) | 序号(4) | 发送时间戳us(4) | 会话(4) | 负载
+ * - ACK： type=2 | 0 | 回显延迟100us(2) | 下一个期望序号(4) | 回显时间戳(4) | 会话(4)
+ * - NAK： type=3 | 0 | 区间数(2) | 0(4) | 0(4) | 会话(4) | [首序号(4) 末序号(4)]...
+ *
+ * @note
+ * - 发送线程先处理重传再发送新数据，二者共享同一个令牌桶
+ * - RTT由ACK回显的时间戳减去接收端持有时间计算
+ */
+
+#include "ReliableUDPOutput.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+constexpr uint8_t kArqData = 1;
+constexpr uint8_t kArqAck = 2;
+constexpr uint8_t kArqNak = 3;
+constexpr uint8_t kArqFlagRetransmit = 0x01;
+constexpr int kArqMaxBatch = 64;
+constexpr int kArqMaxDatagram = kArqHeaderSize + kArqMaxNakRanges * 8;
+constexpr int64_t kMinRetransmitIntervalUs = 1000;
+
+// 速率调整：每个窗口（至少100ms，且不短于4个RTT）按丢包率和RTT增减一次
+constexpr int64_t kPaceWindowUs = 100000;
+constexpr double kPaceLossThreshold = 0.02;     ///< 超过该丢失率视为拥塞
+constexpr int64_t kPaceRttSlackUs = 5000;       ///< RTT超过2倍最小RTT加该余量视为排队
+constexpr double kPaceDecrease = 0.85;          ///< 拥塞时的乘性降速系数
+constexpr double kPaceIncrease = 0.05;          ///< 无拥塞时每窗口增加最大带宽的比例
+
+void put16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value >> 8);
+    out[1] = static_cast<uint8_t>(value);
+}
+
+void put32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+uint16_t get16(const uint8_t* in) {
+    return static_cast<uint16_t>((in[0] << 8) | in[1]);
+}
+
+uint32_t get32(const uint8_t* in) {
+    return (uint32_t(in[0]) << 24) | (uint32_t(in[1]) << 16) | (uint32_t(in[2]) << 8) | uint32_t(in[3]);
+}
+
+/**
+ * @brief 序号比较，正确处理32位回绕
+ * @return a - b的有符号距离
+ */
+int32_t seqDiff(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b);
+}
+
+uint32_t roundUpPow2(int value) {
+    uint32_t size = 1;
+    while (size < static_cast<uint32_t>(std::max(1, value))) {
+        size <<= 1;
+    }
+    return size;
+}
+
+std::vector<TSStreamConfig> defaultStreams() {
+    TSStreamConfig video;
+    video.type = PacketType::Video;
+    video.stream_type = kTSStreamH264;
+
+    TSStreamConfig audio;
+    audio.type = PacketType::Audio;
+    audio.stream_type = kTSStreamAacAdts;
+    return {video, audio};
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// ReliableUDPOutput
+// ============================================================================
+
+ReliableUDPOutput::ReliableUDPOutput(const std::string& name, const ReliableUDPSettings& settings)
+    : BaseOutput(name), settings_(settings) {
+    settings_.batch_size = std::max(1, std::min(settings_.batch_size, kArqMaxBatch));
+    settings_.buffer_packets = std::max(settings_.batch_size, settings_.buffer_packets);
+    settings_.queue_packets = std::max(settings_.batch_size, settings_.queue_packets);
+    settings_.latency_ms = std::max(1, settings_.latency_ms);
+    if (settings_.streams.empty()) {
+        settings_.streams = defaultStreams();
+    }
+}
+
+ReliableUDPOutput::~ReliableUDPOutput() {
+    stop();
+}
+
+bool ReliableUDPOutput::start() {
+    if (active_.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+#ifdef _WIN32
+    LOG_ERROR("Reliable UDP output {} is not supported on this platform", name_);
+    return false;
+#else
+    if (!openSocket()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(muxMutex_);
+        muxer_ = TSMuxer();
+        for (const auto& stream : settings_.streams) {
+            muxer_.addStream(stream);
+        }
+        pending_.size = 0;
+    }
+    queue_.reset(static_cast<size_t>(settings_.queue_packets));
+
+    uint32_t capacity = roundUpPow2(settings_.buffer_packets);
+    slots_.assign(capacity, Slot{});
+    slotMask_ = capacity - 1;
+    retransmitQueue_.assign(capacity, 0);
+    retransmitHead_ = 0;
+    retransmitCount_ = 0;
+    sendSeqs_.assign(static_cast<size_t>(settings_.batch_size), 0);
+    baseSeq_ = 0;
+    nextSeq_ = 0;
+    srttUs_ = 0;
+    minRttUs_ = 0;
+    paceRate_ = static_cast<double>(settings_.bitrate) / 8.0 / 1000000.0;
+    paceWindowStart_ = 0;
+    windowSends_ = 0;
+    windowLosses_ = 0;
+    pacingBitrate_.store(settings_.bitrate, std::memory_order_relaxed);
+    epoch_ = std::chrono::steady_clock::now();
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&ReliableUDPOutput::senderLoop, this);
+    active_.store(true, std::memory_order_release);
+
+    LOG_INFO("Reliable UDP output {} started: {}:{}, latency={} ms, bitrate={}, buffer={} packets",
+             name_, settings_.host, settings_.port, settings_.latency_ms, settings_.bitrate, capacity);
+    return true;
+#endif
+}
+
+void ReliableUDPOutput::stop() {
+    if (!active_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(muxMutex_);
+        flushPending();
+    }
+
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closeSocket();
+
+    ReliableUDPStats stats = getTransportStats();
+    LOG_INFO("Reliable UDP output {} stopped: {} sent, {} retransmitted, {} NAKs, {} expired, rtt={} us, pacing={}",
+             name_, stats.packets_sent, stats.retransmitted, stats.naks_received, stats.expired, stats.rtt_us,
+             stats.pacing_bitrate);
+}
+
+bool ReliableUDPOutput::sendPacket(const EncodedPacket& packet) {
+    if (!active_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(muxMutex_);
+    if (!muxer_.writePacket(packet)) {
+        return false;
+    }
+
+    const auto& ts = muxer_.output();
+    bool queued = queueTSPackets(ts.data(), ts.size());
+    muxer_.clearOutput();
+
+    if (pending_.size > 0 &&
+        std::chrono::steady_clock::now() - pendingSince_ >= std::chrono::milliseconds(settings_.flush_interval_ms)) {
+        queued = flushPending() && queued;
+    }
+    return queued;
+}
+
+ReliableUDPStats ReliableUDPOutput::getTransportStats() const {
+    ReliableUDPStats stats;
+    stats.packets_sent = firstSends_.load(std::memory_order_relaxed);
+    stats.retransmitted = retransmitted_.load(std::memory_order_relaxed);
+    stats.naks_received = naksReceived_.load(std::memory_order_relaxed);
+    stats.expired = expired_.load(std::memory_order_relaxed);
+    stats.rtt_us = rttUs_.load(std::memory_order_relaxed);
+    stats.in_flight = inFlight_.load(std::memory_order_relaxed);
+    stats.pacing_bitrate = pacingBitrate_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool ReliableUDPOutput::queueTSPackets(const uint8_t* data, size_t size) {
+    bool ok = true;
+    while (size > 0) {
+        if (pending_.size == 0) {
+            pendingSince_ = std::chrono::steady_clock::now();
+        }
+        size_t chunk = std::min(size, static_cast<size_t>(kArqPayloadSize - pending_.size));
+        std::memcpy(pending_.data + pending_.size, data, chunk);
+        pending_.size = static_cast<uint16_t>(pending_.size + chunk);
+        data += chunk;
+        size -= chunk;
+        if (pending_.size == kArqPayloadSize) {
+            ok = flushPending() && ok;
+        }
+    }
+    return ok;
+}
+
+bool ReliableUDPOutput::flushPending() {
+    if (pending_.size == 0) {
+        return true;
+    }
+    bool ok = queue_.tryPush(pending_);
+    if (!ok) {
+        countDropped();
+    }
+    pending_.size = 0;
+    return ok;
+}
+
+/**
+ * @brief 发送线程空闲时补发超时的未满数据报
+ * @details 与UDPOutput相同：只尝试加锁，入队仍在muxMutex_内完成
+ */
+void ReliableUDPOutput::flushStalePending() {
+    std::unique_lock<std::mutex> lock(muxMutex_, std::try_to_lock);
+    if (!lock.owns_lock() || pending_.size == 0 ||
+        std::chrono::steady_clock::now() - pendingSince_ < std::chrono::milliseconds(settings_.flush_interval_ms)) {
+        return;
+    }
+    flushPending();
+}
+
+int64_t ReliableUDPOutput::nowMicros() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - epoch_).count();
+}
+
+#ifndef _WIN32
+
+bool ReliableUDPOutput::openSocket() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+
+    addrinfo* result = nullptr;
+    std::string port = std::to_string(settings_.port);
+    int rc = getaddrinfo(settings_.host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0 || !result) {
+        LOG_ERROR("Reliable UDP output {} cannot resolve {}: {}", name_, settings_.host, gai_strerror(rc));
+        return false;
+    }
+
+    int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    if (fd < 0 || connect(fd, result->ai_addr, result->ai_addrlen) != 0) {
+        LOG_ERROR("Reliable UDP output {} cannot open socket: {}", name_, std::strerror(errno));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        freeaddrinfo(result);
+        return false;
+    }
+
+    freeaddrinfo(result);
+    socket_ = fd;
+    return true;
+}
+
+void ReliableUDPOutput::closeSocket() {
+    if (socket_ >= 0) {
+        ::close(socket_);
+        socket_ = -1;
+    }
+}
+
+int ReliableUDPOutput::sendSlots(const uint32_t* seqs, int count, bool retransmit, int64_t now) {
+    uint8_t headers[kArqMaxBatch][kArqHeaderSize];
+    iovec vectors[kArqMaxBatch][2];
+    int n = std::min(count, kArqMaxBatch);
+
+    for (int i = 0; i < n; ++i) {
+        Slot& slot = slots_[seqs[i] & slotMask_];
+        uint8_t* header = headers[i];
+        header[0] = kArqData;
+        header[1] = retransmit ? kArqFlagRetransmit : 0;
+        put16(header + 2, slot.payload.size);
+        put32(header + 4, slot.seq);
+        put32(header + 8, static_cast<uint32_t>(now));
+        put32(header + 12, settings_.session_id);
+        vectors[i][0].iov_base = header;
+        vectors[i][0].iov_len = kArqHeaderSize;
+        vectors[i][1].iov_base = slot.payload.data;
+        vectors[i][1].iov_len = slot.payload.size;
+        slot.lastSent = now;
+    }
+
+    int sent = 0;
+#ifdef __linux__
+    mmsghdr messages[kArqMaxBatch];
+    std::memset(messages, 0, sizeof(mmsghdr) * static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        messages[i].msg_hdr.msg_iov = vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 2;
+    }
+    while (sent < n) {
+        int rc = sendmmsg(socket_, messages + sent, static_cast<unsigned int>(n - sent), 0);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        sent += rc;
+    }
+#else
+    for (int i = 0; i < n; ++i) {
+        msghdr message{};
+        message.msg_iov = vectors[i];
+        message.msg_iovlen = 2;
+        if (sendmsg(socket_, &message, 0) < 0) {
+            if (errno == EINTR) {
+                --i;
+                continue;
+            }
+            break;
+        }
+        ++sent;
+    }
+#endif
+
+    if (sent < n && errno != ECONNREFUSED) {
+        countError();
+    }
+    return sent;
+}
+
+void ReliableUDPOutput::receiveControl(int64_t now) {
+    uint8_t buffer[kArqMaxDatagram];
+    while (true) {
+        ssize_t size = recv(socket_, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (size < 0) {
+            // 对端未启动时会收到ECONNREFUSED，继续发送即可
+            if (errno == EINTR || errno == ECONNREFUSED) {
+                continue;
+            }
+            return;
+        }
+        if (size < kArqHeaderSize || get32(buffer + 12) != settings_.session_id) {
+            continue;
+        }
+
+        if (buffer[0] == kArqAck) {
+            uint32_t ack = get32(buffer + 4);
+            if (seqDiff(ack, baseSeq_) > 0 && seqDiff(ack, nextSeq_) <= 0) {
+                baseSeq_ = ack;
+            }
+            int64_t rtt = static_cast<int64_t>(static_cast<uint32_t>(now) - get32(buffer + 8)) -
+                          static_cast<int64_t>(get16(buffer + 2)) * 100;
+            if (rtt >= 0 && rtt < 10000000) {
+                srttUs_ = srttUs_ == 0 ? rtt : (srttUs_ * 7 + rtt) / 8;
+                minRttUs_ = minRttUs_ == 0 ? rtt : std::min(minRttUs_, rtt);
+                rttUs_.store(static_cast<uint64_t>(srttUs_), std::memory_order_relaxed);
+            }
+        } else if (buffer[0] == kArqNak) {
+            handleNak(buffer, static_cast<size_t>(size), now);
+        }
+    }
+}
+
+#else
+
+bool ReliableUDPOutput::openSocket() {
+    return false;
+}
+
+void ReliableUDPOutput::closeSocket() {}
+
+int ReliableUDPOutput::sendSlots(const uint32_t* seqs, int count, bool retransmit, int64_t now) {
+    (void)seqs;
+    (void)count;
+    (void)retransmit;
+    (void)now;
+    return 0;
+}
+
+void ReliableUDPOutput::receiveControl(int64_t now) {
+    (void)now;
+}
+
+#endif
+
+void ReliableUDPOutput::handleNak(const uint8_t* data, size_t size, int64_t now) {
+    naksReceived_.fetch_add(1, std::memory_order_relaxed);
+
+    int ranges = std::min<int>(get16(data + 2), static_cast<int>((size - kArqHeaderSize) / 8));
+    // 同一序号在一个RTT内只重传一次，避免周期性NAK造成重复重传
+    int64_t suppress = std::max<int64_t>(srttUs_, kMinRetransmitIntervalUs);
+    for (int r = 0; r < ranges; ++r) {
+        uint32_t first = get32(data + kArqHeaderSize + r * 8);
+        uint32_t last = get32(data + kArqHeaderSize + r * 8 + 4);
+        if (seqDiff(first, baseSeq_) < 0) {
+            first = baseSeq_;
+        }
+        for (uint32_t seq = first; seqDiff(seq, last) <= 0 && seqDiff(seq, nextSeq_) < 0; ++seq) {
+            Slot& slot = slots_[seq & slotMask_];
+            if (slot.seq != seq || slot.retransmitQueued || now - slot.lastSent < suppress) {
+                continue;
+            }
+            slot.retransmitQueued = true;
+            retransmitQueue_[(retransmitHead_ + retransmitCount_) & slotMask_] = seq;
+            ++retransmitCount_;
+            ++windowLosses_;
+        }
+    }
+}
+
+void ReliableUDPOutput::expireSlots(int64_t now) {
+    const int64_t latency = static_cast<int64_t>(settings_.latency_ms) * 1000;
+    uint64_t expired = 0;
+    while (baseSeq_ != nextSeq_ && now - slots_[baseSeq_ & slotMask_].firstSent > latency) {
+        ++baseSeq_;
+        ++expired;
+    }
+    // 缓冲区已满时丢弃最早的数据报，为新数据让路
+    if (nextSeq_ - baseSeq_ > slotMask_) {
+        ++baseSeq_;
+        ++expired;
+    }
+    if (expired) {
+        expired_.fetch_add(expired, std::memory_order_relaxed);
+    }
+    inFlight_.store(nextSeq_ - baseSeq_, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 从重传队列中移除已离开发送窗口的序号
+ *
+ * @details 原地压缩，保留仍在窗口内且槽位未被复用的序号，并保持原有顺序。
+ * 只在复用带有待重传标记的槽位时调用，正常情况下队列很短。
+ */
+void ReliableUDPOutput::dropStaleRetransmits() {
+    size_t kept = 0;
+    for (size_t i = 0; i < retransmitCount_; ++i) {
+        uint32_t seq = retransmitQueue_[(retransmitHead_ + i) & slotMask_];
+        if (seqDiff(seq, baseSeq_) >= 0 && slots_[seq & slotMask_].seq == seq) {
+            retransmitQueue_[(retransmitHead_ + kept++) & slotMask_] = seq;
+        }
+    }
+    retransmitCount_ = kept;
+}
+
+/**
+ * @brief 按上一个窗口的丢包率和RTT调整发送速率（AIMD）
+ * @param[in] now 当前时间（微秒）
+ * @param[in] maxRate 配置的最大速率（字节/微秒）
+ * @param[in] minRate 速率下限（字节/微秒）
+ *
+ * @details 丢失率取NAK报告需要重传的数据报数与首次发送数之比；RTT超过最小RTT的两倍
+ *          说明链路在排队。两者之一成立时乘性降速，否则在有数据发送时线性恢复
+ */
+void ReliableUDPOutput::updatePacing(int64_t now, double maxRate, double minRate) {
+    if (paceWindowStart_ == 0) {
+        paceWindowStart_ = now;
+        return;
+    }
+    if (now - paceWindowStart_ < std::max(kPaceWindowUs, srttUs_ * 4)) {
+        return;
+    }
+    const double loss = windowSends_ > 0 ? static_cast<double>(windowLosses_) / windowSends_ : 0.0;
+    const bool queueing = minRttUs_ > 0 && srttUs_ > minRttUs_ * 2 + kPaceRttSlackUs;
+    if (loss > kPaceLossThreshold || queueing) {
+        paceRate_ = std::max(minRate, paceRate_ * kPaceDecrease);
+    } else if (windowSends_ > 0) {
+        paceRate_ = std::min(maxRate, paceRate_ + maxRate * kPaceIncrease);
+    }
+    pacingBitrate_.store(static_cast<int64_t>(paceRate_ * 8.0 * 1000000.0), std::memory_order_relaxed);
+    paceWindowStart_ = now;
+    windowSends_ = 0;
+    windowLosses_ = 0;
+}
+
+void ReliableUDPOutput::senderLoop() {
+    enterWorkerThread();
+
+    // 令牌桶：以字节为单位，按当前速率持续补充，重传与新数据共用；速率随拥塞在上下限之间调整
+    const double maxRate = static_cast<double>(settings_.bitrate) / 8.0 / 1000000.0;
+    const double minRate = settings_.min_bitrate > 0
+        ? std::min(maxRate, static_cast<double>(settings_.min_bitrate) / 8.0 / 1000000.0)
+        : maxRate / 4.0;
+    const bool paced = maxRate > 0.0;
+    const double packetBytes = kArqHeaderSize + kArqPayloadSize;
+    double burst = settings_.burst_bytes > 0 ? settings_.burst_bytes : maxRate * 5000.0;
+    burst = std::max(burst, packetBytes);
+    double tokens = burst;
+    int64_t lastRefill = nowMicros();
+
+    const int maxBatch = settings_.batch_size;
+    while (true) {
+        workerTick(queue_.size(), queue_.capacity());
+        int64_t now = nowMicros();
+        receiveControl(now);
+        expireSlots(now);
+
+        int budget = maxBatch;
+        if (paced) {
+            updatePacing(now, maxRate, minRate);
+            tokens = std::min(burst, tokens + static_cast<double>(now - lastRefill) * paceRate_);
+            lastRefill = now;
+            budget = std::min(maxBatch, static_cast<int>(tokens / packetBytes));
+        }
+
+        int sentPackets = 0;
+        uint64_t sentBytes = 0;
+
+        // 重传优先
+        int count = 0;
+        while (retransmitCount_ > 0 && count < budget) {
+            uint32_t seq = retransmitQueue_[retransmitHead_ & slotMask_];
+            retransmitHead_ = (retransmitHead_ + 1) & slotMask_;
+            --retransmitCount_;
+            Slot& slot = slots_[seq & slotMask_];
+            if (slot.seq != seq) {
+                continue;
+            }
+            slot.retransmitQueued = false;
+            if (seqDiff(seq, baseSeq_) >= 0 && seqDiff(seq, nextSeq_) < 0) {
+                sendSeqs_[count++] = seq;
+                sentBytes += slot.payload.size;
+            }
+        }
+        if (count > 0) {
+            int sent = sendSlots(sendSeqs_.data(), count, true, now);
+            retransmitted_.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+            sentPackets += count;
+        }
+
+        // 新数据直接出队到发送缓冲区槽位
+        int fresh = 0;
+        uint64_t freshBytes = 0;
+        while (fresh < budget - count && nextSeq_ - baseSeq_ <= slotMask_) {
+            Slot& slot = slots_[nextSeq_ & slotMask_];
+            if (!queue_.tryPop(slot.payload)) {
+                break;
+            }
+            // 槽位上的旧序号仍在重传队列中，复用前先清掉，否则新序号可能被重复排队
+            if (slot.retransmitQueued) {
+                dropStaleRetransmits();
+            }
+            slot.seq = nextSeq_;
+            slot.firstSent = now;
+            slot.retransmitQueued = false;
+            sendSeqs_[fresh++] = nextSeq_++;
+            freshBytes += slot.payload.size;
+        }
+        if (fresh > 0) {
+            int sent = sendSlots(sendSeqs_.data(), fresh, false, now);
+            firstSends_.fetch_add(static_cast<uint64_t>(fresh), std::memory_order_relaxed);
+            windowSends_ += static_cast<uint64_t>(fresh);
+            countSent(static_cast<uint64_t>(sent), freshBytes);
+            sentPackets += fresh;
+            sentBytes += freshBytes;
+            inFlight_.store(nextSeq_ - baseSeq_, std::memory_order_relaxed);
+        }
+
+        if (paced) {
+            tokens -= static_cast<double>(sentBytes) + sentPackets * kArqHeaderSize;
+        }
+
+        if (sentPackets > 0) {
+            continue;
+        }
+        if (!running_.load(std::memory_order_acquire) && queue_.size() == 0) {
+            break;
+        }
+        flushStalePending();
+
+        // 空闲或令牌不足：等待控制包或下一个令牌
+        int timeoutMs = 1;
+        if (paced && budget == 0) {
+            timeoutMs = std::max(1, static_cast<int>((packetBytes - tokens) / paceRate_ / 1000.0));
+        }
+#ifndef _WIN32
+        pollfd fd{socket_, POLLIN, 0};
+        poll(&fd, 1, timeoutMs);
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+#endif
+    }
+    leaveWorkerThread();
+}
+
+// ============================================================================
+// ReliableUDPReceiver
+// ============================================================================
+
+ReliableUDPReceiver::ReliableUDPReceiver(const ReliableUDPReceiverSettings& settings, DeliverCallback callback)
+    : settings_(settings), callback_(std::move(callback)),
+      random_(settings.loss_seed),
+      lossDistribution_(std::min(1.0, std::max(0.0, settings.loss_rate))) {}
+
+ReliableUDPReceiver::~ReliableUDPReceiver() {
+    stop();
+}
+
+bool ReliableUDPReceiver::start() {
+    if (running_.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+#ifdef _WIN32
+    LOG_ERROR("Reliable UDP receiver is not supported on this platform");
+    return false;
+#else
+    static_assert(sizeof(peer_) >= sizeof(sockaddr_storage), "peer buffer too small");
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    addrinfo* result = nullptr;
+    std::string port = std::to_string(settings_.port);
+    const char* host = settings_.bind_address.empty() ? nullptr : settings_.bind_address.c_str();
+    int rc = getaddrinfo(host, port.c_str(), &hints, &result);
+    if (rc != 0 || !result) {
+        LOG_ERROR("Reliable UDP receiver cannot resolve {}: {}", settings_.bind_address, gai_strerror(rc));
+        return false;
+    }
+
+    int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    if (fd < 0 || bind(fd, result->ai_addr, result->ai_addrlen) != 0) {
+        LOG_ERROR("Reliable UDP receiver cannot bind {}:{}: {}",
+                  settings_.bind_address, settings_.port, std::strerror(errno));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        freeaddrinfo(result);
+        return false;
+    }
+    freeaddrinfo(result);
+    socket_ = fd;
+
+    sockaddr_storage bound{};
+    socklen_t boundLength = sizeof(bound);
+    if (getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &boundLength) == 0) {
+        settings_.port = bound.ss_family == AF_INET6
+                             ? ntohs(reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port)
+                             : ntohs(reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+    }
+
+    uint32_t capacity = roundUpPow2(settings_.buffer_packets);
+    slots_.assign(capacity, Slot{});
+    slotMask_ = capacity - 1;
+    started_ = false;
+    peerKnown_ = false;
+    epoch_ = std::chrono::steady_clock::now();
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&ReliableUDPReceiver::receiveLoop, this);
+
+    LOG_INFO("Reliable UDP receiver listening on {}:{}, latency={} ms, simulated loss={}",
+             settings_.bind_address, settings_.port, settings_.latency_ms, settings_.loss_rate);
+    return true;
+#endif
+}
+
+void ReliableUDPReceiver::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+#ifndef _WIN32
+    if (socket_ >= 0) {
+        ::close(socket_);
+        socket_ = -1;
+    }
+#endif
+
+    ReliableUDPReceiverStats stats = getStats();
+    LOG_INFO("Reliable UDP receiver stopped: {} received, {} retransmits, {} lost, {} delivered",
+             stats.packets_received, stats.retransmits_received, stats.lost, stats.packets_delivered);
+}
+
+ReliableUDPReceiverStats ReliableUDPReceiver::getStats() const {
+    ReliableUDPReceiverStats stats;
+    stats.packets_received = received_.load(std::memory_order_relaxed);
+    stats.retransmits_received = retransmitsReceived_.load(std::memory_order_relaxed);
+    stats.duplicates = duplicates_.load(std::memory_order_relaxed);
+    stats.simulated_drops = simulatedDrops_.load(std::memory_order_relaxed);
+    stats.lost = lost_.load(std::memory_order_relaxed);
+    stats.naks_sent = naksSent_.load(std::memory_order_relaxed);
+    stats.packets_delivered = delivered_.load(std::memory_order_relaxed);
+    stats.bytes_delivered = bytesDelivered_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+int64_t ReliableUDPReceiver::nowMicros() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - epoch_).count();
+}
+
+#ifndef _WIN32
+
+void ReliableUDPReceiver::receiveLoop() {
+    uint8_t buffer[kArqHeaderSize + kArqPayloadSize];
+    const int64_t ackInterval = static_cast<int64_t>(std::max(1, settings_.ack_interval_ms)) * 1000;
+    const int64_t nakInterval = static_cast<int64_t>(std::max(1, settings_.nak_interval_ms)) * 1000;
+    int64_t lastAck = 0;
+    int64_t lastNak = 0;
+
+    while (running_.load(std::memory_order_acquire)) {
+        pollfd fd{socket_, POLLIN, 0};
+        poll(&fd, 1, 5);
+
+        while (true) {
+            sockaddr_storage from{};
+            socklen_t fromLength = sizeof(from);
+            ssize_t size = recvfrom(socket_, buffer, sizeof(buffer), MSG_DONTWAIT,
+                                    reinterpret_cast<sockaddr*>(&from), &fromLength);
+            if (size < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            if (size < kArqHeaderSize || buffer[0] != kArqData || get32(buffer + 12) != settings_.session_id) {
+                continue;
+            }
+            if (settings_.loss_rate > 0.0 && lossDistribution_(random_)) {
+                simulatedDrops_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            std::memcpy(peer_, &from, fromLength);
+            peerLength_ = fromLength;
+            peerKnown_ = true;
+            handleData(buffer, static_cast<size_t>(size), nowMicros());
+        }
+
+        int64_t now = nowMicros();
+        deliver(now);
+        if (started_ && now - lastAck >= ackInterval) {
+            sendAck();
+            lastAck = now;
+        }
+        if (started_ && now - lastNak >= nakInterval) {
+            sendPeriodicNaks();
+            lastNak = now;
+        }
+    }
+}
+
+void ReliableUDPReceiver::sendAck() {
+    if (!peerKnown_) {
+        return;
+    }
+    uint8_t packet[kArqHeaderSize] = {};
+    packet[0] = kArqAck;
+    int64_t held = std::min<int64_t>((nowMicros() - lastArrival_) / 100, 0xFFFF);
+    put16(packet + 2, static_cast<uint16_t>(held));
+    put32(packet + 4, headSeq_);
+    put32(packet + 8, lastTimestamp_);
+    put32(packet + 12, settings_.session_id);
+    sendto(socket_, packet, sizeof(packet), 0, reinterpret_cast<const sockaddr*>(peer_), peerLength_);
+}
+
+void ReliableUDPReceiver::sendNak(const uint32_t* ranges, int count) {
+    if (!peerKnown_ || count <= 0) {
+        return;
+    }
+    uint8_t packet[kArqMaxDatagram] = {};
+    packet[0] = kArqNak;
+    put16(packet + 2, static_cast<uint16_t>(count));
+    put32(packet + 12, settings_.session_id);
+    for (int i = 0; i < count * 2; ++i) {
+        put32(packet + kArqHeaderSize + i * 4, ranges[i]);
+    }
+    sendto(socket_, packet, static_cast<size_t>(kArqHeaderSize + count * 8), 0,
+           reinterpret_cast<const sockaddr*>(peer_), peerLength_);
+    naksSent_.fetch_add(1, std::memory_order_relaxed);
+}
+
+#else
+
+void ReliableUDPReceiver::receiveLoop() {}
+void ReliableUDPReceiver::sendAck() {}
+void ReliableUDPReceiver::sendNak(const uint32_t* ranges, int count) {
+    (void)ranges;
+    (void)count;
+}
+
+#endif
+
+void ReliableUDPReceiver::handleData(const uint8_t* data, size_t size, int64_t now) {
+    uint16_t payloadSize = get16(data + 2);
+    uint32_t seq = get32(data + 4);
+    if (payloadSize > kArqPayloadSize || kArqHeaderSize + static_cast<size_t>(payloadSize) > size) {
+        return;
+    }
+    received_.fetch_add(1, std::memory_order_relaxed);
+    if (data[1] & kArqFlagRetransmit) {
+        retransmitsReceived_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!started_) {
+        started_ = true;
+        headSeq_ = seq;
+        highestSeq_ = seq - 1;
+    }
+
+    if (seqDiff(seq, headSeq_) < 0) {
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // 超出重排窗口：强制推进队首，窗口外的数据视为丢失
+    if (seqDiff(seq, headSeq_) > static_cast<int32_t>(slotMask_)) {
+        uint32_t newHead = seq - slotMask_;
+        while (headSeq_ != newHead) {
+            Slot& slot = slots_[headSeq_ & slotMask_];
+            if (slot.present) {
+                if (callback_) {
+                    callback_(slot.data, slot.size);
+                }
+                delivered_.fetch_add(1, std::memory_order_relaxed);
+                bytesDelivered_.fetch_add(slot.size, std::memory_order_relaxed);
+                slot.present = false;
+            } else {
+                lost_.fetch_add(1, std::memory_order_relaxed);
+            }
+            ++headSeq_;
+        }
+        if (seqDiff(highestSeq_, headSeq_) < 0) {
+            highestSeq_ = headSeq_ - 1;
+        }
+    }
+
+    Slot& slot = slots_[seq & slotMask_];
+    if (slot.present) {
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::memcpy(slot.data, data + kArqHeaderSize, payloadSize);
+    slot.size = payloadSize;
+    slot.arrival = now;
+    slot.present = true;
+    lastTimestamp_ = get32(data + 8);
+    lastArrival_ = now;
+
+    if (seqDiff(seq, highestSeq_) > 0) {
+        if (seqDiff(seq, highestSeq_) > 1) {
+            // 发现新空洞，立即请求重传
+            uint32_t range[2] = {highestSeq_ + 1, seq - 1};
+            sendNak(range, 1);
+        }
+        highestSeq_ = seq;
+    }
+}
+
+void ReliableUDPReceiver::deliver(int64_t now) {
+    const int64_t latency = static_cast<int64_t>(settings_.latency_ms) * 1000;
+    while (started_ && seqDiff(highestSeq_, headSeq_) >= 0) {
+        Slot& slot = slots_[headSeq_ & slotMask_];
+        if (slot.present) {
+            if (callback_) {
+                callback_(slot.data, slot.size);
+            }
+            delivered_.fetch_add(1, std::memory_order_relaxed);
+            bytesDelivered_.fetch_add(slot.size, std::memory_order_relaxed);
+            slot.present = false;
+            ++headSeq_;
+            continue;
+        }
+
+        // 队首缺失：空洞之后的数据报等待超过延迟窗口则放弃空洞
+        uint32_t next = headSeq_ + 1;
+        while (seqDiff(highestSeq_, next) > 0 && !slots_[next & slotMask_].present) {
+            ++next;
+        }
+        if (now - slots_[next & slotMask_].arrival < latency) {
+            break;
+        }
+        lost_.fetch_add(next - headSeq_, std::memory_order_relaxed);
+        headSeq_ = next;
+    }
+}
+
+void ReliableUDPReceiver::sendPeriodicNaks() {
+    uint32_t ranges[kArqMaxNakRanges * 2];
+    int count = 0;
+    uint32_t seq = headSeq_;
+    while (seqDiff(highestSeq_, seq) > 0 && count < kArqMaxNakRanges) {
+        if (slots_[seq & slotMask_].present) {
+            ++seq;
+            continue;
+        }
+        uint32_t first = seq;
+        while (seqDiff(highestSeq_, seq) > 0 && !slots_[seq & slotMask_].present) {
+            ++seq;
+        }
+        ranges[count * 2] = first;
+        ranges[count * 2 + 1] = seq - 1;
+        ++count;
+    }
+    sendNak(ranges, count);
+}
+
+} // namespace SimpleOBS
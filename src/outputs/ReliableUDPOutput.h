@@ -0,0 +1,311 @@
+/**
+ * @file ReliableUDPOutput.h
+ * @brief 带重传的可靠UDP输出及配套接收器
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了类SRT的可靠UDP传输：发送端给每个数据报编号并保存在
+ * 固定容量的发送缓冲区中，接收端发现序号空洞时回送NAK，发送端据此重传；
+ * 超出延迟窗口仍未补齐的数据报直接放弃，保证端到端延迟有上界。
+ * ReliableUDPReceiver是进程内接收器，可模拟丢包，用于回环测试。
+ *
+ * @note
+ * - 发送缓冲区、重传队列、收发缓冲区都在start()时一次性分配
+ * - 发送线程独占发送缓冲区，收发控制包与数据包都在同一线程完成，无需加锁
+ * - 限速时按丢包和RTT调整发送速率：窗口内NAK报告的丢失率超过阈值或RTT明显高于最小RTT时
+ *   按比例降速，否则逐步恢复到配置的最大带宽（AIMD）
+ * - 仅支持POSIX平台，不支持组播
+ */
+
+#pragma once
+
+#include "BaseOutput.h"
+#include "SpscRing.h"
+#include "TSMuxer.h"
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SimpleOBS {
+
+constexpr int kArqHeaderSize = 16;                             ///< 数据报头长度
+constexpr int kArqPayloadSize = kTSPacketSize * 7;             ///< 每个数据报的TS负载
+constexpr int kArqMaxNakRanges = 64;                           ///< 单个NAK携带的最大区间数
+
+/**
+ * @brief 可靠UDP发送配置
+ */
+struct ReliableUDPSettings {
+    std::string host = "127.0.0.1";        ///< 接收端地址
+    int port = 9000;                       ///< 接收端端口
+    int latency_ms = 120;                  ///< 延迟窗口，超时的数据报不再重传
+    int64_t bitrate = 0;                   ///< 最大发送带宽（bit/s，含重传），0表示不限速
+    int64_t min_bitrate = 0;               ///< 拥塞时的最低发送带宽，0表示bitrate的1/4
+    int burst_bytes = 0;                   ///< 令牌桶容量，0表示按5ms数据量计算
+    int buffer_packets = 8192;             ///< 发送缓冲区容量（数据报数），应覆盖延迟窗口
+    int queue_packets = 1024;              ///< 生产者队列容量（数据报数）
+    int batch_size = 16;                   ///< 每次系统调用最多发送的数据报数
+    int flush_interval_ms = 20;            ///< 不满一个数据报的TS包最长等待时间
+    uint32_t session_id = 1;               ///< 会话标识，接收端据此过滤数据
+    std::vector<TSStreamConfig> streams;   ///< TS流配置，为空时使用H.264 + AAC
+};
+
+/**
+ * @brief 可靠UDP发送端传输统计
+ */
+struct ReliableUDPStats {
+    uint64_t packets_sent = 0;        ///< 首次发送的数据报数
+    uint64_t retransmitted = 0;       ///< 重传的数据报数
+    uint64_t naks_received = 0;       ///< 收到的NAK数
+    uint64_t expired = 0;             ///< 超出延迟窗口仍未确认的数据报数
+    uint64_t rtt_us = 0;              ///< 平滑往返时延（微秒）
+    uint32_t in_flight = 0;           ///< 已发送未确认的数据报数
+    int64_t pacing_bitrate = 0;       ///< 拥塞控制后的当前发送带宽（bit/s），不限速时为0
+};
+
+/**
+ * @brief 可靠UDP输出
+ */
+class ReliableUDPOutput : public BaseOutput {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] name 输出名称
+     * @param[in] settings 发送配置
+     */
+    explicit ReliableUDPOutput(const std::string& name,
+                               const ReliableUDPSettings& settings = ReliableUDPSettings{});
+    ~ReliableUDPOutput() override;
+
+    std::string getId() const override { return "rudp"; }
+
+    /**
+     * @brief 打开套接字并启动发送线程
+     * @return true表示启动成功
+     */
+    bool start() override;
+
+    /**
+     * @brief 停止发送线程
+     * @details 排队中的数据报会先发送完，但不等待重传完成
+     */
+    void stop() override;
+
+    /**
+     * @brief 封装并排队一个数据包
+     * @param[in] packet 编码数据包
+     * @return true表示已排队，false表示未启动、无匹配流或队列已满
+     */
+    bool sendPacket(const EncodedPacket& packet) override;
+
+    /**
+     * @brief 获取传输统计
+     * @return 统计信息快照
+     */
+    ReliableUDPStats getTransportStats() const;
+
+    /**
+     * @brief 获取发送配置
+     * @return 当前配置
+     */
+    const ReliableUDPSettings& getSettings() const { return settings_; }
+
+private:
+    /**
+     * @brief 固定大小的负载，入队出队不分配内存
+     */
+    struct Payload {
+        uint16_t size = 0;
+        uint8_t data[kArqPayloadSize];
+    };
+
+    /**
+     * @brief 发送缓冲区槽位
+     */
+    struct Slot {
+        Payload payload;
+        uint32_t seq = 0;
+        int64_t firstSent = 0;         ///< 首次发送时间（微秒）
+        int64_t lastSent = 0;          ///< 最近发送时间（微秒）
+        bool retransmitQueued = false;
+    };
+
+    bool openSocket();
+    void closeSocket();
+    bool queueTSPackets(const uint8_t* data, size_t size);
+    bool flushPending();
+    void flushStalePending();
+    void senderLoop();
+    void receiveControl(int64_t now);
+    void handleNak(const uint8_t* data, size_t size, int64_t now);
+    void expireSlots(int64_t now);
+    void dropStaleRetransmits();
+    void updatePacing(int64_t now, double maxRate, double minRate);
+    int sendSlots(const uint32_t* seqs, int count, bool retransmit, int64_t now);
+    int64_t nowMicros() const;
+
+    ReliableUDPSettings settings_;           ///< 发送配置
+    int socket_ = -1;                        ///< UDP套接字
+    std::chrono::steady_clock::time_point epoch_;   ///< 时间戳零点
+
+    std::mutex muxMutex_;                    ///< 保护封装器和生产者侧状态
+    TSMuxer muxer_;                          ///< TS封装器
+    Payload pending_;                        ///< 未填满的数据报
+    std::chrono::steady_clock::time_point pendingSince_;
+    SpscRing<Payload> queue_;                ///< 生产者 -> 发送线程
+
+    // 以下仅发送线程访问
+    std::vector<Slot> slots_;                ///< 发送缓冲区，按序号取模索引
+    uint32_t slotMask_ = 0;
+    uint32_t baseSeq_ = 0;                   ///< 最早未确认的序号
+    uint32_t nextSeq_ = 0;                   ///< 下一个新数据报的序号
+    std::vector<uint32_t> retransmitQueue_;  ///< 待重传序号环
+    size_t retransmitHead_ = 0;
+    size_t retransmitCount_ = 0;
+    std::vector<uint32_t> sendSeqs_;         ///< 单批发送的序号
+    int64_t srttUs_ = 0;                     ///< 平滑往返时延
+    int64_t minRttUs_ = 0;                   ///< 观察到的最小往返时延，作为无排队时的基准
+    double paceRate_ = 0.0;                  ///< 当前发送速率（字节/微秒）
+    int64_t paceWindowStart_ = 0;            ///< 本速率调整窗口的起点
+    uint64_t windowSends_ = 0;               ///< 本窗口首次发送的数据报数
+    uint64_t windowLosses_ = 0;              ///< 本窗口NAK报告需要重传的数据报数
+
+    std::thread thread_;                     ///< 发送线程
+    std::atomic<bool> running_{false};       ///< 发送线程运行标志
+
+    std::atomic<uint64_t> firstSends_{0};
+    std::atomic<uint64_t> retransmitted_{0};
+    std::atomic<uint64_t> naksReceived_{0};
+    std::atomic<uint64_t> expired_{0};
+    std::atomic<uint64_t> rttUs_{0};
+    std::atomic<uint32_t> inFlight_{0};
+    std::atomic<int64_t> pacingBitrate_{0};
+};
+
+/**
+ * @brief 可靠UDP接收配置
+ */
+struct ReliableUDPReceiverSettings {
+    std::string bind_address = "127.0.0.1";   ///< 监听地址
+    int port = 9000;                          ///< 监听端口，0表示由系统分配（start()后用getPort()查询）
+    int latency_ms = 120;                     ///< 延迟窗口，空洞超过此时间即放弃
+    int buffer_packets = 8192;                ///< 重排缓冲区容量（数据报数）
+    int nak_interval_ms = 20;                 ///< 周期性重发NAK的间隔
+    int ack_interval_ms = 10;                 ///< ACK间隔
+    double loss_rate = 0.0;                   ///< 模拟丢包率（0~1），仅丢弃数据报
+    uint32_t loss_seed = 1;                   ///< 模拟丢包随机种子
+    uint32_t session_id = 1;                  ///< 只接受该会话的数据
+};
+
+/**
+ * @brief 可靠UDP接收统计
+ */
+struct ReliableUDPReceiverStats {
+    uint64_t packets_received = 0;      ///< 收到的数据报（不含模拟丢弃）
+    uint64_t retransmits_received = 0;  ///< 收到的重传数据报
+    uint64_t duplicates = 0;            ///< 重复数据报
+    uint64_t simulated_drops = 0;       ///< 模拟丢弃的数据报
+    uint64_t lost = 0;                  ///< 超出延迟窗口未能恢复的数据报
+    uint64_t naks_sent = 0;             ///< 发送的NAK数
+    uint64_t packets_delivered = 0;     ///< 按序交付的数据报
+    uint64_t bytes_delivered = 0;       ///< 按序交付的字节数
+};
+
+/**
+ * @brief 进程内可靠UDP接收器
+ * @details 按序号重排后通过回调按序交付TS负载，回调在接收线程中执行
+ */
+class ReliableUDPReceiver {
+public:
+    using DeliverCallback = std::function<void(const uint8_t* data, size_t size)>;
+
+    /**
+     * @brief 构造函数
+     * @param[in] settings 接收配置
+     * @param[in] callback 交付回调，可为空
+     */
+    explicit ReliableUDPReceiver(const ReliableUDPReceiverSettings& settings,
+                                 DeliverCallback callback = nullptr);
+    ~ReliableUDPReceiver();
+
+    ReliableUDPReceiver(const ReliableUDPReceiver&) = delete;
+    ReliableUDPReceiver& operator=(const ReliableUDPReceiver&) = delete;
+
+    /**
+     * @brief 绑定端口并启动接收线程
+     * @return true表示启动成功
+     */
+    bool start();
+
+    /**
+     * @brief 停止接收线程
+     */
+    void stop();
+
+    /**
+     * @brief 获取接收统计
+     * @return 统计信息快照
+     */
+    ReliableUDPReceiverStats getStats() const;
+
+    /**
+     * @brief 获取实际监听的端口
+     * @return 端口号，start()之前为配置值
+     */
+    int getPort() const { return settings_.port; }
+
+private:
+    struct Slot {
+        bool present = false;
+        uint16_t size = 0;
+        int64_t arrival = 0;
+        uint8_t data[kArqPayloadSize];
+    };
+
+    void receiveLoop();
+    void handleData(const uint8_t* data, size_t size, int64_t now);
+    void deliver(int64_t now);
+    void sendAck();
+    void sendNak(const uint32_t* ranges, int count);
+    void sendPeriodicNaks();
+    int64_t nowMicros() const;
+
+    ReliableUDPReceiverSettings settings_;
+    DeliverCallback callback_;
+    int socket_ = -1;
+    std::chrono::steady_clock::time_point epoch_;
+
+    // 以下仅接收线程访问
+    std::vector<Slot> slots_;
+    uint32_t slotMask_ = 0;
+    bool started_ = false;                   ///< 是否已收到首个数据报
+    uint32_t headSeq_ = 0;                   ///< 下一个待交付的序号
+    uint32_t highestSeq_ = 0;                ///< 收到的最大序号
+    uint32_t lastTimestamp_ = 0;             ///< 最近数据报的发送时间戳（ACK回显）
+    int64_t lastArrival_ = 0;                ///< 最近数据报的到达时间
+    bool peerKnown_ = false;
+    alignas(8) uint8_t peer_[128] = {};      ///< 发送端地址（sockaddr_storage）
+    uint32_t peerLength_ = 0;
+    std::mt19937 random_;
+    std::bernoulli_distribution lossDistribution_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> retransmitsReceived_{0};
+    std::atomic<uint64_t> duplicates_{0};
+    std::atomic<uint64_t> simulatedDrops_{0};
+    std::atomic<uint64_t> lost_{0};
+    std::atomic<uint64_t> naksSent_{0};
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> bytesDelivered_{0};
+};
+
+} // namespace SimpleOBS
@@ -0,0 +1,344 @@
+/**
+ * @file TSMuxer.cpp
+ * @brief MPEG-TS封装器实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "TSMuxer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace SimpleOBS {
+
+namespace {
+
+constexpr uint16_t kPatPid = 0x0000;
+constexpr uint16_t kPmtPid = 0x1000;
+constexpr uint16_t kFirstStreamPid = 0x0100;
+constexpr uint16_t kProgramNumber = 1;
+constexpr int kPayloadSize = kTSPacketSize - 4;
+constexpr uint64_t kTimestampMask = (uint64_t(1) << 33) - 1;
+
+struct Crc32Table {
+    uint32_t entries[256];
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i << 24;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : (crc << 1);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+/**
+ * @brief MPEG-2 CRC32（PSI表校验）
+ */
+uint32_t crc32Mpeg(const uint8_t* data, size_t size) {
+    static const Crc32Table table;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = (crc << 8) ^ table.entries[((crc >> 24) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+/**
+ * @brief 微秒转换为90kHz时钟，按33位回绕
+ */
+uint64_t toClock90k(FrameTime time) {
+    int64_t ticks = time.count() * 9 / 100;
+    return static_cast<uint64_t>(ticks) & kTimestampMask;
+}
+
+void writeTimestamp(uint8_t* out, uint8_t marker, uint64_t ts) {
+    out[0] = static_cast<uint8_t>((marker << 4) | ((ts >> 29) & 0x0E) | 0x01);
+    out[1] = static_cast<uint8_t>(ts >> 22);
+    out[2] = static_cast<uint8_t>(((ts >> 14) & 0xFE) | 0x01);
+    out[3] = static_cast<uint8_t>(ts >> 7);
+    out[4] = static_cast<uint8_t>(((ts << 1) & 0xFE) | 0x01);
+}
+
+void writePcr(uint8_t* out, uint64_t base) {
+    out[0] = static_cast<uint8_t>(base >> 25);
+    out[1] = static_cast<uint8_t>(base >> 17);
+    out[2] = static_cast<uint8_t>(base >> 9);
+    out[3] = static_cast<uint8_t>(base >> 1);
+    out[4] = static_cast<uint8_t>(((base & 1) << 7) | 0x7E);
+    out[5] = 0;
+}
+
+} // anonymous namespace
+
+uint16_t TSMuxer::addStream(const TSStreamConfig& config) {
+    Stream stream;
+    stream.config = config;
+    stream.pid = static_cast<uint16_t>(kFirstStreamPid + streams_.size());
+
+    int sameKind = 0;
+    for (const auto& existing : streams_) {
+        if (existing.config.type == config.type) {
+            ++sameKind;
+        }
+    }
+    if (config.stream_type == kTSStreamPrivate) {
+        stream.streamId = 0xBD;
+    } else if (config.type == PacketType::Video) {
+        stream.streamId = static_cast<uint8_t>(0xE0 + (sameKind & 0x0F));
+    } else {
+        stream.streamId = static_cast<uint8_t>(0xC0 + (sameKind & 0x1F));
+    }
+
+    // AAC原始帧需要ADTS头，从AudioSpecificConfig中取出profile/采样率/声道
+    if (config.stream_type == kTSStreamAacAdts && config.extradata.size() >= 2) {
+        const uint8_t* asc = config.extradata.data();
+        int objectType = asc[0] >> 3;
+        int freqIndex = ((asc[0] & 0x07) << 1) | (asc[1] >> 7);
+        int channelConfig = (asc[1] >> 3) & 0x0F;
+        stream.adts[0] = 0xFF;
+        stream.adts[1] = 0xF1;
+        stream.adts[2] = static_cast<uint8_t>(((objectType - 1) & 0x03) << 6 | (freqIndex << 2) | (channelConfig >> 2));
+        stream.adts[3] = static_cast<uint8_t>((channelConfig & 0x03) << 6);
+        stream.adts[5] = 0x1F;
+        stream.adts[6] = 0xFC;
+        stream.hasAdts = true;
+    }
+
+    // 优先使用第一路视频承载PCR
+    if (pcrPid_ == 0x1FFF || (config.type == PacketType::Video && sameKind == 0 &&
+                              streams_[pcrPid_ - kFirstStreamPid].config.type != PacketType::Video)) {
+        pcrPid_ = stream.pid;
+    }
+
+    streams_.push_back(std::move(stream));
+    return streams_.back().pid;
+}
+
+void TSMuxer::reset() {
+    for (auto& stream : streams_) {
+        stream.continuity = 0;
+    }
+    patContinuity_ = 0;
+    pmtContinuity_ = 0;
+    lastTables_ = FrameTime{0};
+    tablesSent_ = false;
+    output_.clear();
+}
+
+bool TSMuxer::writePacket(const EncodedPacket& packet) {
+    Stream* stream = nullptr;
+    for (auto& candidate : streams_) {
+        if (candidate.config.type == packet.type && candidate.config.track == packet.track) {
+            stream = &candidate;
+            break;
+        }
+    }
+    if (!stream) {
+        return false;
+    }
+
+    // 音视频DTS交错到达，小幅回退属正常；回退超过1秒视为时间线重置
+    FrameTime sinceTables = packet.dts - lastTables_;
+    bool keyframe = packet.type == PacketType::Video && packet.keyframe;
+    if (!tablesSent_ || keyframe || sinceTables >= tableInterval_ || sinceTables < FrameTime{-1000000}) {
+        writeTables();
+        lastTables_ = packet.dts;
+        tablesSent_ = true;
+    }
+
+    writePes(*stream, packet);
+    return true;
+}
+
+void TSMuxer::writeTables() {
+    uint8_t section[kPayloadSize];
+
+    // PAT
+    size_t pos = 0;
+    section[pos++] = 0x00;                       // table_id
+    section[pos++] = 0xB0;                       // section_syntax_indicator + length高位
+    section[pos++] = 13;                         // section_length
+    section[pos++] = 0x00;
+    section[pos++] = 0x01;                       // transport_stream_id
+    section[pos++] = 0xC1;                       // version 0, current_next
+    section[pos++] = 0x00;
+    section[pos++] = 0x00;
+    section[pos++] = static_cast<uint8_t>(kProgramNumber >> 8);
+    section[pos++] = static_cast<uint8_t>(kProgramNumber);
+    section[pos++] = static_cast<uint8_t>(0xE0 | (kPmtPid >> 8));
+    section[pos++] = static_cast<uint8_t>(kPmtPid);
+    uint32_t crc = crc32Mpeg(section, pos);
+    section[pos++] = static_cast<uint8_t>(crc >> 24);
+    section[pos++] = static_cast<uint8_t>(crc >> 16);
+    section[pos++] = static_cast<uint8_t>(crc >> 8);
+    section[pos++] = static_cast<uint8_t>(crc);
+    writeSection(kPatPid, patContinuity_, section, pos);
+
+    // PMT
+    pos = 0;
+    section[pos++] = 0x02;
+    pos += 2;                                    // section_length稍后填写
+    section[pos++] = static_cast<uint8_t>(kProgramNumber >> 8);
+    section[pos++] = static_cast<uint8_t>(kProgramNumber);
+    section[pos++] = 0xC1;
+    section[pos++] = 0x00;
+    section[pos++] = 0x00;
+    section[pos++] = static_cast<uint8_t>(0xE0 | (pcrPid_ >> 8));
+    section[pos++] = static_cast<uint8_t>(pcrPid_);
+    section[pos++] = 0xF0;
+    section[pos++] = 0x00;                       // program_info_length
+    for (const auto& stream : streams_) {
+        if (pos + 5 + 4 > sizeof(section) - 1) {
+            LOG_WARN("TS muxer: too many streams for a single PMT section");
+            break;
+        }
+        section[pos++] = stream.config.stream_type;
+        section[pos++] = static_cast<uint8_t>(0xE0 | (stream.pid >> 8));
+        section[pos++] = static_cast<uint8_t>(stream.pid);
+        section[pos++] = 0xF0;
+        section[pos++] = 0x00;                   // ES_info_length
+    }
+    size_t sectionLength = pos - 3 + 4;
+    section[1] = static_cast<uint8_t>(0xB0 | (sectionLength >> 8));
+    section[2] = static_cast<uint8_t>(sectionLength);
+    crc = crc32Mpeg(section, pos);
+    section[pos++] = static_cast<uint8_t>(crc >> 24);
+    section[pos++] = static_cast<uint8_t>(crc >> 16);
+    section[pos++] = static_cast<uint8_t>(crc >> 8);
+    section[pos++] = static_cast<uint8_t>(crc);
+    writeSection(kPmtPid, pmtContinuity_, section, pos);
+}
+
+void TSMuxer::writeSection(uint16_t pid, uint8_t& continuity, const uint8_t* section, size_t size) {
+    size_t offset = output_.size();
+    output_.resize(offset + kTSPacketSize);
+    uint8_t* ts = output_.data() + offset;
+    ts[0] = 0x47;
+    ts[1] = static_cast<uint8_t>(0x40 | (pid >> 8));
+    ts[2] = static_cast<uint8_t>(pid);
+    ts[3] = static_cast<uint8_t>(0x10 | continuity);
+    continuity = (continuity + 1) & 0x0F;
+    ts[4] = 0x00;                                // pointer_field
+    std::memcpy(ts + 5, section, size);
+    std::memset(ts + 5 + size, 0xFF, kTSPacketSize - 5 - size);
+}
+
+void TSMuxer::writePes(Stream& stream, const EncodedPacket& packet) {
+    // 所有时间戳整体后移muxDelay_，保证PTS/DTS始终领先PCR
+    uint64_t pts = toClock90k(packet.pts + muxDelay_);
+    uint64_t dts = toClock90k(packet.dts + muxDelay_);
+    bool writeDts = packet.type == PacketType::Video && pts != dts;
+
+    size_t adtsSize = 0;
+    if (stream.hasAdts && !(packet.data.size() >= 2 && packet.data[0] == 0xFF && (packet.data[1] & 0xF0) == 0xF0)) {
+        adtsSize = 7;
+    }
+
+    size_t headerDataLength = writeDts ? 10 : 5;
+    size_t payloadSize = adtsSize + packet.data.size();
+    pes_.resize(9 + headerDataLength + adtsSize);
+    uint8_t* header = pes_.data();
+    header[0] = 0x00;
+    header[1] = 0x00;
+    header[2] = 0x01;
+    header[3] = stream.streamId;
+    size_t pesLength = 3 + headerDataLength + payloadSize;
+    if (packet.type == PacketType::Video || pesLength > 0xFFFF) {
+        pesLength = 0;                           // 视频PES允许不定长
+    }
+    header[4] = static_cast<uint8_t>(pesLength >> 8);
+    header[5] = static_cast<uint8_t>(pesLength);
+    header[6] = 0x80;
+    header[7] = writeDts ? 0xC0 : 0x80;
+    header[8] = static_cast<uint8_t>(headerDataLength);
+    writeTimestamp(header + 9, writeDts ? 0x03 : 0x02, pts);
+    if (writeDts) {
+        writeTimestamp(header + 14, 0x01, dts);
+    }
+    if (adtsSize) {
+        uint8_t* adts = header + 9 + headerDataLength;
+        std::memcpy(adts, stream.adts, 7);
+        size_t frameLength = 7 + packet.data.size();
+        adts[3] = static_cast<uint8_t>(adts[3] | ((frameLength >> 11) & 0x03));
+        adts[4] = static_cast<uint8_t>(frameLength >> 3);
+        adts[5] = static_cast<uint8_t>(((frameLength & 0x07) << 5) | 0x1F);
+    }
+
+    // PES头和数据依次写入TS包，避免拼接整个PES
+    const uint8_t* parts[2] = {pes_.data(), packet.data.data()};
+    size_t partSizes[2] = {pes_.size(), packet.data.size()};
+    size_t part = 0;
+    size_t partOffset = 0;
+    size_t remaining = pes_.size() + packet.data.size();
+    bool first = true;
+
+    size_t packets = (remaining + kPayloadSize - 1) / kPayloadSize + 1;
+    output_.reserve(output_.size() + packets * kTSPacketSize);
+
+    while (remaining > 0) {
+        size_t offset = output_.size();
+        output_.resize(offset + kTSPacketSize);
+        uint8_t* ts = output_.data() + offset;
+
+        bool pcr = first && stream.pid == pcrPid_;
+        bool randomAccess = first && packet.keyframe;
+        bool hasAdaptation = pcr || randomAccess;
+        size_t adaptationLength = hasAdaptation ? 1 + (pcr ? 6 : 0) : 0;
+        size_t available = kPayloadSize - (hasAdaptation ? 1 + adaptationLength : 0);
+        if (remaining < available) {
+            if (!hasAdaptation) {
+                hasAdaptation = true;
+                adaptationLength = kPayloadSize - 1 - remaining;
+            } else {
+                adaptationLength += available - remaining;
+            }
+            available = remaining;
+        }
+
+        ts[0] = 0x47;
+        ts[1] = static_cast<uint8_t>((first ? 0x40 : 0x00) | (stream.pid >> 8));
+        ts[2] = static_cast<uint8_t>(stream.pid);
+        ts[3] = static_cast<uint8_t>((hasAdaptation ? 0x30 : 0x10) | stream.continuity);
+        stream.continuity = (stream.continuity + 1) & 0x0F;
+
+        uint8_t* payload = ts + 4;
+        if (hasAdaptation) {
+            ts[4] = static_cast<uint8_t>(adaptationLength);
+            if (adaptationLength > 0) {
+                uint8_t flags = 0;
+                size_t used = 1;
+                if (randomAccess) {
+                    flags |= 0x40;
+                }
+                if (pcr) {
+                    flags |= 0x10;
+                    writePcr(ts + 6, toClock90k(packet.dts));
+                    used += 6;
+                }
+                ts[5] = flags;
+                std::memset(ts + 5 + used, 0xFF, adaptationLength - used);
+            }
+            payload = ts + 5 + adaptationLength;
+        }
+
+        size_t written = 0;
+        while (written < available) {
+            size_t chunk = std::min(available - written, partSizes[part] - partOffset);
+            std::memcpy(payload + written, parts[part] + partOffset, chunk);
+            written += chunk;
+            partOffset += chunk;
+            if (partOffset == partSizes[part]) {
+                ++part;
+                partOffset = 0;
+            }
+        }
+        remaining -= available;
+        first = false;
+    }
+}
+
+} // namespace SimpleOBS
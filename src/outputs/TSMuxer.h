@@ -0,0 +1,120 @@
+/**
+ * @file TSMuxer.h
+ * @brief MPEG-TS封装器
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了把编码数据包封装为188字节TS包的MPEG-TS封装器，
+ * 支持单节目、多路基本流、周期性PAT/PMT以及PCR。
+ *
+ * @note
+ * - 视频数据应为Annex-B格式；AAC原始帧会根据AudioSpecificConfig自动加ADTS头
+ * - 输出写入内部缓冲区，调用方取走后调用clearOutput()，缓冲区容量会被复用
+ */
+
+#pragma once
+
+#include "SimpleOBS.h"
+#include <cstdint>
+#include <vector>
+
+namespace SimpleOBS {
+
+constexpr int kTSPacketSize = 188;
+
+/**
+ * @brief 常用的TS流类型
+ */
+enum TSStreamType : uint8_t {
+    kTSStreamPrivate = 0x06,     ///< 私有PES数据（如FLAC）
+    kTSStreamAacAdts = 0x0F,     ///< AAC（ADTS）
+    kTSStreamH264 = 0x1B,        ///< H.264
+    kTSStreamHevc = 0x24         ///< H.265
+};
+
+/**
+ * @brief TS基本流配置
+ */
+struct TSStreamConfig {
+    PacketType type = PacketType::Video;   ///< 匹配的数据包类型
+    int track = 0;                         ///< 匹配的轨道索引
+    uint8_t stream_type = kTSStreamH264;   ///< PMT中的流类型
+    std::vector<uint8_t> extradata;        ///< 编解码器配置（AAC为AudioSpecificConfig）
+};
+
+/**
+ * @brief MPEG-TS封装器
+ */
+class TSMuxer {
+public:
+    /**
+     * @brief 添加基本流，必须在第一次写入前调用
+     * @param[in] config 流配置
+     * @return 分配的PID
+     */
+    uint16_t addStream(const TSStreamConfig& config);
+
+    /**
+     * @brief 设置PSI表（PAT/PMT）重复间隔
+     * @param[in] interval 间隔
+     */
+    void setTableInterval(FrameTime interval) { tableInterval_ = interval; }
+
+    /**
+     * @brief 设置PTS/DTS相对PCR的偏移（解码缓冲延迟）
+     * @param[in] delay 偏移量
+     */
+    void setMuxDelay(FrameTime delay) { muxDelay_ = delay; }
+
+    /**
+     * @brief 封装一个数据包
+     * @param[in] packet 编码数据包
+     * @return true表示封装成功，false表示没有匹配的流
+     */
+    bool writePacket(const EncodedPacket& packet);
+
+    /**
+     * @brief 获取已生成的TS数据
+     * @return 连续的188字节TS包
+     */
+    const std::vector<uint8_t>& output() const { return output_; }
+
+    /**
+     * @brief 清空输出缓冲区
+     */
+    void clearOutput() { output_.clear(); }
+
+    /**
+     * @brief 重置封装状态（连续性计数器、表发送时间等）
+     */
+    void reset();
+
+private:
+    struct Stream {
+        TSStreamConfig config;
+        uint16_t pid = 0;
+        uint8_t streamId = 0;
+        uint8_t continuity = 0;
+        uint8_t adts[7] = {};   ///< ADTS头模板（frame_length字段每包填写）
+        bool hasAdts = false;
+    };
+
+    void writeTables();
+    void writeSection(uint16_t pid, uint8_t& continuity, const uint8_t* section, size_t size);
+    void writePes(Stream& stream, const EncodedPacket& packet);
+
+    std::vector<Stream> streams_;
+    std::vector<uint8_t> output_;
+    std::vector<uint8_t> pes_;               ///< PES组装缓冲区，容量复用
+    uint16_t pcrPid_ = 0x1FFF;
+    uint8_t patContinuity_ = 0;
+    uint8_t pmtContinuity_ = 0;
+    FrameTime tableInterval_{100000};
+    FrameTime muxDelay_{500000};
+    FrameTime lastTables_{0};
+    bool tablesSent_ = false;
+};
+
+} // namespace SimpleOBS
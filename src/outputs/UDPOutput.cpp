@@ -0,0 +1,384 @@
+/**
+ * @file UDPOutput.cpp
+ * @brief UDP MPEG-TS输出实现
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件实现了UDP输出。生产者（编码线程）只负责封装和入队，
+ * 发送线程用令牌桶平滑码率，避免关键帧突发造成接收端或交换机丢包。
+ */
+
+#include "UDPOutput.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace SimpleOBS {
+
+namespace {
+
+std::vector<TSStreamConfig> defaultStreams() {
+    TSStreamConfig video;
+    video.type = PacketType::Video;
+    video.stream_type = kTSStreamH264;
+
+    TSStreamConfig audio;
+    audio.type = PacketType::Audio;
+    audio.stream_type = kTSStreamAacAdts;
+    return {video, audio};
+}
+
+} // anonymous namespace
+
+UDPOutput::UDPOutput(const std::string& name, const UDPOutputSettings& settings)
+    : BaseOutput(name), settings_(settings) {
+    settings_.batch_size = std::max(1, settings_.batch_size);
+    settings_.queue_datagrams = std::max(settings_.batch_size, settings_.queue_datagrams);
+    if (settings_.streams.empty()) {
+        settings_.streams = defaultStreams();
+    }
+}
+
+UDPOutput::~UDPOutput() {
+    stop();
+}
+
+bool UDPOutput::start() {
+    if (active_.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+#ifdef _WIN32
+    LOG_ERROR("UDP output {} is not supported on this platform", name_);
+    return false;
+#else
+    if (!openSocket()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(muxMutex_);
+        muxer_ = TSMuxer();
+        for (const auto& stream : settings_.streams) {
+            muxer_.addStream(stream);
+        }
+        pending_.size = 0;
+    }
+    queue_.reset(static_cast<size_t>(settings_.queue_datagrams));
+    batch_.assign(static_cast<size_t>(settings_.batch_size), Datagram{});
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&UDPOutput::senderLoop, this);
+    active_.store(true, std::memory_order_release);
+
+    LOG_INFO("UDP output {} started: {}:{}, ttl={}, bitrate={}, batch={}",
+             name_, settings_.host, settings_.port, settings_.ttl, settings_.bitrate, settings_.batch_size);
+    return true;
+#endif
+}
+
+void UDPOutput::stop() {
+    if (!active_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(muxMutex_);
+        flushPending();
+    }
+
+    // 发送线程发完队列中剩余的数据报后退出
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closeSocket();
+
+    OutputStats stats = getStats();
+    LOG_INFO("UDP output {} stopped: {} datagrams, {} bytes, {} dropped, {} errors",
+             name_, stats.packets_sent, stats.bytes_sent, stats.packets_dropped, stats.errors);
+}
+
+bool UDPOutput::sendPacket(const EncodedPacket& packet) {
+    if (!active_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(muxMutex_);
+    if (!muxer_.writePacket(packet)) {
+        return false;
+    }
+
+    const auto& ts = muxer_.output();
+    bool queued = queueTSPackets(ts.data(), ts.size());
+    muxer_.clearOutput();
+
+    if (pending_.size > 0 &&
+        std::chrono::steady_clock::now() - pendingSince_ >= std::chrono::milliseconds(settings_.flush_interval_ms)) {
+        queued = flushPending() && queued;
+    }
+    return queued;
+}
+
+bool UDPOutput::queueTSPackets(const uint8_t* data, size_t size) {
+    bool ok = true;
+    while (size > 0) {
+        if (pending_.size == 0) {
+            pendingSince_ = std::chrono::steady_clock::now();
+        }
+        size_t chunk = std::min(size, static_cast<size_t>(kUDPDatagramSize - pending_.size));
+        std::memcpy(pending_.data + pending_.size, data, chunk);
+        pending_.size = static_cast<uint16_t>(pending_.size + chunk);
+        data += chunk;
+        size -= chunk;
+        if (pending_.size == kUDPDatagramSize) {
+            ok = flushPending() && ok;
+        }
+    }
+    return ok;
+}
+
+bool UDPOutput::flushPending() {
+    if (pending_.size == 0) {
+        return true;
+    }
+    bool ok = queue_.tryPush(pending_);
+    if (!ok) {
+        countDropped();
+    }
+    pending_.size = 0;
+    return ok;
+}
+
+/**
+ * @brief 发送线程空闲时补发超时的未满数据报
+ *
+ * @details 编码器停止送包时sendPacket()不再被调用，由发送线程负责在flush_interval_ms
+ * 后发出最后的TS包。只尝试加锁，封装中的生产者会自行检查超时，发送线程不等待。
+ * 生产者侧的入队操作都在muxMutex_内进行，因此仍满足单生产者约束。
+ */
+void UDPOutput::flushStalePending() {
+    std::unique_lock<std::mutex> lock(muxMutex_, std::try_to_lock);
+    if (!lock.owns_lock() || pending_.size == 0 ||
+        std::chrono::steady_clock::now() - pendingSince_ < std::chrono::milliseconds(settings_.flush_interval_ms)) {
+        return;
+    }
+    flushPending();
+}
+
+#ifndef _WIN32
+
+bool UDPOutput::openSocket() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+
+    addrinfo* result = nullptr;
+    std::string port = std::to_string(settings_.port);
+    int rc = getaddrinfo(settings_.host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0 || !result) {
+        LOG_ERROR("UDP output {} cannot resolve {}: {}", name_, settings_.host, gai_strerror(rc));
+        return false;
+    }
+
+    int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    if (fd < 0) {
+        LOG_ERROR("UDP output {} socket() failed: {}", name_, std::strerror(errno));
+        freeaddrinfo(result);
+        return false;
+    }
+
+    bool multicast = false;
+    if (result->ai_family == AF_INET) {
+        auto* addr = reinterpret_cast<sockaddr_in*>(result->ai_addr);
+        multicast = IN_MULTICAST(ntohl(addr->sin_addr.s_addr));
+    } else if (result->ai_family == AF_INET6) {
+        auto* addr = reinterpret_cast<sockaddr_in6*>(result->ai_addr);
+        multicast = IN6_IS_ADDR_MULTICAST(&addr->sin6_addr);
+    }
+
+    int ttl = settings_.ttl;
+    int loop = settings_.multicast_loop ? 1 : 0;
+    if (result->ai_family == AF_INET) {
+        if (multicast) {
+            setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+            setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+            if (!settings_.multicast_interface.empty()) {
+                in_addr iface{};
+                if (inet_pton(AF_INET, settings_.multicast_interface.c_str(), &iface) == 1) {
+                    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+                } else {
+                    LOG_WARN("UDP output {} ignores invalid multicast interface: {}",
+                             name_, settings_.multicast_interface);
+                }
+            }
+        } else {
+            setsockopt(fd, IPPROTO_IP, IP_TTL, &ttl, sizeof(ttl));
+        }
+    } else if (result->ai_family == AF_INET6) {
+        if (multicast) {
+            setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &ttl, sizeof(ttl));
+            setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &loop, sizeof(loop));
+        } else {
+            setsockopt(fd, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &ttl, sizeof(ttl));
+        }
+    }
+
+    if (settings_.send_buffer_bytes > 0) {
+        int bytes = settings_.send_buffer_bytes;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bytes, sizeof(bytes));
+    }
+
+    // connect()后发送时无需再指定目标地址
+    if (connect(fd, result->ai_addr, result->ai_addrlen) != 0) {
+        LOG_ERROR("UDP output {} connect() failed: {}", name_, std::strerror(errno));
+        ::close(fd);
+        freeaddrinfo(result);
+        return false;
+    }
+
+    freeaddrinfo(result);
+    socket_ = fd;
+    return true;
+}
+
+void UDPOutput::closeSocket() {
+    if (socket_ >= 0) {
+        ::close(socket_);
+        socket_ = -1;
+    }
+}
+
+int UDPOutput::sendBatch(int count) {
+#ifdef __linux__
+    mmsghdr messages[64];
+    iovec vectors[64];
+    int sent = 0;
+    while (sent < count) {
+        int n = std::min(count - sent, 64);
+        for (int i = 0; i < n; ++i) {
+            vectors[i].iov_base = batch_[sent + i].data;
+            vectors[i].iov_len = batch_[sent + i].size;
+            std::memset(&messages[i], 0, sizeof(mmsghdr));
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int rc = sendmmsg(socket_, messages, static_cast<unsigned int>(n), 0);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return sent > 0 ? sent : -1;
+        }
+        sent += rc;
+    }
+    return sent;
+#else
+    int sent = 0;
+    for (int i = 0; i < count; ++i) {
+        ssize_t rc = ::send(socket_, batch_[i].data, batch_[i].size, 0);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                --i;
+                continue;
+            }
+            return sent > 0 ? sent : -1;
+        }
+        ++sent;
+    }
+    return sent;
+#endif
+}
+
+#else
+
+bool UDPOutput::openSocket() {
+    return false;
+}
+
+void UDPOutput::closeSocket() {}
+
+int UDPOutput::sendBatch(int count) {
+    (void)count;
+    return -1;
+}
+
+#endif
+
+void UDPOutput::senderLoop() {
+    enterWorkerThread();
+    using Clock = std::chrono::steady_clock;
+
+    // 令牌桶：以字节为单位，按目标码率持续补充
+    const double bytesPerSecond = static_cast<double>(settings_.bitrate) / 8.0;
+    const bool paced = bytesPerSecond > 0.0;
+    double burst = settings_.burst_bytes > 0 ? settings_.burst_bytes : bytesPerSecond * 0.01;
+    burst = std::max(burst, static_cast<double>(kUDPDatagramSize));
+    double tokens = burst;
+    auto lastRefill = Clock::now();
+
+    const int maxBatch = static_cast<int>(batch_.size());
+    while (true) {
+        workerTick(queue_.size(), queue_.capacity());
+        int allowed = maxBatch;
+        if (paced) {
+            auto now = Clock::now();
+            tokens = std::min(burst, tokens + std::chrono::duration<double>(now - lastRefill).count() * bytesPerSecond);
+            lastRefill = now;
+            if (tokens < kUDPDatagramSize) {
+                double wait = (kUDPDatagramSize - tokens) / bytesPerSecond;
+                std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+                continue;
+            }
+            allowed = std::min(maxBatch, static_cast<int>(tokens / kUDPDatagramSize));
+        }
+
+        int count = static_cast<int>(queue_.pop(batch_.data(), static_cast<size_t>(allowed)));
+        if (count == 0) {
+            if (!running_.load(std::memory_order_acquire)) {
+                break;
+            }
+            flushStalePending();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        uint64_t bytes = 0;
+        for (int i = 0; i < count; ++i) {
+            bytes += batch_[i].size;
+        }
+        tokens -= static_cast<double>(bytes);
+
+        int sent = sendBatch(count);
+        if (sent < 0) {
+            LOG_ERROR("UDP output {} send failed: {}", name_, std::strerror(errno));
+            countError();
+            countDropped(static_cast<uint64_t>(count));
+            continue;
+        }
+        uint64_t sentBytes = 0;
+        for (int i = 0; i < sent; ++i) {
+            sentBytes += batch_[i].size;
+        }
+        countSent(static_cast<uint64_t>(sent), sentBytes);
+        if (sent < count) {
+            countError();
+            countDropped(static_cast<uint64_t>(count - sent));
+        }
+    }
+    leaveWorkerThread();
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,125 @@
+/**
+ * @file UDPOutput.h
+ * @brief UDP MPEG-TS输出
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 本文件定义了UDP输出：编码数据包经TSMuxer封装后，每7个TS包（1316字节）
+ * 组成一个数据报，放入无锁队列，由发送线程按令牌桶限速批量发送。
+ * 支持单播和组播（可设置TTL和回环）。
+ *
+ * @note
+ * - Linux上使用sendmmsg()批量发送，减少系统调用次数
+ * - sendPacket()不做网络I/O，队列满时丢弃数据报并计数
+ * - 不满一个数据报的TS包最多等待flush_interval_ms，由sendPacket()或空闲的发送线程补发
+ * - 仅支持POSIX平台
+ */
+
+#pragma once
+
+#include "BaseOutput.h"
+#include "SpscRing.h"
+#include "TSMuxer.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SimpleOBS {
+
+constexpr int kTSPacketsPerDatagram = 7;
+constexpr int kUDPDatagramSize = kTSPacketSize * kTSPacketsPerDatagram;
+
+/**
+ * @brief UDP输出配置
+ */
+struct UDPOutputSettings {
+    std::string host = "127.0.0.1";        ///< 目标地址（单播或组播）
+    int port = 1234;                       ///< 目标端口
+    int ttl = 1;                           ///< TTL（组播时为组播TTL）
+    bool multicast_loop = false;           ///< 组播是否回环到本机
+    std::string multicast_interface;       ///< 组播出口地址（IPv4），为空使用默认
+    int64_t bitrate = 0;                   ///< 发送限速（bit/s），0表示不限速
+    int burst_bytes = 0;                   ///< 令牌桶容量，0表示按10ms数据量计算
+    int batch_size = 16;                   ///< 每次系统调用最多发送的数据报数
+    int queue_datagrams = 4096;            ///< 发送队列容量（数据报数）
+    int flush_interval_ms = 20;            ///< 不满一个数据报的TS包最长等待时间
+    int send_buffer_bytes = 0;             ///< SO_SNDBUF，0表示系统默认
+    std::vector<TSStreamConfig> streams;   ///< TS流配置，为空时使用H.264 + AAC
+};
+
+/**
+ * @brief UDP MPEG-TS输出
+ */
+class UDPOutput : public BaseOutput {
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] name 输出名称
+     * @param[in] settings 输出配置
+     */
+    explicit UDPOutput(const std::string& name,
+                       const UDPOutputSettings& settings = UDPOutputSettings{});
+    ~UDPOutput() override;
+
+    std::string getId() const override { return "udp"; }
+
+    /**
+     * @brief 打开套接字并启动发送线程
+     * @return true表示启动成功
+     */
+    bool start() override;
+
+    /**
+     * @brief 发送剩余数据并停止发送线程
+     */
+    void stop() override;
+
+    /**
+     * @brief 封装并排队一个数据包
+     * @param[in] packet 编码数据包
+     * @return true表示已排队，false表示未启动、无匹配流或队列已满
+     */
+    bool sendPacket(const EncodedPacket& packet) override;
+
+    /**
+     * @brief 获取输出配置
+     * @return 当前配置
+     */
+    const UDPOutputSettings& getSettings() const { return settings_; }
+
+private:
+    /**
+     * @brief 固定大小的数据报，入队出队不分配内存
+     */
+    struct Datagram {
+        uint16_t size = 0;
+        uint8_t data[kUDPDatagramSize];
+    };
+
+    bool openSocket();
+    void closeSocket();
+    bool queueTSPackets(const uint8_t* data, size_t size);
+    bool flushPending();
+    void flushStalePending();
+    void senderLoop();
+    int sendBatch(int count);
+
+    UDPOutputSettings settings_;             ///< 输出配置
+    int socket_ = -1;                        ///< UDP套接字
+
+    std::mutex muxMutex_;                    ///< 保护封装器和生产者侧状态
+    TSMuxer muxer_;                          ///< TS封装器
+    Datagram pending_;                       ///< 未填满的数据报
+    std::chrono::steady_clock::time_point pendingSince_;   ///< pending_中首个TS包的时间
+
+    SpscRing<Datagram> queue_;               ///< 待发送的数据报
+    std::vector<Datagram> batch_;            ///< 发送线程批量缓冲区
+    std::thread thread_;                     ///< 发送线程
+    std::atomic<bool> running_{false};       ///< 发送线程运行标志
+};
+
+} // namespace SimpleOBS
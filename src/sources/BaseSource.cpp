@@ -53,20 +53,18 @@ public:
     bool getAudioFrame(AudioFrame& frame) override {
         if (!active_) return false;
 
-        // Basic implementation: generate silence
-        static float silence_data[48000]; // 1 second of silence data
-        static bool initialized = false;
+        // Basic implementation: generate silence, one engine audio block per call
+        static float silence_data[kMaxAudioBlockSize] = {};
 
-        if (!initialized) {
-            for (int i = 0; i < 48000; ++i) {
-                silence_data[i] = 0.0f;
-            }
-            initialized = true;
-        }
+        // The scene fills in the engine block size and sample rate before pulling
+        const AudioSettings defaults;
+        const int samples = frame.samples > 0 && frame.samples <= kMaxAudioBlockSize
+                                ? frame.samples : defaults.block_size;
+        const int sample_rate = frame.sample_rate > 0 ? frame.sample_rate : defaults.sample_rate;
 
         frame.data[0] = silence_data;
-        frame.samples = 480;
-        frame.sample_rate = 48000;
+        frame.samples = samples;
+        frame.sample_rate = sample_rate;
         frame.channels = 1;
         frame.timestamp = std::chrono::duration_cast<FrameTime>(
             std::chrono::high_resolution_clock::now().time_since_epoch()
@@ -94,4 +92,9 @@ private:
     bool active_;
 };
 
+// 测试图源工厂，由SourceModules.cpp注册
+SourcePtr createBaseSource(const std::string& name) {
+    return std::make_shared<BaseSource>(name);
+}
+
 } // namespace SimpleOBS
@@ -0,0 +1,30 @@
+/**
+ * @file SourceModules.cpp
+ * @brief 内置源模块登记
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ */
+
+#include "ModuleRegistry.h"
+
+namespace SimpleOBS {
+
+SourcePtr createBaseSource(const std::string& name);
+
+/**
+ * @brief 登记内置源模块
+ * @param[in] registry 模块注册表
+ */
+void registerSourceModules(ModuleRegistry& registry) {
+    ModuleDescriptor test;
+    test.name = "sources.test";
+    test.sources = {"base_source"};
+    test.load = [](ModuleRegistry& r) {
+        r.registerSource("base_source", createBaseSource);
+        return true;
+    };
+    registry.addModule(std::move(test));
+}
+
+} // namespace SimpleOBS
@@ -0,0 +1,46 @@
+/**
+ * @file TestCheck.h
+ * @brief 测试共用的检查宏
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 每个测试是独立的可执行文件：CHECK失败时打印位置并计数，main()结束时用testResult()返回退出码。
+ */
+
+#pragma once
+
+#include <cstdio>
+
+namespace SimpleOBS {
+namespace Test {
+
+/// 失败的检查数
+inline int failures = 0;
+
+/**
+ * @brief 打印测试结果并返回进程退出码
+ * @param[in] name 测试名称
+ * @return 有检查失败时返回1
+ */
+inline int testResult(const char* name) {
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("%s tests passed\n", name);
+    return 0;
+}
+
+} // namespace Test
+} // namespace SimpleOBS
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__,     \
+                         __LINE__, #cond);                                  \
+            ++SimpleOBS::Test::failures;                                    \
+        }                                                                   \
+    } while (0)
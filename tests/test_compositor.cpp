@@ -0,0 +1,303 @@
+/**
+ * @file test_compositor.cpp
+ * @brief 合成内核的测试
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 验证：
+ * - compositeLayer（运行时选择的AVX2内核）与compositeLayerScalar逐字节一致，
+ *   覆盖两种混合空间、全部混合模式、多种不透明度，以及不是8的倍数的宽度和左右裁剪
+ * - 层的alpha含连续的全透明、全不透明块和半透明像素，覆盖跳过和直接复制的快速路径
+ * - YUV画布上fadeLayer按out = (src * w + dst * (256 - w)) >> 8逐采样插值，
+ *   不透明度0时画布不变，255时与blitLayer相同，层外的采样不变
+ */
+
+#include "Compositor.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace SimpleOBS;
+
+namespace {
+
+/**
+ * @brief 测试用的帧及其内存
+ */
+struct TestFrame {
+    std::vector<uint8_t> bytes;
+    VideoFrame frame{};
+};
+
+/**
+ * @brief 按格式分配帧并填充随机采样，10位格式只填有效位
+ */
+void makeFrame(TestFrame& image, int format, int width, int height, std::mt19937& rng) {
+    size_t offsets[4];
+    image.frame = VideoFrame{};
+    const size_t size = videoFrameLayout(format, width, height, image.frame.linesize, offsets);
+    image.bytes.assign(size, 0);
+    image.frame.width = width;
+    image.frame.height = height;
+    image.frame.format = format;
+    for (int i = 0; i < 4; ++i) {
+        image.frame.data[i] = image.frame.linesize[i] > 0 ? image.bytes.data() + offsets[i] : nullptr;
+    }
+
+    if (format == kVideoFormatP010 || format == kVideoFormatI010) {
+        const int shift = format == kVideoFormatP010 ? 6 : 0;
+        for (size_t i = 0; i + 1 < size; i += 2) {
+            const uint16_t value = static_cast<uint16_t>((rng() & 0x3FF) << shift);
+            std::memcpy(&image.bytes[i], &value, 2);
+        }
+    } else {
+        for (uint8_t& byte : image.bytes) {
+            byte = static_cast<uint8_t>(rng());
+        }
+    }
+}
+
+/**
+ * @brief 以8像素为一组改写RGBA层的alpha：全透明、全不透明、半透明随机或0/255混杂
+ */
+void shapeAlpha(VideoFrame& layer, std::mt19937& rng) {
+    for (int row = 0; row < layer.height; ++row) {
+        uint8_t* pixels = layer.data[0] + static_cast<size_t>(row) * layer.linesize[0];
+        for (int block = 0; block < layer.width; block += 8) {
+            const unsigned kind = rng() % 4;
+            for (int col = block; col < std::min(block + 8, layer.width); ++col) {
+                uint8_t& alpha = pixels[col * 4 + 3];
+                switch (kind) {
+                case 0: alpha = 0; break;
+                case 1: alpha = 255; break;
+                case 2: alpha = static_cast<uint8_t>(rng()); break;
+                default: alpha = (rng() & 1) ? 255 : 0; break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief 复制帧内存，平面指针指向副本
+ */
+void cloneFrame(TestFrame& copy, const TestFrame& image) {
+    copy.bytes = image.bytes;
+    copy.frame = image.frame;
+    for (int i = 0; i < 4; ++i) {
+        if (image.frame.data[i]) {
+            copy.frame.data[i] = copy.bytes.data() + (image.frame.data[i] - image.bytes.data());
+        }
+    }
+}
+
+bool sameFrame(const TestFrame& a, const TestFrame& b) {
+    return a.bytes == b.bytes;
+}
+
+void testOverKernels() {
+    std::mt19937 rng(20250704);
+    const BlendSpace spaces[] = {BlendSpace::Gamma, BlendSpace::Linear};
+    const int opacities[] = {0, 1, 77, 128, 254, 255};
+    const int widths[] = {1, 3, 7, 8, 9, 15, 16, 17, 31, 33, 64, 67};
+    const int offsets[] = {0, 5, -3, 40};
+
+    constexpr int kCanvasWidth = 72;
+    constexpr int kCanvasHeight = 4;
+    int mismatches = 0;
+    for (BlendSpace space : spaces) {
+        for (int m = 0; m < kBlendModeCount; ++m) {
+            const BlendMode mode = static_cast<BlendMode>(m);
+            for (int opacity : opacities) {
+                for (int width : widths) {
+                    for (int x : offsets) {
+                        TestFrame layer;
+                        makeFrame(layer, kVideoFormatRGBA, width, 3, rng);
+                        shapeAlpha(layer.frame, rng);
+                        TestFrame simd;
+                        makeFrame(simd, kVideoFormatRGBA, kCanvasWidth, kCanvasHeight, rng);
+                        TestFrame scalar;
+                        cloneFrame(scalar, simd);
+
+                        const bool ok = compositeLayer(simd.frame, layer.frame, x, 1, space, mode, opacity);
+                        const bool scalarOk =
+                            compositeLayerScalar(scalar.frame, layer.frame, x, 1, space, mode, opacity);
+                        if (!ok || !scalarOk || !sameFrame(simd, scalar)) {
+                            std::fprintf(stderr, "%s %s opacity %d width %d x %d differs\n",
+                                         blendSpaceName(space), blendModeName(mode), opacity, width, x);
+                            ++mismatches;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+void testTransparentAndClipped() {
+    std::mt19937 rng(7);
+    TestFrame layer;
+    makeFrame(layer, kVideoFormatRGBA, 13, 5, rng);
+    TestFrame canvas;
+    makeFrame(canvas, kVideoFormatRGBA, 16, 8, rng);
+    TestFrame original;
+    cloneFrame(original, canvas);
+
+    // 不透明度0和完全位于画布外的层都不改变画布
+    CHECK(compositeLayer(canvas.frame, layer.frame, 2, 2, BlendSpace::Linear, BlendMode::Overlay, 0));
+    CHECK(compositeLayer(canvas.frame, layer.frame, 16, 0, BlendSpace::Gamma, BlendMode::Normal, 255));
+    CHECK(compositeLayer(canvas.frame, layer.frame, -13, 0, BlendSpace::Gamma, BlendMode::Normal, 255));
+    CHECK(compositeLayer(canvas.frame, layer.frame, 0, -5, BlendSpace::Gamma, BlendMode::Normal, 255));
+    CHECK(sameFrame(canvas, original));
+
+    // 只有RGBA画布可以按alpha叠加
+    TestFrame yuv;
+    makeFrame(yuv, kVideoFormatNV12, 16, 8, rng);
+    CHECK(!compositeLayer(yuv.frame, layer.frame, 0, 0, BlendSpace::Gamma, BlendMode::Normal, 255));
+}
+
+/**
+ * @brief 平面的每像素字节数、采样字节数和色度下采样位移，与Compositor的约定一致
+ */
+bool planeLayout(int format, int plane, int& pixelBytes, int& sampleBytes, int& shift) {
+    sampleBytes = format == kVideoFormatP010 || format == kVideoFormatI010 ? 2 : 1;
+    shift = plane == 0 ? 0 : 1;
+    switch (format) {
+    case kVideoFormatI420:
+    case kVideoFormatI010:
+        pixelBytes = sampleBytes;
+        return plane < 3;
+    case kVideoFormatNV12:
+    case kVideoFormatP010:
+        pixelBytes = sampleBytes * (plane == 0 ? 1 : 2);
+        return plane < 2;
+    default:
+        return false;
+    }
+}
+
+int readSample(const uint8_t* p, int sampleBytes) {
+    if (sampleBytes == 1) {
+        return *p;
+    }
+    uint16_t value;
+    std::memcpy(&value, p, 2);
+    return value;
+}
+
+/**
+ * @brief 按文档中的公式逐采样计算fadeLayer的期望结果
+ */
+void referenceFade(TestFrame& canvas, const TestFrame& layer, int x, int y, int opacity) {
+    const int format = canvas.frame.format;
+    const int weight = opacity + (opacity >> 7);
+    const int valueShift = format == kVideoFormatP010 ? 6 : 0;
+    x &= ~1;
+    y &= ~1;
+    for (int plane = 0; plane < 3; ++plane) {
+        int pixelBytes, sampleBytes, shift;
+        if (!planeLayout(format, plane, pixelBytes, sampleBytes, shift)) {
+            break;
+        }
+        const int px = x >> shift;
+        const int py = y >> shift;
+        const int layerWidth = (layer.frame.width + shift) >> shift;
+        const int layerHeight = (layer.frame.height + shift) >> shift;
+        const int canvasWidth = (canvas.frame.width + shift) >> shift;
+        const int canvasHeight = (canvas.frame.height + shift) >> shift;
+        for (int row = 0; row < layerHeight; ++row) {
+            const int cy = py + row;
+            if (cy < 0 || cy >= canvasHeight) {
+                continue;
+            }
+            for (int col = 0; col < layerWidth; ++col) {
+                const int cx = px + col;
+                if (cx < 0 || cx >= canvasWidth) {
+                    continue;
+                }
+                const uint8_t* src = layer.frame.data[plane] + static_cast<size_t>(row) * layer.frame.linesize[plane] +
+                                     static_cast<size_t>(col) * pixelBytes;
+                uint8_t* dst = canvas.frame.data[plane] + static_cast<size_t>(cy) * canvas.frame.linesize[plane] +
+                               static_cast<size_t>(cx) * pixelBytes;
+                for (int s = 0; s < pixelBytes; s += sampleBytes) {
+                    const int a = readSample(src + s, sampleBytes) >> valueShift;
+                    const int b = readSample(dst + s, sampleBytes) >> valueShift;
+                    const int value = ((a * weight + b * (256 - weight)) >> 8) << valueShift;
+                    if (sampleBytes == 1) {
+                        dst[s] = static_cast<uint8_t>(value);
+                    } else {
+                        const uint16_t sample = static_cast<uint16_t>(value);
+                        std::memcpy(dst + s, &sample, 2);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void testYuvOpacity() {
+    std::mt19937 rng(42);
+    const int formats[] = {kVideoFormatI420, kVideoFormatNV12, kVideoFormatP010, kVideoFormatI010};
+    const int opacities[] = {0, 1, 128, 200, 254, 255};
+    struct Placement {
+        int width, height, x, y;
+    };
+    // 奇数坐标向下取整到偶数；最后两项分别越过右下和左上边界
+    const Placement placements[] = {{6, 4, 2, 2}, {7, 5, 3, 1}, {10, 6, 12, 6}, {9, 7, -3, -2}};
+
+    for (int format : formats) {
+        for (const Placement& place : placements) {
+            for (int opacity : opacities) {
+                TestFrame layer;
+                makeFrame(layer, format, place.width, place.height, rng);
+                TestFrame canvas;
+                makeFrame(canvas, format, 18, 10, rng);
+                TestFrame expected;
+                cloneFrame(expected, canvas);
+                referenceFade(expected, layer, place.x, place.y, opacity);
+
+                CHECK(fadeLayer(canvas.frame, layer.frame, place.x, place.y, opacity));
+                if (!sameFrame(canvas, expected)) {
+                    std::fprintf(stderr, "format %d opacity %d at (%d, %d) differs\n", format, opacity,
+                                 place.x, place.y);
+                    CHECK(false);
+                }
+            }
+        }
+    }
+
+    // 不透明度255与直接复制相同
+    for (int format : formats) {
+        TestFrame layer;
+        makeFrame(layer, format, 8, 6, rng);
+        TestFrame faded;
+        makeFrame(faded, format, 16, 12, rng);
+        TestFrame copied;
+        cloneFrame(copied, faded);
+        CHECK(fadeLayer(faded.frame, layer.frame, 4, 2, 255));
+        CHECK(blitLayer(copied.frame, layer.frame, 4, 2));
+        CHECK(sameFrame(faded, copied));
+    }
+
+    // 格式不一致时拒绝
+    TestFrame nv12;
+    makeFrame(nv12, kVideoFormatNV12, 8, 8, rng);
+    TestFrame i420;
+    makeFrame(i420, kVideoFormatI420, 8, 8, rng);
+    CHECK(!fadeLayer(nv12.frame, i420.frame, 0, 0, 128));
+}
+
+} // anonymous namespace
+
+int main() {
+    testOverKernels();
+    testTransparentAndClipped();
+    testYuvOpacity();
+    return Test::testResult("Compositor");
+}
@@ -0,0 +1,218 @@
+/**
+ * @file test_mp4_muxer.cpp
+ * @brief FragmentedMP4Muxer输出结构的测试
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 把封装结果按盒子结构解析回来，验证：
+ * - esds中每个描述符的长度与其后实际的字节数一致
+ * - 早于首个视频关键帧的音频不被截断到0，所有轨道按最早的样本整体平移
+ */
+
+#include "MP4Muxer.h"
+#include "TestCheck.h"
+#include <cstring>
+#include <vector>
+
+using namespace SimpleOBS;
+
+namespace {
+
+uint32_t read32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+/**
+ * @brief 在[begin, end)中递归查找第一个指定类型的盒子
+ * @param[out] bodyBegin 盒子内容（不含8字节头）的起始位置
+ * @param[out] bodyEnd 盒子的结束位置
+ * @return false表示没有找到
+ */
+bool findBox(const uint8_t* begin, const uint8_t* end, const char* type,
+             const uint8_t*& bodyBegin, const uint8_t*& bodyEnd) {
+    // 只有这些容器盒子的内容是子盒子序列
+    static const char* const containers[] = {"moov", "trak", "mdia", "minf", "stbl", "moof", "traf"};
+    while (end - begin >= 8) {
+        const uint32_t size = read32(begin);
+        if (size < 8 || size > static_cast<size_t>(end - begin)) {
+            return false;
+        }
+        const uint8_t* boxEnd = begin + size;
+        if (std::memcmp(begin + 4, type, 4) == 0) {
+            bodyBegin = begin + 8;
+            bodyEnd = boxEnd;
+            return true;
+        }
+        for (const char* container : containers) {
+            if (std::memcmp(begin + 4, container, 4) == 0 &&
+                findBox(begin + 8, boxEnd, type, bodyBegin, bodyEnd)) {
+                return true;
+            }
+        }
+        // stsd是完整盒子，后跟条目数；mp4a条目有28字节的固定字段
+        if (std::memcmp(begin + 4, "stsd", 4) == 0 && size >= 16 &&
+            findBox(begin + 16, boxEnd, type, bodyBegin, bodyEnd)) {
+            return true;
+        }
+        if (std::memcmp(begin + 4, "mp4a", 4) == 0 && size >= 36 &&
+            findBox(begin + 36, boxEnd, type, bodyBegin, bodyEnd)) {
+            return true;
+        }
+        begin = boxEnd;
+    }
+    return false;
+}
+
+/**
+ * @brief 读取一个描述符头，检查其长度不超出父级范围
+ * @return 描述符内容的结束位置，失败时返回nullptr
+ */
+const uint8_t* readDescriptor(const uint8_t*& p, const uint8_t* end, uint8_t tag) {
+    if (end - p < 2 || p[0] != tag) {
+        return nullptr;
+    }
+    const size_t length = p[1];
+    p += 2;
+    if (length > static_cast<size_t>(end - p)) {
+        return nullptr;
+    }
+    return p + length;
+}
+
+EncodedPacket makeAudioPacket(int64_t ptsUs) {
+    EncodedPacket packet;
+    packet.type = PacketType::Audio;
+    packet.data.assign(200, 0x21);
+    packet.pts = FrameTime(ptsUs);
+    packet.dts = packet.pts;
+    packet.duration = FrameTime(21333);
+    return packet;
+}
+
+void testEsdsLengths() {
+    const std::vector<uint8_t> asc = {0x11, 0x90};
+    FragmentedMP4Muxer muxer;
+    MP4TrackConfig config;
+    config.type = PacketType::Audio;
+    config.codec = "aac";
+    config.extradata = asc;
+    CHECK(muxer.addTrack(config) == 1);
+
+    std::vector<uint8_t> out;
+    CHECK(muxer.addPacket(makeAudioPacket(0), out));
+    muxer.flush(out);
+
+    const uint8_t* body = nullptr;
+    const uint8_t* end = nullptr;
+    CHECK(findBox(out.data(), out.data() + out.size(), "esds", body, end));
+    if (!body) {
+        return;
+    }
+    const uint8_t* p = body + 4;   // 版本与标志
+
+    // ES_Descriptor的内容正好延伸到esds末尾
+    const uint8_t* esEnd = readDescriptor(p, end, 0x03);
+    CHECK(esEnd == end);
+    if (!esEnd) {
+        return;
+    }
+    p += 3;
+
+    // DecoderConfigDescriptor：13字节固定字段 + DecoderSpecificInfo
+    const uint8_t* configEnd = readDescriptor(p, esEnd, 0x04);
+    CHECK(configEnd != nullptr);
+    if (!configEnd) {
+        return;
+    }
+    CHECK(p[0] == 0x40);
+    p += 13;
+    const uint8_t* ascEnd = readDescriptor(p, configEnd, 0x05);
+    CHECK(ascEnd == configEnd);
+    CHECK(ascEnd && static_cast<size_t>(ascEnd - p) == asc.size() &&
+          std::memcmp(p, asc.data(), asc.size()) == 0);
+    p = configEnd;
+
+    // SLConfigDescriptor收尾
+    const uint8_t* slEnd = readDescriptor(p, esEnd, 0x06);
+    CHECK(slEnd == esEnd);
+    CHECK(slEnd && p[0] == 2);
+}
+
+/**
+ * @brief 读取第index个traf的轨道ID和tfdt
+ */
+bool readTraf(const std::vector<uint8_t>& out, int index, uint32_t& trackId, uint64_t& baseDts) {
+    const uint8_t* begin = out.data();
+    const uint8_t* end = out.data() + out.size();
+    const uint8_t* body = nullptr;
+    const uint8_t* bodyEnd = nullptr;
+    if (!findBox(begin, end, "moof", body, bodyEnd)) {
+        return false;
+    }
+    // moof内容：mfhd之后是各轨道的traf
+    const uint8_t* p = body;
+    int seen = -1;
+    while (bodyEnd - p >= 8) {
+        const uint32_t size = read32(p);
+        if (std::memcmp(p + 4, "traf", 4) == 0 && ++seen == index) {
+            const uint8_t* tfhd = nullptr;
+            const uint8_t* tfhdEnd = nullptr;
+            const uint8_t* tfdt = nullptr;
+            const uint8_t* tfdtEnd = nullptr;
+            if (!findBox(p + 8, p + size, "tfhd", tfhd, tfhdEnd) ||
+                !findBox(p + 8, p + size, "tfdt", tfdt, tfdtEnd)) {
+                return false;
+            }
+            trackId = read32(tfhd + 4);
+            baseDts = (uint64_t(read32(tfdt + 4)) << 32) | read32(tfdt + 8);
+            return true;
+        }
+        p += size;
+    }
+    return false;
+}
+
+void testEarlyAudio() {
+    FragmentedMP4Muxer muxer;
+    MP4TrackConfig video;
+    video.codec = "h264";
+    video.extradata = {0x01, 0x42, 0x00, 0x1E, 0xFF, 0xE0, 0x00};
+    CHECK(muxer.addTrack(video) == 1);
+    MP4TrackConfig audio;
+    audio.type = PacketType::Audio;
+    audio.codec = "aac";
+    CHECK(muxer.addTrack(audio) == 2);
+
+    std::vector<uint8_t> out;
+    EncodedPacket keyframe;
+    keyframe.type = PacketType::Video;
+    keyframe.keyframe = true;
+    keyframe.data = {0x00, 0x00, 0x00, 0x02, 0x65, 0x88};
+    keyframe.pts = FrameTime(1000000);
+    keyframe.dts = keyframe.pts;
+    CHECK(muxer.addPacket(keyframe, out));
+    // 音频比视频早20ms开始
+    CHECK(muxer.addPacket(makeAudioPacket(980000), out));
+    CHECK(muxer.addPacket(makeAudioPacket(1001333), out));
+    muxer.flush(out);
+
+    uint32_t videoId = 0;
+    uint32_t audioId = 0;
+    uint64_t videoDts = 0;
+    uint64_t audioDts = 0;
+    CHECK(readTraf(out, 0, videoId, videoDts));
+    CHECK(readTraf(out, 1, audioId, audioDts));
+    CHECK(videoId == 1 && audioId == 2);
+    CHECK(audioDts == 0);
+    CHECK(videoDts == 90000 * 20 / 1000);
+}
+
+} // anonymous namespace
+
+int main() {
+    testEsdsLengths();
+    testEarlyAudio();
+    return Test::testResult("FragmentedMP4Muxer");
+}
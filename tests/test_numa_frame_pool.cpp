@@ -0,0 +1,170 @@
+/**
+ * @file test_numa_frame_pool.cpp
+ * @brief NumaFramePool在伪造拓扑上的测试
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 在临时目录中伪造/sys/devices/system/node，使任意机器都呈现两个NUMA节点，验证：
+ * - 每个节点一个子池，指定节点时只有该节点的子池
+ * - 本节点子池有空闲帧时取本地帧，不计跨节点
+ * - 本节点子池取空后从其他节点取帧，并计入对方子池的remote_acquires
+ */
+
+#include "FramePool.h"
+#include "Numa.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace SimpleOBS;
+
+namespace {
+
+constexpr int kFrames = 4;
+
+void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream file(path);
+    file << text << "\n";
+}
+
+/**
+ * @brief 伪造的sysfs节点目录：nodes个节点，CPU都取0号，保证绑核可以成功
+ */
+std::string makeFakeSysfs(int nodes) {
+    char pattern[] = "/tmp/simpleobs_numa_XXXXXX";
+    std::string root = mkdtemp(pattern);
+    writeFile(root + "/online", nodes > 1 ? "0-" + std::to_string(nodes - 1) : "0");
+    for (int node = 0; node < nodes; ++node) {
+        std::string dir = root + "/node" + std::to_string(node);
+        mkdir(dir.c_str(), 0755);
+        writeFile(dir + "/cpulist", "0");
+    }
+    return root;
+}
+
+void removeFakeSysfs(const std::string& root, int nodes) {
+    for (int node = 0; node < nodes; ++node) {
+        std::string dir = root + "/node" + std::to_string(node);
+        std::remove((dir + "/cpulist").c_str());
+        rmdir(dir.c_str());
+    }
+    std::remove((root + "/online").c_str());
+    rmdir(root.c_str());
+}
+
+FramePoolSettings poolSettings(int node) {
+    FramePoolSettings settings;
+    settings.width = 64;
+    settings.height = 64;
+    settings.frames = kFrames;
+    settings.huge_pages = HugePageMode::Off;
+    settings.node = node;
+    return settings;
+}
+
+void testTopologyOverride(const std::string& root) {
+    setNumaTopologyRoot(root);
+    CHECK(numaNodeCount() == 2);
+    CHECK(numaNodeCpus(1).size() == 1);
+    CHECK(numaNodeCpus(2).empty());
+}
+
+void testLocalAndRemoteAcquire() {
+    NumaFramePool pool;
+    CHECK(pool.initialize(poolSettings(-1)));
+    CHECK(pool.getStats().size() == 2);
+
+    // 节点1的子池取空，全部为本地取帧
+    VideoFrame node1[kFrames];
+    for (auto& frame : node1) {
+        CHECK(pool.acquire(frame, 1));
+    }
+    std::vector<FramePoolStats> stats = pool.getStats();
+    CHECK(stats[1].free == 0);
+    CHECK(stats[0].free == kFrames);
+    CHECK(stats[0].remote_acquires == 0 && stats[1].remote_acquires == 0);
+
+    // 再取就只能跨节点，计入节点0子池
+    VideoFrame remote;
+    CHECK(pool.acquire(remote, 1));
+    stats = pool.getStats();
+    CHECK(stats[0].free == kFrames - 1);
+    CHECK(stats[0].remote_acquires == 1);
+    CHECK(stats[1].remote_acquires == 0);
+
+    // 节点0仍有本地帧，不计跨节点
+    VideoFrame node0[kFrames - 1];
+    for (auto& frame : node0) {
+        CHECK(pool.acquire(frame, 0));
+    }
+    stats = pool.getStats();
+    CHECK(stats[0].free == 0);
+    CHECK(stats[0].remote_acquires == 1);
+    CHECK(stats[1].remote_acquires == 0);
+
+    // 全部取空后失败
+    VideoFrame none;
+    CHECK(!pool.acquire(none, 0));
+    CHECK(!pool.acquire(none, 1));
+
+    // 帧归还到各自所属的子池
+    CHECK(pool.release(remote));
+    for (auto& frame : node1) {
+        CHECK(pool.release(frame));
+    }
+    for (auto& frame : node0) {
+        CHECK(pool.release(frame));
+    }
+    stats = pool.getStats();
+    CHECK(stats[0].free == kFrames && stats[1].free == kFrames);
+}
+
+void testPinnedNode() {
+    NumaFramePool pool;
+    CHECK(pool.initialize(poolSettings(1)));
+    CHECK(pool.getStats().size() == 1);
+
+    // 只有一个子池时任何节点的请求都是本地取帧
+    VideoFrame frame;
+    CHECK(pool.acquire(frame, 0));
+    CHECK(pool.getStats()[0].remote_acquires == 0);
+    CHECK(pool.release(frame));
+}
+
+void testSingleNodeFallback(const std::string& root) {
+    setNumaTopologyRoot(root);
+    CHECK(numaNodeCount() == 1);
+
+    NumaFramePool pool;
+    CHECK(pool.initialize(poolSettings(-1)));
+    CHECK(pool.getStats().size() == 1);
+    VideoFrame frame;
+    CHECK(pool.acquire(frame));
+    CHECK(pool.release(frame));
+}
+
+} // anonymous namespace
+
+int main() {
+    const std::string twoNodes = makeFakeSysfs(2);
+    const std::string oneNode = makeFakeSysfs(1);
+
+    testTopologyOverride(twoNodes);
+    testLocalAndRemoteAcquire();
+    testPinnedNode();
+    testSingleNodeFallback(oneNode);
+
+    setNumaTopologyRoot("");
+    CHECK(numaNodeCount() >= 1);
+
+    removeFakeSysfs(twoNodes, 2);
+    removeFakeSysfs(oneNode, 1);
+
+    return Test::testResult("NumaFramePool");
+}
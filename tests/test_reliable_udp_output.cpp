@@ -0,0 +1,187 @@
+/**
+ * @file test_reliable_udp_output.cpp
+ * @brief ReliableUDPOutput与进程内接收器的回环测试
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 接收器模拟5%丢包，发送缓冲区取较小容量使槽位被多次复用，验证：
+ * - 所有数据报经NAK重传后按序交付，没有超出延迟窗口的丢失
+ * - 交付的TS包每个PID的连续性计数器都连续，即没有重复、缺失或乱序
+ * - 限速时持续丢包使发送速率降到最大带宽以下但不低于下限，无丢包时保持最大带宽
+ */
+
+#include "ReliableUDPOutput.h"
+#include "TestCheck.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using namespace SimpleOBS;
+
+namespace {
+
+/**
+ * @brief 检查交付的TS流：同步字节和每个PID的连续性计数器
+ */
+struct TSChecker {
+    int continuity[8192];
+    uint64_t packets = 0;
+    uint64_t errors = 0;
+
+    TSChecker() {
+        for (int& c : continuity) {
+            c = -1;
+        }
+    }
+
+    void feed(const uint8_t* data, size_t size) {
+        if (size % kTSPacketSize != 0) {
+            ++errors;
+            return;
+        }
+        for (size_t i = 0; i < size; i += kTSPacketSize) {
+            const uint8_t* ts = data + i;
+            ++packets;
+            if (ts[0] != 0x47) {
+                ++errors;
+                continue;
+            }
+            int pid = ((ts[1] & 0x1F) << 8) | ts[2];
+            if ((ts[3] & 0x10) == 0) {
+                continue;   // 无负载的包不递增计数器
+            }
+            int cc = ts[3] & 0x0F;
+            if (continuity[pid] >= 0 && cc != ((continuity[pid] + 1) & 0x0F)) {
+                ++errors;
+            }
+            continuity[pid] = cc;
+        }
+    }
+};
+
+void testLossRecovery() {
+    TSChecker checker;
+    std::atomic<uint64_t> deliveredBytes{0};
+
+    ReliableUDPReceiverSettings receiverSettings;
+    receiverSettings.port = 0;
+    receiverSettings.latency_ms = 500;
+    receiverSettings.loss_rate = 0.05;
+    receiverSettings.loss_seed = 7;
+    ReliableUDPReceiver receiver(receiverSettings, [&](const uint8_t* data, size_t size) {
+        checker.feed(data, size);
+        deliveredBytes.fetch_add(size);
+    });
+    CHECK(receiver.start());
+
+    ReliableUDPSettings settings;
+    settings.port = receiver.getPort();
+    settings.latency_ms = 500;
+    settings.buffer_packets = 1024;
+    ReliableUDPOutput output("rudp_loss", settings);
+    CHECK(output.start());
+
+    // 约3000个数据报，每个视频包约3个数据报
+    for (int i = 0; i < 1000; ++i) {
+        EncodedPacket packet;
+        packet.type = PacketType::Video;
+        packet.keyframe = i % 60 == 0;
+        packet.data.assign(3800, static_cast<uint8_t>(i));
+        packet.pts = FrameTime(static_cast<int64_t>(i) * 1000);
+        packet.dts = packet.pts;
+        CHECK(output.sendPacket(packet));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // 等待最后的未满数据报和所有重传到达
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        ReliableUDPStats sent = output.getTransportStats();
+        if (sent.packets_sent > 0 && receiver.getStats().packets_delivered == sent.packets_sent &&
+            output.getStats().bytes_sent == deliveredBytes.load()) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    output.stop();
+    receiver.stop();
+
+    ReliableUDPStats sent = output.getTransportStats();
+    ReliableUDPReceiverStats received = receiver.getStats();
+    CHECK(sent.packets_sent >= 3000);
+    CHECK(sent.expired == 0);
+    CHECK(received.simulated_drops > 0);
+    CHECK(sent.retransmitted >= received.simulated_drops / 2);
+    CHECK(received.lost == 0);
+    CHECK(received.packets_delivered == sent.packets_sent);
+    CHECK(deliveredBytes.load() == output.getStats().bytes_sent);
+    CHECK(checker.packets > 0);
+    CHECK(checker.errors == 0);
+
+    // 失败时打印两端统计，便于判断丢失发生在哪一侧
+    if (Test::failures > 0) {
+        std::fprintf(stderr, "sent=%llu retransmitted=%llu drops=%llu delivered=%llu lost=%llu\n",
+                     static_cast<unsigned long long>(sent.packets_sent),
+                     static_cast<unsigned long long>(sent.retransmitted),
+                     static_cast<unsigned long long>(received.simulated_drops),
+                     static_cast<unsigned long long>(received.packets_delivered),
+                     static_cast<unsigned long long>(received.lost));
+    }
+}
+
+/**
+ * @brief 以给定丢包率限速发送约600ms的数据，返回结束时的发送带宽
+ */
+int64_t pacedRun(double lossRate, int64_t bitrate) {
+    ReliableUDPReceiverSettings receiverSettings;
+    receiverSettings.port = 0;
+    receiverSettings.latency_ms = 500;
+    receiverSettings.loss_rate = lossRate;
+    receiverSettings.loss_seed = 11;
+    ReliableUDPReceiver receiver(receiverSettings, [](const uint8_t*, size_t) {});
+    CHECK(receiver.start());
+
+    ReliableUDPSettings settings;
+    settings.port = receiver.getPort();
+    settings.latency_ms = 500;
+    settings.bitrate = bitrate;
+    ReliableUDPOutput output("rudp_pacing", settings);
+    CHECK(output.start());
+
+    // 约8Mbit/s的数据，低于最大带宽，只有拥塞控制会让速率下降
+    for (int i = 0; i < 60; ++i) {
+        EncodedPacket packet;
+        packet.type = PacketType::Video;
+        packet.keyframe = i == 0;
+        packet.data.resize(10000, static_cast<uint8_t>(i));
+        packet.pts = FrameTime(static_cast<int64_t>(i) * 10000);
+        packet.dts = packet.pts;
+        CHECK(output.sendPacket(packet));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    const int64_t pacing = output.getTransportStats().pacing_bitrate;
+    output.stop();
+    receiver.stop();
+    return pacing;
+}
+
+void testPacingAdapts() {
+    const int64_t bitrate = 40000000;
+    const int64_t clean = pacedRun(0.0, bitrate);
+    CHECK(clean == bitrate);
+
+    const int64_t lossy = pacedRun(0.10, bitrate);
+    CHECK(lossy < bitrate);
+    CHECK(lossy >= bitrate / 4);
+}
+
+} // anonymous namespace
+
+int main() {
+    testLossRecovery();
+    testPacingAdapts();
+    return Test::testResult("ReliableUDPOutput");
+}
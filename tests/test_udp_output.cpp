@@ -0,0 +1,166 @@
+/**
+ * @file test_udp_output.cpp
+ * @brief UDPOutput回环测试
+ * @author SimpleOBS Team
+ * @date 2025-07-04
+ * @version 1.0.0
+ *
+ * @description
+ * 在本机回环地址上启动一个接收套接字，验证：
+ * - 不满一个数据报的TS包在flush_interval_ms后由发送线程发出，无需后续数据包
+ * - 限速发送的所有数据报都完整到达，且都由188字节的TS包组成
+ */
+
+#include "UDPOutput.h"
+#include "TestCheck.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace SimpleOBS;
+
+namespace {
+
+/**
+ * @brief 绑定到127.0.0.1随机端口的接收套接字
+ */
+struct Receiver {
+    int fd = -1;
+    int port = 0;
+
+    Receiver() {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        int bytes = 8 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof(bytes));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+    }
+
+    ~Receiver() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    // 等待一个数据报，超时返回-1
+    int receive(uint8_t* buffer, size_t size, int timeoutMs) {
+        pollfd p{fd, POLLIN, 0};
+        if (poll(&p, 1, timeoutMs) <= 0) {
+            return -1;
+        }
+        return static_cast<int>(recv(fd, buffer, size, 0));
+    }
+};
+
+bool isTSDatagram(const uint8_t* data, int size) {
+    if (size <= 0 || size % kTSPacketSize != 0) {
+        return false;
+    }
+    for (int i = 0; i < size; i += kTSPacketSize) {
+        if (data[i] != 0x47) {
+            return false;
+        }
+    }
+    return true;
+}
+
+EncodedPacket makePacket(PacketType type, size_t size, int64_t ptsUs, bool keyframe) {
+    EncodedPacket packet;
+    packet.type = type;
+    packet.data.assign(size, 0xAB);
+    packet.pts = FrameTime(ptsUs);
+    packet.dts = packet.pts;
+    packet.keyframe = keyframe;
+    return packet;
+}
+
+// 单个小数据包只产生不满一个数据报的TS包，应在flush_interval_ms后到达
+void testTimedFlush() {
+    Receiver receiver;
+    UDPOutputSettings settings;
+    settings.port = receiver.port;
+    settings.flush_interval_ms = 20;
+    UDPOutput output("udp_flush", settings);
+    CHECK(output.start());
+
+    CHECK(output.sendPacket(makePacket(PacketType::Audio, 64, 0, true)));
+
+    uint8_t buffer[2048];
+    auto begin = std::chrono::steady_clock::now();
+    int size = receiver.receive(buffer, sizeof(buffer), 1000);
+    auto waited = std::chrono::steady_clock::now() - begin;
+    CHECK(size > 0 && size < kUDPDatagramSize);
+    CHECK(isTSDatagram(buffer, size));
+    CHECK(waited < std::chrono::milliseconds(500));
+
+    output.stop();
+}
+
+// 限速发送一串音视频包，接收端收到的字节数与发送统计一致
+void testPacedDelivery() {
+    Receiver receiver;
+    UDPOutputSettings settings;
+    settings.port = receiver.port;
+    settings.bitrate = 40000000;
+    settings.batch_size = 8;
+    UDPOutput output("udp_paced", settings);
+    CHECK(output.start());
+
+    std::atomic<bool> done{false};
+    uint64_t receivedBytes = 0;
+    uint64_t receivedDatagrams = 0;
+    int malformed = 0;
+    std::thread reader([&]() {
+        uint8_t buffer[2048];
+        int idle = 0;
+        while (idle < 5) {
+            int size = receiver.receive(buffer, sizeof(buffer), 100);
+            if (size < 0) {
+                idle = done.load() ? idle + 1 : 0;
+                continue;
+            }
+            if (!isTSDatagram(buffer, size)) {
+                ++malformed;
+            }
+            receivedBytes += static_cast<uint64_t>(size);
+            ++receivedDatagrams;
+        }
+    });
+
+    for (int i = 0; i < 120; ++i) {
+        int64_t pts = i * 33333;
+        CHECK(output.sendPacket(makePacket(PacketType::Video, i % 30 == 0 ? 40000 : 4000, pts, i % 30 == 0)));
+        CHECK(output.sendPacket(makePacket(PacketType::Audio, 300, pts, true)));
+    }
+    output.stop();
+    done.store(true);
+    reader.join();
+
+    OutputStats stats = output.getStats();
+    CHECK(stats.packets_dropped == 0);
+    CHECK(stats.errors == 0);
+    CHECK(stats.packets_sent > 0);
+    CHECK(receivedDatagrams == stats.packets_sent);
+    CHECK(receivedBytes == stats.bytes_sent);
+    CHECK(malformed == 0);
+}
+
+} // anonymous namespace
+
+int main() {
+    testTimedFlush();
+    testPacedDelivery();
+    return Test::testResult("UDPOutput");
+}